@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+
+// ✅ Jitter buffer adaptativo
+//
+// Lado produtor (onArrival): mede quanto cada chunk chegou atrasado em relação
+// ao "relógio de mídia" (frames acumulados / taxa) e guarda o pico recente desse
+// espalhamento. A profundidade alvo é o menor nível que absorve esse pico.
+//
+// Lado consumidor (updateRatio): compara o nível suavizado do buffer com o alvo e
+// devolve uma razão de reamostragem próxima de 1.0 (±0.5%) para o DriftResampler,
+// corrigindo o drift entre os relógios do sender e do receptor sem pular frames.
+class AdaptiveJitterBuffer
+{
+public:
+    static constexpr int32_t MIN_TARGET_MS = 40;
+    static constexpr int32_t MAX_TARGET_MS = 1000;    // Antigo TARGET_PREBUFFER_MS vira o teto
+    static constexpr int32_t INITIAL_TARGET_MS = 120; // Até ter estatística de chegada
+    static constexpr int32_t SAFETY_MS = 10;
+    static constexpr int32_t UNDERRUN_PENALTY_MS = 20; // Cada underrun aumenta o alvo...
+    static constexpr int32_t MAX_PENALTY_MS = 500;
+    static constexpr double PENALTY_DECAY_MS_PER_S = 2.0; // ...e a penalidade some devagar
+    static constexpr double SPREAD_DECAY_S = 15.0;        // Constante de tempo do pico de jitter
+    static constexpr int64_t STREAM_GAP_US = 1000000;     // Pausa do sender: recomeçar a referência
+    static constexpr double MAX_RATIO_DEVIATION = 0.005;  // ±0.5%
+    static constexpr double RATIO_GAIN_PER_S = 0.05;      // 100ms de erro => 0.5%
+    static constexpr double MAX_RATIO_STEP = 0.00002;     // Por callback, evita "warble"
+    static constexpr double FILL_SMOOTHING_S = 2.0;
+
+    void configure(int32_t sampleRate)
+    {
+        rate = std::max(sampleRate, 1);
+        reset();
+    }
+
+    // Só com produtor e consumidor parados
+    void reset()
+    {
+        lastArrivalUs = 0;
+        mediaFrames = 0;
+        lastChunkFrames = 0;
+        referenceLatenessUs = 0.0;
+        peakSpreadUs = 0.0;
+        jitterUs.store(0.0f, std::memory_order_relaxed);
+        penaltyUs.store(0, std::memory_order_relaxed);
+        target.store(msToFrames(INITIAL_TARGET_MS), std::memory_order_relaxed);
+        smoothedFill = -1.0;
+        currentRatio = 1.0;
+    }
+
+    // ✅ PRODUTOR: chamado a cada chunk aceito
+    void onArrival(int64_t nowUs, int32_t frames, int32_t burstFrames)
+    {
+        double mediaUs = (mediaFrames * 1000000.0) / rate;
+        double latenessUs = static_cast<double>(nowUs) - mediaUs;
+
+        if (lastArrivalUs == 0 || nowUs - lastArrivalUs > STREAM_GAP_US)
+        {
+            // Primeiro chunk ou retomada após pausa: não é jitter, é descontinuidade
+            referenceLatenessUs = latenessUs;
+        }
+        else
+        {
+            double elapsedS = std::max(0.0, (nowUs - lastArrivalUs) / 1000000.0);
+
+            // Jitter estilo RFC 3550: desvio entre intervalo de chegada e duração de mídia
+            double mediaDeltaUs = (lastChunkFrames * 1000000.0) / rate;
+            double d = std::abs((nowUs - lastArrivalUs) - mediaDeltaUs);
+            float j = jitterUs.load(std::memory_order_relaxed);
+            jitterUs.store(j + static_cast<float>((d - j) / 16.0), std::memory_order_relaxed);
+
+            // Envelope inferior do atraso: desce na hora, sobe devagar (acompanha drift de até 1000ppm)
+            referenceLatenessUs = std::min(latenessUs, referenceLatenessUs + elapsedS * 1000.0);
+
+            // Pico do espalhamento com decaimento exponencial aproximado
+            peakSpreadUs -= peakSpreadUs * std::min(1.0, elapsedS / SPREAD_DECAY_S);
+
+            // Penalidade de underrun decai com o tempo
+            int32_t decay = static_cast<int32_t>(elapsedS * PENALTY_DECAY_MS_PER_S * 1000.0);
+            decayPenalty(decay);
+        }
+
+        double spreadUs = latenessUs - referenceLatenessUs;
+        peakSpreadUs = std::max(peakSpreadUs, spreadUs);
+
+        mediaFrames += frames;
+        lastChunkFrames = frames;
+        lastArrivalUs = nowUs;
+
+        // Alvo = pico de jitter + um chunk (o buffer esvazia entre chegadas) + burst + margem
+        int64_t targetFrames = static_cast<int64_t>((peakSpreadUs * rate) / 1000000.0) +
+                               frames + burstFrames + msToFrames(SAFETY_MS) +
+                               msToFrames(penaltyUs.load(std::memory_order_relaxed) / 1000);
+        targetFrames = std::clamp<int64_t>(targetFrames, msToFrames(MIN_TARGET_MS), msToFrames(MAX_TARGET_MS));
+        target.store(static_cast<int32_t>(targetFrames), std::memory_order_release);
+    }
+
+    // ✅ CONSUMIDOR: underrun => o alvo atual não era seguro
+    void noteUnderrun()
+    {
+        int32_t current = penaltyUs.load(std::memory_order_relaxed);
+        int32_t next;
+        do
+        {
+            next = std::min(current + UNDERRUN_PENALTY_MS * 1000, MAX_PENALTY_MS * 1000);
+        } while (!penaltyUs.compare_exchange_weak(current, next, std::memory_order_relaxed));
+
+        int32_t t = target.load(std::memory_order_relaxed);
+        target.store(std::min(t + msToFrames(UNDERRUN_PENALTY_MS), msToFrames(MAX_TARGET_MS)),
+                     std::memory_order_release);
+    }
+
+    // ✅ CONSUMIDOR: razão de reamostragem (frames de entrada por frame de saída)
+    double updateRatio(int32_t bufferedFrames, int32_t callbackFrames)
+    {
+        if (smoothedFill < 0.0)
+        {
+            smoothedFill = bufferedFrames;
+        }
+        double alpha = std::min(1.0, callbackFrames / (rate * FILL_SMOOTHING_S));
+        smoothedFill += (bufferedFrames - smoothedFill) * alpha;
+
+        double errorS = (smoothedFill - targetFrames()) / rate;
+        double desired = 1.0 + std::clamp(errorS * RATIO_GAIN_PER_S, -MAX_RATIO_DEVIATION, MAX_RATIO_DEVIATION);
+        currentRatio += std::clamp(desired - currentRatio, -MAX_RATIO_STEP, MAX_RATIO_STEP);
+        return currentRatio;
+    }
+
+    // Reinicia só o estado do consumidor (após prebuffer ou limpeza do ring)
+    void resetConsumer()
+    {
+        smoothedFill = -1.0;
+        currentRatio = 1.0;
+    }
+
+    int32_t targetFrames() const { return target.load(std::memory_order_acquire); }
+    double ratio() const { return currentRatio; }
+    float arrivalJitterMs() const { return jitterUs.load(std::memory_order_relaxed) / 1000.0f; }
+
+private:
+    int32_t msToFrames(int64_t ms) const
+    {
+        return static_cast<int32_t>((ms * rate) / 1000);
+    }
+
+    void decayPenalty(int32_t amountUs)
+    {
+        if (amountUs <= 0)
+            return;
+        int32_t current = penaltyUs.load(std::memory_order_relaxed);
+        while (current > 0 &&
+               !penaltyUs.compare_exchange_weak(current, std::max(0, current - amountUs),
+                                                std::memory_order_relaxed))
+        {
+        }
+    }
+
+    int32_t rate = 48000;
+
+    // Estado do produtor
+    int64_t lastArrivalUs = 0;
+    int64_t mediaFrames = 0;
+    int32_t lastChunkFrames = 0;
+    double referenceLatenessUs = 0.0;
+    double peakSpreadUs = 0.0;
+
+    // Estado do consumidor
+    double smoothedFill = -1.0;
+    double currentRatio = 1.0;
+
+    // Compartilhado
+    std::atomic<int32_t> target{0};
+    std::atomic<int32_t> penaltyUs{0}; // Penalidade de underrun acumulada
+    std::atomic<float> jitterUs{0.0f};
+};
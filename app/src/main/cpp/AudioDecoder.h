@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// ✅ Interface de decodificador de áudio comprimido (um pacote por chunk)
+//
+// Implementada por OpusAudioDecoder (libopus, opcional no build) e por
+// decodificadores falsos nos testes de host. Usada só pela thread do DecodeWorker.
+class AudioDecoder
+{
+public:
+    virtual ~AudioDecoder() = default;
+
+    // Decodifica um pacote em PCM16 intercalado. Retorna frames (< 0 = erro).
+    virtual int32_t decode(const uint8_t *data, int32_t length, int16_t *pcm, int32_t maxFrames) = 0;
+
+    // PLC: sintetiza `frames` frames no lugar de um pacote perdido
+    virtual int32_t conceal(int16_t *pcm, int32_t frames) = 0;
+
+    // FEC: reconstrói o pacote ANTERIOR a `data` a partir da redundância embutida.
+    // Sem redundância o resultado equivale ao PLC.
+    virtual int32_t recover(const uint8_t *data, int32_t length, int16_t *pcm, int32_t frames) = 0;
+
+    // Descarta o estado (descontinuidade grande no stream)
+    virtual void reset() = 0;
+
+    virtual const char *name() const = 0;
+};
+
+// Decodificador Opus, ou nullptr se o .so foi compilado sem SHIBASYNC_WITH_OPUS
+// ou a taxa não é suportada pelo Opus (8/12/16/24/48kHz)
+std::unique_ptr<AudioDecoder> createOpusDecoder(int32_t sampleRate, int32_t channelCount);
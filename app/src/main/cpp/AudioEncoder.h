@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+// ✅ Interface de codificador de áudio (um pacote por chunk da captura)
+//
+// Implementada por OpusAudioEncoder (libopus, opcional no build). Usada só pela
+// thread de captura, através do CapturePipeline.
+class AudioEncoder
+{
+public:
+    virtual ~AudioEncoder() = default;
+
+    // Codifica `frames` frames PCM16 intercalados. Retorna bytes escritos (< 0 = erro).
+    virtual int32_t encode(const int16_t *pcm, int32_t frames, uint8_t *out, int32_t maxBytes) = 0;
+
+    // Codec no cabeçalho SHB1 (packet::CODEC_*)
+    virtual uint8_t codec() const = 0;
+
+    virtual const char *name() const = 0;
+
+    // Taxa alvo em bits/s (0 = fixa, ex. PCM). setBitrate vale a partir do próximo encode().
+    virtual int32_t bitrate() const { return 0; }
+    virtual bool setBitrate(int32_t) { return false; }
+};
+
+// Codificador Opus com FEC embutido, ou nullptr se o .so foi compilado sem
+// SHIBASYNC_WITH_OPUS ou a taxa não é suportada pelo Opus (8/12/16/24/48kHz)
+std::unique_ptr<AudioEncoder> createOpusEncoder(int32_t sampleRate, int32_t channelCount, int32_t bitrate);
@@ -0,0 +1,378 @@
+#include "AudioKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SHIBA_KERNELS_NEON 1
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define SHIBA_KERNELS_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SHIBA_KERNELS_SSE2 1
+#endif
+
+namespace audiokernels
+{
+    namespace
+    {
+        inline int16_t saturate(float v)
+        {
+            return static_cast<int16_t>(std::clamp(std::lrintf(v), -32768L, 32767L));
+        }
+
+        // Trecho escalar a partir do sample `first` (usado pelas caudas SIMD)
+        inline void scalarFrom(int16_t *samples, int32_t first, int32_t total, int32_t channels,
+                               float startGain, float gainStep)
+        {
+            for (int32_t i = first; i < total; i++)
+            {
+                float g = startGain + static_cast<float>(i / channels) * gainStep;
+                samples[i] = saturate(samples[i] * g);
+            }
+        }
+    }
+
+    void applyGainRampScalar(int16_t *samples, int32_t frames, int32_t channels,
+                             float startGain, float gainStep)
+    {
+        scalarFrom(samples, 0, frames * channels, channels, startGain, gainStep);
+    }
+
+    void applyGainRamp(int16_t *samples, int32_t frames, int32_t channels,
+                       float startGain, float gainStep)
+    {
+        const int32_t total = frames * channels;
+
+        // Rampa só vetoriza quando o bloco SIMD cobre frames inteiros (mono/estéreo)
+        if (gainStep != 0.0f && channels != 1 && channels != 2)
+        {
+            applyGainRampScalar(samples, frames, channels, startGain, gainStep);
+            return;
+        }
+
+        // Frame de cada lane dentro de um bloco (com ganho constante o step zera tudo)
+        float lanes[16];
+        for (int32_t k = 0; k < 16; k++)
+        {
+            lanes[k] = static_cast<float>(k / channels);
+        }
+
+        int32_t i = 0;
+
+#if defined(SHIBA_KERNELS_NEON)
+        // 8 samples por iteração: int16 -> 2x float32x4 -> ganho -> arredonda -> satura
+        // O ganho é recalculado a partir do índice do frame (não acumulado) para
+        // não derivar do escalar em rampas longas
+        const float32x4_t start = vdupq_n_f32(startGain);
+        const float32x4_t inc = vdupq_n_f32(8.0f / channels);
+        float32x4_t f0 = vld1q_f32(lanes);
+        float32x4_t f1 = vld1q_f32(lanes + 4);
+
+        for (; i + 8 <= total; i += 8)
+        {
+            float32x4_t g0 = vmlaq_n_f32(start, f0, gainStep);
+            float32x4_t g1 = vmlaq_n_f32(start, f1, gainStep);
+            int16x8_t s = vld1q_s16(samples + i);
+            float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(s)));
+            float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(s)));
+            int32x4_t rlo = vcvtnq_s32_f32(vmulq_f32(lo, g0));
+            int32x4_t rhi = vcvtnq_s32_f32(vmulq_f32(hi, g1));
+            vst1q_s16(samples + i, vcombine_s16(vqmovn_s32(rlo), vqmovn_s32(rhi)));
+            f0 = vaddq_f32(f0, inc);
+            f1 = vaddq_f32(f1, inc);
+        }
+#elif defined(SHIBA_KERNELS_AVX2)
+        // 16 samples por iteração
+        const __m256 start = _mm256_set1_ps(startGain);
+        const __m256 step = _mm256_set1_ps(gainStep);
+        const __m256 inc = _mm256_set1_ps(16.0f / channels);
+        __m256 f0 = _mm256_loadu_ps(lanes);
+        __m256 f1 = _mm256_loadu_ps(lanes + 8);
+
+        for (; i + 16 <= total; i += 16)
+        {
+            __m256 g0 = _mm256_add_ps(start, _mm256_mul_ps(f0, step));
+            __m256 g1 = _mm256_add_ps(start, _mm256_mul_ps(f1, step));
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(samples + i));
+            __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(s)));
+            __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1)));
+            __m256i rlo = _mm256_cvtps_epi32(_mm256_mul_ps(lo, g0));
+            __m256i rhi = _mm256_cvtps_epi32(_mm256_mul_ps(hi, g1));
+            // packs opera por lane de 128 bits: reordenar os blocos de 64 bits
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(rlo, rhi), 0xD8);
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(samples + i), packed);
+            f0 = _mm256_add_ps(f0, inc);
+            f1 = _mm256_add_ps(f1, inc);
+        }
+#elif defined(SHIBA_KERNELS_SSE2)
+        // 8 samples por iteração
+        const __m128 start = _mm_set1_ps(startGain);
+        const __m128 step = _mm_set1_ps(gainStep);
+        const __m128 inc = _mm_set1_ps(8.0f / channels);
+        __m128 f0 = _mm_loadu_ps(lanes);
+        __m128 f1 = _mm_loadu_ps(lanes + 4);
+
+        for (; i + 8 <= total; i += 8)
+        {
+            __m128 g0 = _mm_add_ps(start, _mm_mul_ps(f0, step));
+            __m128 g1 = _mm_add_ps(start, _mm_mul_ps(f1, step));
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(samples + i));
+            // Extensão de sinal int16 -> int32 via unpack + shift aritmético
+            __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16));
+            __m128i rlo = _mm_cvtps_epi32(_mm_mul_ps(lo, g0));
+            __m128i rhi = _mm_cvtps_epi32(_mm_mul_ps(hi, g1));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(samples + i), _mm_packs_epi32(rlo, rhi));
+            f0 = _mm_add_ps(f0, inc);
+            f1 = _mm_add_ps(f1, inc);
+        }
+#endif
+
+        scalarFrom(samples, i, total, channels, startGain, gainStep);
+    }
+
+    Levels copyWithLevelsScalar(int16_t *dst, const int16_t *src, int32_t samples)
+    {
+        Levels levels;
+        for (int32_t i = 0; i < samples; i++)
+        {
+            int32_t v = src[i];
+            dst[i] = src[i];
+            levels.peak = std::max(levels.peak, v < 0 ? -v : v);
+            levels.sumSquares += static_cast<uint64_t>(v * v);
+        }
+        return levels;
+    }
+
+    Levels copyWithLevels(int16_t *dst, const int16_t *src, int32_t samples)
+    {
+        int32_t i = 0;
+        int32_t maxValue = 0;
+        int32_t minValue = 0;
+        uint64_t sumSquares = 0;
+
+#if defined(SHIBA_KERNELS_NEON)
+        // Máximo e mínimo separados: |-32768| não cabe em int16
+        int16x8_t vmax = vdupq_n_s16(0);
+        int16x8_t vmin = vdupq_n_s16(0);
+        uint64x2_t vsum = vdupq_n_u64(0);
+        for (; i + 8 <= samples; i += 8)
+        {
+            int16x8_t s = vld1q_s16(src + i);
+            vst1q_s16(dst + i, s);
+            vmax = vmaxq_s16(vmax, s);
+            vmin = vminq_s16(vmin, s);
+            // Quadrados em 32 bits (<= 2^30) acumulados em pares de 64 bits
+            uint32x4_t lo = vreinterpretq_u32_s32(vmull_s16(vget_low_s16(s), vget_low_s16(s)));
+            uint32x4_t hi = vreinterpretq_u32_s32(vmull_s16(vget_high_s16(s), vget_high_s16(s)));
+            vsum = vpadalq_u32(vsum, lo);
+            vsum = vpadalq_u32(vsum, hi);
+        }
+        maxValue = vmaxvq_s16(vmax);
+        minValue = vminvq_s16(vmin);
+        sumSquares = vgetq_lane_u64(vsum, 0) + vgetq_lane_u64(vsum, 1);
+#elif defined(SHIBA_KERNELS_AVX2)
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i vmax = zero;
+        __m256i vmin = zero;
+        __m256i vsum = zero;
+        for (; i + 16 <= samples; i += 16)
+        {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), s);
+            vmax = _mm256_max_epi16(vmax, s);
+            vmin = _mm256_min_epi16(vmin, s);
+            // madd soma pares de quadrados: até 2^31, cabe em uint32 (estender com zero)
+            __m256i sq = _mm256_madd_epi16(s, s);
+            vsum = _mm256_add_epi64(vsum, _mm256_unpacklo_epi32(sq, zero));
+            vsum = _mm256_add_epi64(vsum, _mm256_unpackhi_epi32(sq, zero));
+        }
+        alignas(32) int16_t maxLanes[16];
+        alignas(32) int16_t minLanes[16];
+        alignas(32) uint64_t sumLanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(maxLanes), vmax);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(minLanes), vmin);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(sumLanes), vsum);
+        for (int32_t k = 0; k < 16; k++)
+        {
+            maxValue = std::max<int32_t>(maxValue, maxLanes[k]);
+            minValue = std::min<int32_t>(minValue, minLanes[k]);
+        }
+        sumSquares = sumLanes[0] + sumLanes[1] + sumLanes[2] + sumLanes[3];
+#elif defined(SHIBA_KERNELS_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        __m128i vmax = zero;
+        __m128i vmin = zero;
+        __m128i vsum = zero;
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), s);
+            vmax = _mm_max_epi16(vmax, s);
+            vmin = _mm_min_epi16(vmin, s);
+            __m128i sq = _mm_madd_epi16(s, s);
+            vsum = _mm_add_epi64(vsum, _mm_unpacklo_epi32(sq, zero));
+            vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi32(sq, zero));
+        }
+        alignas(16) int16_t maxLanes[8];
+        alignas(16) int16_t minLanes[8];
+        alignas(16) uint64_t sumLanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(maxLanes), vmax);
+        _mm_store_si128(reinterpret_cast<__m128i *>(minLanes), vmin);
+        _mm_store_si128(reinterpret_cast<__m128i *>(sumLanes), vsum);
+        for (int32_t k = 0; k < 8; k++)
+        {
+            maxValue = std::max<int32_t>(maxValue, maxLanes[k]);
+            minValue = std::min<int32_t>(minValue, minLanes[k]);
+        }
+        sumSquares = sumLanes[0] + sumLanes[1];
+#endif
+
+        Levels tail = copyWithLevelsScalar(dst + i, src + i, samples - i);
+        Levels levels;
+        levels.peak = std::max({maxValue, -minValue, tail.peak});
+        levels.sumSquares = sumSquares + tail.sumSquares;
+        return levels;
+    }
+
+    void int16ToFloatScalar(float *dst, const int16_t *src, int32_t samples)
+    {
+        constexpr float scale = 1.0f / 32768.0f;
+        for (int32_t i = 0; i < samples; i++)
+            dst[i] = src[i] * scale;
+    }
+
+    void int16ToFloat(float *dst, const int16_t *src, int32_t samples)
+    {
+        int32_t i = 0;
+
+#if defined(SHIBA_KERNELS_NEON)
+        for (; i + 8 <= samples; i += 8)
+        {
+            int16x8_t s = vld1q_s16(src + i);
+            // Conversão de ponto fixo com 15 bits fracionários: o mesmo que s / 32768
+            vst1q_f32(dst + i, vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(s)), 15));
+            vst1q_f32(dst + i + 4, vcvtq_n_f32_s32(vmovl_s16(vget_high_s16(s)), 15));
+        }
+#elif defined(SHIBA_KERNELS_AVX2)
+        const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+        for (; i + 16 <= samples; i += 16)
+        {
+            __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(s));
+            __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(s, 1));
+            _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+            _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+        }
+#elif defined(SHIBA_KERNELS_SSE2)
+        const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            // Estender o sinal: duplicar cada sample em 32 bits e deslocar aritmeticamente
+            __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16);
+            __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(s, s), 16);
+            _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+            _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        }
+#endif
+
+        int16ToFloatScalar(dst + i, src + i, samples - i);
+    }
+
+    void mixSaturateScalar(int16_t *dst, const int16_t *src, int32_t samples)
+    {
+        for (int32_t i = 0; i < samples; i++)
+            dst[i] = static_cast<int16_t>(std::clamp(dst[i] + src[i], -32768, 32767));
+    }
+
+    void mixSaturate(int16_t *dst, const int16_t *src, int32_t samples)
+    {
+        int32_t i = 0;
+
+#if defined(SHIBA_KERNELS_NEON)
+        for (; i + 16 <= samples; i += 16)
+        {
+            vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+            vst1q_s16(dst + i + 8, vqaddq_s16(vld1q_s16(dst + i + 8), vld1q_s16(src + i + 8)));
+        }
+#elif defined(SHIBA_KERNELS_AVX2)
+        for (; i + 16 <= samples; i += 16)
+        {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(dst + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_adds_epi16(a, b));
+        }
+#elif defined(SHIBA_KERNELS_SSE2)
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(dst + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_adds_epi16(a, b));
+        }
+#endif
+
+        mixSaturateScalar(dst + i, src + i, samples - i);
+    }
+
+    const char *backendName()
+    {
+#if defined(SHIBA_KERNELS_NEON)
+        return "neon";
+#elif defined(SHIBA_KERNELS_AVX2)
+        return "avx2";
+#elif defined(SHIBA_KERNELS_SSE2)
+        return "sse2";
+#else
+        return "scalar";
+#endif
+    }
+}
+
+void GainRamp::process(int16_t *samples, int32_t frames, int32_t channels, float target)
+{
+    // Mantém os atalhos do loop antigo: >= 0.99 é unidade, <= 0.01 é mudo
+    if (target >= 0.99f)
+        target = 1.0f;
+    else if (target <= 0.01f)
+        target = 0.0f;
+
+    if (target != targetGain)
+    {
+        targetGain = target;
+        remainingFrames = rampFrames;
+        gainStep = (targetGain - currentGain) / static_cast<float>(rampFrames);
+    }
+
+    int32_t done = 0;
+    if (remainingFrames > 0)
+    {
+        int32_t rampPart = std::min(frames, remainingFrames);
+        audiokernels::applyGainRamp(samples, rampPart, channels, currentGain, gainStep);
+        remainingFrames -= rampPart;
+        currentGain = remainingFrames == 0 ? targetGain : currentGain + gainStep * rampPart;
+        done = rampPart;
+    }
+
+    int32_t rest = frames - done;
+    if (rest <= 0)
+        return;
+
+    int16_t *tail = samples + static_cast<size_t>(done) * channels;
+    if (currentGain == 1.0f)
+    {
+        // Unidade: nada a fazer
+    }
+    else if (currentGain == 0.0f)
+    {
+        std::fill_n(tail, rest * channels, int16_t(0));
+    }
+    else
+    {
+        audiokernels::applyGainRamp(tail, rest, channels, currentGain, 0.0f);
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+// ✅ Kernels de processamento de amostras PCM16
+//
+// NEON no arm64, SSE2/AVX2 no x86_64 (testes no host) e fallback escalar.
+// Todos saturam em int16 e arredondam para o inteiro mais próximo (par em empate),
+// então as versões SIMD e escalar diferem no máximo em 1 LSB durante rampas.
+namespace audiokernels
+{
+    // Ganho com rampa linear por frame, in-place: g(n) = startGain + n * gainStep
+    // (n = índice do frame; o mesmo ganho para todos os canais do frame)
+    void applyGainRamp(int16_t *samples, int32_t frames, int32_t channels,
+                       float startGain, float gainStep);
+
+    // Referência escalar (fallback e comparação no benchmark)
+    void applyGainRampScalar(int16_t *samples, int32_t frames, int32_t channels,
+                             float startGain, float gainStep);
+
+    // Pico (|sample| máximo, até 32768) e soma dos quadrados de um trecho de samples
+    struct Levels
+    {
+        int32_t peak = 0;
+        uint64_t sumSquares = 0;
+    };
+
+    // Copia `samples` samples de src para dst medindo os níveis na mesma passada
+    // (o medidor da captura não percorre o chunk uma segunda vez)
+    Levels copyWithLevels(int16_t *dst, const int16_t *src, int32_t samples);
+
+    // Referência escalar
+    Levels copyWithLevelsScalar(int16_t *dst, const int16_t *src, int32_t samples);
+
+    // PCM16 -> float em [-1, 1) (saída float do stream). Exato: SIMD e escalar são idênticos.
+    void int16ToFloat(float *dst, const int16_t *src, int32_t samples);
+
+    // Referência escalar
+    void int16ToFloatScalar(float *dst, const int16_t *src, int32_t samples);
+
+    // Mixagem: dst[i] = dst[i] + src[i] saturado em int16. Exato: SIMD e escalar são idênticos.
+    void mixSaturate(int16_t *dst, const int16_t *src, int32_t samples);
+
+    // Referência escalar
+    void mixSaturateScalar(int16_t *dst, const int16_t *src, int32_t samples);
+
+    // Nome do backend compilado ("neon", "avx2", "sse2" ou "scalar")
+    const char *backendName();
+}
+
+// ✅ Estágio de ganho com rampa (sem "zipper noise" ao mexer no volume)
+//
+// Cada mudança de alvo é percorrida linearmente em RAMP_MS. Roda no callback:
+// sem alocação e sem locks.
+class GainRamp
+{
+public:
+    static constexpr float RAMP_MS = 20.0f;
+
+    void configure(int32_t sampleRate)
+    {
+        rampFrames = static_cast<int32_t>(sampleRate * RAMP_MS / 1000.0f);
+        if (rampFrames < 1)
+            rampFrames = 1;
+    }
+
+    void reset(float gain)
+    {
+        currentGain = gain;
+        targetGain = gain;
+        remainingFrames = 0;
+        gainStep = 0.0f;
+    }
+
+    // Aplica o ganho em `frames` frames intercalados, andando em direção a `target`
+    void process(int16_t *samples, int32_t frames, int32_t channels, float target);
+
+    float gain() const { return currentGain; }
+
+private:
+    int32_t rampFrames = 960;
+    int32_t remainingFrames = 0;
+    float currentGain = 1.0f;
+    float targetGain = 1.0f;
+    float gainStep = 0.0f;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <time.h>
+
+// Formato das amostras que o stream espera no callback
+enum class OutputFormat
+{
+    I16,
+    Float
+};
+
+// ✅ Interface mínima do stream de saída vista pelo PlayerCore
+//
+// No Android é implementada sobre oboe::AudioStream (OboeAudioPlayer.cpp);
+// no host por FakeAudioStream, que chama o render com um relógio simulado.
+class AudioOutputStream
+{
+public:
+    virtual ~AudioOutputStream() = default;
+
+    virtual int32_t getSampleRate() const = 0;
+    virtual int32_t getChannelCount() const = 0;
+    virtual OutputFormat getFormat() const { return OutputFormat::I16; }
+    virtual int32_t getFramesPerBurst() const = 0;
+    virtual int32_t getBufferSizeInFrames() const { return getFramesPerBurst() * 2; }
+
+    // Frames entregues ao stream até agora (< 0 se desconhecido). Dentro do
+    // callback ainda não inclui o bloco que está sendo preenchido.
+    virtual int64_t getFramesWritten() const { return -1; }
+
+    // Par (frame, instante CLOCK_MONOTONIC em ns) em que esse frame saiu/sairá
+    // no alto-falante. false se o stream ainda não tem timestamp.
+    virtual bool getTimestamp(int64_t & /*framePosition*/, int64_t & /*timeNanos*/) const { return false; }
+};
+
+// ✅ Relógio monotônico injetável (o host usa tempo simulado)
+class PlayerClock
+{
+public:
+    virtual ~PlayerClock() = default;
+    virtual int64_t nowNanos() const = 0;
+
+    int64_t nowMs() const { return nowNanos() / 1000000LL; }
+    int64_t nowUs() const { return nowNanos() / 1000LL; }
+
+    static const PlayerClock &system();
+};
+
+class SystemClock : public PlayerClock
+{
+public:
+    int64_t nowNanos() const override
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (ts.tv_sec * 1000000000LL) + ts.tv_nsec;
+    }
+};
+
+inline const PlayerClock &PlayerClock::system()
+{
+    static const SystemClock clock;
+    return clock;
+}
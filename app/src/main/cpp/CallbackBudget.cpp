@@ -0,0 +1,131 @@
+#include "CallbackBudget.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace
+{
+    // Primeiro inteiro do arquivo, ou -1 se não existe
+    int64_t readValue(const char *path)
+    {
+        FILE *file = std::fopen(path, "r");
+        if (file == nullptr)
+            return -1;
+        long long value = -1;
+        if (std::fscanf(file, "%lld", &value) != 1)
+            value = -1;
+        std::fclose(file);
+        return value;
+    }
+}
+
+uint64_t CallbackBudget::fastCoreMask(const char *cpuRoot)
+{
+    // Kernel sem cpu_capacity (cpu0 não tem): comparar a frequência máxima
+    char path[256];
+    std::snprintf(path, sizeof(path), "%s/cpu0/cpu_capacity", cpuRoot);
+    const char *file = readValue(path) >= 0 ? "cpu_capacity" : "cpufreq/cpuinfo_max_freq";
+
+    int64_t values[MAX_CPUS];
+    for (int32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+    {
+        std::snprintf(path, sizeof(path), "%s/cpu%d/%s", cpuRoot, cpu, file);
+        values[cpu] = readValue(path);
+    }
+
+    int64_t slowest = -1;
+    int64_t fastest = -1;
+    for (int64_t value : values)
+    {
+        if (value <= 0)
+            continue;
+        slowest = slowest < 0 ? value : std::min(slowest, value);
+        fastest = std::max(fastest, value);
+    }
+    if (slowest <= 0 || fastest == slowest)
+        return 0;
+
+    uint64_t mask = 0;
+    for (int32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+    {
+        if (values[cpu] > slowest)
+            mask |= uint64_t(1) << cpu;
+    }
+    return mask;
+}
+
+void CallbackBudget::reset(uint64_t affinityMask)
+{
+    firstCallback = true;
+    requestedMask = affinityMask;
+    smoothedPermille = 0;
+    callbacksSinceCpu = CPU_SAMPLE_CALLBACKS; // Amostrar já no primeiro callback
+    pinnedMask = 0;
+    maxPermille = 0;
+    callbackFrames = 0;
+    wakeups.reset();
+}
+
+void CallbackBudget::applyAffinity()
+{
+#if defined(__linux__)
+    if (requestedMask == 0)
+        return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int32_t cpu = 0; cpu < MAX_CPUS; cpu++)
+    {
+        if ((requestedMask >> cpu) & 1u)
+            CPU_SET(cpu, &set);
+    }
+    // 0 = a thread atual (o callback), não o processo
+    if (sched_setaffinity(0, sizeof(set), &set) == 0)
+        pinnedMask = requestedMask;
+#endif
+}
+
+void CallbackBudget::end(int64_t beginNanos, int32_t numFrames, int32_t sampleRate)
+{
+    int64_t endNanos = clock.nowNanos();
+    wakeups.tick(endNanos);
+    if (numFrames <= 0 || sampleRate <= 0)
+        return;
+    callbackFrames.store(numFrames, std::memory_order_relaxed);
+    int64_t durationNs = endNanos - beginNanos;
+    int64_t periodNs = (static_cast<int64_t>(numFrames) * 1000000000LL) / sampleRate;
+    if (periodNs <= 0)
+        return;
+
+    int64_t permille = (std::max<int64_t>(durationNs, 0) * 1000) / periodNs;
+    smoothedPermille += (permille - smoothedPermille) / SMOOTHING;
+    budgetUs.store(periodNs / 1000, std::memory_order_relaxed);
+    loadPermille.store(smoothedPermille, std::memory_order_relaxed);
+    if (permille > maxPermille.load(std::memory_order_relaxed))
+        maxPermille.store(permille, std::memory_order_relaxed);
+    if (permille >= OVER_BUDGET_PERMILLE)
+        overBudget.store(overBudget.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+#if defined(__linux__)
+    if (++callbacksSinceCpu >= CPU_SAMPLE_CALLBACKS)
+    {
+        callbacksSinceCpu = 0;
+        cpu.store(sched_getcpu(), std::memory_order_relaxed);
+    }
+#endif
+}
+
+void CallbackBudget::snapshotInto(int64_t *out)
+{
+    out[stats::CALLBACK_BUDGET_US] = budgetUs.load(std::memory_order_relaxed);
+    out[stats::CALLBACK_LOAD_PERMILLE] = loadPermille.load(std::memory_order_relaxed);
+    out[stats::CALLBACK_LOAD_MAX_PERMILLE] = maxPermille.exchange(0, std::memory_order_relaxed);
+    out[stats::CALLBACK_OVER_BUDGET] = overBudget.load(std::memory_order_relaxed);
+    out[stats::CALLBACK_CPU] = cpu.load(std::memory_order_relaxed);
+    out[stats::CALLBACK_CPU_MASK] = static_cast<int64_t>(pinnedMask.load(std::memory_order_relaxed));
+    out[stats::CALLBACK_FRAMES] = callbackFrames.load(std::memory_order_relaxed);
+    out[stats::CALLBACK_WAKEUPS_PER_S] = wakeups.perSecond(clock.nowNanos());
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "AudioOutputStream.h"
+#include "PlayerTelemetry.h"
+#include "WakeupMeter.h"
+
+// ✅ Tempo do callback de áudio contra o período do burst, e em que núcleo ele roda
+//
+// Em big.LITTLE o escalonador pode deixar o callback nos núcleos pequenos, onde ele
+// gasta boa parte do período. No primeiro callback de cada stream a thread é fixada
+// (sched_setaffinity) nos núcleos mais rápidos: todos menos o cluster mais lento,
+// para não disputar um único núcleo "prime". A máscara vem do sysfs (fastCoreMask),
+// lida fora do callback. Cada callback mede a duração contra numFrames/sampleRate
+// e conta como um despertar (callbacks por segundo: o custo em energia do stream).
+//  - Controle (stream fechado/parado): reset()
+//  - Callback: begin()/end(), sem lock e sem alocação
+//  - Qualquer thread: snapshotInto() (um leitor por vez: o máximo zera a cada leitura)
+class CallbackBudget
+{
+public:
+    static constexpr int64_t OVER_BUDGET_PERMILLE = 800; // 80% do período: pouca folga
+    static constexpr int32_t SMOOTHING = 16;             // Média móvel exponencial: 1/16 por callback
+    static constexpr int32_t CPU_SAMPLE_CALLBACKS = 64;  // sched_getcpu() a cada tantos callbacks
+    static constexpr int32_t MAX_CPUS = 64;
+
+    explicit CallbackBudget(const PlayerClock &clock = PlayerClock::system()) : clock(clock) {}
+
+    // Núcleos acima do cluster mais lento, pela capacidade (cpu_capacity) ou, sem ela,
+    // pela frequência máxima (cpufreq). 0 = homogêneo ou desconhecido: não fixar.
+    static uint64_t fastCoreMask(const char *cpuRoot = "/sys/devices/system/cpu");
+
+    // Stream novo, antes do primeiro callback. affinityMask = 0 não mexe na afinidade.
+    void reset(uint64_t affinityMask);
+
+    // ✅ CALLBACK: início do trabalho (fixa a thread no primeiro callback)
+    int64_t begin()
+    {
+        if (firstCallback)
+        {
+            firstCallback = false;
+            applyAffinity();
+        }
+        return clock.nowNanos();
+    }
+
+    // ✅ CALLBACK: fim do trabalho de numFrames frames a sampleRate
+    void end(int64_t beginNanos, int32_t numFrames, int32_t sampleRate);
+
+    void snapshotInto(int64_t *out);
+
+    uint64_t getPinnedMask() const { return pinnedMask.load(); } // 0 = não fixada
+    int64_t getLoadPermille() const { return loadPermille.load(); }
+    int64_t getOverBudget() const { return overBudget.load(); }
+    int32_t getCallbackFrames() const { return callbackFrames.load(); }
+    int64_t getWakeupsPerSecond() const { return wakeups.perSecond(clock.nowNanos()); }
+
+private:
+    void applyAffinity();
+
+    const PlayerClock &clock;
+
+    // Só o callback (reset com o callback parado)
+    bool firstCallback = true;
+    uint64_t requestedMask = 0;
+    int64_t smoothedPermille = 0;
+    int32_t callbacksSinceCpu = 0;
+
+    std::atomic<int64_t> budgetUs{0};
+    std::atomic<int64_t> loadPermille{0};
+    std::atomic<int64_t> maxPermille{0};
+    std::atomic<int64_t> overBudget{0};
+    std::atomic<int32_t> cpu{-1};
+    std::atomic<uint64_t> pinnedMask{0};
+    std::atomic<int32_t> callbackFrames{0};
+    WakeupMeter wakeups;
+};
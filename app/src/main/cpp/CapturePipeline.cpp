@@ -0,0 +1,250 @@
+#include "CapturePipeline.h"
+#include "NativeLog.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+bool CapturePipeline::configure(int32_t newSampleRate, int32_t channelCount, int32_t newChunkFrames,
+                                std::unique_ptr<AudioEncoder> newEncoder)
+{
+    if (newSampleRate <= 0 || channelCount <= 0 || newChunkFrames <= 0 || newChunkFrames > MAX_CHUNK_FRAMES)
+    {
+        LOGE("❌ Captura: configuração inválida (%dHz, %dch, chunk=%d)", newSampleRate, channelCount, newChunkFrames);
+        return false;
+    }
+
+    encoder = std::move(newEncoder);
+    codec = encoder ? encoder->codec() : packet::CODEC_PCM16;
+    sampleRate = newSampleRate;
+    channels = channelCount;
+    chunkFrames = newChunkFrames;
+
+    // Adaptativo: o chunk pode crescer até MAX_CHUNK_FRAMES sem realocar
+    int32_t maxFrames = adaptive ? MAX_CHUNK_FRAMES : chunkFrames;
+    accumulator.assign(static_cast<size_t>(maxFrames) * channels, int16_t(0));
+    accumulatedFrames = 0;
+    chunkCaptureTimeUs = NO_TIMESTAMP;
+    chunkLevels = audiokernels::Levels();
+    silenceDetector.configure(sampleRate);
+    sequence = 0;
+    nextSlot = 0;
+
+    int32_t payloadBytes = encoder ? MAX_ENCODED_BYTES : maxFrames * channels * static_cast<int32_t>(sizeof(int16_t));
+    slotBytes = packet::HEADER_BYTES + payloadBytes;
+    slots.assign(static_cast<size_t>(slotBytes) * POOL_PACKETS, uint8_t(0));
+    ready.clear();
+
+    appliedBitrate = encoder ? encoder->bitrate() : 0;
+    congestion.configure(sampleRate, channels, chunkFrames * 1000 / sampleRate, appliedBitrate,
+                         MAX_CHUNK_FRAMES * 1000 / sampleRate);
+    pacingTokens = 0;
+    pacingLastUs = NO_TIMESTAMP;
+
+    peak = 0.0f;
+    rms = 0.0f;
+    packetsProduced = 0;
+    packetsDropped = 0;
+    encodeErrors = 0;
+    bytesProduced = 0;
+    silentPackets = 0;
+    silent = false;
+
+    LOGI("🎙️ Captura: %dHz, %dch, chunk=%d frames, codec=%s%s%s",
+         sampleRate, channels, chunkFrames, encoder ? encoder->name() : "pcm16", dtxEnabled ? ", DTX" : "",
+         adaptive ? ", adaptativo" : "");
+    return true;
+}
+
+bool CapturePipeline::onFeedback(uint32_t listenerId, const uint8_t *bytes, int32_t length, int64_t nowMs)
+{
+    feedback::Report report;
+    if (!adaptive || !feedback::parse(bytes, length, report))
+        return false;
+    congestion.onReport(listenerId, report, nowMs);
+    return true;
+}
+
+void CapturePipeline::applyCongestionSettings()
+{
+    CongestionController::Settings settings = congestion.getSettings();
+    chunkFrames = std::clamp(sampleRate * settings.chunkMs / 1000, 1, MAX_CHUNK_FRAMES);
+
+    if (encoder && settings.bitrate > 0 && settings.bitrate != appliedBitrate)
+    {
+        if (!encoder->setBitrate(settings.bitrate))
+        {
+            LOGW("⚠️ Captura: %s não aceitou %d bps", encoder->name(), settings.bitrate);
+        }
+        appliedBitrate = settings.bitrate; // Sem insistir a cada chunk
+    }
+}
+
+int32_t CapturePipeline::write(const int16_t *samples, int32_t frames, int64_t captureTimeUs)
+{
+    if (accumulator.empty() || samples == nullptr)
+        return 0;
+
+    int32_t produced = 0;
+    int32_t offset = 0;
+    while (offset < frames)
+    {
+        if (accumulatedFrames == 0)
+        {
+            if (adaptive)
+                applyCongestionSettings();
+            // Instante do primeiro frame do chunk, extrapolado dentro da leitura
+            chunkCaptureTimeUs = captureTimeUs == NO_TIMESTAMP
+                                     ? NO_TIMESTAMP
+                                     : captureTimeUs + (static_cast<int64_t>(offset) * 1000000LL) / sampleRate;
+            chunkLevels = audiokernels::Levels();
+        }
+
+        int32_t toCopy = std::min(frames - offset, chunkFrames - accumulatedFrames);
+        audiokernels::Levels levels = audiokernels::copyWithLevels(
+            accumulator.data() + static_cast<size_t>(accumulatedFrames) * channels,
+            samples + static_cast<size_t>(offset) * channels, toCopy * channels);
+        chunkLevels.peak = std::max(chunkLevels.peak, levels.peak);
+        chunkLevels.sumSquares += levels.sumSquares;
+
+        accumulatedFrames += toCopy;
+        offset += toCopy;
+
+        if (accumulatedFrames == chunkFrames)
+        {
+            produced += emitChunk(chunkFrames);
+        }
+    }
+    return produced;
+}
+
+int32_t CapturePipeline::flush()
+{
+    if (accumulatedFrames == 0)
+        return 0;
+
+    int32_t frames = accumulatedFrames;
+    if (encoder)
+    {
+        std::fill(accumulator.begin() + static_cast<size_t>(frames) * channels,
+                  accumulator.begin() + static_cast<size_t>(chunkFrames) * channels, int16_t(0));
+        frames = chunkFrames;
+    }
+    return emitChunk(frames);
+}
+
+int32_t CapturePipeline::emitChunk(int32_t frames)
+{
+    accumulatedFrames = 0;
+
+    // Medidor: publicado mesmo se o pacote for descartado
+    int32_t samples = frames * channels;
+    double rmsLevel = std::sqrt(static_cast<double>(chunkLevels.sumSquares) / samples);
+    peak.store(chunkLevels.peak / 32768.0f, std::memory_order_relaxed);
+    rms.store(static_cast<float>(rmsLevel / 32768.0), std::memory_order_relaxed);
+
+    // ✅ DTX: silêncio depois do hangover vira marcador (nem passa pelo encoder)
+    bool silenceMarker = dtxEnabled && silenceDetector.update(chunkLevels.peak, frames);
+    silent.store(silenceMarker, std::memory_order_relaxed);
+
+    packet::Header header;
+    header.codec = codec;
+    header.sequence = sequence++;
+    header.frames = static_cast<uint32_t>(frames);
+    if (chunkCaptureTimeUs != NO_TIMESTAMP)
+    {
+        header.flags = packet::FLAG_HAS_TIMESTAMP;
+        header.captureTimeUs = chunkCaptureTimeUs;
+    }
+    if (silenceMarker)
+        header.flags |= packet::FLAG_SILENCE;
+
+    // Pool cheio: quem envia parou. Descartar o chunk novo (a sequência pula e o
+    // receptor trata como perda)
+    if (ready.size() >= POOL_PACKETS)
+    {
+        if (++packetsDropped % 50 == 1)
+        {
+            LOGW("⚠️ Captura: pool de pacotes cheio (%lld descartados)", static_cast<long long>(packetsDropped.load()));
+        }
+        return 0;
+    }
+
+    uint32_t index = nextSlot;
+    uint8_t *slot = slots.data() + static_cast<size_t>(index) * slotBytes;
+    int32_t payloadBytes;
+    if (silenceMarker)
+    {
+        payloadBytes = packet::SILENCE_PAYLOAD_BYTES;
+        packet::writeSilence(slot + packet::HEADER_BYTES, static_cast<uint32_t>(frames),
+                             static_cast<uint16_t>(std::min(std::lround(rmsLevel), 65535L)));
+        silentPackets++;
+    }
+    else if (encoder)
+    {
+        payloadBytes = encoder->encode(accumulator.data(), frames, slot + packet::HEADER_BYTES, MAX_ENCODED_BYTES);
+        if (payloadBytes <= 0)
+        {
+            if (++encodeErrors % 50 == 1)
+            {
+                LOGE("❌ Captura: %s falhou (%d)", encoder->name(), payloadBytes);
+            }
+            return 0;
+        }
+    }
+    else
+    {
+        payloadBytes = samples * static_cast<int32_t>(sizeof(int16_t));
+        memcpy(slot + packet::HEADER_BYTES, accumulator.data(), static_cast<size_t>(payloadBytes));
+    }
+    packet::write(slot, header);
+
+    Slot item;
+    item.index = index;
+    item.length = packet::HEADER_BYTES + payloadBytes;
+    ready.push(item);
+    nextSlot = (nextSlot + 1) % POOL_PACKETS;
+
+    packetsProduced++;
+    bytesProduced += item.length;
+    return 1;
+}
+
+int32_t CapturePipeline::nextPacketSize() const
+{
+    const Slot *item = ready.front();
+    return item ? item->length : 0;
+}
+
+int32_t CapturePipeline::nextPacedPacketSize(int64_t nowUs)
+{
+    int32_t size = nextPacketSize();
+    if (size == 0 || !adaptive)
+        return size;
+
+    // Balde de fichas: enche na taxa do controle até PACING_BURST_MS de envio
+    int64_t rate = congestion.getSettings().pacingBytesPerS;
+    int64_t depth = std::max<int64_t>(rate * PACING_BURST_MS / 1000, size) * 1000000LL;
+    if (pacingLastUs == NO_TIMESTAMP)
+        pacingTokens = depth;
+    else
+        pacingTokens = std::min(depth, pacingTokens + rate * std::max<int64_t>(nowUs - pacingLastUs, 0));
+    pacingLastUs = nowUs;
+    return pacingTokens >= static_cast<int64_t>(size) * 1000000LL ? size : 0;
+}
+
+int32_t CapturePipeline::readPacket(uint8_t *out, int32_t capacity)
+{
+    const Slot *item = ready.front();
+    if (item == nullptr)
+        return 0;
+    if (item->length > capacity)
+        return -1;
+
+    int32_t length = item->length;
+    memcpy(out, slots.data() + static_cast<size_t>(item->index) * slotBytes, static_cast<size_t>(length));
+    ready.pop();
+    if (pacingLastUs != NO_TIMESTAMP)
+        pacingTokens -= static_cast<int64_t>(length) * 1000000LL;
+    return length;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "AudioEncoder.h"
+#include "AudioKernels.h"
+#include "CongestionController.h"
+#include "PacketFormat.h"
+#include "PlayoutScheduler.h"
+#include "SilenceDetector.h"
+#include "SpscQueue.h"
+
+// ✅ Pipeline de captura do sender: PCM do AudioRecord -> pacotes SHB1 prontos
+//
+// A thread de captura entrega cada leitura em write(); o PCM é acumulado em
+// chunks de tamanho fixo (medindo pico/RMS na mesma cópia), codificado (Opus ou
+// PCM16 direto), ganha o cabeçalho com sequência e instante de captura e vai
+// para um slot de um pool pré-alocado. A thread que envia retira os pacotes com
+// nextPacketSize()/readPacket(). Sem alocação depois de configure().
+// Com DTX (setSilenceDetection), silêncio longo sai como marcadores de poucos
+// bytes, sem codificar (SilenceDetector.h). Com controle adaptativo (setAdaptive),
+// os relatórios dos receptores (onFeedback, de uma terceira thread) mudam o chunk e
+// o bitrate na borda do próximo chunk, e o envio sai no ritmo do CongestionController.
+class CapturePipeline
+{
+public:
+    static constexpr int32_t MAX_CHUNK_FRAMES = 2880;  // 60ms a 48kHz (maior frame do Opus)
+    static constexpr int32_t MAX_ENCODED_BYTES = 1500; // Mesmo limite do DecodeWorker
+    static constexpr uint32_t POOL_PACKETS = 32;       // ~640ms de chunks de 20ms
+    static constexpr int64_t NO_TIMESTAMP = PlayoutScheduler::NO_TIMESTAMP;
+    static constexpr int32_t PACING_BURST_MS = 40;     // Rajada máxima do pacing, em tempo de envio
+
+    CapturePipeline() = default;
+    CapturePipeline(const CapturePipeline &) = delete;
+    CapturePipeline &operator=(const CapturePipeline &) = delete;
+
+    // Só com as duas threads paradas. encoder == nullptr = PCM16 sem compressão.
+    bool configure(int32_t sampleRate, int32_t channelCount, int32_t chunkFrames,
+                   std::unique_ptr<AudioEncoder> encoder);
+
+    // DTX: antes de configure() ou com a captura parada
+    void setSilenceDetection(bool enabled) { dtxEnabled = enabled; }
+
+    // Chunk/bitrate/pacing pelos relatórios dos receptores. Antes de configure():
+    // o pool passa a ter slots para MAX_CHUNK_FRAMES.
+    void setAdaptive(bool enabled) { adaptive = enabled; }
+
+    // ✅ Relatório SHFB de um ouvinte (ReceiverFeedback.h); qualquer thread.
+    // false se não for um relatório válido ou o controle não estiver ligado.
+    bool onFeedback(uint32_t listenerId, const uint8_t *bytes, int32_t length, int64_t nowMs);
+
+    // ✅ PRODUTOR (thread de captura): `frames` frames intercalados; captureTimeUs é o
+    // instante do primeiro deles no relógio do servidor (ou NO_TIMESTAMP).
+    // Retorna quantos pacotes ficaram prontos.
+    int32_t write(const int16_t *samples, int32_t frames, int64_t captureTimeUs);
+
+    // ✅ PRODUTOR: fecha o chunk parcial (fim da captura). PCM vai com o tamanho real;
+    // Opus completa com silêncio porque só aceita durações fixas.
+    int32_t flush();
+
+    // ✅ CONSUMIDOR: tamanho do próximo pacote (0 = nenhum pronto)
+    int32_t nextPacketSize() const;
+
+    // ✅ CONSUMIDOR: como nextPacketSize(), mas 0 também quando o ritmo de envio
+    // ainda não permite (balde de PACING_BURST_MS na taxa do controle). Sem
+    // controle adaptativo, igual a nextPacketSize().
+    int32_t nextPacedPacketSize(int64_t nowUs);
+
+    // ✅ CONSUMIDOR: copia o próximo pacote e devolve o slot ao pool.
+    // Retorna bytes copiados (0 = nenhum pronto, -1 = out pequeno demais).
+    int32_t readPacket(uint8_t *out, int32_t capacity);
+
+    // Medidor do último chunk fechado (0..1, relativo ao fundo de escala)
+    float getPeak() const { return peak.load(std::memory_order_relaxed); }
+    float getRms() const { return rms.load(std::memory_order_relaxed); }
+
+    uint8_t getCodec() const { return codec; }
+    int32_t getChunkFrames() const { return chunkFrames; }
+    int32_t getChannelCount() const { return channels; }
+    int64_t getPacketsProduced() const { return packetsProduced.load(); }
+    int64_t getPacketsDropped() const { return packetsDropped.load(); } // Pool cheio
+    int64_t getEncodeErrors() const { return encodeErrors.load(); }
+    int64_t getBytesProduced() const { return bytesProduced.load(); }
+    int64_t getSilentPackets() const { return silentPackets.load(); } // Marcadores DTX
+    int32_t getBitrate() const { return encoder ? encoder->bitrate() : 0; } // 0 = PCM
+    const CongestionController &getCongestionController() const { return congestion; }
+    bool isSilent() const { return silent.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        uint32_t index = 0;
+        int32_t length = 0;
+    };
+
+    int32_t emitChunk(int32_t frames);
+    void applyCongestionSettings(); // PRODUTOR, na borda de um chunk
+
+    std::unique_ptr<AudioEncoder> encoder;
+    uint8_t codec = packet::CODEC_PCM16;
+    int32_t sampleRate = 48000;
+    int32_t channels = 2;
+    int32_t chunkFrames = 960;
+
+    // Estado do produtor
+    std::vector<int16_t> accumulator;
+    int32_t accumulatedFrames = 0;
+    int64_t chunkCaptureTimeUs = NO_TIMESTAMP;
+    audiokernels::Levels chunkLevels;
+    SilenceDetector silenceDetector;
+    bool dtxEnabled = false;
+    bool adaptive = false;
+    int32_t appliedBitrate = 0;
+    uint32_t sequence = 0;
+    uint32_t nextSlot = 0;
+
+    // Pool: POOL_PACKETS slots de slotBytes, usados em ordem (a fila é FIFO)
+    std::vector<uint8_t> slots;
+    int32_t slotBytes = 0;
+    SpscQueue<Slot, POOL_PACKETS> ready;
+
+    // ✅ Controle de congestionamento e o balde do pacing (só o consumidor)
+    CongestionController congestion;
+    int64_t pacingTokens = 0; // Bytes x 1e6 (sem perder frações entre chamadas próximas)
+    int64_t pacingLastUs = NO_TIMESTAMP;
+
+    std::atomic<float> peak{0.0f};
+    std::atomic<float> rms{0.0f};
+    std::atomic<int64_t> packetsProduced{0};
+    std::atomic<int64_t> packetsDropped{0};
+    std::atomic<int64_t> encodeErrors{0};
+    std::atomic<int64_t> bytesProduced{0};
+    std::atomic<int64_t> silentPackets{0};
+    std::atomic<bool> silent{false};
+};
@@ -0,0 +1,141 @@
+#include "CongestionController.h"
+#include "NativeLog.h"
+
+#include <algorithm>
+
+int32_t CongestionController::stepIndex(int32_t ms) const
+{
+    for (int32_t i = 0; i < static_cast<int32_t>(CHUNK_STEPS_MS.size()); i++)
+    {
+        if (CHUNK_STEPS_MS[i] >= ms)
+            return i;
+    }
+    return static_cast<int32_t>(CHUNK_STEPS_MS.size()) - 1;
+}
+
+void CongestionController::configure(int32_t newSampleRate, int32_t newChannelCount, int32_t newChunkMs,
+                                     int32_t newBitrate, int32_t maxChunkMs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    sampleRate = std::max(newSampleRate, 1);
+    channelCount = std::max(newChannelCount, 1);
+    nominalStep = stepIndex(newChunkMs);
+    maxStep = nominalStep;
+    while (maxStep + 1 < static_cast<int32_t>(CHUNK_STEPS_MS.size()) && CHUNK_STEPS_MS[maxStep + 1] <= maxChunkMs)
+        maxStep++;
+    step = nominalStep;
+    maxBitrate = std::max(newBitrate, 0);
+    currentBitrate = maxBitrate;
+    lastDecreaseMs = INT64_MIN / 2;
+    lastIncreaseMs = INT64_MIN / 2;
+    lastCongestedMs = INT64_MIN / 2;
+    for (Listener &listener : table)
+        listener.used = false;
+    listeners = 0;
+    decreases = 0;
+    increases = 0;
+    publish();
+}
+
+void CongestionController::onReport(uint32_t listenerId, const feedback::Report &report, int64_t nowMs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Vaga do ouvinte: a dele, uma livre ou a do mais antigo
+    Listener *slot = nullptr;
+    for (Listener &listener : table)
+    {
+        if (listener.used && listener.id == listenerId)
+            slot = &listener;
+    }
+    for (Listener &listener : table)
+    {
+        if (slot == nullptr && !listener.used)
+            slot = &listener;
+    }
+    if (slot == nullptr)
+    {
+        slot = &table[0];
+        for (Listener &listener : table)
+        {
+            if (listener.lastMs < slot->lastMs)
+                slot = &listener;
+        }
+    }
+    slot->used = true;
+    slot->id = listenerId;
+    slot->lastMs = nowMs;
+    slot->report = report;
+
+    // ✅ Pior caso entre os ouvintes com relatório recente
+    int32_t fresh = 0;
+    int32_t worstLoss = 0;
+    int32_t underruns = 0;
+    bool starving = false;
+    for (const Listener &listener : table)
+    {
+        if (!listener.used || nowMs - listener.lastMs > STALE_MS)
+            continue;
+        fresh++;
+        const feedback::Report &r = listener.report;
+        worstLoss = std::max<int32_t>(worstLoss, r.lossPermille);
+        underruns += r.underruns;
+        starving = starving || (!r.isPrebuffering() && r.targetMs > 0 && r.bufferMs * 2 < r.targetMs);
+    }
+    listeners = fresh;
+
+    bool congested = worstLoss >= LOSS_CONGESTED_PERMILLE || underruns > 0 || starving;
+    bool clean = worstLoss <= LOSS_CLEAN_PERMILLE && underruns == 0 && !starving;
+
+    if (congested)
+    {
+        lastCongestedMs = nowMs;
+        if (nowMs - lastDecreaseMs < DECREASE_INTERVAL_MS)
+            return;
+        lastDecreaseMs = nowMs;
+
+        int32_t previousBitrate = currentBitrate;
+        int32_t previousStep = step;
+        if (currentBitrate > 0)
+            currentBitrate = std::max(MIN_BITRATE, currentBitrate * DECREASE_PERCENT / 100);
+        step = std::min(step + 1, maxStep);
+        if (currentBitrate != previousBitrate || step != previousStep)
+        {
+            decreases++;
+            LOGW("📉 Congestionamento (perda %d‰, %d underruns%s): %dms, %d bps",
+                 worstLoss, underruns, starving ? ", buffer baixo" : "", CHUNK_STEPS_MS[step], currentBitrate);
+            publish();
+        }
+        return;
+    }
+
+    if (!clean || nowMs - lastCongestedMs < INCREASE_HOLD_MS || nowMs - lastIncreaseMs < INCREASE_INTERVAL_MS)
+        return;
+
+    // Primeiro o chunk volta ao nominal (latência e PLC mais finos), depois o bitrate
+    if (step > nominalStep)
+        step--;
+    else if (currentBitrate < maxBitrate)
+        currentBitrate = std::min(maxBitrate, currentBitrate + INCREASE_STEP_BPS);
+    else
+        return;
+
+    lastIncreaseMs = nowMs;
+    increases++;
+    LOGI("📈 Rede limpa: %dms, %d bps", CHUNK_STEPS_MS[step], currentBitrate);
+    publish();
+}
+
+void CongestionController::publish()
+{
+    int32_t ms = CHUNK_STEPS_MS[step];
+    int64_t mediaBytesPerS = currentBitrate > 0
+                                 ? currentBitrate / 8
+                                 : static_cast<int64_t>(sampleRate) * channelCount * static_cast<int64_t>(sizeof(int16_t));
+    int64_t overheadBytesPerS = static_cast<int64_t>(PACKET_OVERHEAD_BYTES) * 1000 / ms;
+
+    chunkMs.store(ms, std::memory_order_relaxed);
+    bitrate.store(currentBitrate, std::memory_order_relaxed);
+    pacingBytesPerS.store((mediaBytesPerS + overheadBytesPerS) * PACING_HEADROOM_PERCENT / 100,
+                          std::memory_order_relaxed);
+}
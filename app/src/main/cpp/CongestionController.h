@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#include "ReceiverFeedback.h"
+
+// ✅ Controle de congestionamento do sender a partir dos relatórios dos receptores
+//
+// Junta o relatório mais recente de cada ouvinte (até MAX_LISTENERS, os parados há
+// mais de STALE_MS não contam) e decide pelo pior deles:
+//  - Congestionado (perda >= 5%, underrun ou buffer abaixo de metade do alvo):
+//    bitrate x0.75 e chunk um degrau acima (menos pacotes por segundo), no máximo
+//    uma vez por DECREASE_INTERVAL_MS para esperar o efeito chegar aos relatórios
+//  - Limpo (perda <= 2%, sem underrun) por INCREASE_HOLD_MS: volta um degrau de
+//    chunk até o nominal e depois sobe o bitrate de INCREASE_STEP_BPS até o inicial
+// Perda entre 2% e 5% segura onde está: perda do meio físico, não de fila.
+// O ritmo de envio (pacing) acompanha a taxa atual com PACING_HEADROOM de folga.
+//  - Thread que recebe os relatórios: onReport() (mutex)
+//  - Captura e envio: getSettings() (atômicos, sem lock)
+class CongestionController
+{
+public:
+    static constexpr int32_t MAX_LISTENERS = 64;
+    static constexpr int64_t STALE_MS = 3000;
+    static constexpr int32_t LOSS_CONGESTED_PERMILLE = 50;
+    static constexpr int32_t LOSS_CLEAN_PERMILLE = 20;
+    static constexpr int64_t DECREASE_INTERVAL_MS = 1000;
+    static constexpr int64_t INCREASE_HOLD_MS = 4000;
+    static constexpr int64_t INCREASE_INTERVAL_MS = 2000;
+    static constexpr int32_t DECREASE_PERCENT = 75;
+    static constexpr int32_t INCREASE_STEP_BPS = 8000;
+    static constexpr int32_t MIN_BITRATE = 24000;
+    static constexpr int32_t PACING_HEADROOM_PERCENT = 150;
+    static constexpr int32_t PACKET_OVERHEAD_BYTES = 24 + 28; // SHB1 + IP/UDP
+    static constexpr std::array<int32_t, 4> CHUNK_STEPS_MS = {10, 20, 40, 60}; // Durações do Opus
+
+    struct Settings
+    {
+        int32_t chunkMs = 20;
+        int32_t bitrate = 0;         // 0 = codec sem bitrate ajustável (PCM)
+        int64_t pacingBytesPerS = 0; // Taxa do envio com folga (pacotes inteiros)
+    };
+
+    // chunkMs nominal (o menor usado) e bitrate inicial (teto; 0 = PCM).
+    // maxChunkMs limita os degraus ao que o pipeline aceita.
+    void configure(int32_t sampleRate, int32_t channelCount, int32_t chunkMs, int32_t bitrate, int32_t maxChunkMs);
+
+    // ✅ Relatório de um ouvinte (id qualquer, estável por ouvinte)
+    void onReport(uint32_t listenerId, const feedback::Report &report, int64_t nowMs);
+
+    Settings getSettings() const
+    {
+        Settings settings;
+        settings.chunkMs = chunkMs.load(std::memory_order_relaxed);
+        settings.bitrate = bitrate.load(std::memory_order_relaxed);
+        settings.pacingBytesPerS = pacingBytesPerS.load(std::memory_order_relaxed);
+        return settings;
+    }
+
+    int32_t getListeners() const { return listeners.load(); } // Com relatório recente
+    int64_t getDecreases() const { return decreases.load(); }
+    int64_t getIncreases() const { return increases.load(); }
+
+private:
+    struct Listener
+    {
+        bool used = false;
+        uint32_t id = 0;
+        int64_t lastMs = 0;
+        feedback::Report report;
+    };
+
+    void publish(); // Com mutex
+    int32_t stepIndex(int32_t ms) const;
+
+    std::mutex mutex;
+    std::array<Listener, MAX_LISTENERS> table{};
+    int32_t sampleRate = 48000;
+    int32_t channelCount = 2;
+    int32_t nominalStep = 1;
+    int32_t maxStep = 3;
+    int32_t step = 1;
+    int32_t maxBitrate = 0;
+    int32_t currentBitrate = 0;
+    int64_t lastDecreaseMs = INT64_MIN / 2;
+    int64_t lastIncreaseMs = INT64_MIN / 2;
+    int64_t lastCongestedMs = INT64_MIN / 2;
+
+    std::atomic<int32_t> chunkMs{20};
+    std::atomic<int32_t> bitrate{0};
+    std::atomic<int64_t> pacingBytesPerS{0};
+    std::atomic<int32_t> listeners{0};
+    std::atomic<int64_t> decreases{0};
+    std::atomic<int64_t> increases{0};
+};
@@ -0,0 +1,262 @@
+#include "DecodeWorker.h"
+#include "NativeLog.h"
+
+#include <chrono>
+#include <cstring>
+
+DecodeWorker::DecodeWorker(PlayerCore &core) : core(core)
+{
+}
+
+DecodeWorker::~DecodeWorker()
+{
+    stop();
+}
+
+void DecodeWorker::configure(std::unique_ptr<AudioDecoder> newDecoder, int32_t channelCount)
+{
+    decoder = std::move(newDecoder);
+    channels = channelCount;
+    pcm.assign(static_cast<size_t>(MAX_FRAMES_PER_PACKET) * channelCount, int16_t(0));
+    queue.clear();
+    reorder.configure(MAX_PACKET_BYTES);
+    lastPacketFrames = 960;
+
+    decodedPackets = 0;
+    lostPackets = 0;
+    concealedFrames = 0;
+    concealedPackets = 0;
+    recoveredPackets = 0;
+    decoderResets = 0;
+    rejectedPackets = 0;
+    silentPackets = 0;
+
+    if (decoder)
+    {
+        LOGI("🎼 Decodificador: %s", decoder->name());
+    }
+}
+
+void DecodeWorker::start()
+{
+    if (!decoder || running.exchange(true))
+        return;
+    thread = std::thread(&DecodeWorker::run, this);
+}
+
+void DecodeWorker::stop()
+{
+    if (!running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+
+    // Pacotes pendentes pertencem à sessão anterior
+    queue.clear();
+    reorder.reset();
+}
+
+void DecodeWorker::discardPending()
+{
+    bool wasRunning = running.load();
+    stop();
+    queue.clear();
+    reorder.reset();
+    if (wasRunning)
+        start();
+}
+
+bool DecodeWorker::submit(const uint8_t *bytes, int32_t length)
+{
+    if (!enqueue(bytes, length))
+        return false;
+    notifyWorker();
+    return true;
+}
+
+int32_t DecodeWorker::submitBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count)
+{
+    int32_t accepted = 0;
+    for (int32_t i = 0; i < count; i++)
+    {
+        if (enqueue(bytes + offsets[i], offsets[i + 1] - offsets[i]))
+            accepted++;
+    }
+    if (accepted > 0)
+        notifyWorker();
+    return accepted;
+}
+
+bool DecodeWorker::enqueue(const uint8_t *bytes, int32_t length)
+{
+    if (!decoder)
+        return false;
+
+    Packet item;
+    if (!packet::parse(bytes, length, item.header) || item.header.codec != packet::CODEC_OPUS)
+    {
+        rejectedPackets++;
+        return false;
+    }
+
+    item.length = length - packet::HEADER_BYTES;
+    if (item.length <= 0 || item.length > MAX_PACKET_BYTES)
+    {
+        rejectedPackets++;
+        return false;
+    }
+    memcpy(item.data, bytes + packet::HEADER_BYTES, item.length);
+
+    if (!queue.push(item))
+    {
+        // Decodificação atrasada demais: o pacote vira perda (e PLC) lá na frente
+        if (++rejectedPackets % 50 == 1)
+        {
+            LOGW("⚠️ Fila de decodificação cheia (%d descartados)", rejectedPackets.load());
+        }
+        return false;
+    }
+    return true;
+}
+
+void DecodeWorker::notifyWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+}
+
+void DecodeWorker::run()
+{
+    while (running.load())
+    {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait_for(lock, std::chrono::milliseconds(20),
+                          [this] { return queue.size() > 0 || !running.load(); });
+        }
+        drain();
+    }
+}
+
+int32_t DecodeWorker::drain()
+{
+    int32_t handled = 0;
+    while (const Packet *item = queue.front())
+    {
+        const packet::Header &header = item->header;
+        reorder.push(header.sequence,
+                     header.hasTimestamp() ? header.captureTimeUs : PlayoutScheduler::NO_TIMESTAMP,
+                     item->data, item->length,
+                     [this](const ReorderBuffer::Entry &entry, uint32_t lostBefore)
+                     { handlePacket(entry, lostBefore); },
+                     header.flags);
+        queue.pop();
+        handled++;
+    }
+    return handled;
+}
+
+void DecodeWorker::handlePacket(const ReorderBuffer::Entry &item, uint32_t lostBefore)
+{
+    if (lostBefore > 0 && lostBefore <= static_cast<uint32_t>(MAX_CONCEAL_PACKETS))
+    {
+        concealGap(item, lostBefore);
+    }
+    else if (lostBefore > 0)
+    {
+        // Buraco grande ou sender reiniciado: recomeçar do zero
+        lostPackets += lostBefore != ReorderBuffer::DISCONTINUITY ? lostBefore : 0;
+        decoderResets++;
+        decoder->reset();
+        LOGW("⚠️ Descontinuidade na sequência (%u pacotes) antes de #%u: decodificador reiniciado",
+             lostBefore == ReorderBuffer::DISCONTINUITY ? 0u : lostBefore, item.sequence);
+    }
+
+    if ((item.flags & packet::FLAG_SILENCE) != 0)
+    {
+        // ✅ DTX: o encoder não viu esses frames, então o decodificador também não
+        // passa por eles (os dois estados seguem casados)
+        uint32_t silentFrames = 0;
+        uint16_t level = 0;
+        if (!packet::parseSilence(item.data, item.length, silentFrames, level) || silentFrames == 0 ||
+            silentFrames > static_cast<uint32_t>(MAX_FRAMES_PER_PACKET))
+        {
+            rejectedPackets++;
+            return;
+        }
+        auto frames = static_cast<int32_t>(silentFrames);
+        silence::fill(pcm.data(), frames * channels, core.isComfortNoise() ? level : 0, noiseSeed);
+        silentPackets++;
+        lastPacketFrames = frames;
+        deliver(frames, item.captureTimeUs);
+        return;
+    }
+
+    int32_t frames = decoder->decode(item.data, item.length, pcm.data(), MAX_FRAMES_PER_PACKET);
+    if (frames <= 0)
+    {
+        // Pacote corrompido: tratar como perdido
+        lostPackets++;
+        frames = decoder->conceal(pcm.data(), lastPacketFrames);
+        if (frames <= 0)
+            return;
+        concealedFrames += frames;
+        concealedPackets++;
+    }
+    else
+    {
+        decodedPackets++;
+        lastPacketFrames = frames;
+    }
+
+    deliver(frames, item.captureTimeUs);
+}
+
+void DecodeWorker::concealGap(const ReorderBuffer::Entry &next, uint32_t lost)
+{
+    lostPackets += lost;
+
+    // Instante de captura do primeiro frame perdido, recuado a partir do pacote atual
+    int32_t sampleRate = core.getSampleRate();
+    int64_t gapFrames = static_cast<int64_t>(lost) * lastPacketFrames;
+    int64_t captureTimeUs = next.captureTimeUs != PlayoutScheduler::NO_TIMESTAMP
+                                ? next.captureTimeUs - (gapFrames * 1000000LL) / sampleRate
+                                : PlayoutScheduler::NO_TIMESTAMP;
+
+    for (uint32_t i = 0; i < lost; i++)
+    {
+        // O último perdido pode vir da redundância (FEC) do pacote atual (marcador de
+        // silêncio não tem redundância)
+        bool lastLost = (i + 1 == lost) && (next.flags & packet::FLAG_SILENCE) == 0;
+        int32_t frames = lastLost
+                             ? decoder->recover(next.data, next.length, pcm.data(), lastPacketFrames)
+                             : decoder->conceal(pcm.data(), lastPacketFrames);
+        if (frames <= 0)
+            continue;
+
+        if (lastLost)
+        {
+            recoveredPackets++;
+        }
+        else
+        {
+            concealedFrames += frames;
+            concealedPackets++;
+        }
+
+        deliver(frames, captureTimeUs);
+        if (captureTimeUs != PlayoutScheduler::NO_TIMESTAMP)
+            captureTimeUs += (static_cast<int64_t>(frames) * 1000000LL) / sampleRate;
+    }
+}
+
+void DecodeWorker::deliver(int32_t frames, int64_t captureTimeUs)
+{
+    core.writeFrames(pcm.data(), frames, captureTimeUs);
+}
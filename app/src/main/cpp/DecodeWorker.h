@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AudioDecoder.h"
+#include "PacketFormat.h"
+#include "PlayerCore.h"
+#include "ReorderBuffer.h"
+#include "SilenceDetector.h"
+#include "SpscQueue.h"
+
+// ✅ Estágio de decodificação entre a rede e o PlayerCore
+//
+// A thread JNI só copia o pacote SHB1 codificado para uma fila SPSC (submit);
+// uma thread própria reordena (ReorderBuffer), decodifica e escreve PCM no ring do
+// PlayerCore. Buracos na sequência viram PLC (e FEC para o último pacote perdido,
+// que o Opus carrega dentro do pacote seguinte). Buracos grandes demais reiniciam
+// o decodificador.
+class DecodeWorker
+{
+public:
+    static constexpr int32_t MAX_PACKET_BYTES = 1500;      // Cabe num datagrama
+    static constexpr int32_t MAX_FRAMES_PER_PACKET = 5760; // 120ms a 48kHz (limite do Opus)
+    static constexpr int32_t MAX_CONCEAL_PACKETS = 5;      // ~100ms de PLC; acima disso, recomeçar
+    static constexpr int32_t QUEUE_PACKETS = 64;
+
+    explicit DecodeWorker(PlayerCore &core);
+    ~DecodeWorker();
+    DecodeWorker(const DecodeWorker &) = delete;
+    DecodeWorker &operator=(const DecodeWorker &) = delete;
+
+    // Só com a thread parada. decoder == nullptr desativa o caminho codificado.
+    void configure(std::unique_ptr<AudioDecoder> decoder, int32_t channelCount);
+    bool isAvailable() const { return decoder != nullptr; }
+
+    void start();
+    void stop();
+
+    // ✅ CONTROLE: PCM chegou para a mesma fonte. Para a thread (nenhum writeFrames
+    // em andamento), descarta fila e reordenação e volta a rodar se estava rodando;
+    // a partir daí outro produtor pode escrever no core.
+    void discardPending();
+
+    // ✅ PRODUTOR (thread JNI): enfileira um pacote SHB1 codificado
+    bool submit(const uint8_t *bytes, int32_t length);
+
+    // ✅ PRODUTOR: vários pacotes (offsets como PlayerCore::writeBatch) e um só
+    // despertar do worker. Retorna quantos entraram na fila.
+    int32_t submitBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count);
+
+    // Decodifica tudo que estiver na fila (thread do worker; nos testes, direto)
+    int32_t drain();
+
+    // Estatísticas
+    int64_t getDecodedPackets() const { return decodedPackets.load(); }
+    int64_t getLostPackets() const { return lostPackets.load(); }
+    int64_t getConcealedFrames() const { return concealedFrames.load(); }
+    int64_t getConcealedPackets() const { return concealedPackets.load(); } // PLC
+    int64_t getRecoveredPackets() const { return recoveredPackets.load(); } // FEC (ou PLC sem redundância)
+    int32_t getDecoderResets() const { return decoderResets.load(); }
+    int32_t getRejectedPackets() const { return rejectedPackets.load(); }
+    int64_t getSilentPackets() const { return silentPackets.load(); } // Marcadores DTX
+    int64_t getLatePackets() const { return reorder.getLatePackets(); } // Atrasados + duplicados
+    int64_t getReceivedPackets() const { return reorder.getReceivedPackets(); }
+    int64_t getReorderedPackets() const { return reorder.getReorderedPackets(); }
+
+private:
+    struct Packet
+    {
+        packet::Header header;
+        int32_t length = 0;
+        uint8_t data[MAX_PACKET_BYTES];
+    };
+
+    void run();
+    bool enqueue(const uint8_t *bytes, int32_t length);
+    void notifyWorker();
+    void handlePacket(const ReorderBuffer::Entry &item, uint32_t lostBefore);
+    void concealGap(const ReorderBuffer::Entry &next, uint32_t lost);
+    void deliver(int32_t frames, int64_t captureTimeUs);
+
+    PlayerCore &core;
+    std::unique_ptr<AudioDecoder> decoder;
+    int32_t channels = 2;
+
+    SpscQueue<Packet, QUEUE_PACKETS> queue;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    // Estado da thread de decodificação
+    std::vector<int16_t> pcm;
+    ReorderBuffer reorder;
+    int32_t lastPacketFrames = 960;
+    uint32_t noiseSeed = 33333;
+
+    std::atomic<int64_t> decodedPackets{0};
+    std::atomic<int64_t> lostPackets{0};
+    std::atomic<int64_t> concealedFrames{0};
+    std::atomic<int64_t> concealedPackets{0};
+    std::atomic<int64_t> recoveredPackets{0};
+    std::atomic<int32_t> decoderResets{0};
+    std::atomic<int32_t> rejectedPackets{0};
+    std::atomic<int64_t> silentPackets{0};
+};
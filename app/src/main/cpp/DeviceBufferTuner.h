@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+// ✅ Tamanho do buffer do dispositivo ajustado pelos xruns (como o oboe::LatencyTuner)
+//
+// Começa em INITIAL_BURSTS bursts. A cada CHECK_INTERVAL_MS o callback lê o contador
+// de xruns do stream: xrun novo com áudio tocando cresce o buffer em um burst;
+// QUIET_PERIOD_MS sem xrun encolhe um burst. Se o xrun volta logo depois de um
+// encolhimento, a espera para o próximo dobra (até MAX_QUIET_PERIOD_MS), para não
+// ficar oscilando em volta do tamanho mínimo estável.
+//
+// Ligado ao prebuffer do PlayerCore: xruns enquanto todas as fontes estão em
+// prebuffer (saída em silêncio, aquecimento do stream) não aumentam a latência.
+// Sem contagem de xruns (OpenSL ES) fica no tamanho fixo de antes (90% da capacidade).
+class DeviceBufferTuner
+{
+public:
+    static constexpr int32_t INITIAL_BURSTS = 2;
+    static constexpr int32_t CHECK_INTERVAL_MS = 50;
+    static constexpr int32_t QUIET_PERIOD_MS = 30000;
+    static constexpr int32_t MAX_QUIET_PERIOD_MS = 480000;
+    static constexpr int32_t FALLBACK_PERCENT = 90;
+
+    // Stream novo (antes do start). xrunsSupported = getXRunCount() funciona.
+    void reset(int32_t framesPerBurst, int32_t capacityFrames, int32_t sampleRate, bool xrunsSupported)
+    {
+        burst = std::max(framesPerBurst, 1);
+        capacity = std::max(capacityFrames, burst);
+        rate = std::max(sampleRate, 1);
+        enabled = xrunsSupported;
+        checkFrames = static_cast<int32_t>((static_cast<int64_t>(rate) * CHECK_INTERVAL_MS) / 1000);
+        quietPeriodMs = QUIET_PERIOD_MS;
+        framesSinceCheck = 0;
+        quietFrames = 0;
+        framesSinceShrink = -1;
+        lastXruns = -1;
+
+        int32_t size = enabled ? std::min(burst * INITIAL_BURSTS, capacity)
+                               : (capacity * FALLBACK_PERCENT) / 100;
+        bufferSize.store(size, std::memory_order_relaxed);
+    }
+
+    bool isEnabled() const { return enabled; }
+
+    // ✅ CALLBACK: true quando é hora de ler os xruns e chamar update()
+    bool tick(int32_t frames)
+    {
+        if (!enabled)
+            return false;
+        framesSinceCheck += frames;
+        return framesSinceCheck >= checkFrames;
+    }
+
+    // ✅ CALLBACK: xruns = total do stream; audible = alguma fonte fora do prebuffer.
+    // Devolve o tamanho novo a aplicar com setBufferSizeInFrames(), ou 0 se não mudou.
+    int32_t update(int32_t xruns, bool audible)
+    {
+        int32_t elapsed = framesSinceCheck;
+        framesSinceCheck = 0;
+        if (!enabled)
+            return 0;
+
+        bool newXruns = lastXruns >= 0 && xruns > lastXruns;
+        lastXruns = xruns;
+        if (framesSinceShrink >= 0)
+        {
+            framesSinceShrink += elapsed;
+            if (framesSinceShrink >= msToFrames(quietPeriodMs))
+                framesSinceShrink = -1; // O encolhimento se provou estável
+        }
+
+        int32_t size = bufferSize.load(std::memory_order_relaxed);
+        if (newXruns && audible)
+        {
+            quietFrames = 0;
+            if (framesSinceShrink >= 0 && framesSinceShrink < msToFrames(quietPeriodMs))
+            {
+                // O tamanho de antes do encolhimento era o necessário: esperar mais na próxima
+                quietPeriodMs = std::min(quietPeriodMs * 2, MAX_QUIET_PERIOD_MS);
+            }
+            framesSinceShrink = -1;
+            if (size >= capacity)
+                return 0;
+            growths.fetch_add(1, std::memory_order_relaxed);
+            return apply(std::min(size + burst, capacity));
+        }
+
+        quietFrames += elapsed;
+        if (quietFrames < msToFrames(quietPeriodMs) || size <= burst * INITIAL_BURSTS)
+            return 0;
+
+        quietFrames = 0;
+        framesSinceShrink = 0;
+        shrinks.fetch_add(1, std::memory_order_relaxed);
+        return apply(std::max(size - burst, burst * INITIAL_BURSTS));
+    }
+
+    // Tamanho que o stream aceitou de fato (setBufferSizeInFrames pode arredondar)
+    void setActual(int32_t frames) { bufferSize.store(frames, std::memory_order_relaxed); }
+
+    // Qualquer thread (telemetria)
+    int32_t getBufferSize() const { return bufferSize.load(std::memory_order_relaxed); }
+    int32_t getGrowths() const { return growths.load(std::memory_order_relaxed); }
+    int32_t getShrinks() const { return shrinks.load(std::memory_order_relaxed); }
+    int32_t getQuietPeriodMs() const { return quietPeriodMs; }
+
+private:
+    int32_t msToFrames(int32_t ms) const
+    {
+        return static_cast<int32_t>((static_cast<int64_t>(ms) * rate) / 1000);
+    }
+
+    int32_t apply(int32_t size)
+    {
+        bufferSize.store(size, std::memory_order_relaxed);
+        return size;
+    }
+
+    int32_t burst = 192;
+    int32_t capacity = 192 * INITIAL_BURSTS;
+    int32_t rate = 48000;
+    bool enabled = false;
+    int32_t checkFrames = 2400;
+    int32_t quietPeriodMs = QUIET_PERIOD_MS;
+
+    // Estado do callback
+    int32_t framesSinceCheck = 0;
+    int32_t quietFrames = 0;
+    int32_t framesSinceShrink = -1; // -1 = sem encolhimento recente
+    int32_t lastXruns = -1;
+
+    std::atomic<int32_t> bufferSize{192 * INITIAL_BURSTS};
+    std::atomic<int32_t> growths{0};
+    std::atomic<int32_t> shrinks{0};
+};
@@ -0,0 +1,186 @@
+#include "DriftResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace
+{
+    // Bessel modificada de ordem 0 (janela de Kaiser)
+    double besselI0(double x)
+    {
+        double sum = 1.0;
+        double term = 1.0;
+        for (int k = 1; k < 32; k++)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+        }
+        return sum;
+    }
+}
+
+void DriftResampler::configure(int32_t channelCount)
+{
+    channels = std::max(channelCount, 1);
+    // Histórico + antecipação da interpolação mais longa (sinc), para não realocar em setRates()
+    window.assign(static_cast<size_t>(WINDOW_FRAMES + 2 * SINC_HALF_TAPS) * channels, int16_t(0));
+    accumulator.assign(static_cast<size_t>(channels), 0.0f);
+    reset();
+}
+
+void DriftResampler::setRates(int32_t inputRate, int32_t outputRate)
+{
+    converting = inputRate > 0 && outputRate > 0 && inputRate != outputRate;
+    history = converting ? SINC_HALF_TAPS - 1 : 1;
+    lookahead = converting ? SINC_HALF_TAPS : 2;
+
+    if (converting)
+    {
+        // Passa-baixas abaixo da menor Nyquist (em frações da Nyquist da entrada)
+        double cutoff = SINC_CUTOFF * std::min(1.0, static_cast<double>(outputRate) / inputRate);
+        double norm = besselI0(SINC_KAISER_BETA);
+        constexpr int32_t TAPS = 2 * SINC_HALF_TAPS;
+        sincTable.assign(static_cast<size_t>(SINC_PHASES + 1) * TAPS, 0.0f);
+
+        for (int32_t phase = 0; phase <= SINC_PHASES; phase++)
+        {
+            double frac = static_cast<double>(phase) / SINC_PHASES;
+            float *row = sincTable.data() + static_cast<size_t>(phase) * TAPS;
+            double sum = 0.0;
+            for (int32_t j = 0; j < TAPS; j++)
+            {
+                // Tap j lê o frame (i - HALF + 1 + j); distância até a posição i + frac
+                double x = (j - (SINC_HALF_TAPS - 1)) - frac;
+                double u = x / SINC_HALF_TAPS;
+                double w = std::abs(u) < 1.0 ? besselI0(SINC_KAISER_BETA * std::sqrt(1.0 - u * u)) / norm : 0.0;
+                double arg = M_PI * cutoff * x;
+                double sinc = std::abs(arg) < 1e-9 ? 1.0 : std::sin(arg) / arg;
+                row[j] = static_cast<float>(cutoff * sinc * w);
+                sum += row[j];
+            }
+            // Ganho DC unitário em todas as fases (sem modulação de amplitude)
+            for (int32_t j = 0; j < TAPS; j++)
+                row[j] = static_cast<float>(row[j] / sum);
+        }
+    }
+    else
+    {
+        sincTable.clear();
+    }
+
+    reset();
+}
+
+void DriftResampler::reset()
+{
+    // Silêncio como histórico: a reprodução sempre começa do silêncio
+    std::fill_n(window.data(), static_cast<size_t>(history) * channels, int16_t(0));
+    windowCount = history;
+    position = history;
+}
+
+int32_t DriftResampler::bufferedFrames() const
+{
+    return std::max(0, windowCount - static_cast<int32_t>(position));
+}
+
+bool DriftResampler::refill(SpscFrameRing &ring, int32_t needIndex)
+{
+    // Manter só o histórico anterior à posição atual
+    int32_t keepFrom = static_cast<int32_t>(position) - history;
+    int32_t keep = windowCount - keepFrom;
+    if (keepFrom > 0)
+    {
+        memmove(window.data(), window.data() + static_cast<size_t>(keepFrom) * channels,
+                static_cast<size_t>(keep) * channels * sizeof(int16_t));
+        windowCount = keep;
+        position -= keepFrom;
+        needIndex -= keepFrom;
+    }
+
+    int32_t space = static_cast<int32_t>(window.size() / channels) - windowCount;
+    windowCount += ring.read(window.data() + static_cast<size_t>(windowCount) * channels, space);
+    return needIndex < windowCount;
+}
+
+void DriftResampler::interpolateSinc(const int16_t *center, double frac, int16_t *dst)
+{
+    constexpr int32_t TAPS = 2 * SINC_HALF_TAPS;
+
+    // Coeficientes da fase: interpolação linear entre as duas linhas vizinhas da tabela
+    double scaled = frac * SINC_PHASES;
+    auto phase = std::min(static_cast<int32_t>(scaled), SINC_PHASES - 1);
+    auto mix = static_cast<float>(scaled - phase);
+    const float *a = sincTable.data() + static_cast<size_t>(phase) * TAPS;
+    const float *b = a + TAPS;
+    for (int32_t j = 0; j < TAPS; j++)
+        taps[j] = a[j] + (b[j] - a[j]) * mix;
+
+    const int16_t *first = center - static_cast<size_t>(SINC_HALF_TAPS - 1) * channels;
+    std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+    for (int32_t j = 0; j < TAPS; j++)
+    {
+        const int16_t *frame = first + static_cast<size_t>(j) * channels;
+        for (int32_t c = 0; c < channels; c++)
+            accumulator[c] += taps[j] * frame[c];
+    }
+    for (int32_t c = 0; c < channels; c++)
+        dst[c] = static_cast<int16_t>(std::clamp(std::lrintf(accumulator[c]), -32768L, 32767L));
+}
+
+int32_t DriftResampler::process(SpscFrameRing &ring, int16_t *out, int32_t outFrames, double ratio)
+{
+    int32_t produced = 0;
+    const int16_t *w = window.data();
+
+    while (produced < outFrames)
+    {
+        int32_t i = static_cast<int32_t>(position);
+        if (i + lookahead >= windowCount)
+        {
+            if (!refill(ring, i + lookahead))
+                break; // Ring vazio: underrun
+            i = static_cast<int32_t>(position);
+        }
+
+        const int16_t *y1 = w + static_cast<size_t>(i) * channels;
+        int16_t *dst = out + static_cast<size_t>(produced) * channels;
+
+        if (converting)
+        {
+            interpolateSinc(y1, position - i, dst);
+            position += ratio;
+            produced++;
+            continue;
+        }
+
+        float t = static_cast<float>(position - i);
+        const int16_t *y0 = y1 - channels;
+        const int16_t *y2 = y1 + channels;
+        const int16_t *y3 = y2 + channels;
+
+        if (t == 0.0f)
+        {
+            // Fase inteira (caso comum com ratio 1.0): cópia exata
+            memcpy(dst, y1, channels * sizeof(int16_t));
+        }
+        else
+        {
+            for (int32_t c = 0; c < channels; c++)
+            {
+                float p0 = y0[c], p1 = y1[c], p2 = y2[c], p3 = y3[c];
+                float a0 = -0.5f * p0 + 1.5f * p1 - 1.5f * p2 + 0.5f * p3;
+                float a1 = p0 - 2.5f * p1 + 2.0f * p2 - 0.5f * p3;
+                float a2 = -0.5f * p0 + 0.5f * p2;
+                float v = ((a0 * t + a1) * t + a2) * t + p1;
+                dst[c] = static_cast<int16_t>(std::clamp(std::lrintf(v), -32768L, 32767L));
+            }
+        }
+
+        position += ratio;
+        produced++;
+    }
+
+    return produced;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "SpscFrameRing.h"
+
+// ✅ Reamostrador cúbico (Catmull-Rom) para compensar drift de relógio
+//
+// Consome frames do SpscFrameRing com passo fracionário `ratio` (frames de entrada
+// por frame de saída). Com ratio 1.0 e fase zero a saída é idêntica à entrada.
+// Roda no callback de áudio: a janela é alocada em configure() e nunca cresce.
+//
+// Com taxas diferentes na fonte e no dispositivo (44.1kHz vs 48kHz), setRates()
+// troca a cúbica por um sinc janelado (Kaiser, 64 taps, tabela polifásica) com
+// corte abaixo da menor das duas Nyquist; o `ratio` passado a process() passa a
+// incluir a razão nominal entrada/saída.
+class DriftResampler
+{
+public:
+    static constexpr int32_t WINDOW_FRAMES = 1024;
+    static constexpr int32_t SINC_HALF_TAPS = 32;
+    static constexpr int32_t SINC_PHASES = 256;
+    static constexpr double SINC_KAISER_BETA = 8.0;
+    static constexpr double SINC_CUTOFF = 0.91; // Fração da menor Nyquist
+
+    void configure(int32_t channelCount);
+
+    // Liga o sinc quando inputRate != outputRate (calcula a tabela: fora do callback).
+    // Descarta a janela, como reset().
+    void setRates(int32_t inputRate, int32_t outputRate);
+    bool isConverting() const { return converting; }
+
+    // Descarta a janela e a fase (consumidor parado ou dentro do callback)
+    void reset();
+
+    // Produz até outFrames frames em out. Retorna menos se o ring esvaziar.
+    int32_t process(SpscFrameRing &ring, int16_t *out, int32_t outFrames, double ratio);
+
+    // Frames já retirados do ring e ainda não tocados
+    int32_t bufferedFrames() const;
+
+    // Idem, com a fase fracionária: o próximo frame de saída corresponde ao
+    // índice readPosition() - pendingFrames() do ring
+    double pendingFrames() const { return windowCount - position; }
+
+private:
+    bool refill(SpscFrameRing &ring, int32_t needIndex);
+    void interpolateSinc(const int16_t *center, double frac, int16_t *dst);
+
+    std::vector<int16_t> window;
+    int32_t channels = 2;
+    int32_t windowCount = 0; // Frames válidos na janela
+    double position = 1.0;   // Posição de leitura; sempre >= history
+    int32_t history = 1;     // Frames necessários antes da posição (1 cúbica, 31 sinc)
+    int32_t lookahead = 2;   // E depois dela (2 cúbica, 32 sinc)
+
+    // ✅ Sinc: (SINC_PHASES + 1) linhas de 2*SINC_HALF_TAPS coeficientes
+    bool converting = false;
+    std::vector<float> sincTable;
+    std::array<float, 2 * SINC_HALF_TAPS> taps{};
+    std::vector<float> accumulator; // Um por canal
+};
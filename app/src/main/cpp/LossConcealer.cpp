@@ -0,0 +1,164 @@
+#include "LossConcealer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+void LossConcealer::configure(int32_t sampleRate, int32_t channelCount)
+{
+    rate = std::max(sampleRate, 1);
+    channels = std::max(channelCount, 1);
+    historyCapacity = (rate * HISTORY_MS) / 1000;
+    history.assign(static_cast<size_t>(historyCapacity) * channels, int16_t(0));
+    mono.assign(static_cast<size_t>(historyCapacity), 0.0f);
+    period.assign(static_cast<size_t>(rate * MAX_PERIOD_MS / 1000.0f + 1) * channels, int16_t(0));
+    reset();
+}
+
+void LossConcealer::reset()
+{
+    historyFrames = 0;
+    concealing = false;
+    periodFrames = 0;
+    phase = 0;
+    concealedFrames = 0;
+}
+
+void LossConcealer::remember(const int16_t *samples, int32_t frames)
+{
+    if (historyCapacity == 0 || frames <= 0)
+        return;
+
+    if (frames >= historyCapacity)
+    {
+        memcpy(history.data(), samples + static_cast<size_t>(frames - historyCapacity) * channels,
+               history.size() * sizeof(int16_t));
+        historyFrames = historyCapacity;
+        return;
+    }
+
+    // Empurrar o histórico para a esquerda e anexar o chunk no fim
+    int32_t keep = std::min(historyFrames, historyCapacity - frames);
+    memmove(history.data() + static_cast<size_t>(historyCapacity - frames - keep) * channels,
+            history.data() + static_cast<size_t>(historyCapacity - keep) * channels,
+            static_cast<size_t>(keep) * channels * sizeof(int16_t));
+    memcpy(history.data() + static_cast<size_t>(historyCapacity - frames) * channels, samples,
+           static_cast<size_t>(frames) * channels * sizeof(int16_t));
+    historyFrames = keep + frames;
+}
+
+int32_t LossConcealer::findPeriod() const
+{
+    auto minPeriod = static_cast<int32_t>(rate * MIN_PERIOD_MS / 1000.0f);
+    auto maxPeriod = static_cast<int32_t>(rate * MAX_PERIOD_MS / 1000.0f);
+    auto match = static_cast<int32_t>(rate * MATCH_MS / 1000.0f);
+
+    // Histórico curto (início do stream): repetir o que houver
+    maxPeriod = std::min(maxPeriod, historyFrames - match);
+    if (maxPeriod < minPeriod)
+        return std::clamp(historyFrames, 0, static_cast<int32_t>(period.size() / channels));
+
+    // O template é o final do histórico; o candidato termina `lag` frames antes
+    const float *end = mono.data() + historyCapacity;
+    double templateEnergy = 0.0;
+    for (int32_t i = 1; i <= match; i++)
+        templateEnergy += static_cast<double>(end[-i]) * end[-i];
+
+    int32_t best = maxPeriod;
+    double bestScore = -2.0;
+    for (int32_t lag = minPeriod; lag <= maxPeriod; lag++)
+    {
+        double cross = 0.0;
+        double energy = 0.0;
+        for (int32_t i = 1; i <= match; i++)
+        {
+            float c = end[-i - lag];
+            cross += static_cast<double>(end[-i]) * c;
+            energy += static_cast<double>(c) * c;
+        }
+        double denom = std::sqrt(templateEnergy * energy);
+        double score = denom > 0.0 ? cross / denom : 0.0;
+        if (score > bestScore)
+        {
+            bestScore = score;
+            best = lag;
+        }
+    }
+    return best;
+}
+
+float LossConcealer::gainAt(int64_t frame) const
+{
+    int64_t full = (static_cast<int64_t>(rate) * FULL_GAIN_MS) / 1000;
+    if (frame < full)
+        return 1.0f;
+    int64_t fade = (static_cast<int64_t>(rate) * FADE_MS) / 1000;
+    return std::max(0.0f, 1.0f - static_cast<float>(frame - full) / static_cast<float>(fade));
+}
+
+void LossConcealer::conceal(int16_t *out, int32_t frames)
+{
+    if (!concealing)
+    {
+        for (int32_t f = 0; f < historyCapacity; f++)
+        {
+            float sum = 0.0f;
+            for (int32_t c = 0; c < channels; c++)
+                sum += history[static_cast<size_t>(f) * channels + c];
+            mono[f] = sum;
+        }
+
+        // O período começa `periodFrames` antes do fim: a repetição continua o
+        // trecho que mais se parece com o que acabou de tocar
+        periodFrames = findPeriod();
+        if (periodFrames > 0)
+        {
+            memcpy(period.data(), history.data() + static_cast<size_t>(historyCapacity - periodFrames) * channels,
+                   static_cast<size_t>(periodFrames) * channels * sizeof(int16_t));
+        }
+        phase = 0;
+        concealedFrames = 0;
+        concealing = true;
+    }
+
+    if (periodFrames <= 0)
+    {
+        std::fill_n(out, frames * channels, int16_t(0));
+        concealedFrames += frames;
+        return;
+    }
+
+    for (int32_t f = 0; f < frames; f++)
+    {
+        float gain = gainAt(concealedFrames + f);
+        const int16_t *src = period.data() + static_cast<size_t>(phase) * channels;
+        for (int32_t c = 0; c < channels; c++)
+            out[static_cast<size_t>(f) * channels + c] = static_cast<int16_t>(std::lrintf(src[c] * gain));
+        phase = (phase + 1) % periodFrames;
+    }
+    concealedFrames += frames;
+}
+
+void LossConcealer::blendInto(int16_t *samples, int32_t frames)
+{
+    if (!concealing)
+        return;
+    concealing = false;
+
+    auto overlap = std::min(frames, static_cast<int32_t>(rate * OVERLAP_MS / 1000.0f));
+    if (periodFrames <= 0 || overlap <= 0)
+        return;
+
+    for (int32_t f = 0; f < overlap; f++)
+    {
+        float w = (f + 0.5f) / overlap; // Peso do áudio real
+        float gain = gainAt(concealedFrames + f) * (1.0f - w);
+        const int16_t *src = period.data() + static_cast<size_t>(phase) * channels;
+        for (int32_t c = 0; c < channels; c++)
+        {
+            int16_t &s = samples[static_cast<size_t>(f) * channels + c];
+            s = static_cast<int16_t>(std::clamp(std::lrintf(src[c] * gain + s * w), -32768L, 32767L));
+        }
+        phase = (phase + 1) % periodFrames;
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// ✅ Concealment de chunks PCM perdidos (lado produtor)
+//
+// Guarda os últimos HISTORY_MS do áudio real. Na perda, procura o período (2.5..15ms)
+// cujo trecho anterior mais se parece com o final do histórico (correlação
+// normalizada) e repete esse período a partir do ponto alinhado, sem degrau na
+// emenda. Perdas seguidas vão a silêncio depois de FULL_GAIN_MS; o primeiro chunk
+// real depois da perda entra com crossfade (overlap-add) sobre a continuação.
+class LossConcealer
+{
+public:
+    static constexpr int32_t HISTORY_MS = 40;
+    static constexpr float MIN_PERIOD_MS = 2.5f;
+    static constexpr float MAX_PERIOD_MS = 15.0f;
+    static constexpr float MATCH_MS = 5.0f;   // Trecho comparado na busca do período
+    static constexpr float OVERLAP_MS = 5.0f; // Crossfade de volta ao áudio real
+    static constexpr int32_t FULL_GAIN_MS = 20;
+    static constexpr int32_t FADE_MS = 40;    // Depois disso, silêncio
+
+    void configure(int32_t sampleRate, int32_t channelCount);
+    void reset();
+
+    // Áudio real entregue ao ring (depois de blendInto, se houve perda)
+    void remember(const int16_t *samples, int32_t frames);
+
+    // Sintetiza `frames` frames no lugar de um chunk perdido
+    void conceal(int16_t *out, int32_t frames);
+
+    // Primeiro chunk real depois de conceal(): crossfade da continuação sintética
+    // para o áudio real, in-place. Sem perda pendente, não faz nada.
+    void blendInto(int16_t *samples, int32_t frames);
+
+    bool isConcealing() const { return concealing; }
+
+private:
+    int32_t findPeriod() const;
+    float gainAt(int64_t frame) const;
+
+    int32_t rate = 48000;
+    int32_t channels = 2;
+    int32_t historyCapacity = 0; // Em frames
+    int32_t historyFrames = 0;
+    std::vector<int16_t> history; // Linear: o frame mais novo fica no fim
+    std::vector<float> mono;      // Mixdown para a busca do período
+
+    bool concealing = false;
+    std::vector<int16_t> period; // Período congelado no início da perda
+    int32_t periodFrames = 0;
+    int32_t phase = 0;
+    int64_t concealedFrames = 0;
+};
@@ -0,0 +1,205 @@
+#include <jni.h>
+#include <climits>
+#include <mutex>
+
+#include "NativeLog.h"
+#include "CapturePipeline.h"
+
+// ✅ JNI do lado do sender (NativeCaptureEncoder.kt)
+//
+// O AudioRecord lê direto num ByteBuffer direto; write() acumula, mede, codifica e
+// empacota aqui, e o Kotlin só retira os pacotes SHB1 prontos para o socket.
+static CapturePipeline *g_capture = nullptr;
+static std::mutex g_feedbackMutex; // Relatórios chegam pela thread do socket: não ver o pipeline sendo trocado
+
+extern "C"
+{
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeCreate(
+        JNIEnv *env, jobject thiz, jint sampleRate, jint channelCount, jint chunkFrames,
+        jboolean useOpus, jint bitrate, jboolean adaptive)
+    {
+        std::lock_guard<std::mutex> lock(g_feedbackMutex);
+        delete g_capture;
+        g_capture = new CapturePipeline();
+        g_capture->setAdaptive(adaptive == JNI_TRUE);
+
+        std::unique_ptr<AudioEncoder> encoder;
+        if (useOpus)
+        {
+            encoder = createOpusEncoder(sampleRate, channelCount, bitrate);
+            if (!encoder)
+            {
+                LOGW("⚠️ Opus indisponível: enviando PCM16");
+            }
+        }
+
+        if (!g_capture->configure(sampleRate, channelCount, chunkFrames, std::move(encoder)))
+        {
+            delete g_capture;
+            g_capture = nullptr;
+            return JNI_FALSE;
+        }
+        return JNI_TRUE;
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeWrite(
+        JNIEnv *env, jobject thiz, jobject buffer, jint offset, jint length, jlong captureTimeUs)
+    {
+        if (g_capture == nullptr)
+            return 0;
+
+        auto *base = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (base == nullptr || offset < 0 || length < 0 || offset + static_cast<jlong>(length) > capacity)
+        {
+            LOGE("❌ Captura: ByteBuffer inválido (offset=%d, length=%d)", offset, length);
+            return 0;
+        }
+
+        // Long.MIN_VALUE no Kotlin = sem timestamp
+        int64_t timestamp = captureTimeUs == LLONG_MIN ? CapturePipeline::NO_TIMESTAMP : captureTimeUs;
+        int32_t frameBytes = static_cast<int32_t>(sizeof(int16_t)) * g_capture->getChannelCount();
+        return g_capture->write(reinterpret_cast<const int16_t *>(base + offset), length / frameBytes, timestamp);
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeFlush(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->flush();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeNextPacketSize(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        // Com controle adaptativo, no ritmo de envio do CongestionController
+        return g_capture->nextPacedPacketSize(PlayerClock::system().nowNanos() / 1000);
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeReadPacket(
+        JNIEnv *env, jobject thiz, jbyteArray out)
+    {
+        if (g_capture == nullptr)
+            return 0;
+
+        jsize capacity = env->GetArrayLength(out);
+        auto *bytes = static_cast<uint8_t *>(env->GetPrimitiveArrayCritical(out, nullptr));
+        if (bytes == nullptr)
+            return 0;
+        int32_t length = g_capture->readPacket(bytes, capacity);
+        env->ReleasePrimitiveArrayCritical(out, bytes, 0);
+        return length;
+    }
+
+    JNIEXPORT jfloat JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetPeak(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0.0f;
+        return g_capture->getPeak();
+    }
+
+    JNIEXPORT jfloat JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetRms(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0.0f;
+        return g_capture->getRms();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetCodec(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->getCodec();
+    }
+
+    JNIEXPORT jlong JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetDroppedPackets(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->getPacketsDropped();
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeSetSilenceDetection(
+        JNIEnv *env, jobject thiz, jboolean enabled)
+    {
+        if (g_capture != nullptr)
+        {
+            g_capture->setSilenceDetection(enabled == JNI_TRUE);
+        }
+    }
+
+    JNIEXPORT jlong JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetSilentPackets(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->getSilentPackets();
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeOnFeedback(
+        JNIEnv *env, jobject thiz, jint listenerId, jbyteArray report)
+    {
+        if (report == nullptr)
+            return JNI_FALSE;
+        uint8_t bytes[feedback::REPORT_BYTES];
+        if (env->GetArrayLength(report) < feedback::REPORT_BYTES)
+            return JNI_FALSE;
+        env->GetByteArrayRegion(report, 0, feedback::REPORT_BYTES, reinterpret_cast<jbyte *>(bytes));
+
+        std::lock_guard<std::mutex> lock(g_feedbackMutex);
+        if (g_capture == nullptr)
+            return JNI_FALSE;
+        bool accepted = g_capture->onFeedback(static_cast<uint32_t>(listenerId), bytes, feedback::REPORT_BYTES,
+                                              PlayerClock::system().nowNanos() / 1000000);
+        return accepted ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetChunkFrames(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->getChunkFrames();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeGetBitrate(
+        JNIEnv *env, jobject thiz)
+    {
+        if (g_capture == nullptr)
+            return 0;
+        return g_capture->getBitrate();
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_NativeCaptureEncoder_nativeDestroy(
+        JNIEnv *env, jobject thiz)
+    {
+        std::lock_guard<std::mutex> lock(g_feedbackMutex);
+        if (g_capture != nullptr)
+        {
+            delete g_capture;
+            g_capture = nullptr;
+        }
+    }
+}
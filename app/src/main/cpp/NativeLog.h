@@ -0,0 +1,49 @@
+#pragma once
+
+// ✅ Log nativo compartilhado entre o .so do Android e os alvos de host
+//
+// No Android vai para o logcat. No host vai para stderr; LOGI só aparece com
+// SHIBASYNC_LOG=info para não poluir testes e benchmarks.
+
+#define LOG_TAG "OboeNative"
+
+#if defined(__ANDROID__)
+#include <android/log.h>
+
+#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
+#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
+#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+#else
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace nativelog
+{
+    inline bool infoEnabled()
+    {
+        static const bool enabled = [] {
+            const char *level = std::getenv("SHIBASYNC_LOG");
+            return level != nullptr && std::strcmp(level, "info") == 0;
+        }();
+        return enabled;
+    }
+}
+
+#define SHIBA_HOST_LOG(level, ...)                    \
+    do                                                \
+    {                                                 \
+        std::fprintf(stderr, "%s %s: ", level, LOG_TAG); \
+        std::fprintf(stderr, __VA_ARGS__);            \
+        std::fputc('\n', stderr);                     \
+    } while (0)
+
+#define LOGI(...)                            \
+    do                                       \
+    {                                        \
+        if (nativelog::infoEnabled())        \
+            SHIBA_HOST_LOG("I", __VA_ARGS__); \
+    } while (0)
+#define LOGE(...) SHIBA_HOST_LOG("E", __VA_ARGS__)
+#define LOGW(...) SHIBA_HOST_LOG("W", __VA_ARGS__)
+#endif
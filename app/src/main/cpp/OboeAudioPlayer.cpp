@@ -1,412 +1,400 @@
 #include <jni.h>
+#include <android/api-level.h>
 #include <oboe/Oboe.h>
-#include <android/log.h>
-#include <queue>
-#include <mutex>
+#include <array>
 #include <atomic>
-#include <condition_variable>
 #include <cstring>
-#include <time.h>
 #include <algorithm>
+#include <mutex>
+#include <vector>
+
+#include "CallbackBudget.h"
+#include "DeviceBufferTuner.h"
+#include "NativeLog.h"
+#include "PacketFormat.h"
+#include "SourceMixer.h"
+#include "StreamRecovery.h"
+#include "TraceRecorder.h"
+#include "UdpReceiver.h"
+#include "WakeupMeter.h"
+
+// ✅ Visão do oboe::AudioStream pela interface neutra do PlayerCore
+class OboeStreamView : public AudioOutputStream
+{
+public:
+    explicit OboeStreamView(oboe::AudioStream *stream) : stream(stream) {}
+
+    int32_t getSampleRate() const override { return stream->getSampleRate(); }
+    int32_t getChannelCount() const override { return stream->getChannelCount(); }
+    OutputFormat getFormat() const override
+    {
+        return stream->getFormat() == oboe::AudioFormat::Float ? OutputFormat::Float : OutputFormat::I16;
+    }
+    int32_t getFramesPerBurst() const override { return stream->getFramesPerBurst(); }
+    int32_t getBufferSizeInFrames() const override { return stream->getBufferSizeInFrames(); }
+    int64_t getFramesWritten() const override { return stream->getFramesWritten(); }
+
+    bool getTimestamp(int64_t &framePosition, int64_t &timeNanos) const override
+    {
+        auto result = stream->getTimestamp(CLOCK_MONOTONIC);
+        if (!result)
+            return false;
+        framePosition = result.value().position;
+        timeNanos = result.value().timestamp;
+        return true;
+    }
 
-#define LOG_TAG "OboeNative"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
-#define LOGW(...) __android_log_print(ANDROID_LOG_WARN, LOG_TAG, __VA_ARGS__)
+private:
+    oboe::AudioStream *stream;
+};
 
+// ✅ Casca Android: stream Oboe + JNI. A lógica de buffer fica no PlayerCore de cada
+// sender; o SourceMixer soma os senders no callback.
 class OboeAudioPlayer : public oboe::AudioStreamDataCallback,
                         public oboe::AudioStreamErrorCallback
 {
 private:
+    // ✅ O stream é trocado pela thread de recuperação: todo acesso fora do
+    // callback de áudio passa por streamMutex (o callback recebe o próprio stream)
     std::shared_ptr<oboe::AudioStream> stream;
-    std::mutex queueMutex;
-    std::condition_variable bufferCondition;
-
-    // ✅ CORREÇÃO: Armazenar chunks como frames, não samples
-    struct AudioChunk
-    {
-        std::vector<int16_t> data;
-        int32_t frameCount; // Número de frames (não samples!)
-    };
-
-    std::queue<AudioChunk> audioQueue;
-    AudioChunk currentChunk;
-    int32_t currentFrameIndex = 0; // ✅ Mudado para frame index
-
-    std::atomic<int32_t> underrunCount{0};
-    std::atomic<int32_t> bufferSize{0};
-    std::atomic<bool> isPlaying{false};
-    std::atomic<bool> isPrebuffering{true};
-    std::atomic<int32_t> totalCallbacks{0};
-    std::atomic<int32_t> prebufferingCallbacks{0}; // ✅ Contador de callbacks em prebuffering
-
-    // Rastreamento
-    std::atomic<int64_t> totalFramesWritten{0};
-    std::atomic<int64_t> startTimeMs{0};
-    std::atomic<int32_t> chunksConsumed{0};
-    std::atomic<int32_t> chunksAdded{0};
-
-    // ✅ Timing simples para debug
-    std::atomic<int64_t> lastChunkTimeMs{0};
-    std::atomic<float> smoothedChunkInterval{20.0f};
-
-    // ✅ Controle de volume
-    std::atomic<float> volumeLevel{1.0f}; // 0.0 a 1.0
+    std::mutex streamMutex;
+    bool streamStarted = false;       // start() pedido e não pausado/parado (streamMutex)
+    bool pinFastCores = true;         // Afinidade do callback nos núcleos rápidos (streamMutex)
+    bool performanceHint = true;      // Sessão ADPF do Oboe (Android 13+) (streamMutex)
+    bool powerSaving = false;         // Modo de economia: stream PowerSaving (streamMutex)
+    std::atomic<bool> configured{false}; // Fontes com buffers alocados: podem receber dados
+
+    SourceMixer mixer; // Um PlayerCore + DecodeWorker por sender
+    DeviceBufferTuner bufferTuner; // Estado do callback; reset com streamMutex e o callback parado
+    CallbackBudget callbackBudget; // Idem: tempo do callback contra o burst e afinidade
+    StreamRecovery recovery{[this] { return reopenStream(); }};
+    UdpReceiver receiver{mixer}; // Chunks por UDP direto no mixer (opcional)
+    TraceRecorder tracer;        // Chegadas e callbacks para o trace-replay (opcional)
+    WakeupMeter ingestWakeups;   // Entregas pela JNI (thread do processador de chunks)
+    std::vector<uint8_t> arrayScratch; // Cópia do ByteArray do addAudioData (arrayScratchMutex)
+    std::mutex arrayScratchMutex;
 
     // Configuração
     int32_t configuredSampleRate = 48000;
     int32_t configuredChannelCount = 2;
 
-    // ✅ Buffer settings - BASEADO EM TEMPO, NÃO EM QUANTIDADE DE CHUNKS
-    // Porque chunks podem ser de 10ms (1920 bytes) ou 20ms (3840 bytes)
-    static constexpr int MAX_QUEUE_SIZE = 500;           // Aumentar de 200 para 500
-    static constexpr int32_t TARGET_PREBUFFER_MS = 1000; // Aumentar de 700ms para 1000ms
-    static constexpr int32_t MIN_BUFFER_MS = 700;        // Aumentar de 500ms para 700ms
-    int32_t estimatedChunkMs = 20;                       // Assumir 20ms inicialmente, será ajustado
-
 public:
+    // ✅ Modo de economia (tela apagada, horas tocando): stream PowerSaving compartilhado
+    // com callbacks de POWER_SAVING_CALLBACK_MS em vez de poucos ms, buffer do
+    // dispositivo profundo e a rede lida em lotes de POWER_SAVING_INGEST_MS
+    static constexpr int32_t POWER_SAVING_CALLBACK_MS = 40;
+    static constexpr int32_t POWER_SAVING_INGEST_MS = 100;
+
     OboeAudioPlayer() = default;
     ~OboeAudioPlayer()
     {
+        receiver.stop();
+        tracer.stop();
+        recovery.stop();
+        mixer.stop();
+        std::lock_guard<std::mutex> lock(streamMutex);
         if (stream)
         {
             stream->close();
         }
     }
 
-    // ✅ CALLBACK PRINCIPAL CORRIGIDO
+    // ✅ CALLBACK PRINCIPAL - delega ao mixer (lock-free)
     oboe::DataCallbackResult onAudioReady(
         oboe::AudioStream *audioStream,
         void *audioData,
         int32_t numFrames) override
     {
-        auto *outputData = static_cast<int16_t *>(audioData);
-        int32_t channelCount = audioStream->getChannelCount();
-        int32_t framesWritten = 0;
-
-        totalCallbacks++;
-
-        // Rastrear timing - INICIALIZAR APENAS QUANDO COMEÇAR A REPRODUZIR
-        if (startTimeMs == 0 && !isPrebuffering)
-        {
-            startTimeMs = getCurrentTimeMs();
-        }
-
-        std::unique_lock<std::mutex> lock(queueMutex);
+        int64_t beginNanos = callbackBudget.begin();
+        tracer.recordCallback(numFrames);
+        OboeStreamView view(audioStream);
+        mixer.render(view, audioData, numFrames);
 
-        // ✅ PREBUFFERING BASEADO EM TEMPO (suporta chunks de 10ms e 20ms)
-        if (isPrebuffering.load())
+        // ✅ LATÊNCIA: cresce o buffer do dispositivo só quando houve xrun tocando
+        if (bufferTuner.tick(numFrames))
         {
-            prebufferingCallbacks++;
-
-            // ⚠️ TIMEOUT: Se ficar mais de 10 segundos prebuffering, desistir
-            // (300 callbacks × 10ms callback = 3000ms, mas com margem)
-            if (prebufferingCallbacks > 1000 && audioQueue.size() == 0)
-            {
-                LOGE("💀 TIMEOUT: Prebuffering há %d callbacks sem chunks! Sender pode ter parado.",
-                     prebufferingCallbacks.load());
-                LOGE("   Continuando com buffer vazio (silêncio)...");
-                isPrebuffering = false;
-                prebufferingCallbacks = 0;
-                // Continuar reproduzindo silêncio em vez de travar
-            }
-
-            // Calcular tempo total do buffer atual
-            int32_t totalBufferMs = audioQueue.size() * estimatedChunkMs;
-
-            if (totalBufferMs < TARGET_PREBUFFER_MS)
+            auto xruns = audioStream->getXRunCount();
+            int32_t size = xruns ? bufferTuner.update(xruns.value(), mixer.isAudible()) : 0;
+            if (size > 0)
             {
-                std::fill_n(outputData, numFrames * channelCount, int16_t(0));
-
-                if (totalCallbacks % 50 == 0)
-                {
-                    LOGI("⏳ Prebuffering... %zu chunks (~%dms / %dms target) [callbacks: %d]",
-                         audioQueue.size(), totalBufferMs, TARGET_PREBUFFER_MS, prebufferingCallbacks.load());
-                }
-                return oboe::DataCallbackResult::Continue;
-            }
-            else
-            {
-                isPrebuffering = false;
-                prebufferingCallbacks = 0;
-                // ✅ RESETAR CONTADORES PARA CÁLCULO CORRETO DO DRIFT
-                startTimeMs = getCurrentTimeMs();
-                totalFramesWritten = 0;
-                LOGI("✅ Prebuffering completo! %zu chunks (~%dms buffer)",
-                     audioQueue.size(), totalBufferMs);
+                auto actual = audioStream->setBufferSizeInFrames(size);
+                if (actual)
+                    bufferTuner.setActual(actual.value());
             }
         }
+        callbackBudget.end(beginNanos, numFrames, audioStream->getSampleRate());
+        return oboe::DataCallbackResult::Continue;
+    }
 
-        // ✅ PROCESSAR FRAMES - SIMPLES E DIRETO
-        while (framesWritten < numFrames)
-        {
-            // Se chunk atual vazio, pegar próximo
-            if (currentFrameIndex >= currentChunk.frameCount)
-            {
-                if (!audioQueue.empty())
-                {
-                    currentChunk = std::move(audioQueue.front());
-                    audioQueue.pop();
-                    currentFrameIndex = 0;
-                    chunksConsumed++;
-                    bufferSize = audioQueue.size();
-                }
-                else
-                {
-                    // Buffer vazio - silêncio
-                    int32_t framesToFill = numFrames - framesWritten;
-                    std::fill_n(outputData + (framesWritten * channelCount),
-                                framesToFill * channelCount,
-                                int16_t(0));
-
-                    underrunCount++;
-                    framesWritten = numFrames;
-
-                    // ✅ VOLTAR AO PREBUFFERING de forma mais conservadora
-                    int32_t currentBufferMs = audioQueue.size() * estimatedChunkMs;
-
-                    // Se buffer completamente vazio, rebuffer após 10 underruns consecutivos (não 5)
-                    if (audioQueue.size() == 0 && underrunCount % 10 == 0)
-                    {
-                        isPrebuffering = true;
-                        prebufferingCallbacks = 0;
-                        LOGW("⚠️ Buffer vazio! Prebuffering... (UR: %d)", underrunCount.load());
-                    }
-                    // Se buffer baixo mas não vazio, dar muito mais chances antes de rebuffer
-                    else if (currentBufferMs < MIN_BUFFER_MS && underrunCount % 50 == 0)
-                    {
-                        isPrebuffering = true;
-                        prebufferingCallbacks = 0;
-                        LOGW("⚠️ Buffer crítico! %dms < %dms. Prebuffering... (UR: %d)",
-                             currentBufferMs, MIN_BUFFER_MS, underrunCount.load());
-                    }
-                    else if (underrunCount % 100 == 0)
-                    {
-                        LOGW("⚠️ Underrun #%d | Queue: %zu chunks (~%dms)",
-                             underrunCount.load(), audioQueue.size(), currentBufferMs);
-                    }
-
-                    break;
-                }
-            }
-
-            // ✅ COPIAR FRAMES SIMPLES - SEM MANIPULAÇÃO DE TAXA
-            int32_t framesToCopy = std::min(
-                numFrames - framesWritten,
-                currentChunk.frameCount - currentFrameIndex);
-
-            int32_t samplesToCopy = framesToCopy * channelCount;
-            int32_t sourceOffset = currentFrameIndex * channelCount;
-            int32_t destOffset = framesWritten * channelCount;
-
-            // Verificar limites rigorosamente
-            if (sourceOffset >= 0 &&
-                samplesToCopy > 0 &&
-                sourceOffset + samplesToCopy <= (int32_t)currentChunk.data.size() &&
-                destOffset + samplesToCopy <= numFrames * channelCount)
-            {
-                // ✅ COPIAR E APLICAR VOLUME
-                float currentVolume = volumeLevel.load();
-                const int16_t *sourceData = currentChunk.data.data() + sourceOffset;
-                int16_t *destData = outputData + destOffset;
+    // ⚠️ Thread interna do Oboe: não reabrir aqui (e addAudioData continua escrevendo
+    // no ring). A thread de recuperação reabre com retry/backoff, sem perder o buffer.
+    void onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) override
+    {
+        LOGE("Stream error: %s", oboe::convertToText(error));
+        recovery.request();
+    }
 
-                if (currentVolume >= 0.99f)
-                {
-                    // Volume máximo - copiar direto (otimização)
-                    std::copy_n(sourceData, samplesToCopy, destData);
-                }
-                else if (currentVolume <= 0.01f)
-                {
-                    // Volume mínimo - silêncio
-                    std::fill_n(destData, samplesToCopy, int16_t(0));
-                }
-                else
-                {
-                    // Volume intermediário - aplicar ganho
-                    for (int32_t i = 0; i < samplesToCopy; i++)
-                    {
-                        destData[i] = static_cast<int16_t>(sourceData[i] * currentVolume);
-                    }
-                }
-
-                currentFrameIndex += framesToCopy;
-                framesWritten += framesToCopy;
-            }
-            else
-            {
-                LOGE("❌ Bounds error! src=%d, samples=%d, chunkSize=%zu, dest=%d, maxDest=%d",
-                     sourceOffset, samplesToCopy, currentChunk.data.size(),
-                     destOffset, numFrames * channelCount);
-                currentFrameIndex = currentChunk.frameCount; // Forçar próximo chunk
-            }
+    // ✅ THREAD DE RECUPERAÇÃO: stream novo na rota atual, mesmo buffer e mesma posição
+    // Também chamado pela troca de modo (setPowerSaving), com o stream antigo tocando.
+    bool reopenStream()
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (stream)
+        {
+            // Depois de um erro o Oboe já fechou o stream; na troca de modo ele ainda
+            // toca e precisa parar antes (o callback não pode rodar durante o close)
+            oboe::StreamState state = stream->getState();
+            if (state != oboe::StreamState::Closed && state != oboe::StreamState::Disconnected)
+                stream->stop();
+            stream->close();
+            stream.reset();
         }
 
-        // ✅ CONTAR FRAMES APENAS QUANDO NÃO ESTÁ EM PREBUFFERING
-        if (!isPrebuffering.load())
+        // ✅ MESMA NEGOCIAÇÃO: o dispositivo novo pode ter outra taxa/formato
+        oboe::Result result = openNegotiatedStream();
+        if (result != oboe::Result::OK)
         {
-            totalFramesWritten += numFrames;
+            LOGE("❌ Falha ao recriar: %s", oboe::convertToText(result));
+            return false;
         }
+        applyBufferSize();
+        mixer.notifyOutputRestarted();
+        tracer.recordRestart(stream->getSampleRate(), stream->getFramesPerBurst());
 
-        // ✅ Debug simples a cada 100 callbacks
-        if (totalCallbacks % 100 == 0 && startTimeMs > 0 && !isPrebuffering.load())
+        if (streamStarted)
         {
-            int64_t elapsedMs = getCurrentTimeMs() - startTimeMs;
-            if (elapsedMs > 1000)
+            result = stream->start();
+            if (result != oboe::Result::OK)
             {
-                float actualRate = (totalFramesWritten.load() * 1000.0f) / elapsedMs;
-                float expectedRate = audioStream->getSampleRate();
-                float driftPercent = ((actualRate - expectedRate) / expectedRate) * 100.0f;
-                float currentInterval = smoothedChunkInterval.load();
-
-                LOGI("📊 Playback: %.0f/%.0f Hz (drift: %.1f%%) | Interval: %.1fms | Queue: %zu | UR: %d",
-                     actualRate, expectedRate, driftPercent, currentInterval,
-                     audioQueue.size(), underrunCount.load());
+                LOGE("❌ Stream recriado não iniciou: %s", oboe::convertToText(result));
+                stream->close();
+                stream.reset();
+                return false;
             }
         }
 
-        return oboe::DataCallbackResult::Continue;
+        LOGI("✅ Stream recriado: %dHz, %d ch, %s (buffers mantidos: %d fontes)", stream->getSampleRate(),
+             stream->getChannelCount(), oboe::convertToText(stream->getFormat()), mixer.getSourceCount());
+        return true;
     }
-    void onErrorAfterClose(oboe::AudioStream *audioStream, oboe::Result error) override
+
+    // ✅ ADICIONAR DADOS (ByteArray) - uma cópia para o scratch do player
+    // GetByteArrayRegion copia antes do withSource: nada de seção crítica da JNI
+    // segurando o GC enquanto espera o mutex do mixer. Quem quer zero cópia usa o
+    // ByteBuffer direto (addDirectData).
+    bool addAudioData(JNIEnv *env, int32_t sourceId, jbyteArray audioData, jint length)
     {
-        LOGE("Stream error: %s", oboe::convertToText(error));
+        if (!configured.load() || !mixer.isPlaying())
+            return false;
+        ingestWakeups.tick(PlayerClock::system().nowNanos());
 
-        if (isPlaying)
+        if (length < 0 || length > env->GetArrayLength(audioData))
         {
-            LOGI("Tentando recriar stream...");
+            LOGW("⚠️ Tamanho inválido: %d bytes", length);
+            return false;
+        }
 
-            // ✅ USAR MESMA CONFIGURAÇÃO
-            oboe::AudioStreamBuilder builder;
-            configureBuilder(builder, configuredSampleRate, configuredChannelCount);
+        std::lock_guard<std::mutex> lock(arrayScratchMutex);
+        if (arrayScratch.size() < static_cast<size_t>(length))
+            arrayScratch.resize(length);
+        env->GetByteArrayRegion(audioData, 0, length, reinterpret_cast<jbyte *>(arrayScratch.data()));
+        if (env->ExceptionCheck())
+            return false;
 
-            oboe::Result result = builder.openStream(stream);
-            if (result == oboe::Result::OK)
-            {
-                stream->start();
-                LOGI("✅ Stream recriado");
-            }
-            else
-            {
-                LOGE("❌ Falha ao recriar: %s", oboe::convertToText(result));
-            }
-        }
+        const uint8_t *bytes = arrayScratch.data();
+        if (sourceId == SourceMixer::DEFAULT_SOURCE)
+            tracer.recordPacket(bytes, length);
+        bool accepted = false;
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                         { accepted = source.write(bytes, length); });
+        return accepted;
     }
 
-    // ✅ ADICIONAR DADOS CORRIGIDO
-    bool addAudioData(JNIEnv *env, jbyteArray audioData, jint length)
+    // ✅ ADICIONAR DADOS (ByteBuffer direto) - zero alocação, zero pinning
+    bool addDirectData(JNIEnv *env, int32_t sourceId, jobject buffer, jint offset, jint length)
     {
-        if (!stream || !isPlaying)
+        if (!configured.load() || !mixer.isPlaying())
             return false;
+        ingestWakeups.tick(PlayerClock::system().nowNanos());
 
-        // Validar tamanho
-        if (length % (2 * configuredChannelCount) != 0)
+        auto *base = static_cast<const uint8_t *>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (base == nullptr || capacity < 0)
         {
-            LOGW("⚠️ Tamanho inválido: %d bytes (não é múltiplo de %d)",
-                 length, 2 * configuredChannelCount);
+            LOGW("⚠️ ByteBuffer não é direto");
+            return false;
+        }
+        if (offset < 0 || length < 0 || static_cast<jlong>(offset) + length > capacity)
+        {
+            LOGW("⚠️ Faixa inválida: offset=%d, length=%d, capacity=%lld",
+                 offset, length, static_cast<long long>(capacity));
             return false;
         }
 
-        jbyte *bytes = env->GetByteArrayElements(audioData, nullptr);
-
-        // ✅ CALCULAR FRAMES CORRETAMENTE
-        int32_t numSamples = length / 2;                         // 2 bytes por sample
-        int32_t numFrames = numSamples / configuredChannelCount; // ✅ IMPORTANTE!
-
-        AudioChunk chunk;
-        chunk.data.resize(numSamples);
-        chunk.frameCount = numFrames;
-
-        // Copiar dados como int16_t (Little Endian)
-        memcpy(chunk.data.data(), bytes, length);
+        if (sourceId == SourceMixer::DEFAULT_SOURCE)
+            tracer.recordPacket(base + offset, length);
+        bool accepted = false;
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                         { accepted = source.write(base + offset, length); });
+        return accepted;
+    }
 
-        env->ReleaseByteArrayElements(audioData, bytes, JNI_ABORT);
+    // ✅ ADICIONAR PACOTE CODIFICADO (SHB1 + Opus, ByteBuffer direto)
+    // Só copia para a fila do DecodeWorker; a decodificação roda na thread dele.
+    bool addEncodedData(JNIEnv *env, int32_t sourceId, jobject buffer, jint offset, jint length)
+    {
+        if (!configured.load() || !mixer.isPlaying())
+            return false;
+        ingestWakeups.tick(PlayerClock::system().nowNanos());
 
-        // Debug ocasional
-        if (chunksAdded % 100 == 0)
+        auto *base = static_cast<const uint8_t *>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (base == nullptr || capacity < 0)
         {
-            LOGI("� Chunk %d: %d frames (%d samples, %d bytes)",
-                 chunksAdded.load(), numFrames, numSamples, length);
-
-            // Verificar primeiros samples
-            if (chunk.data.size() >= 4)
-            {
-                LOGI("   Samples: [%d, %d, %d, %d]",
-                     chunk.data[0], chunk.data[1], chunk.data[2], chunk.data[3]);
-            }
+            LOGW("⚠️ ByteBuffer não é direto");
+            return false;
+        }
+        if (offset < 0 || length < 0 || static_cast<jlong>(offset) + length > capacity)
+        {
+            LOGW("⚠️ Faixa inválida: offset=%d, length=%d, capacity=%lld",
+                 offset, length, static_cast<long long>(capacity));
+            return false;
         }
 
-        // ✅ TIMING E AUTO-DETECÇÃO DO TAMANHO DO CHUNK
-        int64_t currentTime = getCurrentTimeMs();
+        if (sourceId == SourceMixer::DEFAULT_SOURCE)
+            tracer.recordPacket(base + offset, length);
+        bool accepted = false;
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                         { accepted = source.submitEncoded(base + offset, length); });
+        return accepted;
+    }
 
-        // Estimar duração do chunk baseado no número de frames
-        // 48000 Hz: 480 frames = 10ms, 960 frames = 20ms
-        int32_t chunkDurationMs = (numFrames * 1000) / configuredSampleRate;
+    // ✅ ADICIONAR LOTE (ByteBuffer direto com vários pacotes + offsets)
+    // Uma travessia JNI, uma trava do mixer e uma publicação no ring para até
+    // MAX_BATCH_CHUNKS chunks do mesmo sender: é o que esvazia o acúmulo depois de
+    // uma parada da rede sem disputar CPU com o callback. O pacote i vai de
+    // offsets[i] a offsets[i + 1]; PCM e Opus seguem pelo codec do primeiro.
+    static constexpr int32_t MAX_BATCH_CHUNKS = 64;
 
-        // Atualizar estimativa (média móvel)
-        if (chunksAdded > 0 && chunkDurationMs > 5 && chunkDurationMs < 50)
-        {
-            int32_t current = estimatedChunkMs;
-            estimatedChunkMs = (current * 9 + chunkDurationMs) / 10; // Média móvel suave
+    int32_t addBatchData(JNIEnv *env, int32_t sourceId, jobject buffer, jintArray offsetsArray, jint count)
+    {
+        if (!configured.load() || !mixer.isPlaying())
+            return 0;
+        ingestWakeups.tick(PlayerClock::system().nowNanos());
 
-            if (chunksAdded % 100 == 0)
-            {
-                LOGI("📦 Chunk detectado: %d frames = %dms (média: %dms)",
-                     numFrames, chunkDurationMs, estimatedChunkMs);
-            }
+        auto *base = static_cast<const uint8_t *>(env->GetDirectBufferAddress(buffer));
+        jlong capacity = env->GetDirectBufferCapacity(buffer);
+        if (base == nullptr || capacity < 0)
+        {
+            LOGW("⚠️ ByteBuffer não é direto");
+            return 0;
+        }
+        if (count <= 0 || count > MAX_BATCH_CHUNKS || env->GetArrayLength(offsetsArray) < count + 1)
+        {
+            LOGW("⚠️ Lote inválido: %d chunks", count);
+            return 0;
         }
 
-        if (lastChunkTimeMs > 0)
+        std::array<jint, MAX_BATCH_CHUNKS + 1> offsets{};
+        env->GetIntArrayRegion(offsetsArray, 0, count + 1, offsets.data());
+        for (int32_t i = 0; i < count; i++)
         {
-            int32_t interval = (int32_t)(currentTime - lastChunkTimeMs);
-            if (interval > 0 && interval < 1000)
+            if (offsets[i] < 0 || offsets[i] > offsets[i + 1] || offsets[i + 1] > capacity)
             {
-                // Suavização simples
-                float current = smoothedChunkInterval.load();
-                float newInterval = (current * 0.9f) + (interval * 0.1f);
-                smoothedChunkInterval = newInterval;
+                LOGW("⚠️ Faixa inválida no lote: chunk %d de %d a %d (capacity=%lld)",
+                     i, offsets[i], offsets[i + 1], static_cast<long long>(capacity));
+                return 0;
             }
         }
-        lastChunkTimeMs = currentTime;
 
-        // Adicionar à fila
+        if (sourceId == SourceMixer::DEFAULT_SOURCE)
         {
-            std::unique_lock<std::mutex> lock(queueMutex);
+            for (int32_t i = 0; i < count; i++)
+                tracer.recordPacket(base + offsets[i], offsets[i + 1] - offsets[i]);
+        }
+        packet::Header first;
+        bool encoded = packet::parse(base + offsets[0], offsets[1] - offsets[0], first) &&
+                       first.codec == packet::CODEC_OPUS;
+        int32_t accepted = 0;
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                         { accepted = encoded ? source.submitEncodedBatch(base, offsets.data(), count)
+                                              : source.writeBatch(base, offsets.data(), count); });
+        return accepted;
+    }
 
-            // Limitar tamanho da fila
-            while (audioQueue.size() >= MAX_QUEUE_SIZE)
-            {
-                audioQueue.pop();
-                LOGW("⚠️ Fila cheia, descartando chunk antigo");
-            }
+    bool isEncodedSupported()
+    {
+        bool available = false;
+        mixer.withSource(SourceMixer::DEFAULT_SOURCE, [&](SourceMixer::Source &source)
+                         { available = source.decodeWorker.isAvailable(); });
+        return available;
+    }
 
-            audioQueue.push(std::move(chunk));
-            chunksAdded++;
-            bufferSize = audioQueue.size();
-        }
+    // ✅ SENDERS: cada um com o próprio buffer/jitter buffer/ganho no mixer
+    bool addSource(int32_t sourceId) { return configured.load() && mixer.addSource(sourceId); }
+    bool removeSource(int32_t sourceId) { return mixer.removeSource(sourceId); }
+    bool setSourceGain(int32_t sourceId, float gain) { return mixer.setSourceGain(sourceId, gain); }
+    int32_t getSourceCount() const { return mixer.getSourceCount(); }
+
+    // ✅ RECEPÇÃO UDP: datagramas SHB1 vão da thread do socket direto para o mixer,
+    // sem passar pela JVM. Devolve a porta (0 = qualquer livre) ou -1.
+    int32_t startReceiver(int32_t port)
+    {
+        if (!configured.load())
+            return -1;
+        return receiver.start(port);
+    }
+
+    void stopReceiver() { receiver.stop(); }
 
-        bufferCondition.notify_one();
+    // ✅ TRACE: instantes e tamanhos das chegadas (fonte padrão) e dos callbacks num
+    // arquivo .shtr, para reproduzir no host com o trace-replay. Sem o áudio.
+    bool startTrace(const char *path)
+    {
+        trace::Header header;
+        header.sampleRate = configuredSampleRate;
+        header.channelCount = configuredChannelCount;
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            header.deviceSampleRate = stream ? stream->getSampleRate() : configuredSampleRate;
+            header.framesPerBurst = stream ? stream->getFramesPerBurst() : 0;
+        }
+        if (!tracer.start(path, header))
+            return false;
+        receiver.setTraceRecorder(&tracer);
         return true;
     }
 
+    void stopTrace()
+    {
+        receiver.setTraceRecorder(nullptr);
+        tracer.stop();
+    }
+
     // ✅ CRIAR STREAM MELHORADO
-    bool createStream(int32_t sampleRate, int32_t channelCount)
+    // maxBufferMs: teto do buffer de cada sender em duração (memória exata do ring)
+    bool createStream(int32_t sampleRate, int32_t channelCount, int32_t maxBufferMs)
     {
+        // O ring é realocado abaixo: nenhum callback antigo pode estar lendo dele,
+        // nem a recuperação reabrindo um stream no meio
+        recovery.stop();
+        configured = false;
+
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (stream)
+        {
+            stream->stop();
+            stream->close();
+            stream.reset();
+        }
+
         configuredSampleRate = sampleRate;
         configuredChannelCount = channelCount;
 
-        oboe::AudioStreamBuilder builder;
-
-        builder.setDirection(oboe::Direction::Output)
-            ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
-            ->setSharingMode(oboe::SharingMode::Exclusive)
-            ->setFormat(oboe::AudioFormat::I16)
-            ->setSampleRate(sampleRate)
-            ->setChannelCount(channelCount)
-            ->setUsage(oboe::Usage::Media)
-            ->setContentType(oboe::ContentType::Music)
-            ->setDataCallback(this)
-            ->setErrorCallback(this);
+        // ✅ Alocar buffers UMA VEZ, fora da thread de áudio (recomeça só com o sender padrão)
+        mixer.configure(sampleRate, channelCount, maxBufferMs);
 
-        oboe::Result result = builder.openStream(stream);
+        oboe::Result result = openNegotiatedStream();
 
         if (result != oboe::Result::OK)
         {
@@ -414,75 +402,117 @@ public:
             return false;
         }
 
-        // Verificar configuração real
         int32_t actualSR = stream->getSampleRate();
-        int32_t actualCC = stream->getChannelCount();
-        oboe::AudioFormat actualFormat = stream->getFormat();
         int32_t framesPerBurst = stream->getFramesPerBurst();
 
         LOGI("✅ Stream criado:");
-        LOGI("   Config: %dHz, %d ch, I16", sampleRate, channelCount);
-        LOGI("   Actual: %dHz, %d ch, %s", actualSR, actualCC,
-             oboe::convertToText(actualFormat));
+        LOGI("   Fonte: %dHz, %d ch, I16", sampleRate, channelCount);
+        LOGI("   Dispositivo: %dHz, %d ch, %s", actualSR, stream->getChannelCount(),
+             oboe::convertToText(stream->getFormat()));
         LOGI("   Frames/burst: %d", framesPerBurst);
         LOGI("   Buffer capacity: %d frames", stream->getBufferCapacityInFrames());
+        LOGI("   Ring: %dms max", std::clamp(maxBufferMs, PlayerCore::MIN_MAX_BUFFER_MS, PlayerCore::MAX_MAX_BUFFER_MS));
 
-        // Alertas
-        if (actualSR != sampleRate)
-        {
-            LOGW("⚠️ Sample rate: requested %d, got %d", sampleRate, actualSR);
-        }
-        if (actualCC != channelCount)
-        {
-            LOGW("⚠️ Channels: requested %d, got %d", channelCount, actualCC);
-        }
+        applyBufferSize();
 
-        // ✅ Configurar buffer MÁXIMO para reduzir glitches
-        // Usar 90% da capacidade para dar mais margem contra jitter
-        int32_t targetBufferSize = (stream->getBufferCapacityInFrames() * 9) / 10;
-        stream->setBufferSizeInFrames(targetBufferSize);
-        LOGI("   Buffer size configurado: %d frames (%.1fms)",
-             targetBufferSize, (targetBufferSize * 1000.0f) / actualSR);
+        configured = true;
+        recovery.start();
+        return true;
+    }
 
-        // Reset
-        totalFramesWritten = 0;
-        chunksConsumed = 0;
-        chunksAdded = 0;
-        startTimeMs = 0;
-        underrunCount = 0;
-        currentFrameIndex = 0;
-        currentChunk.frameCount = 0;
-        currentChunk.data.clear();
+    // ✅ Buffer do dispositivo pequeno (2 bursts) e ajustado pelo DeviceBufferTuner no
+    // callback; o jitter da rede fica por conta do buffer do PlayerCore. Sem contagem
+    // de xruns, 90% da capacidade como antes (com streamMutex, callback parado)
+    void applyBufferSize()
+    {
+        int32_t framesPerBurst = stream->getFramesPerBurst();
+        // Callback fixo maior que o burst (economia): o player repõe de callback em callback
+        mixer.setFramesPerBurst(std::max(framesPerBurst, stream->getFramesPerCallback()));
+        // Economia: buffer profundo fixo; o ajuste por xrun encolheria para 2 bursts
+        bool xrunsSupported = static_cast<bool>(stream->getXRunCount()) && !powerSaving;
+        bufferTuner.reset(framesPerBurst, stream->getBufferCapacityInFrames(), stream->getSampleRate(),
+                          xrunsSupported);
+
+        auto actual = stream->setBufferSizeInFrames(bufferTuner.getBufferSize());
+        if (actual)
+            bufferTuner.setActual(actual.value());
+        int32_t size = bufferTuner.getBufferSize();
+        LOGI("   Buffer size configurado: %d frames (%.1fms, %s)", size,
+             (size * 1000.0f) / stream->getSampleRate(), xrunsSupported ? "ajuste por xrun" : "fixo");
+    }
 
-        // ✅ Reset timing e estimativa de chunk
-        lastChunkTimeMs = 0;
-        smoothedChunkInterval = 20.0f;
-        estimatedChunkMs = 20; // Assumir 20ms inicialmente, será ajustado automaticamente
+    // ✅ NEGOCIAÇÃO DO FORMATO DE SAÍDA
+    // Taxa e formato ficam a cargo do dispositivo (o que o caminho nativo prefere) e
+    // a conversão do Oboe/AAudio fica desligada: a conversão de taxa (sinc), o
+    // upmix/downmix e o PCM16 -> float são feitos no PlayerCore/mixer, uma vez só.
+    // Formato que não sabemos escrever (I24/I32): reabrir pedindo float.
+    oboe::Result openNegotiatedStream()
+    {
+        oboe::AudioStreamBuilder builder;
+        configureBuilder(builder, oboe::AudioFormat::Unspecified);
+        oboe::Result result = builder.openStream(stream);
+        if (result != oboe::Result::OK)
+            return result;
 
-        return true;
+        oboe::AudioFormat format = stream->getFormat();
+        if (format != oboe::AudioFormat::I16 && format != oboe::AudioFormat::Float)
+        {
+            LOGW("⚠️ Formato nativo %s, reabrindo em float", oboe::convertToText(format));
+            stream->close();
+            stream.reset();
+            configureBuilder(builder, oboe::AudioFormat::Float);
+            result = builder.openStream(stream);
+            if (result != oboe::Result::OK)
+                return result;
+        }
+
+        // Só aqui: o callback deste stream ainda não começou (thread nova: fixar de novo)
+        mixer.setOutputSampleRate(stream->getSampleRate());
+        callbackBudget.reset(pinFastCores && !powerSaving ? CallbackBudget::fastCoreMask() : 0);
+        if (stream->getChannelCount() != configuredChannelCount)
+        {
+            LOGI("🔀 Canais: fonte %d -> dispositivo %d", configuredChannelCount, stream->getChannelCount());
+        }
+        return oboe::Result::OK;
     }
-    // ✅ CONFIGURAÇÃO CONSISTENTE
-    void configureBuilder(oboe::AudioStreamBuilder &builder, int32_t sampleRate, int32_t channelCount)
+
+    void configureBuilder(oboe::AudioStreamBuilder &builder, oboe::AudioFormat format)
     {
         builder.setDirection(oboe::Direction::Output)
             ->setPerformanceMode(oboe::PerformanceMode::LowLatency)
-            ->setSharingMode(oboe::SharingMode::Exclusive)
-            ->setFormat(oboe::AudioFormat::I16) // ✅ CORRIGIDO: ERA Float, AGORA É I16!
-            ->setSampleRate(sampleRate)
-            ->setChannelCount(channelCount)
+            ->setSharingMode(oboe::SharingMode::Exclusive) // Oboe cai para Shared se não houver
+            ->setFormat(format)
+            ->setFormatConversionAllowed(false)
+            ->setSampleRate(oboe::kUnspecified)
+            ->setSampleRateConversionQuality(oboe::SampleRateConversionQuality::None)
+            ->setChannelCount(configuredChannelCount)
+            ->setChannelConversionAllowed(false)
             ->setUsage(oboe::Usage::Media)
             ->setContentType(oboe::ContentType::Music)
+            ->setPerformanceHintEnabled(performanceHint) // ADPF: o Oboe mede o callback e informa o sistema
             ->setDataCallback(this)
             ->setErrorCallback(this);
 
         // ✅ NÃO FIXAR framesPerCallback - deixar Oboe decidir
         // builder.setFramesPerCallback(960); // REMOVIDO
+
+        // ✅ Economia: caminho compartilhado do mixer do sistema com callbacks longos
+        // (menos despertares). Afinidade e ADPF só servem para segurar callbacks curtos.
+        // A taxa do dispositivo só é conhecida depois de abrir: a da fonte é a estimativa.
+        if (powerSaving)
+        {
+            builder.setPerformanceMode(oboe::PerformanceMode::PowerSaving)
+                ->setSharingMode(oboe::SharingMode::Shared)
+                ->setPerformanceHintEnabled(false)
+                ->setFramesPerCallback(configuredSampleRate * POWER_SAVING_CALLBACK_MS / 1000);
+        }
     }
 
     void start()
     {
-        isPlaying = true;
-        isPrebuffering = true;
+        mixer.start();
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamStarted = true;
         if (stream)
         {
             oboe::Result result = stream->start();
@@ -492,6 +522,8 @@ public:
 
     void pause()
     {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamStarted = false;
         if (stream)
         {
             stream->pause();
@@ -501,34 +533,49 @@ public:
 
     void stop()
     {
-        isPlaying = false;
-        isPrebuffering = true;
+        mixer.stop();
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamStarted = false;
         if (stream)
         {
             stream->stop();
             LOGI("⏹️ Stream parado");
         }
-        clearQueue();
     }
 
     void clearQueue()
     {
-        std::unique_lock<std::mutex> lock(queueMutex);
-        std::queue<AudioChunk> empty;
-        std::swap(audioQueue, empty);
-        currentChunk.data.clear();
-        currentChunk.frameCount = 0;
-        currentFrameIndex = 0;
-        bufferSize = 0;
+        mixer.requestClear();
         LOGI("🗑️ Fila limpa");
     }
 
-    // Getters
-    int32_t getBufferSize() const { return bufferSize.load(); }
-    int32_t getUnderrunCount() const { return underrunCount.load(); }
+    // Getters (somando os senders; o buffer é o do sender mais cheio)
+    int32_t getBufferSize()
+    {
+        int32_t frames = 0;
+        mixer.forEachSource([&](SourceMixer::Source &source)
+                            { frames = std::max(frames, source.core.getBufferedFrames()); });
+        return frames;
+    }
+
+    int32_t getBufferedMs()
+    {
+        int32_t ms = 0;
+        mixer.forEachSource([&](SourceMixer::Source &source)
+                            { ms = std::max(ms, source.core.getBufferedMs()); });
+        return ms;
+    }
+
+    int32_t getUnderrunCount()
+    {
+        int32_t underruns = 0;
+        mixer.forEachSource([&](SourceMixer::Source &source) { underruns += source.core.getUnderrunCount(); });
+        return underruns;
+    }
 
     int32_t getLatencyMillis()
     {
+        std::lock_guard<std::mutex> lock(streamMutex);
         if (!stream)
             return 0;
 
@@ -536,133 +583,565 @@ public:
         return result ? result.value() : 0;
     }
 
-    // 🔧 Volume control
+    // 🔧 Volume geral (multiplica o ganho de cada sender)
     bool setVolume(float volume)
     {
-        // Clamp volume between 0.0 and 1.0
-        volumeLevel.store(std::clamp(volume, 0.0f, 1.0f));
+        mixer.setMasterVolume(volume);
         return true;
     }
 
-    // 🔧 NOVO: Método helper para tempo
-    int64_t getCurrentTimeMs()
+    // 🕒 Sincronização entre receptores (vale para todos os senders)
+    void setClockOffset(int64_t offsetUs) { mixer.setClockOffsetUs(offsetUs); }
+    void setPlayoutDelay(int32_t ms) { mixer.setPlayoutDelayMs(ms); }
+
+    // ✅ Início rápido: toca com poucos bursts no buffer e completa o alvo mais devagar
+    void setFastStart(bool enabled) { mixer.setFastStart(enabled); }
+
+    // DTX: marcadores de silêncio viram ruído de conforto em vez de zeros
+    void setComfortNoise(bool enabled) { mixer.setComfortNoise(enabled); }
+
+    // Afinidade do callback e dica de desempenho (ADPF): valem a partir do próximo stream
+    void setCallbackTuning(bool pin, bool hint)
     {
-        struct timespec ts;
-        clock_gettime(CLOCK_MONOTONIC, &ts);
-        return (ts.tv_sec * 1000LL) + (ts.tv_nsec / 1000000LL);
+        std::lock_guard<std::mutex> lock(streamMutex);
+        pinFastCores = pin;
+        performanceHint = hint;
+    }
+    void setLogLevel(int32_t level) { mixer.setLogLevel(level); } // RealtimeLog::Level
+
+    // ✅ Troca de modo em tempo de execução (tela apagada/acesa): o stream é reaberto
+    // como na recuperação, com o mesmo buffer e a mesma posição, sem perder áudio.
+    // Falhando, a thread de recuperação tenta de novo com backoff.
+    bool setPowerSaving(bool enabled)
+    {
+        receiver.setBatchIntervalMs(enabled ? POWER_SAVING_INGEST_MS : 0);
+        {
+            std::lock_guard<std::mutex> lock(streamMutex);
+            if (powerSaving == enabled)
+                return true;
+            powerSaving = enabled;
+            if (!stream)
+                return true; // Vale a partir do próximo createStream
+        }
+
+        LOGI("🔋 Modo %s: reabrindo o stream", enabled ? "economia" : "baixa latência");
+        if (reopenStream())
+            return true;
+        recovery.request();
+        return false;
+    }
+
+    // Maior erro de agendamento entre os senders sincronizados
+    int64_t getSyncErrorUs()
+    {
+        int64_t worst = 0;
+        mixer.forEachSource([&](SourceMixer::Source &source)
+                            {
+            int64_t error = source.core.isScheduled() ? source.core.getSyncErrorUs() : 0;
+            if (std::abs(error) > std::abs(worst))
+                worst = error; });
+        return worst;
+    }
+
+    // ✅ Perdas somando os caminhos PCM e codificado: perdidos, atrasados, reordenados, escondidos
+    // (no Opus, recuperados por FEC também contam como escondidos)
+    static void addPacketCounters(const SourceMixer::Source &source, int64_t out[4])
+    {
+        out[0] += source.core.getLostPackets() + source.decodeWorker.getLostPackets();
+        out[1] += source.core.getLatePackets() + source.decodeWorker.getLatePackets();
+        out[2] += source.core.getReorderedPackets() + source.decodeWorker.getReorderedPackets();
+        out[3] += source.core.getConcealedPackets() + source.decodeWorker.getConcealedPackets() +
+                  source.decodeWorker.getRecoveredPackets();
+    }
+
+    // Telemetria do core de um sender com os contadores do DecodeWorker somados
+    static void sourceStats(SourceMixer::Source &source, int64_t *out)
+    {
+        source.core.getStats(out);
+
+        int64_t counters[4] = {0, 0, 0, 0};
+        addPacketCounters(source, counters);
+        out[stats::LOST_PACKETS] = counters[0];
+        out[stats::LATE_PACKETS] = counters[1];
+        out[stats::REORDERED_PACKETS] = counters[2];
+        out[stats::CONCEALED_PACKETS] = counters[3];
+        out[stats::SILENT_PACKETS] += source.decodeWorker.getSilentPackets();
+        out[stats::RECEIVED_PACKETS] += source.decodeWorker.getReceivedPackets();
+    }
+
+    // ✅ Relatório SHFB (ReceiverFeedback.h) do sender para mandar de volta a ele;
+    // chamado a cada ~500ms da thread de controle. Retorna os bytes escritos (0 = sem a fonte).
+    int32_t getFeedback(int32_t sourceId, uint8_t *out)
+    {
+        int64_t nowMs = PlayerClock::system().nowNanos() / 1000000;
+        int32_t written = 0;
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                         {
+            int64_t values[stats::COUNT] = {};
+            sourceStats(source, values);
+            feedback::write(out, source.feedback.build(values, nowMs));
+            written = feedback::REPORT_BYTES; });
+        return written;
+    }
+
+    // Soma de todos os senders
+    void getPacketCounters(int64_t out[4])
+    {
+        std::fill_n(out, 4, int64_t(0));
+        mixer.forEachSource([&](SourceMixer::Source &source) { addPacketCounters(source, out); });
+    }
+
+    // ✅ Telemetria (PlayerTelemetry.h) de um sender + xruns do stream; chamado da
+    // thread da UI. sourceId < 0: o sender com mais áudio no buffer.
+    void getStats(int32_t sourceId, int64_t *out)
+    {
+        if (sourceId < 0)
+        {
+            int32_t mostBuffered = -1;
+            mixer.forEachSource([&](SourceMixer::Source &source)
+                                {
+                int32_t frames = source.core.getBufferedFrames();
+                if (frames > mostBuffered)
+                {
+                    mostBuffered = frames;
+                    sourceId = source.id;
+                } });
+        }
+
+        std::fill_n(out, static_cast<int32_t>(stats::COUNT), int64_t(0));
+        mixer.withSource(sourceId, [&](SourceMixer::Source &source) { sourceStats(source, out); });
+        out[stats::STREAM_RECOVERIES] = recovery.getRecoveries();
+        out[stats::SOURCES] = mixer.getSourceCount();
+        out[stats::BUFFER_GROWTHS] = bufferTuner.getGrowths();
+        out[stats::UDP_DATAGRAMS] = receiver.getDatagrams();
+        out[stats::UDP_DROPPED] = receiver.getDropped() + receiver.getRejected();
+        out[stats::OUTPUT_LATENCY_US] = -1;
+        out[stats::INGEST_WAKEUPS_PER_S] = ingestWakeups.perSecond(PlayerClock::system().nowNanos()) +
+                                           receiver.getWakeupsPerSecond();
+        callbackBudget.snapshotInto(out);
+
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (stream)
+        {
+            out[stats::PERFORMANCE_HINT] =
+                performanceHint && !powerSaving && android_get_device_api_level() >= 33 ? 1 : 0;
+            out[stats::POWER_SAVING] = powerSaving ? 1 : 0;
+
+            auto xruns = stream->getXRunCount();
+            out[stats::XRUNS] = xruns ? xruns.value() : -1;
+
+            int32_t deviceRate = std::max(stream->getSampleRate(), 1);
+            int64_t deviceBufferUs = static_cast<int64_t>(bufferTuner.getBufferSize()) * 1000000 / deviceRate;
+            out[stats::DEVICE_BUFFER_US] = deviceBufferUs;
+
+            // ⚠️ calculateLatencyMillis() já inclui os frames na fila do dispositivo:
+            // somar o buffer do dispositivo de novo contaria duas vezes
+            auto latency = stream->calculateLatencyMillis();
+            int64_t outputUs = latency ? static_cast<int64_t>(latency.value() * 1000.0) : deviceBufferUs;
+            if (latency)
+                out[stats::OUTPUT_LATENCY_US] = outputUs;
+
+            int64_t sourceRate = std::max<int64_t>(out[stats::SAMPLE_RATE], 1);
+            out[stats::TOTAL_LATENCY_US] = out[stats::BUFFER_FRAMES] * 1000000 / sourceRate + outputUs;
+        }
     }
 };
 
 // JNI Interface
+// ✅ Cada OboeAudioPlayer.kt guarda o próprio handle (ponteiro nativo); sem instância global
+namespace
+{
+    OboeAudioPlayer *fromHandle(jlong handle)
+    {
+        return reinterpret_cast<OboeAudioPlayer *>(handle);
+    }
+}
+
 extern "C"
 {
-    // Global instance
-    static OboeAudioPlayer *g_player = nullptr;
+    JNIEXPORT jlong JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeCreate(
+        JNIEnv *env, jobject thiz)
+    {
+        return reinterpret_cast<jlong>(new OboeAudioPlayer());
+    }
 
     JNIEXPORT jboolean JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeCreateStream(
-        JNIEnv *env, jobject thiz, jint sampleRate, jint channelCount)
+        JNIEnv *env, jobject thiz, jlong handle, jint sampleRate, jint channelCount, jint maxBufferMs)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->createStream(sampleRate, channelCount, maxBufferMs) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeStartTrace(
+        JNIEnv *env, jobject thiz, jlong handle, jstring path)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr || path == nullptr)
+            return JNI_FALSE;
+        const char *chars = env->GetStringUTFChars(path, nullptr);
+        if (chars == nullptr)
+            return JNI_FALSE;
+        bool started = player->startTrace(chars);
+        env->ReleaseStringUTFChars(path, chars);
+        return started ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeStopTrace(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->stopTrace();
+        }
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeAddSource(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->addSource(sourceId) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeRemoveSource(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->removeSource(sourceId) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetSourceGain(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jfloat gain)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->setSourceGain(sourceId, gain) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetSourceCount(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return 0;
+        return player->getSourceCount();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeStartReceiver(
+        JNIEnv *env, jobject thiz, jlong handle, jint port)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return -1;
+        return player->startReceiver(port);
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeStopReceiver(
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player == nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            g_player = new OboeAudioPlayer();
+            player->stopReceiver();
         }
-        return g_player->createStream(sampleRate, channelCount) ? JNI_TRUE : JNI_FALSE;
     }
 
     JNIEXPORT jboolean JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeAddData(
-        JNIEnv *env, jobject thiz, jbyteArray audioData, jint length)
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jbyteArray audioData, jint length)
     {
-        if (g_player == nullptr)
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
             return JNI_FALSE;
-        return g_player->addAudioData(env, audioData, length) ? JNI_TRUE : JNI_FALSE;
+        return player->addAudioData(env, sourceId, audioData, length) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeAddDirect(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jobject buffer, jint offset, jint length)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->addDirectData(env, sourceId, buffer, offset, length) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeAddEncoded(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jobject buffer, jint offset, jint length)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->addEncodedData(env, sourceId, buffer, offset, length) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeAddBatch(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jobject buffer, jintArray offsets, jint count)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return 0;
+        return player->addBatchData(env, sourceId, buffer, offsets, count);
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeIsEncodedSupported(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->isEncodedSupported() ? JNI_TRUE : JNI_FALSE;
     }
 
     JNIEXPORT void JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeStart(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player != nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            g_player->start();
+            player->start();
         }
     }
 
     JNIEXPORT void JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativePause(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player != nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            g_player->pause();
+            player->pause();
         }
     }
 
     JNIEXPORT void JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeStop(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player != nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            g_player->stop();
+            player->stop();
         }
     }
 
     JNIEXPORT void JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeClearQueue(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player != nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            g_player->clearQueue();
+            player->clearQueue();
         }
     }
 
     JNIEXPORT jint JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetBufferSize(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player == nullptr)
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
             return 0;
-        return g_player->getBufferSize();
+        return player->getBufferSize();
+    }
+
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetBufferedMs(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return 0;
+        return player->getBufferedMs();
     }
 
     JNIEXPORT jint JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetUnderrunCount(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player == nullptr)
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
             return 0;
-        return g_player->getUnderrunCount();
+        return player->getUnderrunCount();
     }
 
     JNIEXPORT jint JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetLatency(
-        JNIEnv *env, jobject thiz)
+        JNIEnv *env, jobject thiz, jlong handle)
     {
-        if (g_player == nullptr)
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
             return 0;
-        return g_player->getLatencyMillis();
+        return player->getLatencyMillis();
     }
 
     JNIEXPORT jboolean JNICALL
     Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetVolume(
-        JNIEnv *env, jobject thiz, jfloat volume)
+        JNIEnv *env, jobject thiz, jlong handle, jfloat volume)
     {
-        if (g_player == nullptr)
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
             return JNI_FALSE;
-        return g_player->setVolume(volume) ? JNI_TRUE : JNI_FALSE;
+        return player->setVolume(volume) ? JNI_TRUE : JNI_FALSE;
     }
 
     JNIEXPORT void JNICALL
-    Java_com_shirou_shibasync_OboeAudioPlayer_nativeDestroy(
-        JNIEnv *env, jobject thiz)
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetClockOffset(
+        JNIEnv *env, jobject thiz, jlong handle, jlong offsetUs)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->setClockOffset(offsetUs);
+        }
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetPlayoutDelay(
+        JNIEnv *env, jobject thiz, jlong handle, jint delayMs)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->setPlayoutDelay(delayMs);
+        }
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetFastStart(
+        JNIEnv *env, jobject thiz, jlong handle, jboolean enabled)
     {
-        if (g_player != nullptr)
+        if (OboeAudioPlayer *player = fromHandle(handle))
         {
-            delete g_player;
-            g_player = nullptr;
+            player->setFastStart(enabled == JNI_TRUE);
         }
     }
-}
\ No newline at end of file
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetCallbackTuning(
+        JNIEnv *env, jobject thiz, jlong handle, jboolean pinFastCores, jboolean performanceHint)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->setCallbackTuning(pinFastCores == JNI_TRUE, performanceHint == JNI_TRUE);
+        }
+    }
+
+    JNIEXPORT jboolean JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetPowerSaving(
+        JNIEnv *env, jobject thiz, jlong handle, jboolean enabled)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return JNI_FALSE;
+        return player->setPowerSaving(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetComfortNoise(
+        JNIEnv *env, jobject thiz, jlong handle, jboolean enabled)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->setComfortNoise(enabled == JNI_TRUE);
+        }
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeSetLogLevel(
+        JNIEnv *env, jobject thiz, jlong handle, jint level)
+    {
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            player->setLogLevel(level);
+        }
+    }
+
+    JNIEXPORT jlong JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetSyncError(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr)
+            return 0;
+        return player->getSyncErrorUs();
+    }
+
+    JNIEXPORT jlongArray JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetPacketCounters(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        jlong values[4] = {0, 0, 0, 0};
+        if (OboeAudioPlayer *player = fromHandle(handle))
+        {
+            int64_t counters[4];
+            player->getPacketCounters(counters);
+            for (int i = 0; i < 4; i++)
+                values[i] = counters[i];
+        }
+        jlongArray result = env->NewLongArray(4);
+        if (result != nullptr)
+        {
+            env->SetLongArrayRegion(result, 0, 4, values);
+        }
+        return result;
+    }
+
+    // Preenche até out.size posições (índices em PlayerStats.kt); retorna stats::COUNT
+    JNIEXPORT jint JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetStats(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId, jlongArray out)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        if (player == nullptr || out == nullptr)
+            return 0;
+
+        int64_t values[stats::COUNT];
+        player->getStats(sourceId, values);
+
+        jlong copied[stats::COUNT];
+        jsize length = std::min<jsize>(env->GetArrayLength(out), stats::COUNT);
+        for (jsize i = 0; i < length; i++)
+            copied[i] = values[i];
+        env->SetLongArrayRegion(out, 0, length, copied);
+        return stats::COUNT;
+    }
+
+    JNIEXPORT jbyteArray JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeGetFeedback(
+        JNIEnv *env, jobject thiz, jlong handle, jint sourceId)
+    {
+        OboeAudioPlayer *player = fromHandle(handle);
+        uint8_t report[feedback::REPORT_BYTES];
+        if (player == nullptr || player->getFeedback(sourceId, report) == 0)
+            return nullptr;
+
+        jbyteArray result = env->NewByteArray(feedback::REPORT_BYTES);
+        if (result != nullptr)
+        {
+            env->SetByteArrayRegion(result, 0, feedback::REPORT_BYTES, reinterpret_cast<const jbyte *>(report));
+        }
+        return result;
+    }
+
+    JNIEXPORT void JNICALL
+    Java_com_shirou_shibasync_OboeAudioPlayer_nativeDestroy(
+        JNIEnv *env, jobject thiz, jlong handle)
+    {
+        delete fromHandle(handle);
+    }
+}
@@ -0,0 +1,73 @@
+#include "AudioDecoder.h"
+#include "NativeLog.h"
+
+#if defined(SHIBASYNC_WITH_OPUS)
+#include <opus.h>
+
+// ✅ libopus: PLC com data == nullptr e FEC com decode_fec = 1
+class OpusAudioDecoder : public AudioDecoder
+{
+public:
+    static std::unique_ptr<AudioDecoder> create(int32_t sampleRate, int32_t channelCount)
+    {
+        int error = OPUS_OK;
+        OpusDecoder *decoder = opus_decoder_create(sampleRate, channelCount, &error);
+        if (error != OPUS_OK || decoder == nullptr)
+        {
+            LOGE("❌ opus_decoder_create(%d, %d): %s", sampleRate, channelCount, opus_strerror(error));
+            return nullptr;
+        }
+        return std::unique_ptr<AudioDecoder>(new OpusAudioDecoder(decoder));
+    }
+
+    ~OpusAudioDecoder() override { opus_decoder_destroy(decoder); }
+
+    int32_t decode(const uint8_t *data, int32_t length, int16_t *pcm, int32_t maxFrames) override
+    {
+        return opus_decode(decoder, data, length, pcm, maxFrames, 0);
+    }
+
+    int32_t conceal(int16_t *pcm, int32_t frames) override
+    {
+        return opus_decode(decoder, nullptr, 0, pcm, frames, 0);
+    }
+
+    int32_t recover(const uint8_t *data, int32_t length, int16_t *pcm, int32_t frames) override
+    {
+        return opus_decode(decoder, data, length, pcm, frames, 1);
+    }
+
+    void reset() override { opus_decoder_ctl(decoder, OPUS_RESET_STATE); }
+
+    const char *name() const override { return "opus"; }
+
+private:
+    explicit OpusAudioDecoder(OpusDecoder *decoder) : decoder(decoder) {}
+
+    OpusDecoder *decoder;
+};
+
+std::unique_ptr<AudioDecoder> createOpusDecoder(int32_t sampleRate, int32_t channelCount)
+{
+    switch (sampleRate)
+    {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        return OpusAudioDecoder::create(sampleRate, channelCount);
+    default:
+        LOGW("⚠️ Opus não suporta %dHz", sampleRate);
+        return nullptr;
+    }
+}
+
+#else
+
+std::unique_ptr<AudioDecoder> createOpusDecoder(int32_t, int32_t)
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,80 @@
+#include "AudioEncoder.h"
+#include "NativeLog.h"
+#include "PacketFormat.h"
+
+#if defined(SHIBASYNC_WITH_OPUS)
+#include <opus.h>
+
+// ✅ libopus em modo música, com FEC embutido para o DecodeWorker dos receptores
+class OpusAudioEncoder : public AudioEncoder
+{
+public:
+    static constexpr int32_t EXPECTED_LOSS_PERCENT = 10; // Liga a redundância do FEC
+
+    static std::unique_ptr<AudioEncoder> create(int32_t sampleRate, int32_t channelCount, int32_t bitrate)
+    {
+        int error = OPUS_OK;
+        OpusEncoder *encoder = opus_encoder_create(sampleRate, channelCount, OPUS_APPLICATION_AUDIO, &error);
+        if (error != OPUS_OK || encoder == nullptr)
+        {
+            LOGE("❌ opus_encoder_create(%d, %d): %s", sampleRate, channelCount, opus_strerror(error));
+            return nullptr;
+        }
+        opus_encoder_ctl(encoder, OPUS_SET_BITRATE(bitrate));
+        opus_encoder_ctl(encoder, OPUS_SET_INBAND_FEC(1));
+        opus_encoder_ctl(encoder, OPUS_SET_PACKET_LOSS_PERC(EXPECTED_LOSS_PERCENT));
+        return std::unique_ptr<AudioEncoder>(new OpusAudioEncoder(encoder, bitrate));
+    }
+
+    ~OpusAudioEncoder() override { opus_encoder_destroy(encoder); }
+
+    int32_t encode(const int16_t *pcm, int32_t frames, uint8_t *out, int32_t maxBytes) override
+    {
+        return opus_encode(encoder, pcm, frames, out, maxBytes);
+    }
+
+    uint8_t codec() const override { return packet::CODEC_OPUS; }
+    const char *name() const override { return "opus"; }
+
+    int32_t bitrate() const override { return currentBitrate; }
+
+    // ✅ Controle de congestionamento: muda sem recriar o encoder (nem perder o estado)
+    bool setBitrate(int32_t bitrate) override
+    {
+        if (opus_encoder_ctl(encoder, OPUS_SET_BITRATE(bitrate)) != OPUS_OK)
+            return false;
+        currentBitrate = bitrate;
+        return true;
+    }
+
+private:
+    OpusAudioEncoder(OpusEncoder *encoder, int32_t bitrate) : encoder(encoder), currentBitrate(bitrate) {}
+
+    OpusEncoder *encoder;
+    int32_t currentBitrate;
+};
+
+std::unique_ptr<AudioEncoder> createOpusEncoder(int32_t sampleRate, int32_t channelCount, int32_t bitrate)
+{
+    switch (sampleRate)
+    {
+    case 8000:
+    case 12000:
+    case 16000:
+    case 24000:
+    case 48000:
+        return OpusAudioEncoder::create(sampleRate, channelCount, bitrate);
+    default:
+        LOGW("⚠️ Opus não suporta %dHz", sampleRate);
+        return nullptr;
+    }
+}
+
+#else
+
+std::unique_ptr<AudioEncoder> createOpusEncoder(int32_t, int32_t, int32_t)
+{
+    return nullptr;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "OutputStage.h"
+#include "AudioKernels.h"
+
+#include <algorithm>
+#include <cstring>
+
+void OutputStage::configure(int32_t sourceChannelCount)
+{
+    sourceChannels = std::max(sourceChannelCount, 1);
+    source.assign(static_cast<size_t>(SCRATCH_FRAMES) * sourceChannels, int16_t(0));
+    remapped.assign(static_cast<size_t>(SCRATCH_FRAMES) * MAX_DEVICE_CHANNELS, int16_t(0));
+}
+
+const int16_t *OutputStage::remap(int32_t frames, int32_t deviceChannels)
+{
+    if (deviceChannels == sourceChannels)
+        return source.data();
+
+    const int16_t *in = source.data();
+    int16_t *out = remapped.data();
+
+    if (deviceChannels == 1)
+    {
+        for (int32_t f = 0; f < frames; f++)
+        {
+            int32_t sum = 0;
+            for (int32_t c = 0; c < sourceChannels; c++)
+                sum += in[static_cast<size_t>(f) * sourceChannels + c];
+            out[f] = static_cast<int16_t>(sum / sourceChannels);
+        }
+        return out;
+    }
+
+    std::fill_n(out, static_cast<size_t>(frames) * deviceChannels, int16_t(0));
+    int32_t common = std::min(sourceChannels, deviceChannels);
+    for (int32_t f = 0; f < frames; f++)
+    {
+        const int16_t *src = in + static_cast<size_t>(f) * sourceChannels;
+        int16_t *dst = out + static_cast<size_t>(f) * deviceChannels;
+        if (sourceChannels == 1)
+        {
+            dst[0] = src[0];
+            dst[1] = src[0];
+        }
+        else
+        {
+            for (int32_t c = 0; c < common; c++)
+                dst[c] = src[c];
+        }
+    }
+    return out;
+}
+
+void OutputStage::convert(int32_t frames, int32_t deviceChannels, OutputFormat format, void *dst, int32_t firstFrame)
+{
+    const int16_t *samples = remap(frames, deviceChannels);
+    size_t offset = static_cast<size_t>(firstFrame) * deviceChannels;
+    int32_t count = frames * deviceChannels;
+
+    if (format == OutputFormat::Float)
+        audiokernels::int16ToFloat(static_cast<float *>(dst) + offset, samples, count);
+    else
+        memcpy(static_cast<int16_t *>(dst) + offset, samples, static_cast<size_t>(count) * sizeof(int16_t));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "AudioOutputStream.h"
+
+// ✅ Estágio final do callback: layout da fonte -> layout do dispositivo
+//
+// O PlayerCore sempre produz PCM16 na contagem de canais da fonte. Quando o stream
+// abriu em float ou com outra contagem de canais, o render escreve no scratch
+// daqui e convert() faz o upmix/downmix e a conversão (SIMD) direto no buffer do
+// callback — sem o salto de conversão extra dentro do AAudio.
+//  - mono -> N: o mesmo sinal em L e R, demais canais em silêncio
+//  - N -> mono: média de todos os canais
+//  - N -> M (M > 1): os primeiros canais em comum, o resto em silêncio
+class OutputStage
+{
+public:
+    static constexpr int32_t SCRATCH_FRAMES = 2048; // Callbacks maiores são feitos em partes
+    static constexpr int32_t MAX_DEVICE_CHANNELS = 8;
+
+    // Aloca o scratch. Fora do callback.
+    void configure(int32_t sourceChannelCount);
+
+    // Formato e layout iguais aos da fonte: o render escreve direto na saída
+    bool isPassthrough(int32_t deviceChannels, OutputFormat format) const
+    {
+        return format == OutputFormat::I16 && deviceChannels == sourceChannels;
+    }
+
+    bool supports(int32_t deviceChannels) const
+    {
+        return deviceChannels >= 1 && deviceChannels <= MAX_DEVICE_CHANNELS;
+    }
+
+    // Buffer onde o render escreve até SCRATCH_FRAMES frames no layout da fonte
+    int16_t *scratch() { return source.data(); }
+
+    // Converte `frames` frames do scratch para dst (a partir do frame firstFrame)
+    void convert(int32_t frames, int32_t deviceChannels, OutputFormat format, void *dst, int32_t firstFrame);
+
+private:
+    const int16_t *remap(int32_t frames, int32_t deviceChannels);
+
+    int32_t sourceChannels = 2;
+    std::vector<int16_t> source;   // SCRATCH_FRAMES x canais da fonte
+    std::vector<int16_t> remapped; // SCRATCH_FRAMES x MAX_DEVICE_CHANNELS
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+
+// ✅ Cabeçalho binário dos chunks de áudio ("SHB1")
+//
+// Layout (little-endian, 24 bytes):
+//   0  u32 magic         'S' 'H' 'B' '1'
+//   4  u8  version       1
+//   5  u8  codec         0 = PCM16 intercalado, 1 = Opus (um pacote por chunk)
+//   6  u16 flags         HAS_TIMESTAMP: captureTimeUs é válido; SILENCE: ver abaixo
+//   8  u32 sequence      Contador do sender (por stream)
+//   12 i64 captureTimeUs Instante de captura do 1º frame no relógio do servidor
+//   20 u32 frames        Frames de áudio no payload
+//
+// Com SILENCE (DTX), o payload não é áudio: são `frames` frames de silêncio e o
+// payload tem SILENCE_PAYLOAD_BYTES (u32 frames, u16 nível RMS em unidades PCM16,
+// para ruído de conforto). O codec continua o do sender: o pacote segue o mesmo
+// caminho (e a mesma sequência) dos chunks de áudio.
+//
+// Chunks sem o magic continuam sendo tratados como PCM16 cru (senders antigos).
+// A versão Kotlin fica em AudioChunk.kt: as duas precisam andar juntas.
+namespace packet
+{
+    constexpr int32_t HEADER_BYTES = 24;
+    constexpr uint8_t VERSION = 1;
+    constexpr uint8_t CODEC_PCM16 = 0;
+    constexpr uint8_t CODEC_OPUS = 1;
+    constexpr uint16_t FLAG_HAS_TIMESTAMP = 1 << 0;
+    constexpr uint16_t FLAG_SILENCE = 1 << 1;
+    constexpr int32_t SILENCE_PAYLOAD_BYTES = 6;
+
+    struct Header
+    {
+        uint8_t version = VERSION;
+        uint8_t codec = CODEC_PCM16;
+        uint16_t flags = 0;
+        uint32_t sequence = 0;
+        int64_t captureTimeUs = 0;
+        uint32_t frames = 0;
+
+        bool hasTimestamp() const { return (flags & FLAG_HAS_TIMESTAMP) != 0; }
+        bool isSilence() const { return (flags & FLAG_SILENCE) != 0; }
+    };
+
+    namespace detail
+    {
+        inline uint64_t readLe(const uint8_t *p, int bytes)
+        {
+            uint64_t v = 0;
+            for (int i = bytes - 1; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        inline void writeLe(uint8_t *p, uint64_t v, int bytes)
+        {
+            for (int i = 0; i < bytes; i++, v >>= 8)
+                p[i] = static_cast<uint8_t>(v & 0xFF);
+        }
+    }
+
+    inline bool hasMagic(const uint8_t *bytes, int32_t length)
+    {
+        return length >= HEADER_BYTES &&
+               bytes[0] == 'S' && bytes[1] == 'H' && bytes[2] == 'B' && bytes[3] == '1';
+    }
+
+    // Lê o cabeçalho; false se não for um pacote SHB1 de versão conhecida
+    inline bool parse(const uint8_t *bytes, int32_t length, Header &out)
+    {
+        if (!hasMagic(bytes, length))
+            return false;
+
+        out.version = bytes[4];
+        out.codec = bytes[5];
+        out.flags = static_cast<uint16_t>(detail::readLe(bytes + 6, 2));
+        out.sequence = static_cast<uint32_t>(detail::readLe(bytes + 8, 4));
+        out.captureTimeUs = static_cast<int64_t>(detail::readLe(bytes + 12, 8));
+        out.frames = static_cast<uint32_t>(detail::readLe(bytes + 20, 4));
+        return out.version == VERSION;
+    }
+
+    inline void write(uint8_t *bytes, const Header &header)
+    {
+        bytes[0] = 'S';
+        bytes[1] = 'H';
+        bytes[2] = 'B';
+        bytes[3] = '1';
+        bytes[4] = header.version;
+        bytes[5] = header.codec;
+        detail::writeLe(bytes + 6, header.flags, 2);
+        detail::writeLe(bytes + 8, header.sequence, 4);
+        detail::writeLe(bytes + 12, static_cast<uint64_t>(header.captureTimeUs), 8);
+        detail::writeLe(bytes + 20, header.frames, 4);
+    }
+
+    inline void writeSilence(uint8_t *payload, uint32_t frames, uint16_t level)
+    {
+        detail::writeLe(payload, frames, 4);
+        detail::writeLe(payload + 4, level, 2);
+    }
+
+    // Payload de um pacote SILENCE; false se curto demais
+    inline bool parseSilence(const uint8_t *payload, int32_t length, uint32_t &frames, uint16_t &level)
+    {
+        if (length < SILENCE_PAYLOAD_BYTES)
+            return false;
+        frames = static_cast<uint32_t>(detail::readLe(payload, 4));
+        level = static_cast<uint16_t>(detail::readLe(payload + 4, 2));
+        return true;
+    }
+}
@@ -0,0 +1,729 @@
+#include "PlayerCore.h"
+#include "NativeLog.h"
+#include "PacketFormat.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+PlayerCore::PlayerCore(const PlayerClock &clock) : clock(clock)
+{
+}
+
+void PlayerCore::configure(int32_t sampleRate, int32_t channelCount, int32_t maxBufferMs)
+{
+    configuredSampleRate = sampleRate;
+    configuredChannelCount = channelCount;
+
+    // ✅ Alocar o ring UMA VEZ, fora da thread de áudio, pela duração e não por chunks.
+    // Folga de 1/8 acima do máximo: o produtor só esbarra no teto se o callback parar.
+    maxBufferFrames = msToFrames(std::clamp(maxBufferMs, MIN_MAX_BUFFER_MS, MAX_MAX_BUFFER_MS));
+    ring.allocate(maxBufferFrames + maxBufferFrames / 8, channelCount);
+    dropCrossfadeFrames = msToFrames(DROP_CROSSFADE_MS);
+    dropFadeOut.assign(static_cast<size_t>(dropCrossfadeFrames) * channelCount, int16_t(0));
+    dropFadeIn.assign(static_cast<size_t>(dropCrossfadeFrames) * channelCount, int16_t(0));
+    resampler.configure(channelCount);
+    resampler.setRates(sampleRate, sampleRate);
+    outputSampleRate = sampleRate;
+    outputStage.configure(channelCount);
+    gainRamp.configure(sampleRate);
+    gainRamp.reset(volumeLevel.load());
+    jitterBuffer.configure(sampleRate);
+    scheduler.configure(sampleRate);
+    scheduled = false;
+    lastChunkTimestamped = false;
+    clearRequested = false;
+    outputRestarted = false;
+    awaitingOutputTimestamp = false;
+    reorder.configure(MAX_CHUNK_FRAMES * channelCount * static_cast<int32_t>(sizeof(int16_t)));
+    concealer.configure(sampleRate, channelCount);
+    concealScratch.assign(static_cast<size_t>(MAX_CHUNK_FRAMES) * channelCount, int16_t(0));
+    silenceScratch.assign(concealScratch.size(), int16_t(0));
+    silenceScratchZero = true;
+    silentPackets = 0;
+    lastSequencedFrames = 0;
+    sequenceResetRequested = false;
+    concealedPackets = 0;
+
+    // Reset
+    totalCallbacks = 0;
+    totalFramesWritten = 0;
+    chunksAdded = 0;
+    droppedFrames = 0;
+    rejectedChunks = 0;
+    startTimeMs = 0;
+    underrunCount = 0;
+    buildingBuffer = false;
+    stretchRatio = 1.0;
+
+    // ✅ Reset timing
+    lastChunkTimeMs = 0;
+    smoothedChunkInterval = 20.0f;
+    telemetry.reset();
+}
+
+void PlayerCore::setOutputSampleRate(int32_t sampleRate)
+{
+    // Mesma taxa (stream reaberto no mesmo dispositivo): manter a janela do reamostrador
+    if (sampleRate <= 0 || sampleRate == outputSampleRate.load())
+        return;
+    outputSampleRate = sampleRate;
+    resampler.setRates(configuredSampleRate, sampleRate);
+    if (resampler.isConverting())
+        LOGI("🔁 Conversão de taxa: %dHz -> %dHz (sinc)", configuredSampleRate, sampleRate);
+}
+
+void PlayerCore::start()
+{
+    playing = true;
+    prebuffering = true;
+}
+
+void PlayerCore::stop()
+{
+    playing = false;
+    prebuffering = true;
+    requestClear();
+}
+
+void PlayerCore::requestClear()
+{
+    // O índice de leitura pertence ao callback: apenas sinalizar.
+    // Com o stream parado o pedido é aplicado no próximo start().
+    // A janela de reordenação é do produtor: recomeça no próximo write().
+    clearRequested = true;
+    sequenceResetRequested = true;
+}
+
+int32_t PlayerCore::getBufferedFrames() const
+{
+    // ✅ Nível do ring em frames (pedidos de limpeza pendentes contam como vazio)
+    return clearRequested.load() ? 0 : ring.availableToRead();
+}
+
+bool PlayerCore::setVolume(float volume)
+{
+    // Clamp volume between 0.0 and 1.0
+    volumeLevel.store(std::clamp(volume, 0.0f, 1.0f));
+    return true;
+}
+
+// ✅ CAMINHO COMUM DE INGESTÃO - ESCREVE DIRETO NO RING (sem fila, sem lock)
+bool PlayerCore::write(const uint8_t *bytes, int32_t length)
+{
+    if (!playing)
+        return false;
+
+    // ✅ CABEÇALHO SHB1 OPCIONAL: timestamp de captura para reprodução sincronizada
+    packet::Header header;
+    bool hasHeader = packet::parse(bytes, length, header);
+    if (hasHeader)
+    {
+        if (header.codec != packet::CODEC_PCM16)
+        {
+            LOGW("⚠️ Codec %d não é PCM: use o caminho codificado (DecodeWorker)", header.codec);
+            return false;
+        }
+        bytes += packet::HEADER_BYTES;
+        length -= packet::HEADER_BYTES;
+    }
+    else if (packet::hasMagic(bytes, length))
+    {
+        LOGW("⚠️ Versão de pacote desconhecida: %d", bytes[4]);
+        return false;
+    }
+
+    // ✅ DTX: marcador de silêncio; os frames são gerados na entrega, em ordem
+    if (hasHeader && header.isSilence())
+    {
+        uint32_t frames = 0;
+        uint16_t level = 0;
+        if (!packet::parseSilence(bytes, length, frames, level) || frames == 0 || frames > MAX_CHUNK_FRAMES)
+        {
+            LOGW("⚠️ Marcador de silêncio inválido (%d bytes, %u frames)", length, frames);
+            return false;
+        }
+        length = packet::SILENCE_PAYLOAD_BYTES;
+    }
+    else
+    {
+        // Validar tamanho
+        if (length % (2 * configuredChannelCount) != 0)
+        {
+            LOGW("⚠️ Tamanho inválido: %d bytes (não é múltiplo de %d)",
+                 length, 2 * configuredChannelCount);
+            return false;
+        }
+
+        // ✅ CALCULAR FRAMES CORRETAMENTE
+        int32_t numSamples = length / 2;                         // 2 bytes por sample
+        int32_t numFrames = numSamples / configuredChannelCount; // ✅ IMPORTANTE!
+
+        if (!hasHeader)
+        {
+            // PCM cru de senders antigos: sem sequência, direto para o ring
+            return writeFrames(reinterpret_cast<const int16_t *>(bytes), numFrames, PlayoutScheduler::NO_TIMESTAMP);
+        }
+
+        if (numFrames > MAX_CHUNK_FRAMES)
+        {
+            LOGW("⚠️ Chunk de %d frames maior que o máximo com sequência (%d)", numFrames, MAX_CHUNK_FRAMES);
+            return false;
+        }
+    }
+
+    // ✅ REORDENAÇÃO: pacotes saem em ordem, com os buracos anotados
+    if (sequenceResetRequested.exchange(false))
+    {
+        reorder.reset();
+        concealer.reset();
+        lastSequencedFrames = 0;
+    }
+    return reorder.push(header.sequence,
+                        header.hasTimestamp() ? header.captureTimeUs : PlayoutScheduler::NO_TIMESTAMP,
+                        bytes, length,
+                        [this](const ReorderBuffer::Entry &entry, uint32_t lostBefore)
+                        { deliverSequenced(entry, lostBefore); },
+                        header.flags);
+}
+
+int32_t PlayerCore::writeBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count)
+{
+    int32_t accepted = 0;
+    batching = true;
+    for (int32_t i = 0; i < count; i++)
+    {
+        if (write(bytes + offsets[i], offsets[i + 1] - offsets[i]))
+            accepted++;
+    }
+    batching = false;
+    ring.commit();
+    return accepted;
+}
+
+void PlayerCore::deliverSequenced(const ReorderBuffer::Entry &entry, uint32_t lostBefore)
+{
+    const auto *samples = reinterpret_cast<const int16_t *>(entry.data);
+    int32_t numFrames = entry.length / (2 * configuredChannelCount);
+    if ((entry.flags & packet::FLAG_SILENCE) != 0)
+    {
+        samples = expandSilence(entry, numFrames);
+    }
+
+    if (lostBefore > 0 && lostBefore <= MAX_CONCEAL_PACKETS && lastSequencedFrames > 0)
+    {
+        // ✅ CONCEALMENT: repetir o período alinhado no lugar de cada chunk perdido,
+        // com o instante de captura recuado a partir do pacote atual
+        int64_t captureTimeUs = entry.captureTimeUs;
+        if (captureTimeUs != PlayoutScheduler::NO_TIMESTAMP)
+        {
+            captureTimeUs -= (static_cast<int64_t>(lostBefore) * lastSequencedFrames * 1000000LL) / configuredSampleRate;
+        }
+        for (uint32_t i = 0; i < lostBefore; i++)
+        {
+            concealer.conceal(concealScratch.data(), lastSequencedFrames);
+            writeFrames(concealScratch.data(), lastSequencedFrames, captureTimeUs);
+            concealedPackets++;
+            if (captureTimeUs != PlayoutScheduler::NO_TIMESTAMP)
+                captureTimeUs += (static_cast<int64_t>(lastSequencedFrames) * 1000000LL) / configuredSampleRate;
+        }
+    }
+    else if (lostBefore > 0)
+    {
+        // Buraco grande ou sender reiniciado: emenda seca, o jitter buffer/agendamento absorve
+        concealer.reset();
+        LOGW("⚠️ Descontinuidade na sequência (%u pacotes) antes de #%u",
+             lostBefore == ReorderBuffer::DISCONTINUITY ? 0u : lostBefore, entry.sequence);
+    }
+
+    lastSequencedFrames = numFrames;
+    if (concealer.isConcealing())
+    {
+        // Primeiro chunk real depois da perda: crossfade sobre a continuação sintética
+        memcpy(concealScratch.data(), samples, static_cast<size_t>(numFrames) * configuredChannelCount * sizeof(int16_t));
+        concealer.blendInto(concealScratch.data(), numFrames);
+        samples = concealScratch.data();
+    }
+    concealer.remember(samples, numFrames);
+    writeFrames(samples, numFrames, entry.captureTimeUs);
+}
+
+// Frames de um marcador DTX no buffer de silêncio: zeros (preenchido uma vez só)
+// ou ruído de conforto no nível medido pelo sender
+const int16_t *PlayerCore::expandSilence(const ReorderBuffer::Entry &entry, int32_t &numFrames)
+{
+    uint32_t frames = 0;
+    uint16_t level = 0;
+    packet::parseSilence(entry.data, entry.length, frames, level);
+    numFrames = static_cast<int32_t>(frames);
+    silentPackets++;
+
+    int32_t noiseLevel = comfortNoise.load() ? level : 0;
+    if (noiseLevel > 0 || !silenceScratchZero)
+    {
+        silence::fill(silenceScratch.data(), numFrames * configuredChannelCount, noiseLevel, noiseSeed);
+        silenceScratchZero = noiseLevel == 0;
+    }
+    return silenceScratch.data();
+}
+
+// ✅ PRODUTOR: frames PCM16 já decodificados (caminho cru ou DecodeWorker)
+bool PlayerCore::writeFrames(const int16_t *samples, int32_t numFrames, int64_t captureTimeUs)
+{
+    if (!playing || numFrames <= 0)
+        return false;
+
+    // Chunk inteiro ou nada: nunca publicar meio chunk. O índice de leitura é do
+    // callback, então aqui o descartado é o chunk novo; o corte dos mais antigos
+    // (com crossfade) fica com o consumidor ao passar de maxBufferFrames.
+    if (ring.availableToWrite() < numFrames)
+    {
+        int32_t rejected = ++rejectedChunks;
+        droppedFrames += numFrames;
+        if (rejected % 50 == 1)
+        {
+            LOGW("⚠️ Ring cheio, descartando chunk (%d descartados)", rejected);
+        }
+        return false;
+    }
+
+    // Debug ocasional
+    if (chunksAdded % 100 == 0)
+    {
+        int32_t numSamples = numFrames * configuredChannelCount;
+        LOGI("📦 Chunk %d: %d frames (%d samples)",
+             chunksAdded.load(), numFrames, numSamples);
+
+        // Verificar primeiros samples
+        if (numSamples >= 4)
+        {
+            LOGI("   Samples: [%d, %d, %d, %d]",
+                 samples[0], samples[1], samples[2], samples[3]);
+        }
+    }
+
+    // ✅ ÂNCORA DE TEMPO: frame do ring -> instante de captura (antes de publicar os frames)
+    bool timestamped = captureTimeUs != PlayoutScheduler::NO_TIMESTAMP;
+    if (timestamped || lastChunkTimestamped)
+    {
+        scheduler.pushAnchor(ring.writePosition(), captureTimeUs);
+    }
+    lastChunkTimestamped = timestamped;
+
+    // Copiar dados como int16_t (Little Endian) e publicar para o callback
+    // (em lote, a publicação fica para o fim do writeBatch)
+    if (batching)
+        ring.stage(samples, numFrames);
+    else
+        ring.write(samples, numFrames);
+
+    // ✅ TIMING DE CHEGADA: alimenta o jitter buffer adaptativo
+    jitterBuffer.onArrival(clock.nowUs(), numFrames, framesPerBurst.load());
+
+    int64_t currentTime = clock.nowMs();
+    if (lastChunkTimeMs > 0)
+    {
+        int32_t interval = (int32_t)(currentTime - lastChunkTimeMs);
+        if (interval > 0 && interval < 1000)
+        {
+            // Suavização simples
+            float current = smoothedChunkInterval.load();
+            float newInterval = (current * 0.9f) + (interval * 0.1f);
+            smoothedChunkInterval = newInterval;
+        }
+    }
+    lastChunkTimeMs = currentTime;
+
+    chunksAdded++;
+    return true;
+}
+
+// ✅ CALLBACK PRINCIPAL - LOCK-FREE
+// Sem log periódico aqui: as medidas vão para a telemetria e a UI lê por getStats()
+void PlayerCore::render(const AudioOutputStream &output, void *outputData, int32_t numFrames)
+{
+    int64_t startNs = clock.nowNanos();
+    int32_t deviceChannels = output.getChannelCount();
+    OutputFormat format = output.getFormat();
+    double ratio = 1.0;
+
+    totalCallbacks++;
+
+    if (outputStage.isPassthrough(deviceChannels, format))
+    {
+        // Caminho comum: PCM16 no layout da fonte, direto no buffer do callback
+        ratio = renderBlock(output, static_cast<int16_t *>(outputData), numFrames);
+    }
+    else if (!outputStage.supports(deviceChannels))
+    {
+        // Layout que não sabemos mapear: silêncio em vez de samples embaralhados
+        size_t bytes = format == OutputFormat::Float ? sizeof(float) : sizeof(int16_t);
+        memset(outputData, 0, static_cast<size_t>(numFrames) * deviceChannels * bytes);
+    }
+    else
+    {
+        // ✅ Float e/ou outra contagem de canais: render no scratch e conversão na saída
+        for (int32_t done = 0; done < numFrames;)
+        {
+            int32_t frames = std::min(numFrames - done, OutputStage::SCRATCH_FRAMES);
+            ratio = renderBlock(output, outputStage.scratch(), frames);
+            outputStage.convert(frames, deviceChannels, format, outputData, done);
+            done += frames;
+        }
+    }
+
+    int32_t fillFrames = ring.availableToRead() + resampler.bufferedFrames();
+    telemetry.recordCallback((clock.nowNanos() - startNs) / 1000, framesToMs(fillFrames), ratio);
+}
+
+double PlayerCore::renderBlock(const AudioOutputStream &output, int16_t *outputData, int32_t numFrames)
+{
+    int32_t channelCount = configuredChannelCount;
+
+    // Frames da fonte consumidos por frame de saída (1.0 sem conversão de taxa)
+    double rateRatio = static_cast<double>(configuredSampleRate) / std::max(output.getSampleRate(), 1);
+
+    // Rastrear timing - INICIALIZAR APENAS QUANDO COMEÇAR A REPRODUZIR
+    if (startTimeMs == 0 && !prebuffering)
+    {
+        startTimeMs = clock.nowMs();
+    }
+
+    // ✅ LIMPEZA PEDIDA POR clearQueue(): só o consumidor mexe no índice de leitura
+    if (clearRequested.exchange(false))
+    {
+        ring.discard(ring.availableToRead());
+        resampler.reset();
+        jitterBuffer.resetConsumer();
+        scheduler.resetTimeline();
+        buildingBuffer = false;
+        stretchRatio = 1.0;
+    }
+
+    // ✅ STREAM REABERTO: o ring continua; só o par frame/instante do stream é novo
+    if (outputRestarted.exchange(false))
+    {
+        scheduler.resetOutputTimestamp();
+        awaitingOutputTimestamp = true;
+        restartWaitFrames = 0;
+    }
+
+    // ✅ REPRODUÇÃO SINCRONIZADA: o agendamento substitui o prebuffer adaptativo
+    int64_t scheduleErrorUs = 0;
+    bool isScheduledNow = scheduler.hasSchedule(readHeadFrame());
+    if (isScheduledNow != scheduled.load())
+    {
+        scheduled = isScheduledNow;
+        prebuffering = true; // Realinhar (ou voltar ao prebuffer adaptativo)
+        buildingBuffer = false;
+        stretchRatio = 1.0;
+        if (isScheduledNow)
+            postLog(RealtimeLog::SCHEDULED, scheduler.getPlayoutDelayMs());
+        else
+            postLog(RealtimeLog::UNSCHEDULED);
+    }
+    if (awaitingOutputTimestamp)
+    {
+        if (isScheduledNow)
+        {
+            // Alinhar pela estimativa da latência erraria por dezenas de ms: esperar a medida
+            scheduler.presentationTimeUs(output, clock.nowUs());
+            if (!scheduler.hasOutputTimestamp() && restartWaitFrames < msToFrames(MAX_RESTART_WAIT_MS))
+            {
+                prebuffering = true;
+                restartWaitFrames += numFrames;
+                std::fill_n(outputData, numFrames * channelCount, int16_t(0));
+                return 1.0;
+            }
+            prebuffering = true; // Realinhar no frame que deve sair agora
+        }
+        awaitingOutputTimestamp = false;
+    }
+    if (isScheduledNow && !alignToSchedule(output, outputData, numFrames, scheduleErrorUs))
+    {
+        return 1.0;
+    }
+
+    int32_t bufferedFrames = ring.availableToRead() + resampler.bufferedFrames();
+    int32_t targetFrames = jitterBuffer.targetFrames();
+
+    // ✅ LIMITE DE LATÊNCIA: descartar os frames mais antigos acima do máximo.
+    // Excesso grande (rajada após travada da rede) também é cortado até o alvo,
+    // porque drenar a ±0.5% levaria minutos. No modo sincronizado a profundidade
+    // é ditada pelo atraso comum: só o teto absoluto vale. O corte é em bursts
+    // inteiros e com crossfade, sem clique na emenda.
+    int32_t trimLimit = isScheduledNow ? maxBufferFrames
+                                       : std::min(maxBufferFrames, targetFrames + msToFrames(EXCESS_TRIM_MS));
+    int32_t trimTarget = isScheduledNow ? maxBufferFrames : targetFrames;
+    if (!prebuffering.load() && bufferedFrames > trimLimit)
+    {
+        bufferedFrames -= dropOldest(bufferedFrames - trimTarget);
+    }
+
+    // ✅ PREBUFFERING BASEADO NO NÍVEL DO RING (em frames)
+    // No início rápido basta alguns bursts; o resto do alvo enche tocando mais devagar
+    if (prebuffering.load())
+    {
+        int32_t startFrames = fastStart.load() ? fastStartFrames(targetFrames) : targetFrames;
+
+        prebufferingCallbacks++;
+
+        // ⚠️ TIMEOUT: Se ficar mais de 10 segundos prebuffering, desistir
+        // (300 callbacks × 10ms callback = 3000ms, mas com margem)
+        if (prebufferingCallbacks > 1000 && bufferedFrames == 0)
+        {
+            postLog(RealtimeLog::PREBUFFER_TIMEOUT, prebufferingCallbacks.load());
+            prebuffering = false;
+            prebufferingCallbacks = 0;
+            // Continuar reproduzindo silêncio em vez de travar
+        }
+        else if (bufferedFrames < startFrames)
+        {
+            std::fill_n(outputData, numFrames * channelCount, int16_t(0));
+
+            if (totalCallbacks % 50 == 0)
+            {
+                postLog(RealtimeLog::PREBUFFER_PROGRESS, bufferedFrames, framesToMs(bufferedFrames),
+                        framesToMs(startFrames), prebufferingCallbacks.load());
+            }
+            return 1.0;
+        }
+        else
+        {
+            prebuffering = false;
+            prebufferingCallbacks = 0;
+            // ✅ RESETAR CONTADORES PARA CÁLCULO CORRETO DO DRIFT
+            startTimeMs = clock.nowMs();
+            totalFramesWritten = 0;
+            jitterBuffer.resetConsumer();
+            if (fastStart.load())
+            {
+                // Fade-in na rampa de ganho em vez de começar no volume cheio
+                gainRamp.reset(0.0f);
+                buildingBuffer = bufferedFrames < targetFrames;
+            }
+            postLog(RealtimeLog::PREBUFFER_DONE, bufferedFrames, framesToMs(bufferedFrames),
+                    framesToMs(targetFrames));
+        }
+    }
+
+    // ✅ LER DO RING PARA O BUFFER DE SAÍDA COM REAMOSTRAGEM FINA
+    // ratio > 1 consome mais rápido (buffer acima do alvo), < 1 mais devagar
+    auto sourceFrames = static_cast<int32_t>(numFrames * rateRatio);
+    double ratio = isScheduledNow ? scheduler.updateRatio(scheduleErrorUs)
+                                  : jitterBuffer.updateRatio(bufferedFrames, sourceFrames);
+    if (!isScheduledNow && (buildingBuffer.load() || stretchRatio < 1.0))
+        ratio = fastStartRatio(bufferedFrames, targetFrames);
+    int32_t framesRead = resampler.process(ring, outputData, numFrames, ratio * rateRatio);
+    int32_t samplesRead = framesRead * channelCount;
+
+    // ✅ APLICAR VOLUME NO PRÓPRIO BUFFER DE SAÍDA (SIMD, rampa e saturação)
+    gainRamp.process(outputData, framesRead, channelCount, volumeLevel.load());
+
+    if (framesRead < numFrames)
+    {
+        // Buffer vazio - silêncio no restante
+        std::fill_n(outputData + samplesRead,
+                    (numFrames - framesRead) * channelCount,
+                    int16_t(0));
+
+        underrunCount++;
+        jitterBuffer.noteUnderrun();
+
+        // ✅ VOLTAR AO PREBUFFERING após 10 underruns com o ring vazio. No início
+        // rápido já no primeiro: o prebuffer custa poucos bursts e volta com fade-in
+        bool ringEmpty = ring.availableToRead() == 0;
+        if (ringEmpty && (fastStart.load() || underrunCount % 10 == 0))
+        {
+            prebuffering = true;
+            prebufferingCallbacks = 0;
+            buildingBuffer = false;
+            stretchRatio = 1.0;
+            postLog(RealtimeLog::UNDERRUN_REBUFFER, underrunCount.load());
+        }
+        else if (underrunCount % 100 == 0)
+        {
+            postLog(RealtimeLog::UNDERRUN, underrunCount.load(), ring.availableToRead(),
+                    framesToMs(ring.availableToRead()));
+        }
+    }
+
+    // ✅ CONTAR FRAMES APENAS QUANDO NÃO ESTÁ EM PREBUFFERING
+    if (!prebuffering.load())
+    {
+        totalFramesWritten += numFrames;
+    }
+
+    return ratio;
+}
+
+// ✅ ALINHAMENTO AO AGENDAMENTO (início, retomada ou erro grande)
+// Adiantado: silêncio até o instante do head. Atrasado: pular os frames que
+// já deveriam ter tocado. Em regime o erro pequeno é corrigido só pela razão.
+bool PlayerCore::alignToSchedule(const AudioOutputStream &output, int16_t *outputData, int32_t numFrames,
+                                 int64_t &errorUs)
+{
+    int64_t presentUs = scheduler.presentationTimeUs(output, clock.nowUs());
+    errorUs = scheduler.errorUs(readHeadFrame(), presentUs);
+
+    if (!prebuffering.load() && std::abs(errorUs) <= PlayoutScheduler::REALIGN_THRESHOLD_US)
+        return true;
+
+    int32_t channelCount = configuredChannelCount; // outputData está no layout da fonte
+    int64_t halfCallbackUs = (static_cast<int64_t>(numFrames) * 500000LL) / std::max(output.getSampleRate(), 1);
+
+    if (errorUs > halfCallbackUs)
+    {
+        // Atrasado: descartar até o frame que deveria sair agora
+        resampler.reset();
+        errorUs = scheduler.errorUs(readHeadFrame(), presentUs);
+        auto lateFrames = static_cast<int32_t>((errorUs * configuredSampleRate) / 1000000LL);
+        int32_t skipped = ring.discard(lateFrames);
+        droppedFrames += skipped;
+        errorUs = scheduler.errorUs(readHeadFrame(), presentUs);
+
+        if (skipped < lateFrames)
+        {
+            // Os dados do "agora" ainda não chegaram: atraso de reprodução menor que o da rede
+            std::fill_n(outputData, numFrames * channelCount, int16_t(0));
+            prebuffering = true;
+            if (++prebufferingCallbacks % 250 == 1)
+            {
+                postLog(RealtimeLog::SCHEDULE_LATE, errorUs / 1000, scheduler.getPlayoutDelayMs());
+            }
+            return false;
+        }
+    }
+    else if (errorUs < -halfCallbackUs)
+    {
+        // Adiantado: segurar (o buffer enche até o atraso comum)
+        std::fill_n(outputData, numFrames * channelCount, int16_t(0));
+        prebuffering = true;
+        return false;
+    }
+
+    if (ring.availableToRead() < numFrames)
+    {
+        std::fill_n(outputData, numFrames * channelCount, int16_t(0));
+        prebuffering = true;
+        return false;
+    }
+
+    prebuffering = false;
+    prebufferingCallbacks = 0;
+    startTimeMs = clock.nowMs();
+    totalFramesWritten = 0;
+    scheduler.resetConsumer();
+    if (fastStart.load())
+        gainRamp.reset(0.0f);
+    postLog(RealtimeLog::SCHEDULE_ALIGNED, errorUs, framesToMs(ring.availableToRead()));
+    return true;
+}
+
+int32_t PlayerCore::burstSourceFrames() const
+{
+    return static_cast<int32_t>((static_cast<int64_t>(framesPerBurst.load()) * configuredSampleRate) /
+                                std::max(outputSampleRate.load(), 1));
+}
+
+int32_t PlayerCore::dropOldest(int32_t frames)
+{
+    // Bursts inteiros (sem burst conhecido, blocos do tamanho do crossfade)
+    int32_t burst = burstSourceFrames();
+    int32_t block = burst > 0 ? burst : std::max(dropCrossfadeFrames, 1);
+    int32_t available = ring.availableToRead();
+    int32_t fade = std::min(dropCrossfadeFrames, available / 2);
+    int32_t drop = std::min(((frames + block - 1) / block) * block, available - fade);
+    if (drop <= 0)
+        return 0;
+
+    // ✅ CROSSFADE: o novo head entra por cima da continuação do head antigo
+    if (fade > 0)
+    {
+        int32_t channelCount = configuredChannelCount;
+        ring.peek(0, dropFadeOut.data(), fade);
+        ring.peek(drop, dropFadeIn.data(), fade);
+        for (int32_t i = 0; i < fade; i++)
+        {
+            float in = static_cast<float>(i + 1) / static_cast<float>(fade + 1);
+            for (int32_t ch = 0; ch < channelCount; ch++)
+            {
+                size_t index = static_cast<size_t>(i) * channelCount + ch;
+                dropFadeIn[index] = static_cast<int16_t>(dropFadeOut[index] * (1.0f - in) + dropFadeIn[index] * in);
+            }
+        }
+        ring.overwrite(drop, dropFadeIn.data(), fade);
+    }
+
+    int32_t dropped = ring.discard(drop);
+    droppedFrames += dropped;
+    jitterBuffer.resetConsumer();
+    return dropped;
+}
+
+int32_t PlayerCore::fastStartFrames(int32_t targetFrames) const
+{
+    auto frames = static_cast<int32_t>(std::max<int64_t>(FAST_START_BURSTS * static_cast<int64_t>(burstSourceFrames()),
+                                                         msToFrames(FAST_START_MIN_MS)));
+    return std::min(frames, targetFrames);
+}
+
+double PlayerCore::fastStartRatio(int32_t bufferedFrames, int32_t targetFrames)
+{
+    if (buildingBuffer.load() && bufferedFrames >= targetFrames)
+    {
+        buildingBuffer = false;
+        postLog(RealtimeLog::BUFFER_AT_TARGET, framesToMs(bufferedFrames));
+    }
+
+    // Rampa da razão: sem salto de afinação ao entrar e ao sair do modo lento
+    double goal = buildingBuffer.load() ? 1.0 - FAST_START_STRETCH : 1.0;
+    stretchRatio += std::clamp(goal - stretchRatio, -FAST_START_RATIO_STEP, FAST_START_RATIO_STEP);
+    if (!buildingBuffer.load() && stretchRatio >= 1.0)
+    {
+        stretchRatio = 1.0;
+        jitterBuffer.resetConsumer(); // O controle de drift assume a partir de 1.0
+    }
+    return stretchRatio;
+}
+
+void PlayerCore::getStats(int64_t *out)
+{
+    std::fill_n(out, static_cast<int32_t>(stats::COUNT), int64_t(0));
+    telemetry.snapshotInto(out);
+
+    int32_t bufferedFrames = getBufferedFrames();
+    out[stats::SAMPLE_RATE] = configuredSampleRate;
+    out[stats::CALLBACKS] = totalCallbacks.load();
+    out[stats::UNDERRUNS] = underrunCount.load();
+    out[stats::XRUNS] = -1;
+    out[stats::DROPPED_FRAMES] = droppedFrames.load();
+    out[stats::BUFFER_FRAMES] = bufferedFrames;
+    out[stats::TARGET_FRAMES] = jitterBuffer.targetFrames();
+    out[stats::MAX_BUFFER_FRAMES] = maxBufferFrames;
+    out[stats::ARRIVAL_JITTER_US] = static_cast<int64_t>(jitterBuffer.arrivalJitterMs() * 1000.0f);
+    out[stats::CHUNK_INTERVAL_US] = static_cast<int64_t>(smoothedChunkInterval.load() * 1000.0f);
+    out[stats::SYNC_ERROR_US] = scheduler.lastErrorUs();
+    out[stats::LOST_PACKETS] = getLostPackets();
+    out[stats::LATE_PACKETS] = getLatePackets();
+    out[stats::REORDERED_PACKETS] = getReorderedPackets();
+    out[stats::CONCEALED_PACKETS] = getConcealedPackets();
+    out[stats::SILENT_PACKETS] = getSilentPackets();
+    out[stats::RECEIVED_PACKETS] = getReceivedPackets();
+
+    out[stats::STATE] = (playing.load() ? stats::STATE_PLAYING : 0) |
+                        (prebuffering.load() ? stats::STATE_PREBUFFERING : 0) |
+                        (scheduled.load() ? stats::STATE_SCHEDULED : 0) |
+                        (buildingBuffer.load() ? stats::STATE_BUILDING : 0);
+
+    // ✅ Drift medido (o que o antigo log "📊 Playback" mostrava): frames entregues
+    // desde o fim do prebuffer contra o relógio do sistema. Só depois de 1s de dados.
+    int64_t started = startTimeMs.load();
+    int64_t elapsedMs = started > 0 ? clock.nowMs() - started : 0;
+    if (elapsedMs > 1000 && !prebuffering.load())
+    {
+        double actualRate = (static_cast<double>(totalFramesWritten.load()) * 1000.0) / elapsedMs;
+        out[stats::CLOCK_DRIFT_PPM] =
+            static_cast<int64_t>((actualRate / outputSampleRate.load() - 1.0) * 1000000.0);
+    }
+}
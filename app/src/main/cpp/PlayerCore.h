@@ -0,0 +1,258 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "AudioOutputStream.h"
+#include "SpscFrameRing.h"
+#include "AdaptiveJitterBuffer.h"
+#include "PlayoutScheduler.h"
+#include "DriftResampler.h"
+#include "AudioKernels.h"
+#include "ReorderBuffer.h"
+#include "LossConcealer.h"
+#include "PlayerTelemetry.h"
+#include "OutputStage.h"
+#include "RealtimeLog.h"
+#include "SilenceDetector.h"
+
+// ✅ Núcleo do player, independente de plataforma
+//
+// Contém o buffer (ring SPSC), o jitter buffer adaptativo, o reamostrador, o ganho
+// e a máquina de estados de prebuffer/underrun. O ring fica no formato da fonte; a
+// taxa, os canais e o formato do dispositivo são adaptados na saída (reamostrador e
+// OutputStage). Não conhece Oboe nem JNI:
+//  - Produtor (thread JNI ou simulador): write()
+//  - Consumidor (callback de áudio ou FakeAudioStream): render()
+class PlayerCore
+{
+public:
+    // O prebuffer e o nível em regime vêm do AdaptiveJitterBuffer (40ms..1000ms)
+    // ✅ Teto do buffer em duração (não em chunks): o ring tem exatamente esse tamanho
+    // (mais a folga) na taxa configurada, qualquer que seja o tamanho dos chunks
+    static constexpr int32_t DEFAULT_MAX_BUFFER_MS = 10000; // Equivale aos antigos 500 chunks de 20ms
+    static constexpr int32_t MIN_MAX_BUFFER_MS = 1500;      // Alvo máximo do jitter buffer + corte
+    static constexpr int32_t MAX_MAX_BUFFER_MS = 60000;
+    static constexpr int32_t DROP_CROSSFADE_MS = 5;         // Emenda ao descartar os mais antigos
+    static constexpr int32_t EXCESS_TRIM_MS = 300;  // Acima do alvo + isso, cortar em vez de reamostrar
+    static constexpr int32_t MAX_CHUNK_FRAMES = 5760; // 120ms a 48kHz: maior chunk com sequência
+    static constexpr uint32_t MAX_CONCEAL_PACKETS = 5; // Buraco maior: emendar sem concealment
+    static constexpr int32_t MAX_RESTART_WAIT_MS = 300; // Espera pelo timestamp do stream novo
+
+    // ✅ Início rápido (setFastStart): a saída começa com FAST_START_BURSTS bursts no
+    // buffer (no mínimo FAST_START_MIN_MS), com fade-in, e toca FAST_START_STRETCH mais
+    // devagar até o buffer chegar ao alvo do jitter buffer
+    static constexpr int32_t FAST_START_BURSTS = 3;
+    static constexpr int32_t FAST_START_MIN_MS = 30;
+    static constexpr double FAST_START_STRETCH = 0.02;      // 2% (~1/3 de semitom): 90ms em ~4.5s
+    static constexpr double FAST_START_RATIO_STEP = 0.0005; // Por callback: entra e sai sem salto
+
+    explicit PlayerCore(const PlayerClock &clock = PlayerClock::system());
+    PlayerCore(const PlayerCore &) = delete;
+    PlayerCore &operator=(const PlayerCore &) = delete;
+
+    // Aloca buffers e zera contadores. Só com produtor e consumidor parados.
+    // maxBufferMs é limitado a [MIN_MAX_BUFFER_MS, MAX_MAX_BUFFER_MS].
+    void configure(int32_t sampleRate, int32_t channelCount, int32_t maxBufferMs = DEFAULT_MAX_BUFFER_MS);
+    void setFramesPerBurst(int32_t frames) { framesPerBurst = frames; }
+    void setFastStart(bool enabled) { fastStart = enabled; }
+    // Marcadores de silêncio (DTX) viram ruído de conforto no nível do sender, não zeros
+    void setComfortNoise(bool enabled) { comfortNoise = enabled; }
+    bool isComfortNoise() const { return comfortNoise.load(); }
+
+    // Mensagens do callback vão para `log` (nullptr descarta), com o id do sender.
+    // Só com o callback parado.
+    void setLog(RealtimeLog *log, int32_t sourceId)
+    {
+        rtLog = log;
+        logSource = sourceId;
+    }
+
+    // Taxa negociada com o dispositivo. Diferente da fonte liga o conversor sinc.
+    // Só com o callback parado (antes de abrir/depois de fechar o stream).
+    void setOutputSampleRate(int32_t sampleRate);
+
+    void start();
+    void stop();
+    void requestClear();
+
+    // O stream de saída foi reaberto (recuperação): o buffer segue intacto, sem novo
+    // prebuffer. No modo sincronizado, o callback segura o áudio até o stream novo
+    // ter latência medida (ou MAX_RESTART_WAIT_MS) e então realinha na posição certa.
+    void notifyOutputRestarted() { outputRestarted = true; }
+
+    // ✅ PRODUTOR: PCM16 little-endian intercalado, com ou sem cabeçalho SHB1
+    // (PacketFormat.h). Chunk inteiro ou nada. Com cabeçalho, passa pela janela de
+    // reordenação: atrasados/duplicados voltam false e buracos viram concealment.
+    bool write(const uint8_t *bytes, int32_t length);
+
+    // ✅ PRODUTOR: vários pacotes no formato de write(), publicados para o callback
+    // num único passo (um store no ring em vez de um por chunk). O pacote i vai de
+    // offsets[i] a offsets[i + 1] (count + 1 posições). Retorna quantos foram aceitos.
+    int32_t writeBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count);
+
+    // ✅ PRODUTOR: frames já decodificados; captureTimeUs = PlayoutScheduler::NO_TIMESTAMP se não houver
+    bool writeFrames(const int16_t *samples, int32_t numFrames, int64_t captureTimeUs);
+
+    // ✅ CONSUMIDOR: preenche numFrames frames no formato/layout de output
+    // (silêncio em prebuffer/underrun)
+    void render(const AudioOutputStream &output, void *outputData, int32_t numFrames);
+
+    bool setVolume(float volume);
+
+    // ✅ Reprodução sincronizada: offset do relógio do servidor e atraso comum
+    void setClockOffsetUs(int64_t offsetUs) { scheduler.setClockOffsetUs(offsetUs); }
+    void setPlayoutDelayMs(int32_t ms) { scheduler.setPlayoutDelayMs(ms); }
+
+    // Getters
+    bool isPlaying() const { return playing.load(); }
+    bool isPrebuffering() const { return prebuffering.load(); }
+    bool isFastStart() const { return fastStart.load(); }
+    bool isBuildingBuffer() const { return buildingBuffer.load(); } // Início rápido, abaixo do alvo
+    int32_t getBufferedFrames() const;
+    int32_t getBufferedMs() const { return framesToMs(getBufferedFrames()); }
+    int32_t getMaxBufferFrames() const { return maxBufferFrames; }
+    int32_t getUnderrunCount() const { return underrunCount.load(); }
+    int64_t getDroppedFrames() const { return droppedFrames.load(); }
+    int32_t getTargetFrames() const { return jitterBuffer.targetFrames(); }
+    int32_t getSampleRate() const { return configuredSampleRate; }
+    int32_t getChannelCount() const { return configuredChannelCount; }
+    int32_t getOutputSampleRate() const { return outputSampleRate.load(); }
+    bool isScheduled() const { return scheduled.load(); }
+    int64_t getSyncErrorUs() const { return scheduler.lastErrorUs(); }
+    int32_t getPlayoutDelayMs() const { return scheduler.getPlayoutDelayMs(); }
+
+    // ✅ Perdas no caminho PCM com sequência
+    int64_t getLostPackets() const { return reorder.getLostPackets(); }
+    int64_t getLatePackets() const { return reorder.getLatePackets(); } // Atrasados + duplicados
+    int64_t getReceivedPackets() const { return reorder.getReceivedPackets(); }
+    int64_t getReorderedPackets() const { return reorder.getReorderedPackets(); }
+    int64_t getConcealedPackets() const { return concealedPackets.load(); }
+    int64_t getSilentPackets() const { return silentPackets.load(); } // Marcadores DTX
+
+    // ✅ Telemetria completa num array de stats::COUNT posições (PlayerTelemetry.h).
+    // Sem stream não há contagem de xruns: XRUNS sai -1 e a camada Oboe preenche.
+    void getStats(int64_t *out);
+
+    int32_t msToFrames(int32_t ms) const
+    {
+        return static_cast<int32_t>((static_cast<int64_t>(ms) * configuredSampleRate) / 1000);
+    }
+
+    int32_t framesToMs(int32_t frames) const
+    {
+        return static_cast<int32_t>((static_cast<int64_t>(frames) * 1000) / configuredSampleRate);
+    }
+
+private:
+    // Índice (fracionário) no ring do próximo frame que vai para a saída
+    double readHeadFrame() const
+    {
+        return static_cast<double>(ring.readPosition()) - resampler.pendingFrames();
+    }
+
+    // Modo sincronizado: segura ou corta até o head coincidir com o agendamento.
+    // false = escreveu silêncio e o callback deve terminar.
+    bool alignToSchedule(const AudioOutputStream &output, int16_t *outputData, int32_t numFrames,
+                         int64_t &errorUs);
+
+    // Corpo do callback, em PCM16 no layout da fonte; render() mede a duração e
+    // converte para o dispositivo. Devolve a razão de drift aplicada.
+    double renderBlock(const AudioOutputStream &output, int16_t *outputData, int32_t numFrames);
+
+    // Início rápido: nível (frames da fonte) para sair do prebuffer, e a razão
+    // mais lenta enquanto o buffer sobe até o alvo (só o consumidor)
+    int32_t fastStartFrames(int32_t targetFrames) const;
+    double fastStartRatio(int32_t bufferedFrames, int32_t targetFrames);
+
+    // Descarta os frames mais antigos do ring, arredondados para bursts inteiros,
+    // com crossfade do head antigo para o novo. Devolve frames descartados.
+    int32_t dropOldest(int32_t frames);
+    int32_t burstSourceFrames() const; // Burst do dispositivo em frames da fonte
+
+    // ✅ Log do callback: só empilha o registro (RealtimeLog), nunca chama o logd
+    void postLog(RealtimeLog::Code code, int64_t a = 0, int64_t b = 0, int64_t c = 0, int64_t d = 0)
+    {
+        if (rtLog != nullptr)
+            rtLog->post(code, logSource, a, b, c, d);
+    }
+
+    // Pacote PCM liberado pela janela de reordenação, com os perdidos logo antes dele
+    void deliverSequenced(const ReorderBuffer::Entry &entry, uint32_t lostBefore);
+    const int16_t *expandSilence(const ReorderBuffer::Entry &entry, int32_t &numFrames);
+
+    const PlayerClock &clock;
+
+    // ✅ Ring buffer SPSC de frames: sem mutex e sem alocação no callback
+    SpscFrameRing ring;
+    std::atomic<bool> clearRequested{false}; // Limpeza é feita pelo consumidor
+    std::atomic<bool> outputRestarted{false};
+    bool awaitingOutputTimestamp = false; // Consumidor
+    int32_t restartWaitFrames = 0;
+
+    // ✅ Profundidade alvo adaptativa + reamostragem fina para compensar drift
+    AdaptiveJitterBuffer jitterBuffer;
+    DriftResampler resampler;
+    OutputStage outputStage;
+
+    // ✅ Agenda de saída em relógio compartilhado (chunks com timestamp)
+    PlayoutScheduler scheduler;
+    std::atomic<bool> scheduled{false};
+    bool lastChunkTimestamped = false; // Produtor: só avisar a troca de modo
+    bool batching = false;             // Produtor: writeBatch() em andamento (ring.stage)
+
+    // ✅ Sequência, reordenação e concealment (só o produtor mexe)
+    ReorderBuffer reorder;
+    LossConcealer concealer;
+    std::vector<int16_t> concealScratch;
+    int32_t lastSequencedFrames = 0;
+    std::atomic<bool> sequenceResetRequested{false}; // stop/limpeza vindos de outra thread
+    std::atomic<int64_t> concealedPackets{0};
+
+    // ✅ DTX (só o produtor mexe no buffer): sem alocação por marcador
+    std::vector<int16_t> silenceScratch;
+    bool silenceScratchZero = true;
+    uint32_t noiseSeed = 22222;
+    std::atomic<bool> comfortNoise{false};
+    std::atomic<int64_t> silentPackets{0};
+
+    std::atomic<int32_t> underrunCount{0};
+    std::atomic<bool> playing{false};
+    std::atomic<bool> prebuffering{true};
+    std::atomic<int32_t> totalCallbacks{0};
+    std::atomic<int32_t> prebufferingCallbacks{0}; // ✅ Contador de callbacks em prebuffering
+    std::atomic<bool> fastStart{false};
+    std::atomic<bool> buildingBuffer{false}; // Escrito só pelo consumidor
+    double stretchRatio = 1.0;               // Consumidor
+
+    // Rastreamento
+    std::atomic<int64_t> totalFramesWritten{0};
+    std::atomic<int64_t> startTimeMs{0};
+    std::atomic<int32_t> chunksAdded{0};
+    std::atomic<int64_t> droppedFrames{0};
+    std::atomic<int32_t> rejectedChunks{0};
+
+    // ✅ Timing simples para debug
+    std::atomic<int64_t> lastChunkTimeMs{0};
+    std::atomic<float> smoothedChunkInterval{20.0f};
+
+    RealtimeLog *rtLog = nullptr;
+    int32_t logSource = 0;
+
+    // ✅ Histogramas e medidas do callback, lidos por getStats()
+    PlayerTelemetry telemetry;
+
+    // ✅ Controle de volume
+    std::atomic<float> volumeLevel{1.0f}; // 0.0 a 1.0 (alvo)
+    GainRamp gainRamp;                    // Rampa até o alvo, só no callback
+
+    // Configuração
+    int32_t configuredSampleRate = 48000;
+    int32_t configuredChannelCount = 2;
+    std::atomic<int32_t> outputSampleRate{48000};
+    std::atomic<int32_t> framesPerBurst{0};
+    int32_t maxBufferFrames = 0; // maxBufferMs na taxa configurada
+    int32_t dropCrossfadeFrames = 0;
+    std::vector<int16_t> dropFadeOut; // Head antigo (consumidor)
+    std::vector<int16_t> dropFadeIn;  // Head novo, misturado e reescrito no ring
+};
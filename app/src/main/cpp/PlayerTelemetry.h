@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+// ✅ Telemetria do callback de áudio, sem lock e sem log na thread de tempo real
+//
+// O callback grava com stores relaxed (um escritor só); a UI lê quando quiser com
+// snapshotInto(). Não é um retrato atômico do conjunto: cada campo é coerente sozinho,
+// o que basta para estatística. Os índices do array exportado (stats::) são
+// espelhados em PlayerStats.kt — só acrescentar no fim.
+namespace stats
+{
+    constexpr int32_t HISTOGRAM_BUCKETS = 12;
+
+    enum Index : int32_t
+    {
+        SAMPLE_RATE = 0,
+        CALLBACKS,
+        UNDERRUNS,
+        XRUNS,             // stream->getXRunCount() (-1 = não suportado)
+        DROPPED_FRAMES,
+        BUFFER_FRAMES,
+        TARGET_FRAMES,
+        RATIO_PPM,         // Correção do reamostrador
+        CLOCK_DRIFT_PPM,   // Frames entregues vs relógio do sistema, desde o fim do prebuffer
+        ARRIVAL_JITTER_US,
+        CHUNK_INTERVAL_US,
+        CALLBACK_LAST_US,
+        CALLBACK_MAX_US,   // Maior desde a leitura anterior
+        SYNC_ERROR_US,
+        STATE,             // STATE_* abaixo
+        LOST_PACKETS,
+        LATE_PACKETS,
+        REORDERED_PACKETS,
+        CONCEALED_PACKETS,
+        CALLBACK_HISTOGRAM, // HISTOGRAM_BUCKETS entradas: duração do callback
+        FILL_HISTOGRAM = CALLBACK_HISTOGRAM + HISTOGRAM_BUCKETS, // Nível do buffer no fim do callback
+        STREAM_RECOVERIES = FILL_HISTOGRAM + HISTOGRAM_BUCKETS, // Streams reabertos após erro/troca de rota
+        SOURCES,                                                // Senders no mixer (camada Oboe)
+        DEVICE_BUFFER_US,                                       // Buffer do stream (DeviceBufferTuner)
+        OUTPUT_LATENCY_US,                                      // calculateLatencyMillis() (-1 = indisponível)
+        TOTAL_LATENCY_US,                                       // Buffer da rede + latência de saída
+        BUFFER_GROWTHS,                                         // Bursts acrescentados por xrun
+        UDP_DATAGRAMS,                                          // Aceitos pelo UdpReceiver
+        UDP_DROPPED,                                            // Recusados ou descartados pelo UdpReceiver
+        MAX_BUFFER_FRAMES,                                      // Teto do buffer (maxBufferMs na taxa da fonte)
+        CALLBACK_BUDGET_US,                                     // Período do último callback (numFrames/taxa)
+        CALLBACK_LOAD_PERMILLE,                                 // Duração/período, média móvel (CallbackBudget)
+        CALLBACK_LOAD_MAX_PERMILLE,                             // Maior desde a leitura anterior
+        CALLBACK_OVER_BUDGET,                                   // Callbacks acima de 80% do período
+        CALLBACK_CPU,                                           // Núcleo do callback (-1 = desconhecido)
+        CALLBACK_CPU_MASK,                                      // Núcleos fixados (0 = sem afinidade)
+        PERFORMANCE_HINT,                                       // Sessão ADPF pedida ao Oboe (1 = sim)
+        SILENT_PACKETS,                                         // Marcadores de silêncio (DTX) tocados
+        RECEIVED_PACKETS,                                       // Pacotes com sequência aceitos (base da perda)
+        POWER_SAVING,                                           // Stream em modo de economia (1 = PowerSaving)
+        CALLBACK_FRAMES,                                        // Frames do último callback
+        CALLBACK_WAKEUPS_PER_S,                                 // Callbacks por segundo (WakeupMeter)
+        INGEST_WAKEUPS_PER_S,                                   // Entregas ao player por segundo (JNI + UDP)
+        COUNT
+    };
+
+    constexpr int64_t STATE_PLAYING = 1;
+    constexpr int64_t STATE_PREBUFFERING = 2;
+    constexpr int64_t STATE_SCHEDULED = 4;
+    constexpr int64_t STATE_BUILDING = 8; // Início rápido: tocando mais devagar até o alvo
+
+    // Limite superior (exclusivo) de cada bucket; o último acumula o resto
+    constexpr int64_t CALLBACK_BUCKET_BASE_US = 25; // 25, 50, 100 ... 25.6ms
+    constexpr int64_t FILL_BUCKET_BASE_MS = 10;     // 10, 20, 40 ... 10.24s
+}
+
+class PlayerTelemetry
+{
+public:
+    // Só com o callback parado
+    void reset()
+    {
+        for (auto &bucket : callbackHistogram)
+            bucket.store(0, std::memory_order_relaxed);
+        for (auto &bucket : fillHistogram)
+            bucket.store(0, std::memory_order_relaxed);
+        lastCallbackUs.store(0, std::memory_order_relaxed);
+        maxCallbackUs.store(0, std::memory_order_relaxed);
+        ratioPpm.store(0, std::memory_order_relaxed);
+    }
+
+    // ✅ CONSUMIDOR: uma vez por callback, no fim
+    void recordCallback(int64_t durationUs, int32_t fillMs, double ratio)
+    {
+        bump(callbackHistogram[bucketFor(durationUs, stats::CALLBACK_BUCKET_BASE_US)]);
+        bump(fillHistogram[bucketFor(fillMs, stats::FILL_BUCKET_BASE_MS)]);
+        lastCallbackUs.store(durationUs, std::memory_order_relaxed);
+        if (durationUs > maxCallbackUs.load(std::memory_order_relaxed))
+            maxCallbackUs.store(durationUs, std::memory_order_relaxed);
+        ratioPpm.store(std::llround((ratio - 1.0) * 1000000.0), std::memory_order_relaxed);
+    }
+
+    // Qualquer thread (um leitor por vez: o máximo é zerado a cada leitura)
+    void snapshotInto(int64_t *out)
+    {
+        out[stats::CALLBACK_LAST_US] = lastCallbackUs.load(std::memory_order_relaxed);
+        out[stats::CALLBACK_MAX_US] = maxCallbackUs.exchange(0, std::memory_order_relaxed);
+        out[stats::RATIO_PPM] = ratioPpm.load(std::memory_order_relaxed);
+        for (int32_t i = 0; i < stats::HISTOGRAM_BUCKETS; i++)
+        {
+            out[stats::CALLBACK_HISTOGRAM + i] = callbackHistogram[i].load(std::memory_order_relaxed);
+            out[stats::FILL_HISTOGRAM + i] = fillHistogram[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    static int32_t bucketFor(int64_t value, int64_t base)
+    {
+        int32_t bucket = 0;
+        for (int64_t limit = base; value >= limit && bucket < stats::HISTOGRAM_BUCKETS - 1; limit <<= 1)
+            bucket++;
+        return bucket;
+    }
+
+private:
+    // Escritor único: load + store relaxed em vez de fetch_add (sem RMW no callback)
+    static void bump(std::atomic<int64_t> &counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<int64_t>, stats::HISTOGRAM_BUCKETS> callbackHistogram{};
+    std::array<std::atomic<int64_t>, stats::HISTOGRAM_BUCKETS> fillHistogram{};
+    std::atomic<int64_t> lastCallbackUs{0};
+    std::atomic<int64_t> maxCallbackUs{0};
+    std::atomic<int64_t> ratioPpm{0};
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+#include "AudioOutputStream.h"
+#include "SpscQueue.h"
+
+// ✅ Agendamento de reprodução em relógio compartilhado
+//
+// Cada chunk com timestamp deixa uma âncora (frame do ring -> instante de captura
+// no relógio do servidor). Com o offset servidor/local (ClockSync no Kotlin) e um
+// atraso de reprodução comum a todos os receptores, cada frame tem um instante
+// de saída absoluto: captura + atraso. O consumidor compara esse instante com o
+// horário em que o próximo frame realmente sai no alto-falante (getTimestamp do
+// stream) e corrige a diferença com a razão do DriftResampler, sem pulos.
+class PlayoutScheduler
+{
+public:
+    static constexpr int64_t NO_TIMESTAMP = INT64_MIN;
+    static constexpr int32_t DEFAULT_PLAYOUT_DELAY_MS = 300;
+    static constexpr int32_t MAX_PLAYOUT_DELAY_MS = 5000;
+    static constexpr int64_t REALIGN_THRESHOLD_US = 100000; // Acima disso: cortar/esperar em vez de reamostrar
+    static constexpr double ANCHOR_SMOOTHING = 8.0;         // Suaviza o jitter dos timestamps do sender
+    static constexpr double RATIO_GAIN_PER_S = 0.5;         // 10ms de erro => 0.5%
+    static constexpr double MAX_RATIO_DEVIATION = 0.005;
+    static constexpr double MAX_RATIO_STEP = 0.00005;
+    static constexpr int64_t TIMESTAMP_REFRESH_US = 200000;
+
+    struct Anchor
+    {
+        uint64_t frameIndex;
+        int64_t captureTimeUs; // Relógio do servidor, ou NO_TIMESTAMP
+    };
+
+    void configure(int32_t sampleRate)
+    {
+        rate = std::max(sampleRate, 1);
+        anchors.clear();
+        resetConsumer();
+        resetTimeline();
+        haveAnchor = false;
+        haveTimestamp = false;
+        lastTimestampQueryUs = 0;
+    }
+
+    // ✅ Qualquer thread: offset = relógio do servidor - relógio local (µs)
+    void setClockOffsetUs(int64_t offsetUs)
+    {
+        clockOffsetUs.store(offsetUs, std::memory_order_relaxed);
+        synced.store(true, std::memory_order_release);
+    }
+
+    void setPlayoutDelayMs(int32_t ms)
+    {
+        playoutDelayUs.store(static_cast<int64_t>(std::clamp(ms, 0, MAX_PLAYOUT_DELAY_MS)) * 1000,
+                             std::memory_order_relaxed);
+    }
+
+    bool isSynced() const { return synced.load(std::memory_order_acquire); }
+    int32_t getPlayoutDelayMs() const { return static_cast<int32_t>(playoutDelayUs.load() / 1000); }
+
+    // ✅ PRODUTOR: o frame `frameIndex` do ring foi capturado em captureTimeUs
+    void pushAnchor(uint64_t frameIndex, int64_t captureTimeUs)
+    {
+        anchors.push({frameIndex, captureTimeUs});
+    }
+
+    // ✅ CONSUMIDOR: aplica as âncoras que o head já alcançou.
+    // true se o frame do head tem instante de saída definido.
+    bool hasSchedule(double headFrame)
+    {
+        while (const Anchor *next = anchors.front())
+        {
+            if (haveAnchor && static_cast<double>(next->frameIndex) > headFrame)
+                break;
+            applyAnchor(*next);
+            anchors.pop();
+        }
+        return haveAnchor && timelineValid && isSynced();
+    }
+
+    // ✅ CONSUMIDOR: instante local (µs) em que o próximo frame escrito sai no alto-falante.
+    // getTimestamp pode custar uma ida ao serviço de áudio: só consultar a cada
+    // TIMESTAMP_REFRESH_US e extrapolar pelo contador de frames escritos.
+    int64_t presentationTimeUs(const AudioOutputStream &output, int64_t nowUs)
+    {
+        if (!haveTimestamp || nowUs - lastTimestampQueryUs >= TIMESTAMP_REFRESH_US)
+        {
+            lastTimestampQueryUs = nowUs;
+            int64_t framePosition = 0;
+            int64_t timeNanos = 0;
+            if (output.getTimestamp(framePosition, timeNanos))
+            {
+                timestampFrame = framePosition;
+                timestampUs = timeNanos / 1000;
+                haveTimestamp = true;
+            }
+        }
+
+        // Frames do stream andam na taxa do dispositivo, que pode não ser a da fonte
+        int64_t outputRate = std::max(output.getSampleRate(), 1);
+        int64_t written = output.getFramesWritten();
+        if (haveTimestamp && written >= 0)
+        {
+            return timestampUs + ((written - timestampFrame) * 1000000LL) / outputRate;
+        }
+
+        // Sem timestamp (stream recém-aberto): estimar pela latência nominal do buffer
+        return nowUs + (static_cast<int64_t>(output.getBufferSizeInFrames()) * 1000000LL) / outputRate;
+    }
+
+    // ✅ CONSUMIDOR: stream novo (recuperação). O par frame/instante do stream antigo
+    // não vale mais; até o novo reportar um, hasOutputTimestamp() fica false.
+    void resetOutputTimestamp()
+    {
+        haveTimestamp = false;
+        lastTimestampQueryUs = 0;
+    }
+
+    bool hasOutputTimestamp() const { return haveTimestamp; }
+
+    // ✅ CONSUMIDOR: erro de agendamento (µs) do frame headFrame se ele sair em presentUs.
+    // > 0: atrasado (consumir mais rápido); < 0: adiantado.
+    int64_t errorUs(double headFrame, int64_t presentUs)
+    {
+        double captureUs = anchorTimeUs + ((headFrame - static_cast<double>(anchorFrame)) * 1000000.0) / rate;
+        double targetLocalUs = captureUs - clockOffsetUs.load(std::memory_order_relaxed) +
+                               playoutDelayUs.load(std::memory_order_relaxed);
+        auto error = static_cast<int64_t>(std::llround(presentUs - targetLocalUs));
+        lastError.store(error, std::memory_order_relaxed);
+        return error;
+    }
+
+    // ✅ CONSUMIDOR: razão de reamostragem que zera o erro sem "warble"
+    double updateRatio(int64_t error)
+    {
+        double desired = 1.0 + std::clamp((error / 1000000.0) * RATIO_GAIN_PER_S,
+                                          -MAX_RATIO_DEVIATION, MAX_RATIO_DEVIATION);
+        currentRatio += std::clamp(desired - currentRatio, -MAX_RATIO_STEP, MAX_RATIO_STEP);
+        return currentRatio;
+    }
+
+    // Reinicia a razão (após realinhar)
+    void resetConsumer()
+    {
+        currentRatio = 1.0;
+    }
+
+    // Esquece a linha do tempo: a próxima âncora é aceita sem suavização (limpeza do ring)
+    void resetTimeline()
+    {
+        timelineValid = false;
+    }
+
+    int64_t lastErrorUs() const { return lastError.load(std::memory_order_relaxed); }
+    double ratio() const { return currentRatio; }
+
+private:
+    void applyAnchor(const Anchor &anchor)
+    {
+        haveAnchor = true;
+        if (anchor.captureTimeUs == NO_TIMESTAMP)
+        {
+            // Sender sem timestamp: volta para o modo adaptativo
+            timelineValid = false;
+            anchorFrame = anchor.frameIndex;
+            return;
+        }
+
+        double predictedUs = anchorTimeUs + ((static_cast<double>(anchor.frameIndex) -
+                                              static_cast<double>(anchorFrame)) * 1000000.0) / rate;
+        double deviationUs = anchor.captureTimeUs - predictedUs;
+        if (!timelineValid || std::abs(deviationUs) > REALIGN_THRESHOLD_US)
+        {
+            // Primeira âncora ou descontinuidade (sender reiniciou)
+            anchorTimeUs = static_cast<double>(anchor.captureTimeUs);
+        }
+        else
+        {
+            anchorTimeUs = predictedUs + deviationUs / ANCHOR_SMOOTHING;
+        }
+        anchorFrame = anchor.frameIndex;
+        timelineValid = true;
+    }
+
+    int32_t rate = 48000;
+    SpscQueue<Anchor, 512> anchors;
+
+    // Compartilhado
+    std::atomic<int64_t> clockOffsetUs{0};
+    std::atomic<int64_t> playoutDelayUs{DEFAULT_PLAYOUT_DELAY_MS * 1000LL};
+    std::atomic<bool> synced{false};
+    std::atomic<int64_t> lastError{0};
+
+    // Estado do consumidor
+    bool haveAnchor = false;
+    bool timelineValid = false;
+    uint64_t anchorFrame = 0;
+    double anchorTimeUs = 0.0;
+    double currentRatio = 1.0;
+
+    bool haveTimestamp = false;
+    int64_t lastTimestampQueryUs = 0;
+    int64_t timestampFrame = 0;
+    int64_t timestampUs = 0;
+};
@@ -0,0 +1,154 @@
+#include "RealtimeLog.h"
+#include "NativeLog.h"
+
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+    struct Format
+    {
+        RealtimeLog::Level level;
+        const char *text; // Quatro argumentos long long (os que sobram são ignorados)
+    };
+
+    // Mesma ordem de RealtimeLog::Code
+    constexpr Format FORMATS[RealtimeLog::CODE_COUNT] = {
+        {RealtimeLog::LEVEL_INFO, "⏳ Prebuffering... %lld frames (~%lldms / %lldms target) [callbacks: %lld]"},
+        {RealtimeLog::LEVEL_INFO, "✅ Prebuffering completo! %lld frames (~%lldms buffer, alvo %lldms)"},
+        {RealtimeLog::LEVEL_ERROR, "💀 TIMEOUT: Prebuffering há %lld callbacks sem chunks! Continuando com silêncio"},
+        {RealtimeLog::LEVEL_WARN, "⚠️ Buffer vazio! Prebuffering... (UR: %lld)"},
+        {RealtimeLog::LEVEL_WARN, "⚠️ Underrun #%lld | Ring: %lld frames (~%lldms)"},
+        {RealtimeLog::LEVEL_INFO, "🕒 Reprodução sincronizada (atraso %lldms)"},
+        {RealtimeLog::LEVEL_INFO, "🕒 Sem timestamps, modo adaptativo"},
+        {RealtimeLog::LEVEL_WARN, "⚠️ Chunks chegando %lldms depois do horário agendado (atraso %lldms pequeno demais?)"},
+        {RealtimeLog::LEVEL_INFO, "✅ Alinhado ao agendamento: erro %lldus, buffer ~%lldms"},
+        {RealtimeLog::LEVEL_INFO, "✅ Buffer no alvo (%lldms), velocidade normal"},
+    };
+
+    const char *const CODE_NAMES[RealtimeLog::CODE_COUNT] = {
+        "prebuffer", "prebuffer completo", "timeout", "rebuffer", "underrun",
+        "sincronizado", "adaptativo", "atraso", "alinhamento", "alvo",
+    };
+}
+
+RealtimeLog::RealtimeLog(const PlayerClock &clock) : clock(clock)
+{
+}
+
+RealtimeLog::~RealtimeLog()
+{
+    stop();
+}
+
+RealtimeLog::Level RealtimeLog::levelOf(Code code)
+{
+    return code < CODE_COUNT ? FORMATS[code].level : LEVEL_INFO;
+}
+
+void RealtimeLog::start()
+{
+    if (running.exchange(true))
+        return;
+    thread = std::thread(&RealtimeLog::run, this);
+}
+
+void RealtimeLog::stop()
+{
+    if (!running.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+    drain();
+}
+
+void RealtimeLog::run()
+{
+    while (running.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        drain();
+    }
+}
+
+void RealtimeLog::emit(Level lineLevel, const char *line)
+{
+    if (sink)
+    {
+        sink(lineLevel, line);
+        return;
+    }
+    switch (lineLevel)
+    {
+    case LEVEL_ERROR:
+        LOGE("%s", line);
+        break;
+    case LEVEL_WARN:
+        LOGW("%s", line);
+        break;
+    default:
+        LOGI("%s", line);
+        break;
+    }
+}
+
+// Fim da janela: uma linha por código que passou do limite
+int32_t RealtimeLog::flushSuppressed(int64_t nowMs)
+{
+    int32_t lines = 0;
+    char line[MAX_LINE];
+    for (int32_t code = 0; code < CODE_COUNT; code++)
+    {
+        if (windowSuppressed[code] > 0)
+        {
+            std::snprintf(line, sizeof(line), "🔇 %d mensagens \"%s\" suprimidas em %lldms", windowSuppressed[code],
+                          CODE_NAMES[code], static_cast<long long>(nowMs - windowStartMs));
+            emit(FORMATS[code].level, line);
+            lines++;
+        }
+        windowCount[code] = 0;
+        windowSuppressed[code] = 0;
+    }
+    windowStartMs = nowMs;
+    return lines;
+}
+
+int32_t RealtimeLog::drain()
+{
+    int32_t lines = 0;
+    int64_t nowMs = clock.nowMs();
+    if (nowMs - windowStartMs >= RATE_WINDOW_MS)
+        lines += flushSuppressed(nowMs);
+
+    char line[MAX_LINE];
+    for (const Record *record; (record = queue.front()) != nullptr; queue.pop())
+    {
+        if (record->code >= CODE_COUNT)
+            continue;
+        if (windowCount[record->code]++ >= RATE_LIMIT)
+        {
+            windowSuppressed[record->code]++;
+            suppressed++;
+            continue;
+        }
+
+        // Fontes extras do mixer: prefixo com o id do sender
+        int prefix = record->source != 0 ? std::snprintf(line, sizeof(line), "[%d] ", record->source) : 0;
+        std::snprintf(line + prefix, sizeof(line) - prefix, FORMATS[record->code].text,
+                      static_cast<long long>(record->args[0]), static_cast<long long>(record->args[1]),
+                      static_cast<long long>(record->args[2]), static_cast<long long>(record->args[3]));
+        emit(FORMATS[record->code].level, line);
+        lines++;
+    }
+
+    int64_t droppedNow = dropped.load();
+    if (droppedNow != reportedDropped)
+    {
+        std::snprintf(line, sizeof(line), "⚠️ Log do callback: %lld registros perdidos (fila cheia)",
+                      static_cast<long long>(droppedNow - reportedDropped));
+        emit(LEVEL_WARN, line);
+        reportedDropped = droppedNow;
+        lines++;
+    }
+    return lines;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#include "AudioOutputStream.h"
+#include "SpscQueue.h"
+
+// ✅ Log do callback de áudio sem bloquear no logd
+//
+// O callback só empilha registros de tamanho fixo (código do evento + até quatro
+// inteiros) numa fila SPSC, sem lock, sem alocação e sem formatar nada. Uma
+// thread esvazia a fila a cada DRAIN_INTERVAL_MS, formata pelo texto do código e
+// manda para o LOG*, com no máximo RATE_LIMIT registros de cada código por
+// RATE_WINDOW_MS (os excedentes viram uma linha de "suprimidos").
+//  - Produtor: um só (o callback; as fontes do mixer dividem a mesma thread)
+//  - Consumidor: a thread própria (start/stop) ou drain() direto nos testes
+class RealtimeLog
+{
+public:
+    static constexpr uint32_t QUEUE_RECORDS = 256;
+    static constexpr int32_t DRAIN_INTERVAL_MS = 50;
+    static constexpr int32_t RATE_LIMIT = 5;
+    static constexpr int32_t RATE_WINDOW_MS = 1000;
+    static constexpr int32_t MAX_LINE = 256;
+
+    // Verbosidade: registros acima do nível nem entram na fila
+    enum Level : int32_t
+    {
+        LEVEL_OFF = 0,
+        LEVEL_ERROR = 1,
+        LEVEL_WARN = 2,
+        LEVEL_INFO = 3,
+    };
+
+    enum Code : uint16_t
+    {
+        PREBUFFER_PROGRESS, // frames, ms, alvo ms, callbacks
+        PREBUFFER_DONE,     // frames, ms, alvo ms
+        PREBUFFER_TIMEOUT,  // callbacks
+        UNDERRUN_REBUFFER,  // underruns
+        UNDERRUN,           // underruns, frames no ring, ms no ring
+        SCHEDULED,          // atraso ms
+        UNSCHEDULED,
+        SCHEDULE_LATE,      // atraso dos chunks ms, atraso de reprodução ms
+        SCHEDULE_ALIGNED,   // erro µs, buffer ms
+        BUFFER_AT_TARGET,   // buffer ms
+        CODE_COUNT
+    };
+
+    struct Record
+    {
+        uint16_t code = 0;
+        int16_t source = 0;
+        int64_t args[4] = {};
+    };
+
+    // Destino das linhas formatadas (padrão: LOGE/LOGW/LOGI)
+    using Sink = std::function<void(Level, const char *)>;
+
+    explicit RealtimeLog(const PlayerClock &clock = PlayerClock::system());
+    ~RealtimeLog();
+    RealtimeLog(const RealtimeLog &) = delete;
+    RealtimeLog &operator=(const RealtimeLog &) = delete;
+
+    void start();
+    void stop(); // Formata o que ficou na fila
+
+    void setLevel(int32_t level) { this->level.store(level, std::memory_order_relaxed); }
+    int32_t getLevel() const { return level.load(std::memory_order_relaxed); }
+    void setSink(Sink newSink) { sink = std::move(newSink); } // Só com a thread parada
+
+    // ✅ PRODUTOR (callback): sem lock; fila cheia descarta e conta
+    void post(Code code, int32_t source, int64_t a = 0, int64_t b = 0, int64_t c = 0, int64_t d = 0)
+    {
+        if (levelOf(code) > level.load(std::memory_order_relaxed))
+            return;
+        Record record;
+        record.code = code;
+        record.source = static_cast<int16_t>(source);
+        record.args[0] = a;
+        record.args[1] = b;
+        record.args[2] = c;
+        record.args[3] = d;
+        if (!queue.push(record))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // CONSUMIDOR: formata e loga o que estiver na fila; devolve linhas emitidas
+    int32_t drain();
+
+    int64_t getDropped() const { return dropped.load(); }     // Fila cheia
+    int64_t getSuppressed() const { return suppressed.load(); } // Limite por código
+
+    static Level levelOf(Code code);
+
+private:
+    void run();
+    void emit(Level level, const char *line);
+    int32_t flushSuppressed(int64_t nowMs);
+
+    const PlayerClock &clock;
+    SpscQueue<Record, QUEUE_RECORDS> queue;
+    std::atomic<int32_t> level{LEVEL_INFO};
+    Sink sink;
+
+    // Estado do consumidor: janela do limite por código
+    int64_t windowStartMs = 0;
+    std::array<int32_t, CODE_COUNT> windowCount{};
+    std::array<int32_t, CODE_COUNT> windowSuppressed{};
+    int64_t reportedDropped = 0;
+
+    std::atomic<bool> running{false};
+    std::thread thread;
+    std::atomic<int64_t> dropped{0};
+    std::atomic<int64_t> suppressed{0};
+};
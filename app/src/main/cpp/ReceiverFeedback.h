@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "PlayerTelemetry.h"
+
+// ✅ Relatório do receptor para o sender ("SHFB"), a cada ~500ms por sender
+//
+// O receptor manda pelo servidor (evento receiver-feedback) como está o buffer
+// daquele sender; o CongestionController do sender junta os relatórios de todos os
+// ouvintes e ajusta chunk, bitrate e ritmo de envio.
+//
+// Layout (little-endian, 20 bytes):
+//   0  u32 magic         'S' 'H' 'F' 'B'
+//   4  u8  version       1
+//   5  u8  flags         PREBUFFERING: ainda enchendo (buffer baixo é esperado)
+//   6  u16 bufferMs      Nível do buffer agora
+//   8  u16 targetMs      Alvo do jitter buffer
+//   10 u16 lossPermille  Perda na última janela de LOSS_WINDOW_PACKETS (perdidos / esperados)
+//   12 u32 jitterUs      Jitter de chegada (média móvel do receptor)
+//   16 u16 underruns     Underruns no intervalo (satura em 65535)
+//   18 u16 intervalMs    Duração do intervalo (0 = primeiro relatório)
+//
+// A versão Kotlin só repassa os bytes (OboeAudioPlayer.getFeedback ->
+// NativeCaptureEncoder.onFeedback).
+namespace feedback
+{
+    constexpr int32_t REPORT_BYTES = 20;
+    constexpr uint8_t VERSION = 1;
+    constexpr uint8_t FLAG_PREBUFFERING = 1 << 0;
+    // A perda sai de janelas de pacotes, não do intervalo: em 500ms de chunks de 60ms
+    // um único pacote perdido já seria 12%. Com LOSS_WINDOW_MIN_LOST perdidos a janela
+    // fecha antes (rajada de descarte na fila é sinal claro, não precisa esperar).
+    constexpr int64_t LOSS_WINDOW_PACKETS = 100;
+    constexpr int64_t LOSS_WINDOW_MIN_LOST = 5;
+
+    struct Report
+    {
+        uint8_t version = VERSION;
+        uint8_t flags = 0;
+        uint16_t bufferMs = 0;
+        uint16_t targetMs = 0;
+        uint16_t lossPermille = 0;
+        uint32_t jitterUs = 0;
+        uint16_t underruns = 0;
+        uint16_t intervalMs = 0;
+
+        bool isPrebuffering() const { return (flags & FLAG_PREBUFFERING) != 0; }
+    };
+
+    namespace detail
+    {
+        inline uint32_t readLe(const uint8_t *p, int bytes)
+        {
+            uint32_t v = 0;
+            for (int i = bytes - 1; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        inline void writeLe(uint8_t *p, uint32_t v, int bytes)
+        {
+            for (int i = 0; i < bytes; i++, v >>= 8)
+                p[i] = static_cast<uint8_t>(v & 0xFF);
+        }
+
+        inline uint16_t clampU16(int64_t v) { return static_cast<uint16_t>(std::clamp<int64_t>(v, 0, 65535)); }
+    }
+
+    // false se não for um relatório SHFB de versão conhecida
+    inline bool parse(const uint8_t *bytes, int32_t length, Report &out)
+    {
+        if (bytes == nullptr || length < REPORT_BYTES ||
+            bytes[0] != 'S' || bytes[1] != 'H' || bytes[2] != 'F' || bytes[3] != 'B')
+            return false;
+
+        out.version = bytes[4];
+        out.flags = bytes[5];
+        out.bufferMs = static_cast<uint16_t>(detail::readLe(bytes + 6, 2));
+        out.targetMs = static_cast<uint16_t>(detail::readLe(bytes + 8, 2));
+        out.lossPermille = static_cast<uint16_t>(detail::readLe(bytes + 10, 2));
+        out.jitterUs = detail::readLe(bytes + 12, 4);
+        out.underruns = static_cast<uint16_t>(detail::readLe(bytes + 16, 2));
+        out.intervalMs = static_cast<uint16_t>(detail::readLe(bytes + 18, 2));
+        return out.version == VERSION;
+    }
+
+    inline void write(uint8_t *bytes, const Report &report)
+    {
+        bytes[0] = 'S';
+        bytes[1] = 'H';
+        bytes[2] = 'F';
+        bytes[3] = 'B';
+        bytes[4] = report.version;
+        bytes[5] = report.flags;
+        detail::writeLe(bytes + 6, report.bufferMs, 2);
+        detail::writeLe(bytes + 8, report.targetMs, 2);
+        detail::writeLe(bytes + 10, report.lossPermille, 2);
+        detail::writeLe(bytes + 12, report.jitterUs, 4);
+        detail::writeLe(bytes + 16, report.underruns, 2);
+        detail::writeLe(bytes + 18, report.intervalMs, 2);
+    }
+
+    // ✅ Relatórios de um sender a partir da telemetria (stats::COUNT posições):
+    // os contadores acumulados viram diferenças desde o relatório anterior.
+    // Um por sender, chamado sempre da mesma thread.
+    class Reporter
+    {
+    public:
+        void reset()
+        {
+            started = false;
+            windowLoss = 0;
+        }
+
+        Report build(const int64_t *values, int64_t nowMs)
+        {
+            Report report;
+            int64_t sampleRate = std::max<int64_t>(values[stats::SAMPLE_RATE], 1);
+            if ((values[stats::STATE] & stats::STATE_PREBUFFERING) != 0)
+                report.flags |= FLAG_PREBUFFERING;
+            report.bufferMs = detail::clampU16(values[stats::BUFFER_FRAMES] * 1000 / sampleRate);
+            report.targetMs = detail::clampU16(values[stats::TARGET_FRAMES] * 1000 / sampleRate);
+            report.jitterUs = static_cast<uint32_t>(std::max<int64_t>(values[stats::ARRIVAL_JITTER_US], 0));
+
+            int64_t lost = values[stats::LOST_PACKETS];
+            int64_t received = values[stats::RECEIVED_PACKETS];
+            int64_t underruns = values[stats::UNDERRUNS];
+            if (started)
+            {
+                report.underruns = detail::clampU16(underruns - lastUnderruns);
+                report.intervalMs = detail::clampU16(nowMs - lastMs);
+            }
+            // Contadores zerados (fonte recriada): a janela recomeça, sem diferença negativa
+            if (!started || lost < windowLost || received < windowReceived)
+            {
+                windowLost = lost;
+                windowReceived = received;
+            }
+
+            int64_t lostDelta = lost - windowLost;
+            int64_t expected = lostDelta + (received - windowReceived);
+            if (expected >= LOSS_WINDOW_PACKETS || lostDelta >= LOSS_WINDOW_MIN_LOST)
+            {
+                windowLoss = detail::clampU16(lostDelta * 1000 / expected);
+                windowLost = lost;
+                windowReceived = received;
+            }
+            report.lossPermille = windowLoss;
+
+            started = true;
+            lastUnderruns = underruns;
+            lastMs = nowMs;
+            return report;
+        }
+
+    private:
+        bool started = false;
+        int64_t windowLost = 0;
+        int64_t windowReceived = 0;
+        uint16_t windowLoss = 0; // Da última janela fechada
+        int64_t lastUnderruns = 0;
+        int64_t lastMs = 0;
+    };
+}
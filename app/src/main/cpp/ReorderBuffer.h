@@ -0,0 +1,221 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// ✅ Janela de reordenação por número de sequência (lado produtor)
+//
+// Pacotes fora de ordem ficam guardados até WINDOW_PACKETS à frente do esperado
+// e saem em ordem. Um buraco só é dado como perdido quando já há pacotes
+// MAX_WAIT_PACKETS adiante dele; o consumidor recebe, junto de cada pacote, quantos
+// faltaram logo antes (para esconder a perda com PLC/FEC ou concealment).
+// Atrasados e duplicados são descartados. Uma única thread usa push(); os
+// contadores podem ser lidos de qualquer thread.
+class ReorderBuffer
+{
+public:
+    static constexpr uint32_t WINDOW_PACKETS = 8;
+    static constexpr uint32_t MAX_WAIT_PACKETS = 3;     // ~60ms com chunks de 20ms
+    static constexpr int32_t MAX_LATE_PACKETS = 64;     // Mais velho que isso = sender reiniciou
+    static constexpr uint32_t DISCONTINUITY = UINT32_MAX; // lostBefore quando a sequência recomeça
+
+    struct Entry
+    {
+        uint32_t sequence = 0;
+        int64_t captureTimeUs = 0;
+        int32_t length = 0;
+        const uint8_t *data = nullptr;
+        uint16_t flags = 0; // Do cabeçalho do pacote (ex.: packet::FLAG_SILENCE)
+    };
+
+    // Só com o produtor parado
+    void configure(int32_t maxPacketBytes)
+    {
+        slotBytes = maxPacketBytes;
+        storage.assign(static_cast<size_t>(maxPacketBytes) * WINDOW_PACKETS, uint8_t(0));
+        reset();
+        lostPackets = 0;
+        arrivedPackets = 0;
+        latePackets = 0;
+        reorderedPackets = 0;
+    }
+
+    // Esquece a sequência e os pacotes guardados (limpeza, stop)
+    void reset()
+    {
+        for (Slot &slot : slots)
+            slot.used = false;
+        started = false;
+        held = 0;
+        pendingLost = 0;
+    }
+
+    // ✅ PRODUTOR: deliver(const Entry &, uint32_t lostBefore) é chamado para cada pacote
+    // liberado, em ordem. false = pacote atrasado/duplicado (ou grande demais) descartado.
+    // `flags` volta intacto no Entry.
+    template <typename Deliver>
+    bool push(uint32_t sequence, int64_t captureTimeUs, const uint8_t *data, int32_t length, Deliver &&deliver,
+              uint16_t flags = 0)
+    {
+        if (length <= 0 || length > slotBytes)
+            return false;
+        arrivedPackets++;
+
+        Entry entry;
+        entry.sequence = sequence;
+        entry.captureTimeUs = captureTimeUs;
+        entry.length = length;
+        entry.data = data;
+        entry.flags = flags;
+
+        if (!started)
+        {
+            started = true;
+            expected = sequence;
+        }
+
+        auto ahead = static_cast<int32_t>(sequence - expected);
+        if (ahead < 0)
+        {
+            if (ahead >= -MAX_LATE_PACKETS)
+            {
+                latePackets++;
+                return false;
+            }
+            // Sequência recomeçou: entregar o que estava guardado e seguir do novo ponto
+            flush(deliver);
+            deliver(entry, DISCONTINUITY);
+            expected = sequence + 1;
+            return true;
+        }
+
+        if (static_cast<uint32_t>(ahead) >= WINDOW_PACKETS)
+        {
+            // Salto maior que a janela: não há como esperar pelo buraco
+            flush(deliver);
+            auto gap = static_cast<uint32_t>(sequence - expected);
+            lostPackets += gap;
+            deliver(entry, gap);
+            expected = sequence + 1;
+            return true;
+        }
+
+        if (ahead == 0 && held == 0)
+        {
+            // Caminho comum: em ordem e nada guardado, sem cópia
+            deliver(entry, takePendingLost());
+            expected++;
+            return true;
+        }
+
+        Slot &slot = slots[sequence % WINDOW_PACKETS];
+        if (slot.used)
+        {
+            latePackets++; // Duplicado de um pacote ainda guardado
+            return false;
+        }
+
+        if (held > 0 && static_cast<int32_t>(sequence - highest) < 0)
+            reorderedPackets++; // Chegou depois de um posterior, mas ainda a tempo
+        if (held == 0 || static_cast<int32_t>(sequence - highest) > 0)
+            highest = sequence;
+
+        slot.used = true;
+        slot.sequence = sequence;
+        slot.captureTimeUs = captureTimeUs;
+        slot.length = length;
+        slot.flags = flags;
+        memcpy(slotData(sequence), data, static_cast<size_t>(length));
+        held++;
+
+        release(deliver, false);
+        return true;
+    }
+
+    uint32_t heldPackets() const { return held; }
+
+    int64_t getLostPackets() const { return lostPackets.load(); }
+    int64_t getLatePackets() const { return latePackets.load(); }
+    // Aceitos (chegaram a tempo, sem duplicados): a base da taxa de perda
+    int64_t getReceivedPackets() const { return arrivedPackets.load() - latePackets.load(); }
+    int64_t getReorderedPackets() const { return reorderedPackets.load(); }
+
+private:
+    struct Slot
+    {
+        bool used = false;
+        uint32_t sequence = 0;
+        int64_t captureTimeUs = 0;
+        int32_t length = 0;
+        uint16_t flags = 0;
+    };
+
+    uint8_t *slotData(uint32_t sequence)
+    {
+        return storage.data() + static_cast<size_t>(sequence % WINDOW_PACKETS) * slotBytes;
+    }
+
+    uint32_t takePendingLost()
+    {
+        uint32_t lost = pendingLost;
+        pendingLost = 0;
+        return lost;
+    }
+
+    // Entrega os guardados a partir do esperado; buracos esperam até haver
+    // MAX_WAIT_PACKETS pacotes adiante (ou sempre viram perda, se `force`)
+    template <typename Deliver>
+    void release(Deliver &deliver, bool force)
+    {
+        while (held > 0)
+        {
+            Slot &slot = slots[expected % WINDOW_PACKETS];
+            if (slot.used)
+            {
+                Entry entry;
+                entry.sequence = slot.sequence;
+                entry.captureTimeUs = slot.captureTimeUs;
+                entry.length = slot.length;
+                entry.data = slotData(slot.sequence);
+                entry.flags = slot.flags;
+                slot.used = false;
+                held--;
+                expected++;
+                deliver(entry, takePendingLost());
+                continue;
+            }
+
+            if (!force && static_cast<uint32_t>(highest - expected) < MAX_WAIT_PACKETS)
+                break;
+
+            pendingLost++;
+            lostPackets++;
+            expected++;
+        }
+    }
+
+    template <typename Deliver>
+    void flush(Deliver &deliver)
+    {
+        release(deliver, true);
+        pendingLost = 0;
+    }
+
+    std::vector<uint8_t> storage;
+    int32_t slotBytes = 0;
+    std::array<Slot, WINDOW_PACKETS> slots{};
+
+    bool started = false;
+    uint32_t expected = 0;
+    uint32_t highest = 0;
+    uint32_t held = 0;
+    uint32_t pendingLost = 0; // Perdidos a informar junto do próximo entregue
+
+    std::atomic<int64_t> lostPackets{0};
+    std::atomic<int64_t> arrivedPackets{0};
+    std::atomic<int64_t> latePackets{0};
+    std::atomic<int64_t> reorderedPackets{0};
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+// ✅ Detecção de silêncio do sender (DTX) e o silêncio/ruído de conforto do receptor
+//
+// O sender mede o pico de cada chunk (CapturePipeline). Depois de HANGOVER_MS
+// seguidos abaixo de ENTER_PEAK, os chunks viram marcadores "N frames de silêncio"
+// (packet::FLAG_SILENCE) em vez de payload. Histerese: uma vez em silêncio, só sai
+// quando o pico passa de EXIT_PEAK, para não ficar alternando no limiar. O primeiro
+// chunk acima do limiar sai inteiro, sem espera.
+//
+// Os limiares ficam perto do silêncio digital (-66/-60 dBFS): trocar por zeros ou
+// por ruído de conforto no mesmo nível não muda o que se ouve.
+class SilenceDetector
+{
+public:
+    static constexpr int32_t ENTER_PEAK = 16; // ~-66 dBFS
+    static constexpr int32_t EXIT_PEAK = 32;  // ~-60 dBFS
+    static constexpr int32_t HANGOVER_MS = 300;
+
+    void configure(int32_t sampleRate)
+    {
+        hangoverFrames = static_cast<int32_t>((static_cast<int64_t>(sampleRate) * HANGOVER_MS) / 1000);
+        reset();
+    }
+
+    void reset()
+    {
+        silent = false;
+        quietFrames = 0;
+    }
+
+    // Um chunk fechado; true = mandar como marcador de silêncio
+    bool update(int32_t peak, int32_t frames)
+    {
+        if (silent)
+        {
+            if (peak > EXIT_PEAK)
+                reset();
+            return silent;
+        }
+
+        if (peak > ENTER_PEAK)
+        {
+            quietFrames = 0;
+            return false;
+        }
+        // O chunk que completa o hangover ainda sai inteiro
+        silent = quietFrames >= hangoverFrames;
+        quietFrames = std::min(quietFrames + frames, hangoverFrames);
+        return silent;
+    }
+
+    bool isSilent() const { return silent; }
+
+private:
+    int32_t hangoverFrames = 14400;
+    int32_t quietFrames = 0;
+    bool silent = false;
+};
+
+namespace silence
+{
+    // `samples` amostras de silêncio (level = 0) ou de ruído branco com RMS ~level.
+    // LCG com o estado em `seed`: sem alocação, pode rodar em qualquer produtor.
+    inline void fill(int16_t *out, int32_t samples, int32_t level, uint32_t &seed)
+    {
+        if (level <= 0)
+        {
+            std::fill_n(out, samples, int16_t(0));
+            return;
+        }
+        // Uniforme em [-a, a] tem RMS a/√3
+        int32_t amplitude = std::min(level * 1732 / 1000, 32767);
+        for (int32_t i = 0; i < samples; i++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            auto uniform = static_cast<int32_t>(seed >> 16) - 32768; // [-32768, 32767]
+            out[i] = static_cast<int16_t>((uniform * amplitude) / 32768);
+        }
+    }
+}
@@ -0,0 +1,386 @@
+#include "SourceMixer.h"
+#include "AudioKernels.h"
+#include "NativeLog.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace
+{
+    // O stream visto como PCM16 a partir do frame `offset` do callback: cada fonte
+    // renderiza no buffer de mixagem sem converter, e o agendamento enxerga a
+    // posição certa do bloco dentro do callback
+    class MixView : public AudioOutputStream
+    {
+    public:
+        MixView(const AudioOutputStream &stream, int32_t offset) : stream(stream), offset(offset) {}
+
+        int32_t getSampleRate() const override { return stream.getSampleRate(); }
+        int32_t getChannelCount() const override { return stream.getChannelCount(); }
+        int32_t getFramesPerBurst() const override { return stream.getFramesPerBurst(); }
+        int32_t getBufferSizeInFrames() const override { return stream.getBufferSizeInFrames(); }
+
+        int64_t getFramesWritten() const override
+        {
+            int64_t written = stream.getFramesWritten();
+            return written < 0 ? written : written + offset;
+        }
+
+        bool getTimestamp(int64_t &framePosition, int64_t &timeNanos) const override
+        {
+            return stream.getTimestamp(framePosition, timeNanos);
+        }
+
+    private:
+        const AudioOutputStream &stream;
+        int32_t offset;
+    };
+}
+
+SourceMixer::SourceMixer(const PlayerClock &clock) : clock(clock)
+{
+    mixBuffer.assign(static_cast<size_t>(MIX_FRAMES) * OutputStage::MAX_DEVICE_CHANNELS, int16_t(0));
+    sourceBuffer.assign(mixBuffer.size(), int16_t(0));
+    log.start();
+}
+
+SourceMixer::~SourceMixer()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto &slot : active)
+        slot = nullptr;
+    waitForRender();
+    for (auto &source : owned)
+        source.reset(); // ~DecodeWorker para a thread antes de o core sumir
+    log.stop();
+}
+
+void SourceMixer::configure(int32_t sampleRate, int32_t channelCount, int32_t maxBufferMs)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        configured = false;
+        for (auto &slot : active)
+            slot = nullptr;
+        waitForRender();
+        for (auto &source : owned)
+            source.reset();
+
+        configuredSampleRate = sampleRate;
+        configuredChannelCount = channelCount;
+        configuredMaxBufferMs = maxBufferMs;
+        outputSampleRate = 0; // Até o stream abrir: a taxa da fonte
+    }
+
+    addSource(DEFAULT_SOURCE);
+    configured = true;
+}
+
+void SourceMixer::Source::stopDecoderForPcm()
+{
+    if (!encodedPending)
+        return;
+    encodedPending = false;
+    decodeWorker.discardPending();
+    LOGI("🔀 Fonte %d: PCM depois de Opus, pacotes codificados pendentes descartados", id);
+}
+
+bool SourceMixer::Source::write(const uint8_t *bytes, int32_t length)
+{
+    stopDecoderForPcm();
+    return core.write(bytes, length);
+}
+
+int32_t SourceMixer::Source::writeBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count)
+{
+    stopDecoderForPcm();
+    return core.writeBatch(bytes, offsets, count);
+}
+
+bool SourceMixer::Source::submitEncoded(const uint8_t *bytes, int32_t length)
+{
+    bool accepted = decodeWorker.submit(bytes, length);
+    encodedPending = encodedPending || accepted;
+    return accepted;
+}
+
+int32_t SourceMixer::Source::submitEncodedBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count)
+{
+    int32_t accepted = decodeWorker.submitBatch(bytes, offsets, count);
+    encodedPending = encodedPending || accepted > 0;
+    return accepted;
+}
+
+bool SourceMixer::addSource(int32_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (find(id) != nullptr)
+        return false;
+
+    auto slot = std::find(owned.begin(), owned.end(), nullptr);
+    if (slot == owned.end())
+    {
+        LOGW("⚠️ Mixer cheio (%d fontes), sender %d ignorado", MAX_SOURCES, id);
+        return false;
+    }
+
+    // ✅ Tudo alocado e configurado antes de o callback enxergar a fonte
+    auto source = std::make_unique<Source>(id, clock);
+    source->core.configure(configuredSampleRate, configuredChannelCount, configuredMaxBufferMs);
+    source->decodeWorker.configure(createOpusDecoder(configuredSampleRate, configuredChannelCount),
+                                   configuredChannelCount);
+    applySettings(*source);
+    if (playing.load())
+    {
+        source->core.start();
+        source->decodeWorker.start();
+    }
+
+    auto index = static_cast<size_t>(slot - owned.begin());
+    active[index] = source.get();
+    *slot = std::move(source);
+    LOGI("🎚️ Fonte %d adicionada ao mixer", id);
+    return true;
+}
+
+bool SourceMixer::removeSource(int32_t id)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < owned.size(); i++)
+    {
+        if (!owned[i] || owned[i]->id != id)
+            continue;
+
+        // Some do próximo callback; o que já está rodando ainda pode ler a fonte
+        active[i] = nullptr;
+        waitForRender();
+        owned[i].reset();
+        LOGI("🎚️ Fonte %d removida do mixer", id);
+        return true;
+    }
+    return false;
+}
+
+int32_t SourceMixer::getSourceCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return static_cast<int32_t>(std::count_if(owned.begin(), owned.end(),
+                                              [](const std::unique_ptr<Source> &source) { return source != nullptr; }));
+}
+
+SourceMixer::Source *SourceMixer::find(int32_t id)
+{
+    for (auto &source : owned)
+    {
+        if (source && source->id == id)
+            return source.get();
+    }
+    return nullptr;
+}
+
+void SourceMixer::applySettings(Source &source)
+{
+    if (outputSampleRate > 0)
+        source.core.setOutputSampleRate(outputSampleRate);
+    source.core.setFramesPerBurst(framesPerBurst);
+    source.core.setClockOffsetUs(clockOffsetUs);
+    source.core.setPlayoutDelayMs(playoutDelayMs);
+    source.core.setFastStart(fastStart);
+    source.core.setComfortNoise(comfortNoise);
+    source.core.setLog(&log, source.id);
+    source.core.setVolume(source.gain * masterVolume);
+}
+
+void SourceMixer::waitForRender() const
+{
+    // Callback em andamento (época ímpar): esperar ele sair do render()
+    uint32_t epoch = renderEpoch.load();
+    while ((epoch & 1u) != 0 && renderEpoch.load() == epoch)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+void SourceMixer::setOutputSampleRate(int32_t sampleRate)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    outputSampleRate = sampleRate;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setOutputSampleRate(sampleRate);
+    }
+}
+
+void SourceMixer::setFramesPerBurst(int32_t frames)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    framesPerBurst = frames;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setFramesPerBurst(frames);
+    }
+}
+
+void SourceMixer::notifyOutputRestarted()
+{
+    forEachSource([](Source &source) { source.core.notifyOutputRestarted(); });
+}
+
+void SourceMixer::start()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    playing = true;
+    for (auto &source : owned)
+    {
+        if (!source)
+            continue;
+        source->core.start();
+        source->decodeWorker.start();
+    }
+}
+
+void SourceMixer::stop()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    playing = false;
+    for (auto &source : owned)
+    {
+        if (!source)
+            continue;
+        source->core.stop();
+        source->decodeWorker.stop();
+    }
+}
+
+void SourceMixer::requestClear()
+{
+    forEachSource([](Source &source) { source.core.requestClear(); });
+}
+
+void SourceMixer::setMasterVolume(float volume)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    masterVolume = std::clamp(volume, 0.0f, 1.0f);
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setVolume(source->gain * masterVolume);
+    }
+}
+
+bool SourceMixer::setSourceGain(int32_t id, float gain)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    Source *source = find(id);
+    if (source == nullptr)
+        return false;
+    source->gain = std::clamp(gain, 0.0f, 1.0f);
+    return source->core.setVolume(source->gain * masterVolume);
+}
+
+void SourceMixer::setClockOffsetUs(int64_t offsetUs)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    clockOffsetUs = offsetUs;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setClockOffsetUs(offsetUs);
+    }
+}
+
+void SourceMixer::setPlayoutDelayMs(int32_t ms)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    playoutDelayMs = ms;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setPlayoutDelayMs(ms);
+    }
+}
+
+void SourceMixer::setFastStart(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    fastStart = enabled;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setFastStart(enabled);
+    }
+}
+
+void SourceMixer::setComfortNoise(bool enabled)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    comfortNoise = enabled;
+    for (auto &source : owned)
+    {
+        if (source)
+            source->core.setComfortNoise(enabled);
+    }
+}
+
+// ✅ CALLBACK - LOCK-FREE
+void SourceMixer::render(const AudioOutputStream &output, void *outputData, int32_t numFrames)
+{
+    renderEpoch++; // Ímpar: removeSource() espera
+
+    Source *sources[MAX_SOURCES];
+    int32_t count = 0;
+    for (auto &slot : active)
+    {
+        Source *source = slot.load();
+        if (source != nullptr)
+            sources[count++] = source;
+    }
+
+    int32_t channels = output.getChannelCount();
+    OutputFormat format = output.getFormat();
+
+    if (count == 1)
+    {
+        // Caso comum (um sender): sem mixagem, o core escreve direto na saída
+        sources[0]->core.render(output, outputData, numFrames);
+    }
+    else if (count == 0 || channels < 1 || channels > OutputStage::MAX_DEVICE_CHANNELS)
+    {
+        size_t bytes = format == OutputFormat::Float ? sizeof(float) : sizeof(int16_t);
+        memset(outputData, 0, static_cast<size_t>(numFrames) * std::max(channels, 0) * bytes);
+    }
+    else
+    {
+        // ✅ MIXAGEM: a 1ª fonte escreve o bloco, as demais somam com saturação.
+        // Saída PCM16 mixa no próprio buffer do callback; float converte no fim.
+        for (int32_t done = 0; done < numFrames;)
+        {
+            int32_t frames = std::min(numFrames - done, MIX_FRAMES);
+            int32_t samples = frames * channels;
+            size_t offset = static_cast<size_t>(done) * channels;
+            MixView view(output, done);
+
+            int16_t *mix = format == OutputFormat::I16 ? static_cast<int16_t *>(outputData) + offset
+                                                       : mixBuffer.data();
+            sources[0]->core.render(view, mix, frames);
+            for (int32_t i = 1; i < count; i++)
+            {
+                sources[i]->core.render(view, sourceBuffer.data(), frames);
+                audiokernels::mixSaturate(mix, sourceBuffer.data(), samples);
+            }
+
+            if (format == OutputFormat::Float)
+                audiokernels::int16ToFloat(static_cast<float *>(outputData) + offset, mix, samples);
+            done += frames;
+        }
+    }
+
+    bool anyAudible = false;
+    for (int32_t i = 0; i < count; i++)
+        anyAudible = anyAudible || !sources[i]->core.isPrebuffering();
+    audible = anyAudible;
+
+    renderEpoch++;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "AudioOutputStream.h"
+#include "DecodeWorker.h"
+#include "OutputStage.h"
+#include "PlayerCore.h"
+#include "RealtimeLog.h"
+#include "ReceiverFeedback.h"
+
+// ✅ Várias fontes (senders) tocando no mesmo stream de saída
+//
+// Cada sender tem a própria fonte: PlayerCore (ring, jitter buffer, reamostrador,
+// agendamento, ganho) e DecodeWorker. O callback renderiza cada fonte ativa em
+// PCM16 no layout do dispositivo e soma com saturação (audiokernels::mixSaturate).
+// Com uma fonte só, o render vai direto para a saída, como antes do mixer.
+//  - Controle e produtores (JNI, UDP): addSource/removeSource/withSource, sob mutex;
+//    os dados entram por Source::write/submitEncoded, que mantêm um produtor por core
+//  - Consumidor (callback): render(), sem lock e sem alocação
+// removeSource() espera o callback em andamento terminar antes de liberar a fonte.
+class SourceMixer
+{
+public:
+    static constexpr int32_t MAX_SOURCES = 8;
+    static constexpr int32_t DEFAULT_SOURCE = 0; // Senders sem id
+    static constexpr int32_t MIX_FRAMES = 1024;  // Callbacks maiores são mixados em partes
+
+    struct Source
+    {
+        Source(int32_t id, const PlayerClock &clock) : id(id), core(clock) {}
+
+        // ✅ PRODUTORES (com o mutex do mixer): o ring do core é SPSC, e o DecodeWorker
+        // escreve nele da própria thread. PCM depois de Opus (sender reiniciado com
+        // outro codec, dois senders na DEFAULT_SOURCE) para o worker e descarta os
+        // pacotes codificados pendentes antes de escrever.
+        bool write(const uint8_t *bytes, int32_t length);
+        int32_t writeBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count);
+        bool submitEncoded(const uint8_t *bytes, int32_t length);
+        int32_t submitEncodedBatch(const uint8_t *bytes, const int32_t *offsets, int32_t count);
+
+        const int32_t id;
+        PlayerCore core;
+        DecodeWorker decodeWorker{core};
+        float gain = 1.0f; // Ganho do sender (o volume geral multiplica)
+        feedback::Reporter feedback; // Relatórios para o sender (thread de controle)
+        bool encodedPending = false; // Opus entregue ao worker desde o último PCM
+
+    private:
+        void stopDecoderForPcm();
+    };
+
+    explicit SourceMixer(const PlayerClock &clock = PlayerClock::system());
+    ~SourceMixer();
+    SourceMixer(const SourceMixer &) = delete;
+    SourceMixer &operator=(const SourceMixer &) = delete;
+
+    // Formato da fonte e teto do buffer de cada fonte, os mesmos para todos os
+    // senders. Remove as fontes e cria DEFAULT_SOURCE. Só com o callback parado.
+    void configure(int32_t sampleRate, int32_t channelCount,
+                   int32_t maxBufferMs = PlayerCore::DEFAULT_MAX_BUFFER_MS);
+
+    // Fonte nova com os ajustes atuais (taxa do dispositivo, atraso, volume, play).
+    // Aloca o ring (~2MB com 10s a 48kHz estéreo): fora do callback. false se já
+    // existe ou não há vaga.
+    bool addSource(int32_t id);
+    bool removeSource(int32_t id);
+    int32_t getSourceCount() const;
+
+    // Executa f(Source&) com a tabela travada; false se a fonte não existe
+    template <typename F>
+    bool withSource(int32_t id, F &&f)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Source *source = find(id);
+        if (source == nullptr)
+            return false;
+        f(*source);
+        return true;
+    }
+
+    // f(Source&) em todas as fontes, com a tabela travada
+    template <typename F>
+    void forEachSource(F &&f)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &source : owned)
+        {
+            if (source)
+                f(*source);
+        }
+    }
+
+    // ✅ Ajustes de todas as fontes (e das que forem criadas depois)
+    void setOutputSampleRate(int32_t sampleRate); // Só com o callback parado
+    void setFramesPerBurst(int32_t frames);
+    void notifyOutputRestarted();
+    void start();
+    void stop();
+    void requestClear();
+    void setMasterVolume(float volume);
+    bool setSourceGain(int32_t id, float gain);
+    void setClockOffsetUs(int64_t offsetUs);
+    void setPlayoutDelayMs(int32_t ms);
+    void setFastStart(bool enabled);
+    void setComfortNoise(bool enabled);
+
+    // Log do callback de todas as fontes (formatado numa thread do mixer)
+    void setLogLevel(int32_t level) { log.setLevel(level); }
+    RealtimeLog &getLog() { return log; }
+
+    bool isPlaying() const { return playing.load(); }
+    bool isConfigured() const { return configured.load(); }
+
+    // ✅ CONSUMIDOR: soma das fontes no formato/layout de output
+    void render(const AudioOutputStream &output, void *outputData, int32_t numFrames);
+
+    // CONSUMIDOR: alguma fonte tocou no último render() (fora do prebuffer)
+    bool isAudible() const { return audible; }
+
+private:
+    Source *find(int32_t id); // Com mutex
+    void applySettings(Source &source); // Com mutex
+    void waitForRender() const;
+
+    const PlayerClock &clock;
+    RealtimeLog log{clock}; // Antes das fontes: os cores guardam o ponteiro
+
+    // Tabela de fontes: dona das fontes (mutex) e a cópia lida pelo callback
+    mutable std::mutex mutex;
+    std::array<std::unique_ptr<Source>, MAX_SOURCES> owned;
+    std::array<std::atomic<Source *>, MAX_SOURCES> active{};
+    std::atomic<uint32_t> renderEpoch{0}; // Ímpar = callback dentro do render()
+    bool audible = false;                 // Só o callback escreve/lê
+
+    // ✅ Buffers de mixagem (PCM16 no layout do dispositivo), alocados uma vez
+    std::vector<int16_t> mixBuffer;
+    std::vector<int16_t> sourceBuffer;
+
+    // Ajustes aplicados às fontes novas (mutex)
+    int32_t configuredSampleRate = 48000;
+    int32_t configuredChannelCount = 2;
+    int32_t configuredMaxBufferMs = PlayerCore::DEFAULT_MAX_BUFFER_MS;
+    int32_t outputSampleRate = 0;
+    int32_t framesPerBurst = 0;
+    int64_t clockOffsetUs = 0;
+    int32_t playoutDelayMs = PlayoutScheduler::DEFAULT_PLAYOUT_DELAY_MS;
+    float masterVolume = 1.0f;
+    bool fastStart = false;
+    bool comfortNoise = false;
+    std::atomic<bool> playing{false};
+    std::atomic<bool> configured{false};
+};
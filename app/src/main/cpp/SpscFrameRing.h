@@ -0,0 +1,199 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+
+// ✅ Ring buffer lock-free SPSC de frames PCM16 intercalados
+//
+// Um único produtor (thread JNI que chama addAudioData) e um único consumidor
+// (callback do Oboe). Os índices são contadores monotônicos de frames de 64 bits
+// publicados com acquire/release, então o callback nunca bloqueia nem aloca.
+// A memória é reservada uma vez em allocate(), fora da thread de áudio, com a
+// capacidade exata pedida: o limite de memória é o limite de duração.
+// Em lote, o produtor copia com stage() e publica tudo num único commit().
+class SpscFrameRing
+{
+public:
+    SpscFrameRing() = default;
+    SpscFrameRing(const SpscFrameRing &) = delete;
+    SpscFrameRing &operator=(const SpscFrameRing &) = delete;
+
+    // Aloca o armazenamento. Só pode ser chamado com produtor e consumidor parados.
+    void allocate(int32_t capacityFrames, int32_t channelCount)
+    {
+        channels = std::max(channelCount, 1);
+        capacity = static_cast<uint32_t>(std::max(capacityFrames, 1));
+        storage.assign(static_cast<size_t>(capacity) * channels, int16_t(0));
+        writeIndex.store(0, std::memory_order_relaxed);
+        readIndex.store(0, std::memory_order_relaxed);
+        staged = 0;
+    }
+
+    int32_t capacityFrames() const { return static_cast<int32_t>(capacity); }
+    int32_t channelCount() const { return channels; }
+    bool isAllocated() const { return !storage.empty(); }
+
+    // Frames prontos para leitura (exato no consumidor, aproximado nas outras threads)
+    int32_t availableToRead() const
+    {
+        uint64_t w = writeIndex.load(std::memory_order_acquire);
+        uint64_t r = readIndex.load(std::memory_order_acquire);
+        return static_cast<int32_t>(w - r);
+    }
+
+    // Índices absolutos de frame (monotônicos desde allocate); a escrita inclui o
+    // que já foi copiado por stage() e ainda não publicado (só o produtor usa)
+    uint64_t writePosition() const { return writeIndex.load(std::memory_order_relaxed) + staged; }
+    uint64_t readPosition() const { return readIndex.load(std::memory_order_relaxed); }
+
+    // Espaço livre em frames (exato no produtor, descontado o que está em stage())
+    int32_t availableToWrite() const
+    {
+        return capacityFrames() - availableToRead() - static_cast<int32_t>(staged);
+    }
+
+    // ✅ PRODUTOR: copia até `frames` frames e publica (junto com o que estiver em
+    // stage()). Retorna frames escritos.
+    int32_t write(const int16_t *src, int32_t frames)
+    {
+        if (storage.empty() || frames <= 0)
+            return 0;
+
+        uint64_t w = writeIndex.load(std::memory_order_relaxed) + staged;
+        uint64_t r = readIndex.load(std::memory_order_acquire);
+        int32_t freeFrames = capacityFrames() - static_cast<int32_t>(w - r);
+        int32_t toWrite = std::min(frames, freeFrames);
+        if (toWrite <= 0)
+            return 0;
+
+        copyIn(w, src, toWrite);
+        writeIndex.store(w + toWrite, std::memory_order_release);
+        staged = 0;
+        return toWrite;
+    }
+
+    // ✅ PRODUTOR: copia até `frames` frames depois dos já copiados, sem publicar.
+    // Retorna frames copiados; o consumidor só os vê depois de commit().
+    int32_t stage(const int16_t *src, int32_t frames)
+    {
+        if (storage.empty() || frames <= 0)
+            return 0;
+
+        uint64_t w = writeIndex.load(std::memory_order_relaxed) + staged;
+        uint64_t r = readIndex.load(std::memory_order_acquire);
+        int32_t freeFrames = capacityFrames() - static_cast<int32_t>(w - r);
+        int32_t toWrite = std::min(frames, freeFrames);
+        if (toWrite <= 0)
+            return 0;
+
+        copyIn(w, src, toWrite);
+        staged += static_cast<uint32_t>(toWrite);
+        return toWrite;
+    }
+
+    // ✅ PRODUTOR: publica de uma vez tudo o que stage() copiou. Retorna frames publicados.
+    int32_t commit()
+    {
+        if (staged == 0)
+            return 0;
+        auto published = static_cast<int32_t>(staged);
+        writeIndex.store(writeIndex.load(std::memory_order_relaxed) + staged, std::memory_order_release);
+        staged = 0;
+        return published;
+    }
+
+    // ✅ CONSUMIDOR: copia até `frames` frames para dst. Retorna frames lidos.
+    int32_t read(int16_t *dst, int32_t frames)
+    {
+        if (storage.empty() || frames <= 0)
+            return 0;
+
+        uint64_t r = readIndex.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex.load(std::memory_order_acquire);
+        int32_t toRead = std::min(frames, static_cast<int32_t>(w - r));
+        if (toRead <= 0)
+            return 0;
+
+        copyOut(r, dst, toRead);
+        readIndex.store(r + toRead, std::memory_order_release);
+        return toRead;
+    }
+
+    // ✅ CONSUMIDOR: descarta os `frames` mais antigos. Retorna frames descartados.
+    int32_t discard(int32_t frames)
+    {
+        uint64_t r = readIndex.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex.load(std::memory_order_acquire);
+        int32_t toDiscard = std::min(frames, static_cast<int32_t>(w - r));
+        if (toDiscard <= 0)
+            return 0;
+
+        readIndex.store(r + toDiscard, std::memory_order_release);
+        return toDiscard;
+    }
+
+    // ✅ CONSUMIDOR: copia `frames` frames a partir de `offset` frames depois da
+    // leitura, sem consumir. Retorna frames copiados.
+    int32_t peek(int32_t offset, int16_t *dst, int32_t frames) const
+    {
+        uint64_t r = readIndex.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex.load(std::memory_order_acquire);
+        int32_t toCopy = std::min(frames, static_cast<int32_t>(w - r) - offset);
+        if (storage.empty() || offset < 0 || toCopy <= 0)
+            return 0;
+        copyOut(r + offset, dst, toCopy);
+        return toCopy;
+    }
+
+    // ✅ CONSUMIDOR: reescreve frames já publicados e ainda não lidos (o produtor só
+    // escreve na parte livre). Retorna frames reescritos.
+    int32_t overwrite(int32_t offset, const int16_t *src, int32_t frames)
+    {
+        uint64_t r = readIndex.load(std::memory_order_relaxed);
+        uint64_t w = writeIndex.load(std::memory_order_acquire);
+        int32_t toCopy = std::min(frames, static_cast<int32_t>(w - r) - offset);
+        if (storage.empty() || offset < 0 || toCopy <= 0)
+            return 0;
+        copyIn(r + offset, src, toCopy);
+        return toCopy;
+    }
+
+private:
+    void copyIn(uint64_t index, const int16_t *src, int32_t frames)
+    {
+        auto start = static_cast<uint32_t>(index % capacity);
+        int32_t firstPart = std::min(frames, capacityFrames() - static_cast<int32_t>(start));
+        memcpy(storage.data() + static_cast<size_t>(start) * channels, src,
+               static_cast<size_t>(firstPart) * channels * sizeof(int16_t));
+        if (firstPart < frames)
+        {
+            memcpy(storage.data(), src + static_cast<size_t>(firstPart) * channels,
+                   static_cast<size_t>(frames - firstPart) * channels * sizeof(int16_t));
+        }
+    }
+
+    void copyOut(uint64_t index, int16_t *dst, int32_t frames) const
+    {
+        auto start = static_cast<uint32_t>(index % capacity);
+        int32_t firstPart = std::min(frames, capacityFrames() - static_cast<int32_t>(start));
+        memcpy(dst, storage.data() + static_cast<size_t>(start) * channels,
+               static_cast<size_t>(firstPart) * channels * sizeof(int16_t));
+        if (firstPart < frames)
+        {
+            memcpy(dst + static_cast<size_t>(firstPart) * channels, storage.data(),
+                   static_cast<size_t>(frames - firstPart) * channels * sizeof(int16_t));
+        }
+    }
+
+    std::vector<int16_t> storage;
+    uint32_t capacity = 1;
+    int32_t channels = 2;
+    uint32_t staged = 0; // Do produtor: copiados por stage(), ainda não publicados
+
+    // Índices em cache lines separadas para evitar false sharing entre as threads
+    alignas(64) std::atomic<uint64_t> writeIndex{0};
+    alignas(64) std::atomic<uint64_t> readIndex{0};
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// ✅ Fila lock-free SPSC de tamanho fixo para metadados pequenos
+//
+// Mesmo protocolo do SpscFrameRing (índices monotônicos com acquire/release),
+// mas para itens inteiros copiáveis (âncoras de tempo, eventos, etc.).
+// Capacity precisa ser potência de 2. Sem alocação: o armazenamento é inline.
+template <typename T, uint32_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity precisa ser potência de 2");
+
+public:
+    // ✅ PRODUTOR: false se a fila estiver cheia
+    bool push(const T &item)
+    {
+        uint32_t w = writeIndex.load(std::memory_order_relaxed);
+        uint32_t r = readIndex.load(std::memory_order_acquire);
+        if (w - r >= Capacity)
+            return false;
+
+        items[w & (Capacity - 1)] = item;
+        writeIndex.store(w + 1, std::memory_order_release);
+        return true;
+    }
+
+    // ✅ CONSUMIDOR: próximo item sem remover (nullptr se vazia)
+    const T *front() const
+    {
+        uint32_t r = readIndex.load(std::memory_order_relaxed);
+        if (writeIndex.load(std::memory_order_acquire) == r)
+            return nullptr;
+        return &items[r & (Capacity - 1)];
+    }
+
+    // ✅ CONSUMIDOR: remove o item da frente (precisa existir)
+    void pop()
+    {
+        readIndex.store(readIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ✅ CONSUMIDOR: esvazia a fila
+    void clear()
+    {
+        readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint32_t size() const
+    {
+        return writeIndex.load(std::memory_order_acquire) - readIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, Capacity> items{};
+
+    alignas(64) std::atomic<uint32_t> writeIndex{0};
+    alignas(64) std::atomic<uint32_t> readIndex{0};
+};
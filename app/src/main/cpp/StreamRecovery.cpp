@@ -0,0 +1,99 @@
+#include "StreamRecovery.h"
+#include "NativeLog.h"
+
+#include <algorithm>
+#include <chrono>
+
+StreamRecovery::StreamRecovery(std::function<bool()> reopen) : reopen(std::move(reopen))
+{
+}
+
+StreamRecovery::~StreamRecovery()
+{
+    stop();
+}
+
+void StreamRecovery::start()
+{
+    if (running.exchange(true))
+        return;
+    thread = std::thread(&StreamRecovery::run, this);
+}
+
+void StreamRecovery::stop()
+{
+    if (!running.exchange(false))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requested = false;
+    }
+    wake.notify_one();
+    if (thread.joinable())
+        thread.join();
+    currentState = State::Idle;
+}
+
+void StreamRecovery::request()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requested = true;
+    }
+    wake.notify_one();
+}
+
+int32_t StreamRecovery::backoffMs(int32_t failures)
+{
+    int32_t delay = INITIAL_BACKOFF_MS;
+    for (int32_t i = 1; i < failures && delay < MAX_BACKOFF_MS; i++)
+        delay *= 2;
+    return std::min(delay, MAX_BACKOFF_MS);
+}
+
+void StreamRecovery::run()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while (running.load())
+    {
+        wake.wait(lock, [this] { return requested || !running.load(); });
+        if (!running.load())
+            break;
+
+        int32_t failures = 0;
+        while (running.load())
+        {
+            requested = false;
+            currentState = State::Reopening;
+
+            lock.unlock();
+            bool reopened = reopen();
+            lock.lock();
+
+            if (reopened)
+            {
+                recoveries++;
+                currentState = State::Idle;
+                if (failures > 0)
+                    LOGI("✅ Stream recuperado após %d tentativa(s)", failures + 1);
+                break;
+            }
+
+            failures++;
+            failedAttempts++;
+            if (failures >= MAX_ATTEMPTS)
+            {
+                currentState = State::Failed;
+                LOGE("💀 Stream não reabriu após %d tentativas", failures);
+                break;
+            }
+
+            // Novo request() (outra mudança de rota) encurta a espera
+            int32_t delay = backoffMs(failures);
+            currentState = State::Backoff;
+            LOGW("⚠️ Reabertura falhou (%d), nova tentativa em %dms", failures, delay);
+            wake.wait_for(lock, std::chrono::milliseconds(delay),
+                          [this] { return requested || !running.load(); });
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// ✅ Recuperação do stream de saída numa thread própria
+//
+// O callback de erro do Oboe (troca para Bluetooth, fone desconectado, mudança de
+// rota) só chama request(): não bloqueia nem reabre nada ali. A thread chama
+// reopen() e, se falhar, tenta de novo com espera exponencial (INITIAL_BACKOFF_MS
+// dobrando até MAX_BACKOFF_MS). Depois de MAX_ATTEMPTS falhas seguidas desiste
+// (estado Failed) até o próximo request(). O buffer do PlayerCore não é tocado.
+class StreamRecovery
+{
+public:
+    static constexpr int32_t INITIAL_BACKOFF_MS = 50;
+    static constexpr int32_t MAX_BACKOFF_MS = 2000;
+    static constexpr int32_t MAX_ATTEMPTS = 20;
+
+    enum class State : int32_t
+    {
+        Idle,
+        Reopening,
+        Backoff,
+        Failed
+    };
+
+    // reopen() roda na thread de recuperação; true = stream aberto (e iniciado, se for o caso)
+    explicit StreamRecovery(std::function<bool()> reopen);
+    ~StreamRecovery();
+    StreamRecovery(const StreamRecovery &) = delete;
+    StreamRecovery &operator=(const StreamRecovery &) = delete;
+
+    void start();
+    void stop(); // Cancela a espera e aguarda a tentativa em andamento
+
+    // Qualquer thread, inclusive o callback de erro: pede uma (nova) recuperação
+    void request();
+
+    State state() const { return currentState.load(); }
+    int32_t getRecoveries() const { return recoveries.load(); }
+    int32_t getFailedAttempts() const { return failedAttempts.load(); }
+
+    static int32_t backoffMs(int32_t failures);
+
+private:
+    void run();
+
+    std::function<bool()> reopen;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool requested = false; // Protegido por mutex
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    std::atomic<State> currentState{State::Idle};
+    std::atomic<int32_t> recoveries{0};
+    std::atomic<int32_t> failedAttempts{0};
+};
@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// ✅ Trace de chegadas e callbacks (".shtr"), gravado pelo TraceRecorder no
+// celular e reproduzido no host pelo trace-replay
+//
+// Cabeçalho (little-endian, 20 bytes):
+//   0  u32 magic           'S' 'H' 'T' 'R'
+//   4  u8  version         1
+//   5  u8  channels        Canais da fonte
+//   6  u16 reservado
+//   8  u32 sampleRate      Taxa da fonte
+//   12 u32 deviceRate      Taxa do stream de saída ao começar a gravar
+//   16 u32 framesPerBurst  Burst do stream ao começar a gravar
+//
+// Depois, um registro por evento: tipo (u8), tempo desde o evento anterior em µs
+// (varint zigzag: eventos de threads diferentes podem chegar fora de ordem) e
+// valor (varint). ~4 bytes por evento, ~1KB/s com callbacks de 4ms.
+namespace trace
+{
+    constexpr int32_t HEADER_BYTES = 20;
+    constexpr uint8_t VERSION = 1;
+    constexpr int32_t MAX_RECORD_BYTES = 1 + 10 + 5;
+
+    enum EventType : uint8_t
+    {
+        EVENT_ARRIVAL = 1,  // value = frames do chunk (addAudioData/UDP)
+        EVENT_CALLBACK = 2, // value = numFrames do callback
+        EVENT_RESTART = 3,  // Stream reaberto (erro/troca de rota); value = taxa nova
+        EVENT_BURST = 4,    // value = frames por burst do stream (logo depois de RESTART)
+    };
+
+    struct Header
+    {
+        uint8_t version = VERSION;
+        int32_t channelCount = 2;
+        int32_t sampleRate = 48000;
+        int32_t deviceSampleRate = 48000;
+        int32_t framesPerBurst = 192;
+    };
+
+    struct Event
+    {
+        int64_t timeUs = 0;
+        uint8_t type = EVENT_CALLBACK;
+        uint32_t value = 0;
+    };
+
+    namespace detail
+    {
+        inline void writeLe(uint8_t *p, uint32_t v, int bytes)
+        {
+            for (int i = 0; i < bytes; i++, v >>= 8)
+                p[i] = static_cast<uint8_t>(v & 0xFF);
+        }
+
+        inline uint32_t readLe(const uint8_t *p, int bytes)
+        {
+            uint32_t v = 0;
+            for (int i = bytes - 1; i >= 0; i--)
+                v = (v << 8) | p[i];
+            return v;
+        }
+
+        inline int32_t writeVarint(uint8_t *p, uint64_t v)
+        {
+            int32_t n = 0;
+            while (v >= 0x80)
+            {
+                p[n++] = static_cast<uint8_t>(v | 0x80);
+                v >>= 7;
+            }
+            p[n++] = static_cast<uint8_t>(v);
+            return n;
+        }
+
+        inline bool readVarint(const uint8_t *&p, const uint8_t *end, uint64_t &v)
+        {
+            v = 0;
+            for (int shift = 0; shift < 64 && p < end; shift += 7)
+            {
+                uint8_t byte = *p++;
+                v |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    inline void writeHeader(uint8_t *bytes, const Header &header)
+    {
+        bytes[0] = 'S';
+        bytes[1] = 'H';
+        bytes[2] = 'T';
+        bytes[3] = 'R';
+        bytes[4] = header.version;
+        bytes[5] = static_cast<uint8_t>(header.channelCount);
+        detail::writeLe(bytes + 6, 0, 2);
+        detail::writeLe(bytes + 8, static_cast<uint32_t>(header.sampleRate), 4);
+        detail::writeLe(bytes + 12, static_cast<uint32_t>(header.deviceSampleRate), 4);
+        detail::writeLe(bytes + 16, static_cast<uint32_t>(header.framesPerBurst), 4);
+    }
+
+    // false se não for um trace SHTR de versão conhecida
+    inline bool parseHeader(const uint8_t *bytes, int32_t length, Header &out)
+    {
+        if (length < HEADER_BYTES || bytes[0] != 'S' || bytes[1] != 'H' || bytes[2] != 'T' || bytes[3] != 'R')
+            return false;
+        out.version = bytes[4];
+        out.channelCount = bytes[5];
+        out.sampleRate = static_cast<int32_t>(detail::readLe(bytes + 8, 4));
+        out.deviceSampleRate = static_cast<int32_t>(detail::readLe(bytes + 12, 4));
+        out.framesPerBurst = static_cast<int32_t>(detail::readLe(bytes + 16, 4));
+        return out.version == VERSION && out.channelCount > 0 && out.sampleRate > 0 && out.deviceSampleRate > 0;
+    }
+
+    // Registro de `event` em `bytes` (até MAX_RECORD_BYTES); devolve o tamanho
+    inline int32_t encode(uint8_t *bytes, const Event &event, int64_t previousTimeUs)
+    {
+        int64_t delta = event.timeUs - previousTimeUs;
+        uint64_t zigzag = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        bytes[0] = event.type;
+        int32_t n = 1 + detail::writeVarint(bytes + 1, zigzag);
+        return n + detail::writeVarint(bytes + n, event.value);
+    }
+
+    // Próximo registro a partir de `p` (avança); false no fim ou em registro truncado
+    inline bool decode(const uint8_t *&p, const uint8_t *end, int64_t previousTimeUs, Event &out)
+    {
+        if (p >= end)
+            return false;
+        out.type = *p++;
+        uint64_t zigzag = 0;
+        uint64_t value = 0;
+        if (!detail::readVarint(p, end, zigzag) || !detail::readVarint(p, end, value))
+            return false;
+        auto delta = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+        out.timeUs = previousTimeUs + delta;
+        out.value = static_cast<uint32_t>(value);
+        return true;
+    }
+
+    // Arquivo inteiro; os eventos voltam ordenados pelo tempo de gravação
+    inline bool readFile(const char *path, Header &header, std::vector<Event> &events)
+    {
+        FILE *file = std::fopen(path, "rb");
+        if (file == nullptr)
+            return false;
+        std::vector<uint8_t> bytes;
+        uint8_t block[4096];
+        size_t n;
+        while ((n = std::fread(block, 1, sizeof(block), file)) > 0)
+            bytes.insert(bytes.end(), block, block + n);
+        std::fclose(file);
+
+        if (!parseHeader(bytes.data(), static_cast<int32_t>(bytes.size()), header))
+            return false;
+        events.clear();
+        const uint8_t *p = bytes.data() + HEADER_BYTES;
+        const uint8_t *end = bytes.data() + bytes.size();
+        int64_t timeUs = 0;
+        Event event;
+        while (decode(p, end, timeUs, event))
+        {
+            events.push_back(event);
+            timeUs = event.timeUs;
+        }
+        std::stable_sort(events.begin(), events.end(),
+                         [](const Event &a, const Event &b) { return a.timeUs < b.timeUs; });
+        return true;
+    }
+
+    // Trace inteiro de uma vez (gerador de traces de referência no host)
+    inline bool writeFile(const char *path, const Header &header, const std::vector<Event> &events)
+    {
+        FILE *file = std::fopen(path, "wb");
+        if (file == nullptr)
+            return false;
+        std::vector<uint8_t> bytes(HEADER_BYTES + events.size() * MAX_RECORD_BYTES);
+        writeHeader(bytes.data(), header);
+        size_t length = HEADER_BYTES;
+        int64_t timeUs = 0;
+        for (const auto &event : events)
+        {
+            length += static_cast<size_t>(encode(bytes.data() + length, event, timeUs));
+            timeUs = event.timeUs;
+        }
+        bool ok = std::fwrite(bytes.data(), 1, length, file) == length;
+        return std::fclose(file) == 0 && ok;
+    }
+}
@@ -0,0 +1,144 @@
+#include "TraceRecorder.h"
+#include "NativeLog.h"
+#include "PacketFormat.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+TraceRecorder::TraceRecorder(const PlayerClock &clock) : clock(clock)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    stop();
+}
+
+bool TraceRecorder::start(const char *path, const trace::Header &header)
+{
+    stop();
+    file = std::fopen(path, "wb");
+    if (file == nullptr)
+    {
+        LOGE("❌ Trace: não abriu %s: %s", path, std::strerror(errno));
+        return false;
+    }
+
+    uint8_t bytes[trace::HEADER_BYTES];
+    trace::writeHeader(bytes, header);
+    std::fwrite(bytes, 1, sizeof(bytes), file);
+
+    // Restos de uma gravação anterior (eventos empilhados depois do stop)
+    callbackEvents.clear();
+    sharedEvents.clear();
+    channelCount = std::max(header.channelCount, 1);
+    batch.reserve(2 * QUEUE_EVENTS);
+    encoded.resize(static_cast<size_t>(2 * QUEUE_EVENTS) * trace::MAX_RECORD_BYTES);
+    lastTimeUs = 0;
+    events = 0;
+    droppedEvents = 0;
+
+    recording.store(true, std::memory_order_relaxed);
+    thread = std::thread(&TraceRecorder::run, this);
+    LOGI("🎞️ Trace: gravando em %s", path);
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    if (!recording.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+    flush();
+    std::fclose(file);
+    file = nullptr;
+    LOGI("🎞️ Trace: %lld eventos gravados (%lld descartados)", static_cast<long long>(events.load()),
+         static_cast<long long>(droppedEvents.load()));
+}
+
+void TraceRecorder::recordPacket(const uint8_t *bytes, int32_t length)
+{
+    if (!isRecording())
+        return;
+    packet::Header header;
+    int32_t frames;
+    if (packet::parse(bytes, length, header))
+        frames = header.frames > 0 ? static_cast<int32_t>(header.frames)
+                                   : (length - packet::HEADER_BYTES) / (2 * channelCount);
+    else
+        frames = length / (2 * channelCount);
+    pushShared(trace::EVENT_ARRIVAL, static_cast<uint32_t>(std::max(frames, 0)));
+}
+
+void TraceRecorder::recordArrival(int32_t frames)
+{
+    if (isRecording())
+        pushShared(trace::EVENT_ARRIVAL, static_cast<uint32_t>(std::max(frames, 0)));
+}
+
+void TraceRecorder::recordCallback(int32_t numFrames)
+{
+    if (!isRecording())
+        return;
+    trace::Event event;
+    event.timeUs = clock.nowUs();
+    event.type = trace::EVENT_CALLBACK;
+    event.value = static_cast<uint32_t>(numFrames);
+    if (!callbackEvents.push(event))
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+}
+
+void TraceRecorder::recordRestart(int32_t sampleRate, int32_t framesPerBurst)
+{
+    if (!isRecording())
+        return;
+    pushShared(trace::EVENT_RESTART, static_cast<uint32_t>(sampleRate));
+    pushShared(trace::EVENT_BURST, static_cast<uint32_t>(framesPerBurst));
+}
+
+void TraceRecorder::pushShared(uint8_t type, uint32_t value)
+{
+    trace::Event event;
+    event.type = type;
+    event.value = value;
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    event.timeUs = clock.nowUs(); // Sob o mutex: a fila sai em ordem de tempo
+    if (!sharedEvents.push(event))
+        droppedEvents++;
+}
+
+void TraceRecorder::run()
+{
+    while (recording.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+        flush();
+    }
+}
+
+// Esvazia as duas filas, intercala pelo tempo e grava
+void TraceRecorder::flush()
+{
+    batch.clear();
+    for (const trace::Event *event; (event = callbackEvents.front()) != nullptr; callbackEvents.pop())
+        batch.push_back(*event);
+    for (const trace::Event *event; (event = sharedEvents.front()) != nullptr; sharedEvents.pop())
+        batch.push_back(*event);
+    if (batch.empty())
+        return;
+    std::stable_sort(batch.begin(), batch.end(),
+                     [](const trace::Event &a, const trace::Event &b) { return a.timeUs < b.timeUs; });
+
+    size_t length = 0;
+    for (const auto &event : batch)
+    {
+        length += static_cast<size_t>(trace::encode(encoded.data() + length, event, lastTimeUs));
+        lastTimeUs = event.timeUs;
+    }
+    std::fwrite(encoded.data(), 1, length, file);
+    std::fflush(file);
+    events += static_cast<int64_t>(batch.size());
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "AudioOutputStream.h"
+#include "SpscQueue.h"
+#include "TraceFormat.h"
+
+// ✅ Gravação de trace de chegadas e callbacks (TraceFormat.h) para reproduzir
+// tempestades de underrun no host (trace-replay)
+//
+// Cada evento é só instante + tamanho, sem o áudio. O callback empilha numa fila
+// SPSC própria (sem lock, sem alocação); os produtores (JNI, thread UDP) dividem
+// outra fila sob mutex. Uma thread esvazia as duas a cada FLUSH_INTERVAL_MS e
+// grava no arquivo. Fila cheia descarta o evento e conta em getDroppedEvents().
+class TraceRecorder
+{
+public:
+    static constexpr uint32_t QUEUE_EVENTS = 4096; // ~16s de callbacks de 4ms
+    static constexpr int32_t FLUSH_INTERVAL_MS = 200;
+
+    explicit TraceRecorder(const PlayerClock &clock = PlayerClock::system());
+    ~TraceRecorder();
+    TraceRecorder(const TraceRecorder &) = delete;
+    TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+    // Cria o arquivo e começa a gravar; false se não abriu
+    bool start(const char *path, const trace::Header &header);
+    void stop(); // Grava o que falta e fecha
+
+    bool isRecording() const { return recording.load(std::memory_order_relaxed); }
+
+    // ✅ PRODUTORES: pacote como chega ao player (SHB1 ou PCM cru); frames do
+    // cabeçalho ou do tamanho do PCM
+    void recordPacket(const uint8_t *bytes, int32_t length);
+    void recordArrival(int32_t frames);
+
+    // ✅ CALLBACK: sem lock
+    void recordCallback(int32_t numFrames);
+
+    // Stream reaberto (thread de recuperação)
+    void recordRestart(int32_t sampleRate, int32_t framesPerBurst);
+
+    int64_t getEvents() const { return events.load(); }
+    int64_t getDroppedEvents() const { return droppedEvents.load(); }
+
+private:
+    void pushShared(uint8_t type, uint32_t value);
+    void run();
+    void flush();
+
+    const PlayerClock &clock;
+    int32_t channelCount = 2;
+
+    SpscQueue<trace::Event, QUEUE_EVENTS> callbackEvents; // Produtor: callback
+    SpscQueue<trace::Event, QUEUE_EVENTS> sharedEvents;   // Produtores: sob sharedMutex
+    std::mutex sharedMutex;
+
+    // Estado da thread de gravação
+    FILE *file = nullptr;
+    std::vector<trace::Event> batch;
+    std::vector<uint8_t> encoded;
+    int64_t lastTimeUs = 0;
+
+    std::atomic<bool> recording{false};
+    std::thread thread;
+    std::atomic<int64_t> events{0};
+    std::atomic<int64_t> droppedEvents{0};
+};
@@ -0,0 +1,290 @@
+#include "UdpReceiver.h"
+#include "NativeLog.h"
+#include "PacketFormat.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    int64_t steadyMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // "ip:porta" para o log
+    void describe(const sockaddr_storage &address, char *out, size_t size)
+    {
+        char host[INET6_ADDRSTRLEN] = "?";
+        int port = 0;
+        if (address.ss_family == AF_INET6)
+        {
+            const auto &in6 = reinterpret_cast<const sockaddr_in6 &>(address);
+            inet_ntop(AF_INET6, &in6.sin6_addr, host, sizeof(host));
+            port = ntohs(in6.sin6_port);
+        }
+        else if (address.ss_family == AF_INET)
+        {
+            const auto &in4 = reinterpret_cast<const sockaddr_in &>(address);
+            inet_ntop(AF_INET, &in4.sin_addr, host, sizeof(host));
+            port = ntohs(in4.sin_port);
+        }
+        std::snprintf(out, size, "%s:%d", host, port);
+    }
+
+    // Socket IPv6 que também recebe IPv4 (endereços mapeados); sem IPv6, só IPv4
+    int openSocket(int32_t port)
+    {
+        int fd = socket(AF_INET6, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0)
+        {
+            int off = 0;
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+            sockaddr_in6 address{};
+            address.sin6_family = AF_INET6;
+            address.sin6_addr = in6addr_any;
+            address.sin6_port = htons(static_cast<uint16_t>(port));
+            if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+                return fd;
+            close(fd);
+        }
+
+        fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return -1;
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+UdpReceiver::UdpReceiver(SourceMixer &mixer, int32_t peerIdleMs)
+    : mixer(mixer), peerIdleMs(peerIdleMs), datagram(MAX_DATAGRAM_BYTES)
+{
+}
+
+UdpReceiver::~UdpReceiver()
+{
+    stop();
+}
+
+int32_t UdpReceiver::start(int32_t port)
+{
+    if (running.load())
+        return boundPort.load();
+    if (port < 0 || port > 65535)
+        return -1;
+
+    socketFd = openSocket(port);
+    if (socketFd < 0)
+    {
+        LOGE("❌ UDP: bind na porta %d falhou: %s", port, std::strerror(errno));
+        return -1;
+    }
+
+    // ✅ Buffer do kernel folgado: a thread pode atrasar (GC não, mas escalonamento sim)
+    int bufferBytes = SOCKET_BUFFER_BYTES;
+    setsockopt(socketFd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+
+    sockaddr_storage local{};
+    socklen_t localLength = sizeof(local);
+    getsockname(socketFd, reinterpret_cast<sockaddr *>(&local), &localLength);
+    boundPort = ntohs(local.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 &>(local).sin6_port
+                                                  : reinterpret_cast<sockaddr_in &>(local).sin_port);
+
+    wakeups.reset();
+    running = true;
+    thread = std::thread(&UdpReceiver::run, this);
+    LOGI("✅ UDP: recebendo na porta %d", boundPort.load());
+    return boundPort.load();
+}
+
+void UdpReceiver::stop()
+{
+    if (!running.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+    close(socketFd);
+    socketFd = -1;
+    boundPort = -1;
+
+    for (auto &peer : peers)
+    {
+        if (peer.sourceId >= 0)
+            releasePeer(peer);
+    }
+    LOGI("UDP: recepção parada (%lld datagramas)", static_cast<long long>(datagrams.load()));
+}
+
+void UdpReceiver::setBatchIntervalMs(int32_t ms)
+{
+    batchIntervalMs.store(std::clamp(ms, 0, MAX_BATCH_INTERVAL_MS), std::memory_order_relaxed);
+}
+
+void UdpReceiver::run()
+{
+    int64_t lastExpiryMs = steadyMs();
+    while (running.load())
+    {
+        // Timeout curto: stop() não precisa acordar a thread, e os senders inativos expiram
+        pollfd descriptor{socketFd, POLLIN, 0};
+        int ready = poll(&descriptor, 1, POLL_INTERVAL_MS);
+        int64_t nowMs = steadyMs();
+
+        if (ready > 0)
+        {
+            // ✅ Esvaziar o socket antes de voltar ao poll
+            while (true)
+            {
+                sockaddr_storage from{};
+                socklen_t fromLength = sizeof(from);
+                ssize_t length = recvfrom(socketFd, datagram.data(), datagram.size(), MSG_DONTWAIT,
+                                          reinterpret_cast<sockaddr *>(&from), &fromLength);
+                if (length < 0)
+                {
+                    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                        LOGW("⚠️ UDP: recvfrom: %s", std::strerror(errno));
+                    break;
+                }
+                handleDatagram(datagram.data(), static_cast<int32_t>(length), from, fromLength, nowMs);
+            }
+            wakeups.tick(PlayerClock::system().nowNanos());
+
+            // ✅ Economia: deixar o próximo lote acumular no socket
+            int32_t intervalMs = batchIntervalMs.load(std::memory_order_relaxed);
+            if (intervalMs > 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+        }
+
+        if (nowMs - lastExpiryMs >= POLL_INTERVAL_MS)
+        {
+            expireIdlePeers(nowMs);
+            lastExpiryMs = nowMs;
+        }
+    }
+}
+
+void UdpReceiver::handleDatagram(const uint8_t *bytes, int32_t length, const sockaddr_storage &from,
+                                 socklen_t fromLength, int64_t nowMs)
+{
+    packet::Header header;
+    if (!packet::parse(bytes, length, header) ||
+        (header.codec != packet::CODEC_PCM16 && header.codec != packet::CODEC_OPUS))
+    {
+        rejected++;
+        return;
+    }
+
+    Peer *peer = findPeer(from, fromLength, nowMs);
+    if (peer == nullptr)
+    {
+        dropped++;
+        return;
+    }
+
+    TraceRecorder *recorder = traceRecorder.load();
+    if (recorder != nullptr && peer->sourceId == SourceMixer::DEFAULT_SOURCE)
+        recorder->recordPacket(bytes, length);
+
+    bool accepted = false;
+    bool exists = mixer.withSource(peer->sourceId, [&](SourceMixer::Source &source)
+                                   { accepted = header.codec == packet::CODEC_OPUS
+                                                    ? source.submitEncoded(bytes, length)
+                                                    : source.write(bytes, length); });
+    if (!exists)
+    {
+        // configure() recriou as fontes: o sender ganha outra no próximo pacote
+        peer->sourceId = -1;
+        peerCount--;
+    }
+
+    if (accepted)
+        datagrams++;
+    else
+        dropped++;
+}
+
+UdpReceiver::Peer *UdpReceiver::findPeer(const sockaddr_storage &from, socklen_t fromLength, int64_t nowMs)
+{
+    Peer *freeSlot = nullptr;
+    bool defaultTaken = false;
+    for (auto &peer : peers)
+    {
+        if (peer.sourceId < 0)
+        {
+            if (freeSlot == nullptr)
+                freeSlot = &peer;
+            continue;
+        }
+        if (peer.addressLength == fromLength && std::memcmp(&peer.address, &from, fromLength) == 0)
+        {
+            peer.lastPacketMs = nowMs;
+            return &peer;
+        }
+        defaultTaken = defaultTaken || peer.sourceId == SourceMixer::DEFAULT_SOURCE;
+    }
+
+    // ✅ SENDER NOVO: o primeiro fica com a fonte padrão, os outros ganham uma fonte
+    if (freeSlot == nullptr)
+        return nullptr;
+    int32_t sourceId = SourceMixer::DEFAULT_SOURCE;
+    if (defaultTaken)
+    {
+        // Mixer cheio: recusar sem chamar addSource() (que loga) a cada datagrama
+        if (mixer.getSourceCount() >= SourceMixer::MAX_SOURCES || !mixer.addSource(nextSourceId))
+            return nullptr;
+        sourceId = nextSourceId++;
+    }
+
+    freeSlot->address = from;
+    freeSlot->addressLength = fromLength;
+    freeSlot->sourceId = sourceId;
+    freeSlot->lastPacketMs = nowMs;
+    peerCount++;
+
+    char name[INET6_ADDRSTRLEN + 8];
+    describe(from, name, sizeof(name));
+    LOGI("🎚️ UDP: sender %s -> fonte %d", name, sourceId);
+    return freeSlot;
+}
+
+// A fonte padrão continua no mixer (é a do caminho Socket.IO); as outras são removidas
+void UdpReceiver::releasePeer(Peer &peer)
+{
+    if (peer.sourceId != SourceMixer::DEFAULT_SOURCE)
+        mixer.removeSource(peer.sourceId);
+    peer.sourceId = -1;
+    peerCount--;
+}
+
+void UdpReceiver::expireIdlePeers(int64_t nowMs)
+{
+    for (auto &peer : peers)
+    {
+        if (peer.sourceId >= 0 && nowMs - peer.lastPacketMs > peerIdleMs)
+        {
+            char name[INET6_ADDRSTRLEN + 8];
+            describe(peer.address, name, sizeof(name));
+            LOGI("🎚️ UDP: sender %s inativo, fonte %d liberada", name, peer.sourceId);
+            releasePeer(peer);
+        }
+    }
+}
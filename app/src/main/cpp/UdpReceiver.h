@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+#include "SourceMixer.h"
+#include "TraceRecorder.h"
+#include "WakeupMeter.h"
+
+// ✅ Recepção nativa dos chunks por UDP (sem JVM no caminho do áudio)
+//
+// Uma thread própria lê datagramas SHB1 (PacketFormat.h) e escreve direto no
+// SourceMixer: PCM16 no ring do PlayerCore, Opus na fila do DecodeWorker. Cada
+// endereço de origem (ip:porta) é um sender com fonte própria no mixer; o primeiro
+// fica com DEFAULT_SOURCE e os demais com ids a partir de FIRST_PEER_SOURCE (longe
+// dos ids que o serviço Kotlin distribui). Sender sem pacotes por PEER_IDLE_MS
+// libera a fonte. O Socket.IO continua só para controle e estatísticas.
+//
+// Datagramas sem cabeçalho SHB1 são recusados: sem sequência não há como
+// reordenar nem detectar perdas.
+//
+// Modo de economia (setBatchIntervalMs): depois de esvaziar o socket a thread dorme
+// o intervalo antes do próximo poll; os datagramas esperam no buffer do kernel e
+// são lidos juntos, num despertar só em vez de um por chunk.
+class UdpReceiver
+{
+public:
+    static constexpr int32_t MAX_DATAGRAM_BYTES = 65536;
+    static constexpr int32_t SOCKET_BUFFER_BYTES = 1 << 20; // ~5s de PCM estéreo 48kHz
+    static constexpr int32_t POLL_INTERVAL_MS = 100;         // Também a granularidade do PEER_IDLE_MS
+    static constexpr int32_t PEER_IDLE_MS = 10000;
+    static constexpr int32_t FIRST_PEER_SOURCE = 1 << 16;
+    static constexpr int32_t MAX_BATCH_INTERVAL_MS = 200;    // Bem abaixo do que cabe no socket
+
+    explicit UdpReceiver(SourceMixer &mixer, int32_t peerIdleMs = PEER_IDLE_MS);
+    ~UdpReceiver();
+    UdpReceiver(const UdpReceiver &) = delete;
+    UdpReceiver &operator=(const UdpReceiver &) = delete;
+
+    // Abre o socket (IPv6 com IPv4 mapeado, ou só IPv4) e inicia a thread.
+    // port = 0 escolhe uma porta livre. Devolve a porta ou -1.
+    int32_t start(int32_t port);
+    void stop(); // Fecha o socket e libera as fontes criadas para os senders UDP
+
+    // Espera entre leituras do socket (0 = ler assim que chegar); qualquer thread
+    void setBatchIntervalMs(int32_t ms);
+
+    // Chegadas da fonte padrão também vão para o trace (nullptr = sem trace)
+    void setTraceRecorder(TraceRecorder *recorder) { traceRecorder = recorder; }
+
+    bool isRunning() const { return running.load(); }
+    int32_t getPort() const { return boundPort.load(); }
+
+    // Estatísticas (qualquer thread)
+    int64_t getDatagrams() const { return datagrams.load(); }    // Aceitos pelo player
+    int64_t getRejected() const { return rejected.load(); }      // Sem SHB1, versão errada, vazios
+    int64_t getDropped() const { return dropped.load(); }        // Ring/fila cheios ou mixer sem vaga
+    int32_t getPeerCount() const { return peerCount.load(); }
+    int64_t getWakeupsPerSecond() const { return wakeups.perSecond(PlayerClock::system().nowNanos()); } // Com dados
+
+private:
+    struct Peer
+    {
+        sockaddr_storage address{};
+        socklen_t addressLength = 0;
+        int32_t sourceId = -1; // -1 = vaga livre
+        int64_t lastPacketMs = 0;
+    };
+
+    void run();
+    void handleDatagram(const uint8_t *bytes, int32_t length, const sockaddr_storage &from,
+                        socklen_t fromLength, int64_t nowMs);
+    Peer *findPeer(const sockaddr_storage &from, socklen_t fromLength, int64_t nowMs);
+    void releasePeer(Peer &peer);
+    void expireIdlePeers(int64_t nowMs);
+
+    SourceMixer &mixer;
+    const int32_t peerIdleMs;
+
+    int socketFd = -1;
+    std::atomic<bool> running{false};
+    std::atomic<int32_t> boundPort{-1};
+    std::thread thread;
+
+    // Estado da thread de recepção
+    std::array<Peer, SourceMixer::MAX_SOURCES> peers;
+    int32_t nextSourceId = FIRST_PEER_SOURCE;
+    std::vector<uint8_t> datagram;
+
+    std::atomic<int64_t> datagrams{0};
+    std::atomic<int64_t> rejected{0};
+    std::atomic<int64_t> dropped{0};
+    std::atomic<int32_t> peerCount{0};
+    std::atomic<int32_t> batchIntervalMs{0};
+    std::atomic<TraceRecorder *> traceRecorder{nullptr};
+    WakeupMeter wakeups; // Escrito pela thread de recepção
+};
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// ✅ Despertares por segundo de uma thread (callback de áudio, ingest), sem lock
+//
+// A thread que acorda chama tick() com o relógio dela; a taxa é a da última janela
+// fechada (WINDOW_NANOS ou mais). Escritor único com stores relaxed; qualquer
+// thread lê com perSecond(). Thread parada há mais de duas janelas conta como 0.
+//  - Escritor: tick()
+//  - Qualquer thread: perSecond()
+//  - reset() só com o escritor parado
+class WakeupMeter
+{
+public:
+    static constexpr int64_t WINDOW_NANOS = 1000000000LL;
+
+    void reset()
+    {
+        windowStartNanos = -1;
+        wakeups = 0;
+        rate.store(0, std::memory_order_relaxed);
+        lastTickNanos.store(-1, std::memory_order_relaxed);
+    }
+
+    // ✅ ESCRITOR: um despertar em nowNanos (o primeiro só abre a janela)
+    void tick(int64_t nowNanos)
+    {
+        lastTickNanos.store(nowNanos, std::memory_order_relaxed);
+        if (windowStartNanos < 0)
+        {
+            windowStartNanos = nowNanos;
+            return;
+        }
+        wakeups++;
+        int64_t elapsed = nowNanos - windowStartNanos;
+        if (elapsed >= WINDOW_NANOS)
+        {
+            rate.store((wakeups * 1000000000LL + elapsed / 2) / elapsed, std::memory_order_relaxed);
+            windowStartNanos = nowNanos;
+            wakeups = 0;
+        }
+    }
+
+    // Despertares por segundo na última janela (0 sem janela fechada ou se parou)
+    int64_t perSecond(int64_t nowNanos) const
+    {
+        int64_t last = lastTickNanos.load(std::memory_order_relaxed);
+        if (last < 0 || nowNanos - last > 2 * WINDOW_NANOS)
+            return 0;
+        return rate.load(std::memory_order_relaxed);
+    }
+
+private:
+    // Só o escritor
+    int64_t windowStartNanos = -1;
+    int64_t wakeups = 0;
+
+    std::atomic<int64_t> rate{0};
+    std::atomic<int64_t> lastTickNanos{-1};
+};
@@ -0,0 +1,181 @@
+// ✅ Testes da medida do callback contra o burst e da afinidade (ctest)
+
+#include "TestCheck.h"
+#include "../CallbackBudget.h"
+#include "FakeAudioStream.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sched.h>
+#include <sys/stat.h>
+
+namespace
+{
+    // sysfs falso: <root>/cpuN/<file> com o valor de cada núcleo
+    std::string fakeCpuRoot(const char *name, const char *file, const std::vector<long long> &values)
+    {
+        const char *tmp = std::getenv("TMPDIR");
+        std::string root = std::string(tmp != nullptr ? tmp : "/tmp") + "/" + name;
+        mkdir(root.c_str(), 0755);
+        for (size_t cpu = 0; cpu < values.size(); cpu++)
+        {
+            std::string dir = root + "/cpu" + std::to_string(cpu);
+            mkdir(dir.c_str(), 0755);
+            mkdir((dir + "/cpufreq").c_str(), 0755);
+            FILE *f = std::fopen((dir + "/" + file).c_str(), "w");
+            if (f != nullptr)
+            {
+                std::fprintf(f, "%lld\n", values[cpu]);
+                std::fclose(f);
+            }
+        }
+        return root;
+    }
+
+    void testFastCoreMask()
+    {
+        // 4 pequenos, 3 grandes e 1 prime: fica com os grandes e o prime
+        std::string bigLittle = fakeCpuRoot("budget-biglittle", "cpu_capacity",
+                                            {160, 160, 160, 160, 512, 512, 512, 1024});
+        EXPECT(CallbackBudget::fastCoreMask(bigLittle.c_str()) == 0xF0);
+
+        // Sem cpu_capacity: pela frequência máxima
+        std::string byFreq = fakeCpuRoot("budget-freq", "cpufreq/cpuinfo_max_freq",
+                                         {1800000, 1800000, 2400000, 2400000});
+        EXPECT(CallbackBudget::fastCoreMask(byFreq.c_str()) == 0xC);
+
+        // Homogêneo ou sem sysfs: não fixar
+        std::string flat = fakeCpuRoot("budget-flat", "cpu_capacity", {1024, 1024, 1024, 1024});
+        EXPECT(CallbackBudget::fastCoreMask(flat.c_str()) == 0);
+        EXPECT(CallbackBudget::fastCoreMask("/nonexistent") == 0);
+    }
+
+    void testLoad()
+    {
+        SimClock clock;
+        CallbackBudget budget(clock);
+        budget.reset(0);
+
+        // 2ms de trabalho num callback de 10ms: 200‰; a média converge para isso
+        int64_t now = 0;
+        for (int32_t i = 0; i < 200; i++)
+        {
+            clock.set(now);
+            int64_t begin = budget.begin();
+            clock.set(now + 2000000);
+            budget.end(begin, 480, 48000);
+            now += 10000000;
+        }
+        int64_t out[stats::COUNT] = {};
+        budget.snapshotInto(out);
+        EXPECT(out[stats::CALLBACK_BUDGET_US] == 10000);
+        EXPECT(out[stats::CALLBACK_LOAD_PERMILLE] > 180 && out[stats::CALLBACK_LOAD_PERMILLE] <= 200);
+        EXPECT(out[stats::CALLBACK_LOAD_MAX_PERMILLE] == 200);
+        EXPECT(out[stats::CALLBACK_OVER_BUDGET] == 0);
+        EXPECT(out[stats::CALLBACK_CPU_MASK] == 0);
+        EXPECT(out[stats::CALLBACK_CPU] >= 0);
+
+        // Um callback de 9ms (90%): conta acima do limite e vira o máximo da próxima leitura
+        clock.set(now);
+        int64_t begin = budget.begin();
+        clock.set(now + 9000000);
+        budget.end(begin, 480, 48000);
+        budget.snapshotInto(out);
+        EXPECT(out[stats::CALLBACK_OVER_BUDGET] == 1);
+        EXPECT(out[stats::CALLBACK_LOAD_MAX_PERMILLE] == 900);
+        budget.snapshotInto(out);
+        EXPECT(out[stats::CALLBACK_LOAD_MAX_PERMILLE] == 0);
+    }
+
+    // Despertares por segundo e tamanho do callback: baixa latência contra economia
+    void testWakeups()
+    {
+        SimClock clock;
+        CallbackBudget budget(clock);
+        auto run = [&](int32_t frames, double seconds)
+        {
+            budget.reset(0);
+            int64_t periodNs = static_cast<int64_t>(frames) * 1000000000LL / 48000;
+            int64_t now = 0;
+            for (; now <= static_cast<int64_t>(seconds * 1e9); now += periodNs)
+            {
+                clock.set(now);
+                int64_t begin = budget.begin();
+                clock.set(now + periodNs / 10);
+                budget.end(begin, frames, 48000);
+            }
+            clock.set(now);
+            int64_t out[stats::COUNT] = {};
+            budget.snapshotInto(out);
+            EXPECT(out[stats::CALLBACK_FRAMES] == frames);
+            return out[stats::CALLBACK_WAKEUPS_PER_S];
+        };
+
+        int64_t lowLatency = run(192, 2.5);  // 4ms
+        int64_t powerSaving = run(1920, 2.5); // 40ms
+        std::printf("despertares: %lld/s (192 frames) | %lld/s (1920 frames)\n",
+                    static_cast<long long>(lowLatency), static_cast<long long>(powerSaving));
+        EXPECT(lowLatency == 250);
+        EXPECT(powerSaving == 25);
+
+        // Antes da primeira janela fechar, e com o callback parado, a taxa é 0
+        EXPECT(run(192, 0.5) == 0);
+        run(1920, 2.5);
+        clock.set(clock.nowNanos() + 3 * WakeupMeter::WINDOW_NANOS);
+        EXPECT(budget.getWakeupsPerSecond() == 0);
+    }
+
+    // Afinidade aplicada na thread do primeiro callback, não no processo
+    void testAffinity()
+    {
+        cpu_set_t original;
+        CPU_ZERO(&original);
+        if (sched_getaffinity(0, sizeof(original), &original) != 0)
+            return;
+        int32_t target = -1;
+        for (int32_t cpu = 0; cpu < CallbackBudget::MAX_CPUS && target < 0; cpu++)
+        {
+            if (CPU_ISSET(cpu, &original))
+                target = cpu;
+        }
+        if (target < 0)
+            return;
+
+        CallbackBudget budget;
+        budget.reset(uint64_t(1) << target);
+        bool pinnedInThread = false;
+        std::thread callback([&]
+                             {
+            budget.end(budget.begin(), 192, 48000);
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            pinnedInThread = sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) == 1 &&
+                             CPU_ISSET(target, &set); });
+        callback.join();
+        EXPECT(pinnedInThread);
+        EXPECT(budget.getPinnedMask() == (uint64_t(1) << target));
+
+        cpu_set_t after;
+        CPU_ZERO(&after);
+        sched_getaffinity(0, sizeof(after), &after);
+        EXPECT(CPU_EQUAL(&after, &original));
+
+        // Stream novo: volta a fixar só no primeiro callback da thread nova
+        budget.reset(0);
+        EXPECT(budget.getPinnedMask() == 0);
+    }
+}
+
+int main()
+{
+    testFastCoreMask();
+    testLoad();
+    testWakeups();
+    testAffinity();
+
+    return testcheck::finish();
+}
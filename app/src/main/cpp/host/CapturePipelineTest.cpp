@@ -0,0 +1,338 @@
+// ✅ Testes do CapturePipeline e do medidor SIMD (ctest)
+//
+// Confere o empacotamento (sequência, timestamps extrapolados dentro das leituras,
+// payload PCM16), o pool cheio e o codificador plugável, sem libopus.
+
+#include "TestCheck.h"
+#include "../CapturePipeline.h"
+#include "../PlayerCore.h"
+#include "FakeAudioStream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960;
+    constexpr int32_t READ_FRAMES = 240; // Leituras do AudioRecord menores que o chunk
+
+    // "Codec" falso: payload = (frames, primeiro sample)
+    class FakeEncoder : public AudioEncoder
+    {
+    public:
+        int32_t encode(const int16_t *pcm, int32_t frames, uint8_t *out, int32_t maxBytes) override
+        {
+            if (maxBytes < 6)
+                return -1;
+            memcpy(out, &frames, 4);
+            memcpy(out + 4, pcm, 2);
+            return 6;
+        }
+
+        uint8_t codec() const override { return packet::CODEC_OPUS; }
+        const char *name() const override { return "fake"; }
+    };
+
+    // Frame i vale i (mod 2^15) no canal 0 e -i no canal 1
+    std::vector<int16_t> makeFrames(int32_t first, int32_t frames)
+    {
+        std::vector<int16_t> samples(static_cast<size_t>(frames) * CHANNELS);
+        for (int32_t i = 0; i < frames; i++)
+        {
+            auto v = static_cast<int16_t>((first + i) & 0x7FFF);
+            samples[2 * i] = v;
+            samples[2 * i + 1] = static_cast<int16_t>(-v);
+        }
+        return samples;
+    }
+
+    std::vector<uint8_t> takePacket(CapturePipeline &pipeline)
+    {
+        std::vector<uint8_t> bytes(pipeline.nextPacketSize());
+        if (!bytes.empty())
+            EXPECT(pipeline.readPacket(bytes.data(), static_cast<int32_t>(bytes.size())) == static_cast<int32_t>(bytes.size()));
+        return bytes;
+    }
+
+    void testLevelsMatchScalar()
+    {
+        // Tamanhos que não fecham blocos SIMD, com -32768 (|x| não cabe em int16)
+        for (int32_t samples : {0, 1, 7, 8, 15, 16, 17, 1023, 3840})
+        {
+            std::vector<int16_t> src(samples);
+            for (int32_t i = 0; i < samples; i++)
+                src[i] = static_cast<int16_t>(std::lrint(30000.0 * std::sin(i * 0.37)));
+            if (samples > 3)
+                src[samples / 2] = -32768;
+
+            std::vector<int16_t> a(samples), b(samples);
+            audiokernels::Levels simd = audiokernels::copyWithLevels(a.data(), src.data(), samples);
+            audiokernels::Levels scalar = audiokernels::copyWithLevelsScalar(b.data(), src.data(), samples);
+            EXPECT(simd.peak == scalar.peak);
+            EXPECT(simd.sumSquares == scalar.sumSquares);
+            EXPECT(a == src);
+            if (samples > 3)
+                EXPECT(simd.peak == 32768);
+        }
+
+        // Pior caso do madd: dois -32768 seguidos somam 2^31
+        std::vector<int16_t> loud(64, int16_t(-32768)), out(64);
+        audiokernels::Levels levels = audiokernels::copyWithLevels(out.data(), loud.data(), 64);
+        EXPECT(levels.sumSquares == 64ull * 32768ull * 32768ull);
+    }
+
+    void testPcmPacketization()
+    {
+        CapturePipeline pipeline;
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr));
+        EXPECT(pipeline.getCodec() == packet::CODEC_PCM16);
+
+        // 10 leituras de 5ms = 2 chunks e meio; timestamp só a partir da 3ª leitura
+        const int64_t baseUs = 5000000;
+        int32_t produced = 0;
+        for (int32_t r = 0; r < 10; r++)
+        {
+            auto samples = makeFrames(r * READ_FRAMES, READ_FRAMES);
+            int64_t ts = r < 2 ? CapturePipeline::NO_TIMESTAMP : baseUs + r * 5000;
+            produced += pipeline.write(samples.data(), READ_FRAMES, ts);
+        }
+        EXPECT(produced == 2);
+        EXPECT(pipeline.flush() == 1);
+
+        packet::Header header;
+        auto first = takePacket(pipeline);
+        EXPECT(packet::parse(first.data(), static_cast<int32_t>(first.size()), header));
+        EXPECT(header.codec == packet::CODEC_PCM16);
+        EXPECT(header.sequence == 0);
+        EXPECT(!header.hasTimestamp()); // A 1ª leitura do chunk não tinha timestamp
+        EXPECT(header.frames == static_cast<uint32_t>(CHUNK_FRAMES));
+        EXPECT(first.size() == static_cast<size_t>(packet::HEADER_BYTES + CHUNK_FRAMES * CHANNELS * 2));
+        auto expected = makeFrames(0, CHUNK_FRAMES);
+        EXPECT(memcmp(first.data() + packet::HEADER_BYTES, expected.data(), expected.size() * 2) == 0);
+
+        auto second = takePacket(pipeline);
+        EXPECT(packet::parse(second.data(), static_cast<int32_t>(second.size()), header));
+        EXPECT(header.sequence == 1);
+        EXPECT(header.hasTimestamp());
+        EXPECT(header.captureTimeUs == baseUs + 4 * 5000);
+
+        // Chunk parcial do flush: 2 leituras = 480 frames
+        auto last = takePacket(pipeline);
+        EXPECT(packet::parse(last.data(), static_cast<int32_t>(last.size()), header));
+        EXPECT(header.sequence == 2);
+        EXPECT(header.frames == static_cast<uint32_t>(2 * READ_FRAMES));
+        EXPECT(header.captureTimeUs == baseUs + 8 * 5000);
+        EXPECT(pipeline.nextPacketSize() == 0);
+
+        // O medidor reflete o último chunk (frames 1920..2399)
+        EXPECT(std::fabs(pipeline.getPeak() - 2399.0f / 32768.0f) < 1e-6f);
+        EXPECT(pipeline.getRms() > 0.0f && pipeline.getRms() < pipeline.getPeak());
+
+        // E o receptor aceita o pacote como está
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+        EXPECT(core.write(first.data(), static_cast<int32_t>(first.size())));
+        EXPECT(core.getBufferedFrames() == CHUNK_FRAMES);
+    }
+
+    void testStartsChunkMidRead()
+    {
+        CapturePipeline pipeline;
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr));
+
+        // Leitura de 1000 frames: o 2º chunk começa no frame 960 dela
+        auto samples = makeFrames(0, 1000);
+        EXPECT(pipeline.write(samples.data(), 1000, 1000000) == 1);
+        auto rest = makeFrames(1000, CHUNK_FRAMES);
+        EXPECT(pipeline.write(rest.data(), CHUNK_FRAMES, 1000000 + (1000 * 1000000LL) / SAMPLE_RATE) == 1);
+
+        packet::Header header;
+        takePacket(pipeline);
+        auto second = takePacket(pipeline);
+        EXPECT(packet::parse(second.data(), static_cast<int32_t>(second.size()), header));
+        EXPECT(header.captureTimeUs == 1000000 + 20000);
+    }
+
+    void testPoolFullDropsNewest()
+    {
+        CapturePipeline pipeline;
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr));
+
+        auto samples = makeFrames(0, CHUNK_FRAMES);
+        for (uint32_t i = 0; i < CapturePipeline::POOL_PACKETS + 3; i++)
+            pipeline.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+        EXPECT(pipeline.getPacketsProduced() == CapturePipeline::POOL_PACKETS);
+        EXPECT(pipeline.getPacketsDropped() == 3);
+
+        // Os que estavam no pool saem inteiros e em ordem; depois do descarte a sequência pula
+        packet::Header header;
+        for (uint32_t i = 0; i < CapturePipeline::POOL_PACKETS; i++)
+        {
+            auto bytes = takePacket(pipeline);
+            EXPECT(packet::parse(bytes.data(), static_cast<int32_t>(bytes.size()), header));
+            EXPECT(header.sequence == i);
+        }
+        pipeline.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+        auto bytes = takePacket(pipeline);
+        EXPECT(packet::parse(bytes.data(), static_cast<int32_t>(bytes.size()), header));
+        EXPECT(header.sequence == CapturePipeline::POOL_PACKETS + 3);
+
+        std::vector<uint8_t> tiny(8);
+        pipeline.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+        EXPECT(pipeline.readPacket(tiny.data(), 8) == -1);
+        EXPECT(pipeline.nextPacketSize() > 0); // Continua na fila
+    }
+
+    void testEncoderAndPaddedFlush()
+    {
+        CapturePipeline pipeline;
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, std::make_unique<FakeEncoder>()));
+        EXPECT(pipeline.getCodec() == packet::CODEC_OPUS);
+
+        auto samples = makeFrames(7, 100);
+        EXPECT(pipeline.write(samples.data(), 100, 2000000) == 0);
+        EXPECT(pipeline.flush() == 1);
+
+        packet::Header header;
+        auto bytes = takePacket(pipeline);
+        EXPECT(bytes.size() == static_cast<size_t>(packet::HEADER_BYTES + 6));
+        EXPECT(packet::parse(bytes.data(), static_cast<int32_t>(bytes.size()), header));
+        EXPECT(header.codec == packet::CODEC_OPUS);
+        EXPECT(header.frames == static_cast<uint32_t>(CHUNK_FRAMES)); // Completado com silêncio
+
+        int32_t encodedFrames;
+        int16_t firstSample;
+        memcpy(&encodedFrames, bytes.data() + packet::HEADER_BYTES, 4);
+        memcpy(&firstSample, bytes.data() + packet::HEADER_BYTES + 4, 2);
+        EXPECT(encodedFrames == CHUNK_FRAMES);
+        EXPECT(firstSample == 7);
+    }
+
+    // Chunk de CHUNK_FRAMES com todos os samples em ±amplitude
+    int32_t writeLevel(CapturePipeline &pipeline, int16_t amplitude)
+    {
+        std::vector<int16_t> samples(static_cast<size_t>(CHUNK_FRAMES) * CHANNELS);
+        for (size_t i = 0; i < samples.size(); i++)
+            samples[i] = static_cast<int16_t>(i % 2 == 0 ? amplitude : -amplitude);
+        return pipeline.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+    }
+
+    // ✅ DTX: marcadores só depois do hangover, com histerese, e o receptor os expande
+    void testSilenceMarkers()
+    {
+        CapturePipeline pipeline;
+        pipeline.setSilenceDetection(true);
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, std::make_unique<FakeEncoder>()));
+
+        // 300ms = 15 chunks de 20ms ainda saem codificados; do 16º em diante, marcadores
+        const int32_t hangoverChunks = SilenceDetector::HANGOVER_MS * SAMPLE_RATE / 1000 / CHUNK_FRAMES;
+        std::vector<std::vector<uint8_t>> packets;
+        for (int32_t i = 0; i < hangoverChunks + 3; i++)
+        {
+            EXPECT(writeLevel(pipeline, 10) == 1);
+            packets.push_back(takePacket(pipeline));
+        }
+        // Entre os limiares: continua em silêncio (histerese)
+        EXPECT(writeLevel(pipeline, 24) == 1);
+        packets.push_back(takePacket(pipeline));
+        EXPECT(pipeline.isSilent());
+        // Acima de EXIT_PEAK: o primeiro chunk já sai inteiro
+        EXPECT(writeLevel(pipeline, 1000) == 1);
+        packets.push_back(takePacket(pipeline));
+        EXPECT(!pipeline.isSilent());
+
+        EXPECT(pipeline.getSilentPackets() == 4);
+        for (size_t i = 0; i < packets.size(); i++)
+        {
+            packet::Header header;
+            const auto &bytes = packets[i];
+            EXPECT(packet::parse(bytes.data(), static_cast<int32_t>(bytes.size()), header));
+            EXPECT(header.sequence == i); // Cadência e sequência de sempre
+            EXPECT(header.codec == packet::CODEC_OPUS);
+            bool marker = i >= static_cast<size_t>(hangoverChunks) && i + 1 < packets.size();
+            EXPECT(header.isSilence() == marker);
+            if (!marker)
+                continue;
+
+            uint32_t frames = 0;
+            uint16_t level = 0;
+            EXPECT(bytes.size() == static_cast<size_t>(packet::HEADER_BYTES + packet::SILENCE_PAYLOAD_BYTES));
+            EXPECT(packet::parseSilence(bytes.data() + packet::HEADER_BYTES, packet::SILENCE_PAYLOAD_BYTES, frames, level));
+            EXPECT(frames == static_cast<uint32_t>(CHUNK_FRAMES));
+            EXPECT(level == (i + 2 == packets.size() ? 24 : 10));
+        }
+
+        // Receptor PCM: o marcador vira CHUNK_FRAMES de zeros, ou ruído no nível medido
+        for (bool comfortNoise : {false, true})
+        {
+            CapturePipeline sender;
+            sender.setSilenceDetection(true);
+            EXPECT(sender.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr));
+            std::vector<uint8_t> marker;
+            for (int32_t i = 0; i <= hangoverChunks; i++)
+            {
+                writeLevel(sender, 500);
+                marker = takePacket(sender);
+            }
+            EXPECT(marker.size() == static_cast<size_t>(packet::HEADER_BYTES + CHUNK_FRAMES * CHANNELS * 2));
+            for (int32_t i = 0; i <= hangoverChunks; i++)
+            {
+                writeLevel(sender, 0);
+                marker = takePacket(sender);
+            }
+            EXPECT(marker.size() == static_cast<size_t>(packet::HEADER_BYTES + packet::SILENCE_PAYLOAD_BYTES));
+
+            // Marcadores seguidos, com nível fixo para o ruído ter o que medir
+            SimClock clock;
+            PlayerCore core(clock);
+            core.configure(SAMPLE_RATE, CHANNELS);
+            core.setComfortNoise(comfortNoise);
+            core.start();
+            const int32_t markers = 12; // 240ms: passa do prebuffer sem corte de excesso
+            for (int32_t i = 0; i < markers; i++)
+            {
+                packet::Header header;
+                header.codec = packet::CODEC_PCM16;
+                header.flags = packet::FLAG_SILENCE;
+                header.sequence = static_cast<uint32_t>(i);
+                header.frames = CHUNK_FRAMES;
+                packet::write(marker.data(), header);
+                packet::writeSilence(marker.data() + packet::HEADER_BYTES, CHUNK_FRAMES, 300);
+                EXPECT(core.write(marker.data(), static_cast<int32_t>(marker.size())));
+            }
+            EXPECT(core.getBufferedFrames() == markers * CHUNK_FRAMES);
+            EXPECT(core.getSilentPackets() == markers);
+
+            FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, CHUNK_FRAMES);
+            for (int32_t i = 0; i < 4; i++)
+                core.render(output, output.data(), CHUNK_FRAMES);
+            EXPECT(core.isPlaying() && !core.isPrebuffering());
+            double sumSquares = 0;
+            for (int32_t i = 0; i < CHUNK_FRAMES * CHANNELS; i++)
+                sumSquares += static_cast<double>(output.data()[i]) * output.data()[i];
+            double rms = std::sqrt(sumSquares / (CHUNK_FRAMES * CHANNELS));
+            if (comfortNoise)
+                EXPECT(rms > 200 && rms < 350);
+            else
+                EXPECT(rms == 0);
+        }
+    }
+}
+
+int main()
+{
+    testLevelsMatchScalar();
+    testPcmPacketization();
+    testStartsChunkMidRead();
+    testPoolFullDropsNewest();
+    testEncoderAndPaddedFlush();
+    testSilenceMarkers();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,410 @@
+// ✅ Testes do relatório dos receptores e do controle de congestionamento (ctest)
+//
+// Além das decisões isoladas, fecha o laço num enlace simulado com gargalo, fila
+// limitada e perda aleatória: CapturePipeline -> enlace -> DecodeWorker/PlayerCore,
+// com os relatórios voltando ao sender. Com o controle, o receptor não tem underrun
+// depois do aquecimento e o sender gasta menos banda que com a taxa fixa.
+
+#include "TestCheck.h"
+#include "../CapturePipeline.h"
+#include "../CongestionController.h"
+#include "../DecodeWorker.h"
+#include "../ReceiverFeedback.h"
+#include "FakeAudioStream.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960;
+    constexpr int32_t BITRATE = 128000;
+
+    // "Codec" com o tamanho de um Opus na taxa atual: (frames, enchimento)
+    class RateEncoder : public AudioEncoder
+    {
+    public:
+        int32_t encode(const int16_t *, int32_t frames, uint8_t *out, int32_t maxBytes) override
+        {
+            int32_t bytes = std::clamp<int32_t>(static_cast<int32_t>(static_cast<int64_t>(rate) * frames / (8 * SAMPLE_RATE)),
+                                                4, maxBytes);
+            memset(out, 0, static_cast<size_t>(bytes));
+            memcpy(out, &frames, 4);
+            return bytes;
+        }
+
+        uint8_t codec() const override { return packet::CODEC_OPUS; }
+        const char *name() const override { return "rate"; }
+        int32_t bitrate() const override { return rate; }
+        bool setBitrate(int32_t bitrate) override
+        {
+            rate = bitrate;
+            return true;
+        }
+
+        int32_t rate = BITRATE;
+    };
+
+    class FrameDecoder : public AudioDecoder
+    {
+    public:
+        int32_t decode(const uint8_t *data, int32_t length, int16_t *pcm, int32_t maxFrames) override
+        {
+            int32_t frames = 0;
+            if (length < 4)
+                return -1;
+            memcpy(&frames, data, 4);
+            frames = std::min(frames, maxFrames);
+            std::fill_n(pcm, frames * CHANNELS, int16_t(1000));
+            return frames;
+        }
+
+        int32_t conceal(int16_t *pcm, int32_t frames) override
+        {
+            std::fill_n(pcm, frames * CHANNELS, int16_t(500));
+            return frames;
+        }
+
+        int32_t recover(const uint8_t *, int32_t, int16_t *pcm, int32_t frames) override { return conceal(pcm, frames); }
+        void reset() override {}
+        const char *name() const override { return "frames"; }
+    };
+
+    feedback::Report report(uint16_t bufferMs, uint16_t targetMs, uint16_t lossPermille, uint16_t underruns = 0)
+    {
+        feedback::Report r;
+        r.bufferMs = bufferMs;
+        r.targetMs = targetMs;
+        r.lossPermille = lossPermille;
+        r.underruns = underruns;
+        r.intervalMs = 500;
+        return r;
+    }
+
+    void testReportFormat()
+    {
+        feedback::Report in = report(180, 120, 37, 2);
+        in.flags = feedback::FLAG_PREBUFFERING;
+        in.jitterUs = 4321;
+        uint8_t bytes[feedback::REPORT_BYTES];
+        feedback::write(bytes, in);
+
+        feedback::Report out;
+        EXPECT(feedback::parse(bytes, feedback::REPORT_BYTES, out));
+        EXPECT(out.bufferMs == 180 && out.targetMs == 120 && out.lossPermille == 37);
+        EXPECT(out.underruns == 2 && out.intervalMs == 500 && out.jitterUs == 4321);
+        EXPECT(out.isPrebuffering());
+        EXPECT(!feedback::parse(bytes, feedback::REPORT_BYTES - 1, out));
+        bytes[2] = 'X';
+        EXPECT(!feedback::parse(bytes, feedback::REPORT_BYTES, out));
+
+        // Contadores acumulados viram diferenças do intervalo
+        int64_t values[stats::COUNT] = {};
+        values[stats::SAMPLE_RATE] = SAMPLE_RATE;
+        values[stats::BUFFER_FRAMES] = 4800;
+        values[stats::TARGET_FRAMES] = 9600;
+        values[stats::LOST_PACKETS] = 10;
+        values[stats::RECEIVED_PACKETS] = 100;
+        values[stats::UNDERRUNS] = 3;
+        feedback::Reporter reporter;
+        feedback::Report first = reporter.build(values, 1000);
+        EXPECT(first.bufferMs == 100 && first.targetMs == 200);
+        EXPECT(first.lossPermille == 0 && first.underruns == 0 && first.intervalMs == 0);
+
+        // Perda isolada em poucos pacotes não fecha a janela; a rajada fecha antes
+        values[stats::LOST_PACKETS] = 11;
+        values[stats::RECEIVED_PACKETS] = 110;
+        values[stats::UNDERRUNS] = 4;
+        feedback::Report second = reporter.build(values, 1500);
+        EXPECT(second.lossPermille == 0);
+        EXPECT(second.underruns == 1);
+        EXPECT(second.intervalMs == 500);
+
+        values[stats::LOST_PACKETS] = 15;
+        values[stats::RECEIVED_PACKETS] = 120;
+        feedback::Report third = reporter.build(values, 2000);
+        EXPECT(third.lossPermille == 200); // 5 de 25
+        EXPECT(third.underruns == 0);
+
+        values[stats::LOST_PACKETS] = 16;
+        values[stats::RECEIVED_PACKETS] = 218;
+        EXPECT(reporter.build(values, 2500).lossPermille == 200); // Janela ainda aberta: mantém a anterior
+        values[stats::RECEIVED_PACKETS] = 220;
+        EXPECT(reporter.build(values, 3000).lossPermille == 9); // 1 de 101
+    }
+
+    void testDecisions()
+    {
+        CongestionController controller;
+        controller.configure(SAMPLE_RATE, CHANNELS, 20, BITRATE, 60);
+        EXPECT(controller.getSettings().chunkMs == 20);
+        EXPECT(controller.getSettings().bitrate == BITRATE);
+        int64_t pacing = controller.getSettings().pacingBytesPerS;
+        EXPECT(pacing > BITRATE / 8 && pacing < BITRATE / 4);
+
+        // Perda alta: desce uma vez, e não de novo antes de DECREASE_INTERVAL_MS
+        controller.onReport(1, report(100, 100, 100), 0);
+        EXPECT(controller.getSettings().bitrate == BITRATE * 3 / 4);
+        EXPECT(controller.getSettings().chunkMs == 40);
+        EXPECT(controller.getSettings().pacingBytesPerS < pacing);
+        controller.onReport(1, report(100, 100, 100), 500);
+        EXPECT(controller.getDecreases() == 1);
+
+        // Um ouvinte bom não esconde o ruim; o ruim parado há mais de STALE_MS não conta
+        controller.onReport(2, report(100, 100, 0), 1000);
+        EXPECT(controller.getDecreases() == 2);
+        EXPECT(controller.getSettings().chunkMs == 60);
+        EXPECT(controller.getListeners() == 2);
+
+        // Limpo: primeiro o chunk volta ao nominal, depois o bitrate sobe aos poucos
+        int64_t now = 1000 + CongestionController::STALE_MS + 1;
+        int32_t lowest = controller.getSettings().bitrate;
+        std::vector<int32_t> chunks;
+        for (int32_t i = 0; i < 40; i++, now += 500)
+        {
+            controller.onReport(2, report(100, 100, 5), now);
+            if (chunks.empty() || chunks.back() != controller.getSettings().chunkMs)
+                chunks.push_back(controller.getSettings().chunkMs);
+        }
+        EXPECT(controller.getListeners() == 1);
+        EXPECT((chunks == std::vector<int32_t>{60, 40, 20}));
+        EXPECT(controller.getSettings().bitrate > lowest);
+        EXPECT(controller.getSettings().bitrate <= BITRATE);
+
+        // Buffer abaixo de metade do alvo conta como congestionamento; no prebuffer, não
+        int64_t decreases = controller.getDecreases();
+        controller.onReport(2, report(10, 100, 0), now);
+        EXPECT(controller.getDecreases() == decreases + 1);
+        feedback::Report filling = report(10, 100, 0);
+        filling.flags = feedback::FLAG_PREBUFFERING;
+        controller.onReport(2, report(100, 100, 0), now + 2000);
+        controller.onReport(3, filling, now + 2000);
+        EXPECT(controller.getDecreases() == decreases + 1);
+
+        // PCM: sem bitrate, só chunk e pacing
+        CongestionController pcm;
+        pcm.configure(SAMPLE_RATE, CHANNELS, 20, 0, 60);
+        pcm.onReport(1, report(100, 100, 0, 3), 0);
+        EXPECT(pcm.getSettings().bitrate == 0);
+        EXPECT(pcm.getSettings().chunkMs == 40);
+        EXPECT(pcm.getSettings().pacingBytesPerS > SAMPLE_RATE * CHANNELS * 2);
+    }
+
+    // O chunk e o bitrate mudam na borda do chunk seguinte; o envio respeita o balde
+    void testPipeline()
+    {
+        CapturePipeline pipeline;
+        pipeline.setAdaptive(true);
+        auto encoder = std::make_unique<RateEncoder>();
+        RateEncoder *rate = encoder.get();
+        EXPECT(pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, std::move(encoder)));
+
+        std::vector<int16_t> samples(static_cast<size_t>(CapturePipeline::MAX_CHUNK_FRAMES) * CHANNELS, int16_t(1000));
+        EXPECT(pipeline.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP) == 1);
+
+        uint8_t bytes[feedback::REPORT_BYTES];
+        feedback::write(bytes, report(100, 100, 200));
+        EXPECT(pipeline.onFeedback(7, bytes, feedback::REPORT_BYTES, 0));
+        EXPECT(!pipeline.onFeedback(7, bytes, 4, 0));
+
+        EXPECT(pipeline.write(samples.data(), 2 * CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP) == 1);
+        EXPECT(pipeline.getChunkFrames() == 2 * CHUNK_FRAMES);
+        EXPECT(rate->rate == BITRATE * 3 / 4);
+
+        // 32 pacotes prontos de uma vez: sai só a rajada, o resto no ritmo do controle
+        for (int32_t i = 0; i < 20; i++)
+            pipeline.write(samples.data(), 2 * CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+        std::vector<uint8_t> out(packet::HEADER_BYTES + CHUNK_FRAMES * CHANNELS * 2);
+        int64_t nowUs = 1000000;
+        int32_t burst = 0;
+        int32_t size;
+        while ((size = pipeline.nextPacedPacketSize(nowUs)) > 0)
+        {
+            EXPECT(pipeline.readPacket(out.data(), static_cast<int32_t>(out.size())) == size);
+            burst++;
+        }
+        EXPECT(burst >= 1 && burst < 10);
+        EXPECT(pipeline.nextPacketSize() > 0);
+
+        int64_t sentBytes = 0;
+        int64_t startUs = nowUs;
+        while (pipeline.nextPacketSize() > 0)
+        {
+            nowUs += 1000;
+            while ((size = pipeline.nextPacedPacketSize(nowUs)) > 0)
+                sentBytes += pipeline.readPacket(out.data(), static_cast<int32_t>(out.size()));
+        }
+        int64_t pacing = pipeline.getCongestionController().getSettings().pacingBytesPerS;
+        EXPECT(sentBytes * 1000000 / (nowUs - startUs) <= pacing + pacing / 10);
+
+        // Sem o controle: nada de relatório nem de pacing
+        CapturePipeline fixed;
+        EXPECT(fixed.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr));
+        EXPECT(!fixed.onFeedback(1, bytes, feedback::REPORT_BYTES, 0));
+        for (int32_t i = 0; i < 5; i++)
+            fixed.write(samples.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+        int32_t immediate = 0;
+        while (fixed.nextPacedPacketSize(0) > 0)
+            immediate += fixed.readPacket(out.data(), static_cast<int32_t>(out.size())) > 0 ? 1 : 0;
+        EXPECT(immediate == 5);
+    }
+
+    // ✅ Enlace com gargalo: fila FIFO limitada em tempo (tail drop), perda
+    // aleatória e atraso fixo. Os relatórios voltam sem perda.
+    struct LinkConfig
+    {
+        int64_t capacityBytesPerS = 10000; // 80 kbps
+        int64_t queueLimitUs = 400000;
+        int64_t propagationUs = 30000;
+        uint32_t randomLossPerMillion = 10000; // 1%
+        int64_t headerBytes = 28;               // IP/UDP
+    };
+
+    struct LinkResult
+    {
+        int32_t underruns = 0;
+        int32_t underrunsAfterWarmup = 0;
+        int64_t wireBytes = 0;
+        int64_t sent = 0;
+        int64_t queueDrops = 0;
+        int64_t lateQueueDrops = 0; // Depois do aquecimento
+        int64_t lateSent = 0;
+        int32_t finalBitrate = 0;
+    };
+
+    LinkResult runLink(bool adaptive, const LinkConfig &link)
+    {
+        constexpr int32_t BURST = 192;
+        constexpr int64_t DURATION_US = 60000000;
+        constexpr int64_t WARMUP_US = 15000000;
+        constexpr int64_t REPORT_US = 500000;
+
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FrameDecoder>(), CHANNELS);
+        FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, BURST);
+
+        CapturePipeline pipeline;
+        pipeline.setAdaptive(adaptive);
+        pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, std::make_unique<RateEncoder>());
+
+        struct InFlight
+        {
+            int64_t arrivalUs;
+            std::vector<uint8_t> bytes;
+        };
+        std::deque<InFlight> packets;
+        std::deque<InFlight> reports;
+        int64_t linkFreeUs = 0;
+        uint32_t random = 12345;
+        feedback::Reporter reporter;
+        std::vector<int16_t> input(static_cast<size_t>(BURST) * CHANNELS, int16_t(1000));
+        std::vector<uint8_t> packet(CapturePipeline::MAX_ENCODED_BYTES + packet::HEADER_BYTES);
+
+        LinkResult result;
+        int32_t underrunsAtWarmup = 0;
+        for (int64_t nowUs = 0; nowUs < DURATION_US; nowUs += BURST * 1000000LL / SAMPLE_RATE)
+        {
+            clock.set(nowUs * 1000);
+            if (nowUs < WARMUP_US)
+                underrunsAtWarmup = core.getUnderrunCount();
+
+            // Sender: captura um burst e põe no enlace o que o ritmo deixa
+            pipeline.write(input.data(), BURST, CapturePipeline::NO_TIMESTAMP);
+            int32_t size;
+            while ((size = pipeline.nextPacedPacketSize(nowUs)) > 0)
+            {
+                pipeline.readPacket(packet.data(), static_cast<int32_t>(packet.size()));
+                int64_t wire = size + link.headerBytes;
+                result.wireBytes += wire;
+                result.sent++;
+                if (nowUs >= WARMUP_US)
+                    result.lateSent++;
+
+                int64_t startUs = std::max(nowUs, linkFreeUs);
+                if (startUs - nowUs > link.queueLimitUs)
+                {
+                    result.queueDrops++;
+                    if (nowUs >= WARMUP_US)
+                        result.lateQueueDrops++;
+                    continue;
+                }
+                linkFreeUs = startUs + wire * 1000000 / link.capacityBytesPerS;
+                random = random * 1664525u + 1013904223u;
+                if ((random >> 8) % 1000000 < link.randomLossPerMillion)
+                    continue;
+                packets.push_back({linkFreeUs + link.propagationUs, std::vector<uint8_t>(packet.begin(), packet.begin() + size)});
+            }
+
+            // Receptor: chegadas até agora, decodificação e um callback
+            while (!packets.empty() && packets.front().arrivalUs <= nowUs)
+            {
+                worker.submit(packets.front().bytes.data(), static_cast<int32_t>(packets.front().bytes.size()));
+                packets.pop_front();
+            }
+            worker.drain();
+            core.render(output, output.data(), BURST);
+
+            // Relatório a cada REPORT_US, com a mesma soma de contadores do OboeAudioPlayer
+            if (nowUs % REPORT_US < BURST * 1000000LL / SAMPLE_RATE)
+            {
+                int64_t values[stats::COUNT] = {};
+                core.getStats(values);
+                values[stats::LOST_PACKETS] += worker.getLostPackets();
+                values[stats::RECEIVED_PACKETS] += worker.getReceivedPackets();
+                std::vector<uint8_t> bytes(feedback::REPORT_BYTES);
+                feedback::write(bytes.data(), reporter.build(values, nowUs / 1000));
+                reports.push_back({nowUs + link.propagationUs, std::move(bytes)});
+            }
+            while (!reports.empty() && reports.front().arrivalUs <= nowUs)
+            {
+                pipeline.onFeedback(1, reports.front().bytes.data(), feedback::REPORT_BYTES, nowUs / 1000);
+                reports.pop_front();
+            }
+        }
+
+        result.underruns = core.getUnderrunCount();
+        result.underrunsAfterWarmup = result.underruns - underrunsAtWarmup;
+        result.finalBitrate = pipeline.getBitrate();
+        return result;
+    }
+
+    void testLossyLink()
+    {
+        LinkConfig link;
+        LinkResult fixed = runLink(false, link);
+        LinkResult adaptive = runLink(true, link);
+        std::printf("  taxa fixa:   %lld bytes, %lld/%lld descartados na fila, %d underruns\n",
+                    static_cast<long long>(fixed.wireBytes), static_cast<long long>(fixed.queueDrops),
+                    static_cast<long long>(fixed.sent), fixed.underruns);
+        std::printf("  adaptativo:  %lld bytes, %lld/%lld descartados na fila, %d underruns (%d bps no fim)\n",
+                    static_cast<long long>(adaptive.wireBytes), static_cast<long long>(adaptive.queueDrops),
+                    static_cast<long long>(adaptive.sent), adaptive.underruns, adaptive.finalBitrate);
+
+        // Acima da capacidade, a taxa fixa perde boa parte na fila do gargalo
+        EXPECT(fixed.lateQueueDrops * 5 > fixed.lateSent);
+        // O controle fica abaixo do gargalo: sem underrun, pouca perda de fila e menos banda
+        EXPECT(adaptive.underrunsAfterWarmup == 0);
+        EXPECT(adaptive.lateQueueDrops * 20 < adaptive.lateSent);
+        EXPECT(adaptive.wireBytes < fixed.wireBytes);
+        EXPECT(adaptive.finalBitrate < BITRATE);
+    }
+}
+
+int main()
+{
+    testReportFormat();
+    testDecisions();
+    testPipeline();
+    testLossyLink();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,326 @@
+// ✅ Testes do DecodeWorker com um decodificador falso (ctest)
+//
+// O "codec" falso carrega só (valor, frames) no payload; PLC e FEC escrevem
+// marcadores fixos. Assim dá para conferir, sem libopus, a ordem e o tamanho do que chega
+// ao ring quando a sequência tem buracos.
+
+#include "TestCheck.h"
+#include "../DecodeWorker.h"
+#include "FakeAudioStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t PACKET_FRAMES = 960;
+    constexpr int16_t PLC_MARK = 1111;
+    constexpr int16_t FEC_MARK = 2222;
+
+    class FakeDecoder : public AudioDecoder
+    {
+    public:
+        int32_t decode(const uint8_t *data, int32_t length, int16_t *pcm, int32_t maxFrames) override
+        {
+            if (length != 4)
+                return -1;
+            int16_t value;
+            uint16_t frames;
+            memcpy(&value, data, 2);
+            memcpy(&frames, data + 2, 2);
+            std::fill_n(pcm, std::min<int32_t>(frames, maxFrames) * CHANNELS, value);
+            return std::min<int32_t>(frames, maxFrames);
+        }
+
+        int32_t conceal(int16_t *pcm, int32_t frames) override
+        {
+            std::fill_n(pcm, frames * CHANNELS, PLC_MARK);
+            return frames;
+        }
+
+        int32_t recover(const uint8_t *, int32_t, int16_t *pcm, int32_t frames) override
+        {
+            std::fill_n(pcm, frames * CHANNELS, FEC_MARK);
+            return frames;
+        }
+
+        void reset() override { resets++; }
+        const char *name() const override { return "fake"; }
+
+        int resets = 0;
+    };
+
+    // Pacote SHB1 "codificado": todos os samples valem o número de sequência
+    // (sem timestamp: o core fica no modo jitter buffer e não agenda a saída)
+    std::vector<uint8_t> makePacket(uint32_t sequence)
+    {
+        std::vector<uint8_t> bytes(packet::HEADER_BYTES + 4);
+        packet::Header header;
+        header.codec = packet::CODEC_OPUS;
+        header.sequence = sequence;
+        header.frames = PACKET_FRAMES;
+        packet::write(bytes.data(), header);
+        auto value = static_cast<int16_t>(sequence);
+        auto frames = static_cast<uint16_t>(PACKET_FRAMES);
+        memcpy(bytes.data() + packet::HEADER_BYTES, &value, 2);
+        memcpy(bytes.data() + packet::HEADER_BYTES + 2, &frames, 2);
+        return bytes;
+    }
+
+    // Lê o sample do meio de cada bloco de PACKET_FRAMES (as bordas passam pela
+    // interpolação do reamostrador)
+    std::vector<int16_t> readBlocks(PlayerCore &core, const PlayerClock &clock, int32_t blocks)
+    {
+        FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, PACKET_FRAMES);
+        std::vector<int16_t> marks;
+        for (int32_t i = 0; i < blocks; i++)
+        {
+            core.render(output, output.data(), PACKET_FRAMES);
+            marks.push_back(output.data()[(PACKET_FRAMES / 2) * CHANNELS]);
+        }
+        return marks;
+    }
+
+    void testGapsAndResync()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        auto decoder = std::make_unique<FakeDecoder>();
+        FakeDecoder *fake = decoder.get();
+        worker.configure(std::move(decoder), CHANNELS);
+
+        // 0 1 [2 perdido] 3 [4 5 perdidos] 6 [7..19 perdidos] 20
+        for (uint32_t sequence : {0u, 1u, 3u, 6u, 20u})
+        {
+            auto bytes = makePacket(sequence);
+            EXPECT(worker.submit(bytes.data(), static_cast<int32_t>(bytes.size())));
+        }
+        EXPECT(worker.drain() == 5);
+
+        EXPECT(worker.getDecodedPackets() == 5);
+        EXPECT(worker.getLostPackets() == 3 + 13);
+        EXPECT(worker.getRecoveredPackets() == 2);             // FEC para 2 e 5
+        EXPECT(worker.getConcealedFrames() == PACKET_FRAMES); // PLC para 4
+        EXPECT(worker.getDecoderResets() == 1);                // Buraco de 13 > MAX_CONCEAL_PACKETS
+        EXPECT(fake->resets == 1);
+        EXPECT(core.getBufferedFrames() == 8 * PACKET_FRAMES);
+
+        // Pular o prebuffer: o alvo inicial cabe nos 8 blocos
+        std::vector<int16_t> marks = readBlocks(core, clock, 9);
+        std::vector<int16_t> expected = {0, 0, 1, FEC_MARK, 3, PLC_MARK, FEC_MARK, 6, 20};
+        // O primeiro callback é prebuffer (silêncio) só se o alvo não foi atingido
+        if (marks.front() == 0 && marks[1] == 0)
+            marks.erase(marks.begin());
+        expected.erase(expected.begin());
+        EXPECT(marks.size() >= expected.size());
+        for (size_t i = 0; i < expected.size() && i < marks.size(); i++)
+        {
+            if (marks[i] != expected[i])
+            {
+                std::fprintf(stderr, "  bloco %zu: %d (esperado %d)\n", i, marks[i], expected[i]);
+                testcheck::failures++;
+            }
+        }
+    }
+
+    // ✅ DTX: o marcador não passa pelo decodificador e a perda antes dele vai para o
+    // PLC (ele não carrega FEC)
+    void testSilenceMarkers()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FakeDecoder>(), CHANNELS);
+
+        // 0 [1 perdido] 2=silêncio 3=silêncio 4
+        for (uint32_t sequence : {0u, 2u, 3u, 4u})
+        {
+            std::vector<uint8_t> bytes = makePacket(sequence);
+            if (sequence == 2 || sequence == 3)
+            {
+                bytes.resize(packet::HEADER_BYTES + packet::SILENCE_PAYLOAD_BYTES);
+                packet::Header header;
+                header.codec = packet::CODEC_OPUS;
+                header.flags = packet::FLAG_SILENCE;
+                header.sequence = sequence;
+                header.frames = PACKET_FRAMES;
+                packet::write(bytes.data(), header);
+                packet::writeSilence(bytes.data() + packet::HEADER_BYTES, PACKET_FRAMES, 0);
+            }
+            EXPECT(worker.submit(bytes.data(), static_cast<int32_t>(bytes.size())));
+        }
+        EXPECT(worker.drain() == 4);
+        EXPECT(worker.getDecodedPackets() == 2);
+        EXPECT(worker.getSilentPackets() == 2);
+        EXPECT(worker.getRecoveredPackets() == 0);
+        EXPECT(worker.getConcealedFrames() == PACKET_FRAMES);
+        EXPECT(core.getBufferedFrames() == 5 * PACKET_FRAMES);
+
+        std::vector<int16_t> marks = readBlocks(core, clock, 6);
+        if (marks.front() == 0 && marks[1] == 0)
+            marks.erase(marks.begin());
+        std::vector<int16_t> expected = {0, PLC_MARK, 0, 0, 4};
+        EXPECT(marks.size() >= expected.size());
+        for (size_t i = 0; i < expected.size() && i < marks.size(); i++)
+            EXPECT(marks[i] == expected[i]);
+
+        // Marcador com frames fora do limite: rejeitado sem tocar no ring
+        std::vector<uint8_t> bad(packet::HEADER_BYTES + packet::SILENCE_PAYLOAD_BYTES);
+        packet::Header header;
+        header.codec = packet::CODEC_OPUS;
+        header.flags = packet::FLAG_SILENCE;
+        header.sequence = 5;
+        packet::write(bad.data(), header);
+        packet::writeSilence(bad.data() + packet::HEADER_BYTES, DecodeWorker::MAX_FRAMES_PER_PACKET + 1, 0);
+        EXPECT(worker.submit(bad.data(), static_cast<int32_t>(bad.size())));
+        worker.drain();
+        EXPECT(worker.getRejectedPackets() == 1);
+        EXPECT(core.getBufferedFrames() <= 5 * PACKET_FRAMES);
+    }
+
+    void testRejectsNonOpus()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FakeDecoder>(), CHANNELS);
+
+        std::vector<uint8_t> raw(PACKET_FRAMES * CHANNELS * 2, 0); // PCM cru, sem cabeçalho
+        EXPECT(!worker.submit(raw.data(), static_cast<int32_t>(raw.size())));
+        EXPECT(worker.getRejectedPackets() == 1);
+
+        DecodeWorker disabled(core);
+        disabled.configure(nullptr, CHANNELS);
+        auto bytes = makePacket(0);
+        EXPECT(!disabled.isAvailable());
+        EXPECT(!disabled.submit(bytes.data(), static_cast<int32_t>(bytes.size())));
+    }
+
+    // A thread real entrega tudo ao ring
+    void testThreaded()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FakeDecoder>(), CHANNELS);
+        worker.start();
+        for (uint32_t sequence = 0; sequence < 32; sequence++)
+        {
+            auto bytes = makePacket(sequence);
+            bool accepted = false;
+            for (int attempt = 0; attempt < 1000 && !accepted; attempt++)
+            {
+                accepted = worker.submit(bytes.data(), static_cast<int32_t>(bytes.size()));
+                if (!accepted)
+                    std::this_thread::yield();
+            }
+            EXPECT(accepted);
+        }
+        for (int i = 0; i < 500 && worker.getDecodedPackets() < 32; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        worker.stop();
+
+        EXPECT(worker.getDecodedPackets() == 32);
+        EXPECT(core.getBufferedFrames() == 32 * PACKET_FRAMES);
+    }
+
+    // submitBatch: um lote com pacote inválido no meio; um despertar entrega o resto
+    void testBatchThreaded()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FakeDecoder>(), CHANNELS);
+        worker.start();
+
+        std::vector<uint8_t> bytes;
+        std::vector<int32_t> offsets;
+        for (uint32_t sequence = 0; sequence < 16; sequence++)
+        {
+            offsets.push_back(static_cast<int32_t>(bytes.size()));
+            auto packet = makePacket(sequence);
+            bytes.insert(bytes.end(), packet.begin(), packet.end());
+            if (sequence == 7)
+            {
+                offsets.push_back(static_cast<int32_t>(bytes.size()));
+                bytes.insert(bytes.end(), 8, 0); // Sem cabeçalho: recusado
+            }
+        }
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+
+        EXPECT(worker.submitBatch(bytes.data(), offsets.data(), 17) == 16);
+        EXPECT(worker.getRejectedPackets() == 1);
+        for (int i = 0; i < 500 && worker.getDecodedPackets() < 16; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        worker.stop();
+
+        EXPECT(worker.getDecodedPackets() == 16);
+        EXPECT(core.getBufferedFrames() == 16 * PACKET_FRAMES);
+    }
+
+    // ✅ discardPending: PCM vai entrar no mesmo core. Nada do que estava na fila chega
+    // ao ring, e um worker que rodava volta a rodar
+    void testDiscardPending()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        DecodeWorker worker(core);
+        worker.configure(std::make_unique<FakeDecoder>(), CHANNELS);
+        for (uint32_t sequence = 0; sequence < 3; sequence++)
+        {
+            auto bytes = makePacket(sequence);
+            EXPECT(worker.submit(bytes.data(), static_cast<int32_t>(bytes.size())));
+        }
+        worker.discardPending();
+        EXPECT(worker.drain() == 0);
+        EXPECT(core.getBufferedFrames() == 0);
+
+        worker.start();
+        worker.discardPending();
+        auto bytes = makePacket(40); // Sequência nova: a reordenação também recomeçou
+        EXPECT(worker.submit(bytes.data(), static_cast<int32_t>(bytes.size())));
+        for (int i = 0; i < 500 && worker.getDecodedPackets() < 1; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        worker.stop();
+        EXPECT(worker.getDecodedPackets() == 1);
+        EXPECT(worker.getLostPackets() == 0);
+        EXPECT(core.getBufferedFrames() == PACKET_FRAMES);
+    }
+}
+
+int main()
+{
+    testGapsAndResync();
+    testSilenceMarkers();
+    testRejectsNonOpus();
+    testThreaded();
+    testBatchThreaded();
+    testDiscardPending();
+
+    return testcheck::finish();
+}
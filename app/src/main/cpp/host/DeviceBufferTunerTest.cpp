@@ -0,0 +1,177 @@
+// ✅ Testes do ajuste do buffer do dispositivo (ctest)
+
+#include "TestCheck.h"
+#include "../DeviceBufferTuner.h"
+
+#include <cstdio>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t BURST = 192;
+    constexpr int32_t CAPACITY = 192 * 16;
+
+    // Callbacks de um burst, como o Oboe; devolve o último tamanho pedido (0 = nenhum)
+    struct Rig
+    {
+        DeviceBufferTuner tuner;
+        int32_t xruns = 0;
+        int32_t applied = 0;
+
+        explicit Rig(bool xrunsSupported = true)
+        {
+            tuner.reset(BURST, CAPACITY, SAMPLE_RATE, xrunsSupported);
+        }
+
+        void run(int32_t ms, bool audible = true)
+        {
+            int32_t callbacks = static_cast<int32_t>((static_cast<int64_t>(ms) * SAMPLE_RATE) / 1000 / BURST);
+            for (int32_t i = 0; i < callbacks; i++)
+            {
+                if (!tuner.tick(BURST))
+                    continue;
+                int32_t size = tuner.update(xruns, audible);
+                if (size > 0)
+                {
+                    applied = size;
+                    tuner.setActual(size);
+                }
+            }
+        }
+
+        int32_t bursts() const { return tuner.getBufferSize() / BURST; }
+    };
+
+    void testStartsSmall()
+    {
+        Rig rig;
+        EXPECT(rig.tuner.isEnabled());
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+
+        // Sem xrun: não muda (já está no mínimo)
+        rig.run(60000);
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+        EXPECT(rig.applied == 0);
+    }
+
+    void testGrowsOnXrun()
+    {
+        Rig rig;
+        rig.run(100);
+        rig.xruns = 1;
+        rig.run(100);
+        EXPECT(rig.bursts() == 3);
+        EXPECT(rig.tuner.getGrowths() == 1);
+
+        // Vários xruns entre duas leituras: um burst por verificação
+        rig.xruns = 5;
+        rig.run(DeviceBufferTuner::CHECK_INTERVAL_MS);
+        EXPECT(rig.bursts() == 4);
+    }
+
+    // Prebuffer (saída em silêncio): xrun não custa latência
+    void testIgnoresXrunWhileSilent()
+    {
+        Rig rig;
+        rig.run(100, false);
+        rig.xruns = 3;
+        rig.run(100, false);
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+
+        // O contador já foi visto: não cresce quando o áudio começa
+        rig.run(100, true);
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+    }
+
+    void testShrinksAfterQuietPeriod()
+    {
+        Rig rig;
+        rig.run(100);
+        for (int32_t i = 1; i <= 3; i++)
+        {
+            rig.xruns = i;
+            rig.run(100);
+        }
+        EXPECT(rig.bursts() == 5);
+
+        rig.run(DeviceBufferTuner::QUIET_PERIOD_MS - 1000);
+        EXPECT(rig.bursts() == 5);
+        rig.run(2000);
+        EXPECT(rig.bursts() == 4);
+        EXPECT(rig.tuner.getShrinks() == 1);
+
+        // Continua encolhendo até o mínimo, e não passa dele
+        rig.run(DeviceBufferTuner::QUIET_PERIOD_MS * 5);
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+        EXPECT(rig.tuner.getShrinks() == 3);
+    }
+
+    // Xrun logo depois de encolher: a próxima espera dobra
+    void testBackoffAfterFailedShrink()
+    {
+        Rig rig;
+        rig.run(100);
+        rig.xruns = 1;
+        rig.run(100);
+        rig.xruns = 2;
+        rig.run(100);
+        EXPECT(rig.bursts() == 4);
+
+        rig.run(DeviceBufferTuner::QUIET_PERIOD_MS + 100);
+        EXPECT(rig.bursts() == 3);
+        rig.xruns = 3;
+        rig.run(100);
+        EXPECT(rig.bursts() == 4);
+        EXPECT(rig.tuner.getQuietPeriodMs() == 2 * DeviceBufferTuner::QUIET_PERIOD_MS);
+
+        // O período antigo não basta mais
+        rig.run(DeviceBufferTuner::QUIET_PERIOD_MS + 1000);
+        EXPECT(rig.bursts() == 4);
+        rig.run(DeviceBufferTuner::QUIET_PERIOD_MS);
+        EXPECT(rig.bursts() == 3);
+
+        // Encolhimento estável (sem xrun no período inteiro): xrun depois não dobra
+        rig.run(4 * DeviceBufferTuner::QUIET_PERIOD_MS);
+        EXPECT(rig.bursts() == DeviceBufferTuner::INITIAL_BURSTS);
+        rig.xruns = 4;
+        rig.run(100);
+        EXPECT(rig.tuner.getQuietPeriodMs() == 2 * DeviceBufferTuner::QUIET_PERIOD_MS);
+    }
+
+    void testCapacityLimit()
+    {
+        Rig rig;
+        rig.run(100);
+        for (int32_t i = 1; i <= 40; i++)
+        {
+            rig.xruns = i;
+            rig.run(DeviceBufferTuner::CHECK_INTERVAL_MS);
+        }
+        EXPECT(rig.tuner.getBufferSize() == CAPACITY);
+        EXPECT(rig.tuner.getGrowths() == CAPACITY / BURST - DeviceBufferTuner::INITIAL_BURSTS);
+    }
+
+    // Sem getXRunCount() (OpenSL ES): tamanho fixo de antes
+    void testFallbackWithoutXruns()
+    {
+        Rig rig(false);
+        EXPECT(!rig.tuner.isEnabled());
+        EXPECT(rig.tuner.getBufferSize() == CAPACITY * DeviceBufferTuner::FALLBACK_PERCENT / 100);
+        rig.xruns = 10;
+        rig.run(1000);
+        EXPECT(rig.applied == 0);
+    }
+}
+
+int main()
+{
+    testStartsSmall();
+    testGrowsOnXrun();
+    testIgnoresXrunWhileSilent();
+    testShrinksAfterQuietPeriod();
+    testBackoffAfterFailedShrink();
+    testCapacityLimit();
+    testFallbackWithoutXruns();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "../AudioOutputStream.h"
+
+// ✅ Relógio simulado: o tempo só anda quando o simulador manda
+class SimClock : public PlayerClock
+{
+public:
+    int64_t nowNanos() const override { return now; }
+    void set(int64_t nanos) { now = nanos; }
+
+private:
+    int64_t now = 0;
+};
+
+// ✅ Stream de saída falso: formato fixo, o simulador chama o render a cada burst
+//
+// O frame escrito no instante t sai no "alto-falante" em t + outputLatency,
+// e getTimestamp reporta exatamente isso (como um AAudio ideal).
+class FakeAudioStream : public AudioOutputStream
+{
+public:
+    FakeAudioStream(const PlayerClock &clock, int32_t sampleRate, int32_t channelCount,
+                    int32_t framesPerBurst, int64_t outputLatencyNanos = 0)
+        : clock(clock), sampleRate(sampleRate), channelCount(channelCount),
+          framesPerBurst(framesPerBurst), outputLatencyNanos(outputLatencyNanos),
+          buffer(static_cast<size_t>(framesPerBurst) * channelCount),
+          floatBuffer(static_cast<size_t>(framesPerBurst) * channelCount)
+    {
+    }
+
+    // Dispositivo que abriu em float: o render escreve em floatData()
+    void setFormat(OutputFormat value) { format = value; }
+
+    int32_t getSampleRate() const override { return sampleRate; }
+    int32_t getChannelCount() const override { return channelCount; }
+    OutputFormat getFormat() const override { return format; }
+    int32_t getFramesPerBurst() const override { return framesPerBurst; }
+    int64_t getFramesWritten() const override { return framesWritten; }
+
+    bool getTimestamp(int64_t &framePosition, int64_t &timeNanos) const override
+    {
+        if (framesWritten < timestampFromFrame)
+            return false; // Stream recém-aberto: latência ainda não medida
+        framePosition = framesWritten;
+        timeNanos = clock.nowNanos() + outputLatencyNanos;
+        return true;
+    }
+
+    // Chamado pelo simulador depois de cada render
+    void advance(int32_t frames) { framesWritten += frames; }
+
+    // Stream reaberto (troca de rota): contador zerado, outra latência e sem
+    // timestamp durante os primeiros `timestampDelayFrames` frames
+    void restart(int64_t newOutputLatencyNanos, int64_t timestampDelayFrames)
+    {
+        framesWritten = 0;
+        outputLatencyNanos = newOutputLatencyNanos;
+        timestampFromFrame = timestampDelayFrames;
+    }
+
+    // Stream reaberto com outra taxa/burst (replay de trace). O buffer do callback
+    // não muda: precisa ter sido criado com o maior callback do trace.
+    void reconfigure(int32_t newSampleRate, int32_t newFramesPerBurst)
+    {
+        sampleRate = newSampleRate;
+        framesPerBurst = newFramesPerBurst;
+    }
+
+    // Instante em que o primeiro frame do último render sai no alto-falante
+    int64_t presentationNanos() const { return clock.nowNanos() + outputLatencyNanos; }
+
+    // Período do callback em nanossegundos no relógio do receptor
+    int64_t callbackPeriodNanos() const
+    {
+        return (static_cast<int64_t>(framesPerBurst) * 1000000000LL) / sampleRate;
+    }
+
+    int16_t *data() { return buffer.data(); }
+    const int16_t *data() const { return buffer.data(); }
+    float *floatData() { return floatBuffer.data(); }
+
+    // Buffer do callback no formato atual
+    void *output() { return format == OutputFormat::Float ? static_cast<void *>(floatBuffer.data()) : buffer.data(); }
+
+private:
+    const PlayerClock &clock;
+    int32_t sampleRate;
+    int32_t channelCount;
+    int32_t framesPerBurst;
+    int64_t outputLatencyNanos;
+    int64_t framesWritten = 0;
+    int64_t timestampFromFrame = 0;
+    OutputFormat format = OutputFormat::I16;
+    std::vector<int16_t> buffer;
+    std::vector<float> floatBuffer;
+};
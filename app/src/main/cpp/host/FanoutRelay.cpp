@@ -0,0 +1,505 @@
+#include "FanoutRelay.h"
+#include "../NativeLog.h"
+#include "../PacketFormat.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t INGEST_TAG = UINT32_MAX; // epoll_event.data do socket de ingest
+    constexpr int32_t SOCKET_BUFFER_BYTES = 1 << 20;
+    constexpr int32_t MAX_EVENTS = 64;
+
+    int64_t steadyMs()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // "ip:porta" para o log
+    void describe(const sockaddr_storage &address, char *out, size_t size)
+    {
+        char host[INET6_ADDRSTRLEN] = "?";
+        int port = 0;
+        if (address.ss_family == AF_INET6)
+        {
+            const auto &in6 = reinterpret_cast<const sockaddr_in6 &>(address);
+            inet_ntop(AF_INET6, &in6.sin6_addr, host, sizeof(host));
+            port = ntohs(in6.sin6_port);
+        }
+        else if (address.ss_family == AF_INET)
+        {
+            const auto &in4 = reinterpret_cast<const sockaddr_in &>(address);
+            inet_ntop(AF_INET, &in4.sin_addr, host, sizeof(host));
+            port = ntohs(in4.sin_port);
+        }
+        std::snprintf(out, size, "%s:%d", host, port);
+    }
+
+    bool sameAddress(const sockaddr_storage &a, socklen_t aLength, const sockaddr_storage &b, socklen_t bLength)
+    {
+        return aLength == bLength && std::memcmp(&a, &b, aLength) == 0;
+    }
+
+    // Socket IPv6 que também recebe IPv4 (endereços mapeados); sem IPv6, só IPv4
+    int openIngest(int32_t port)
+    {
+        int fd = socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd >= 0)
+        {
+            int off = 0;
+            setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+            sockaddr_in6 address{};
+            address.sin6_family = AF_INET6;
+            address.sin6_addr = in6addr_any;
+            address.sin6_port = htons(static_cast<uint16_t>(port));
+            if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0)
+                return fd;
+            close(fd);
+        }
+
+        fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            return -1;
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+}
+
+FanoutRelay::FanoutRelay(int32_t subscriberIdleMs)
+    : subscriberIdleMs(subscriberIdleMs),
+      pool(static_cast<size_t>(POOL_PACKETS) * MAX_PACKET_BYTES),
+      lengths(POOL_PACKETS, 0),
+      refs(POOL_PACKETS, 0),
+      subscribers(MAX_SUBSCRIBERS)
+{
+    freeList.reserve(POOL_PACKETS);
+    for (auto &subscriber : subscribers)
+        subscriber.queue.resize(QUEUE_PACKETS);
+}
+
+FanoutRelay::~FanoutRelay()
+{
+    stop();
+}
+
+int32_t FanoutRelay::start(int32_t port)
+{
+    if (running.load())
+        return boundPort.load();
+    if (port < 0 || port > 65535)
+        return -1;
+
+    ingestFd = openIngest(port);
+    if (ingestFd < 0)
+    {
+        LOGE("❌ Relay: bind na porta %d falhou: %s", port, std::strerror(errno));
+        return -1;
+    }
+    int bufferBytes = SOCKET_BUFFER_BYTES;
+    setsockopt(ingestFd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u32 = INGEST_TAG;
+    if (epollFd < 0 || epoll_ctl(epollFd, EPOLL_CTL_ADD, ingestFd, &event) != 0)
+    {
+        LOGE("❌ Relay: epoll: %s", std::strerror(errno));
+        if (epollFd >= 0)
+            close(epollFd);
+        close(ingestFd);
+        epollFd = ingestFd = -1;
+        return -1;
+    }
+
+    sockaddr_storage local{};
+    socklen_t localLength = sizeof(local);
+    getsockname(ingestFd, reinterpret_cast<sockaddr *>(&local), &localLength);
+    boundPort = ntohs(local.ss_family == AF_INET6 ? reinterpret_cast<sockaddr_in6 &>(local).sin6_port
+                                                  : reinterpret_cast<sockaddr_in &>(local).sin_port);
+
+    freeList.clear();
+    for (int32_t i = POOL_PACKETS - 1; i >= 0; i--)
+        freeList.push_back(i);
+    senderLength = 0;
+
+    running = true;
+    thread = std::thread(&FanoutRelay::run, this);
+    LOGI("✅ Relay: ingest na porta %d", boundPort.load());
+    return boundPort.load();
+}
+
+void FanoutRelay::stop()
+{
+    if (!running.exchange(false))
+        return;
+    if (thread.joinable())
+        thread.join();
+
+    for (int32_t slot = 0; slot < MAX_SUBSCRIBERS; slot++)
+    {
+        if (subscribers[slot].fd >= 0)
+            removeSubscriber(slot);
+    }
+    close(epollFd);
+    close(ingestFd);
+    epollFd = ingestFd = -1;
+    boundPort = -1;
+    LOGI("Relay: parado (%lld recebidos, %lld entregues)", static_cast<long long>(ingested.load()),
+         static_cast<long long>(forwarded.load()));
+}
+
+void FanoutRelay::run()
+{
+    epoll_event events[MAX_EVENTS];
+    int64_t lastExpiryMs = steadyMs();
+    while (running.load())
+    {
+        // Timeout curto: stop() não precisa acordar a thread, e os ouvintes inativos expiram
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, POLL_INTERVAL_MS);
+        int64_t nowMs = steadyMs();
+
+        for (int i = 0; i < ready; i++)
+        {
+            uint32_t tag = events[i].data.u32;
+            if (tag == INGEST_TAG)
+            {
+                receive(nowMs);
+                continue;
+            }
+
+            auto slot = static_cast<int32_t>(tag);
+            if (subscribers[slot].fd < 0)
+                continue;
+            if ((events[i].events & EPOLLERR) != 0)
+            {
+                // Porta do ouvinte fechada (ICMP): sai agora, sem esperar a expiração
+                int error = 0;
+                socklen_t errorLength = sizeof(error);
+                getsockopt(subscribers[slot].fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+                if (error == ECONNREFUSED)
+                {
+                    removeSubscriber(slot);
+                    continue;
+                }
+            }
+            flush(slot); // Volta a só EPOLLERR quando a fila esvazia
+        }
+
+        if (nowMs - lastExpiryMs >= POLL_INTERVAL_MS)
+        {
+            expireIdleSubscribers(nowMs);
+            lastExpiryMs = nowMs;
+        }
+    }
+}
+
+// ✅ Esvazia o ingest em lotes de RECV_BATCH, direto para buffers do pool
+void FanoutRelay::receive(int64_t nowMs)
+{
+    mmsghdr messages[RECV_BATCH];
+    iovec vectors[RECV_BATCH];
+    sockaddr_storage sources[RECV_BATCH];
+    int32_t indices[RECV_BATCH];
+
+    while (true)
+    {
+        int32_t batch = std::min<int32_t>(RECV_BATCH, static_cast<int32_t>(freeList.size()));
+        if (batch == 0)
+            break; // Não acontece com POOL_PACKETS = QUEUE_PACKETS + RECV_BATCH
+        for (int32_t i = 0; i < batch; i++)
+        {
+            indices[i] = acquire();
+            vectors[i] = {bytesOf(indices[i]), static_cast<size_t>(MAX_PACKET_BYTES)};
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+            messages[i].msg_hdr.msg_name = &sources[i];
+            messages[i].msg_hdr.msg_namelen = sizeof(sources[i]);
+        }
+
+        int received = recvmmsg(ingestFd, messages, static_cast<unsigned>(batch), MSG_DONTWAIT, nullptr);
+        if (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            LOGW("⚠️ Relay: recvmmsg: %s", std::strerror(errno));
+
+        for (int32_t i = 0; i < std::max(received, 0); i++)
+        {
+            const uint8_t *bytes = bytesOf(indices[i]);
+            auto length = static_cast<int32_t>(messages[i].msg_len);
+            const msghdr &header = messages[i].msg_hdr;
+            packet::Header parsed;
+
+            if (length >= relay::SUBSCRIBE_BYTES && bytes[0] == 'S' && bytes[1] == 'H' && bytes[2] == 'S' && bytes[3] == 'B')
+            {
+                handleSubscribe(bytes, sources[i], header.msg_namelen, nowMs);
+            }
+            else if ((header.msg_flags & MSG_TRUNC) == 0 && packet::parse(bytes, length, parsed) &&
+                     acceptSender(sources[i], header.msg_namelen, nowMs))
+            {
+                lengths[indices[i]] = length;
+                ingested++;
+                fanOut(indices[i]);
+            }
+            else
+            {
+                rejected++;
+            }
+        }
+        for (int32_t i = 0; i < batch; i++)
+            release(indices[i]); // A referência da recepção; as filas têm as delas
+
+        // Um sendmmsg por ouvinte por lote
+        for (int32_t slot = 0; slot < MAX_SUBSCRIBERS; slot++)
+        {
+            const Subscriber &subscriber = subscribers[slot];
+            if (subscriber.fd >= 0 && subscriber.count > 0 && !subscriber.waitingWritable)
+                flush(slot);
+        }
+
+        if (received < batch)
+            break;
+    }
+}
+
+void FanoutRelay::handleSubscribe(const uint8_t *bytes, const sockaddr_storage &from, socklen_t fromLength,
+                                  int64_t nowMs)
+{
+    if (bytes[4] != relay::VERSION)
+    {
+        rejected++;
+        return;
+    }
+    bool unsubscribe = (bytes[5] & relay::FLAG_UNSUBSCRIBE) != 0;
+    auto port = static_cast<uint16_t>(bytes[6] | (bytes[7] << 8));
+
+    sockaddr_storage address = from;
+    if (port != 0 && address.ss_family == AF_INET6)
+        reinterpret_cast<sockaddr_in6 &>(address).sin6_port = htons(port);
+    else if (port != 0)
+        reinterpret_cast<sockaddr_in &>(address).sin_port = htons(port);
+
+    int32_t freeSlot = -1;
+    for (int32_t slot = 0; slot < MAX_SUBSCRIBERS; slot++)
+    {
+        Subscriber &subscriber = subscribers[slot];
+        if (subscriber.fd < 0)
+        {
+            if (freeSlot < 0)
+                freeSlot = slot;
+            continue;
+        }
+        if (sameAddress(subscriber.address, subscriber.addressLength, address, fromLength))
+        {
+            if (unsubscribe)
+                removeSubscriber(slot);
+            else
+                subscriber.lastSeenMs = nowMs;
+            return;
+        }
+    }
+    if (unsubscribe)
+        return;
+
+    char name[INET6_ADDRSTRLEN + 8];
+    describe(address, name, sizeof(name));
+    if (freeSlot < 0)
+    {
+        rejected++;
+        LOGW("⚠️ Relay: %d ouvintes, %s recusado", MAX_SUBSCRIBERS, name);
+        return;
+    }
+
+    // ✅ Socket próprio, conectado: EAGAIN e ICMP de porta fechada são só deste ouvinte
+    int fd = socket(address.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0 && address.ss_family == AF_INET6)
+    {
+        int off = 0;
+        setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &off, sizeof(off));
+    }
+    epoll_event event{};
+    event.events = 0; // EPOLLERR sempre chega; EPOLLOUT só com a fila travada
+    event.data.u32 = static_cast<uint32_t>(freeSlot);
+    if (fd < 0 || connect(fd, reinterpret_cast<const sockaddr *>(&address), fromLength) != 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        LOGW("⚠️ Relay: ouvinte %s: %s", name, std::strerror(errno));
+        if (fd >= 0)
+            close(fd);
+        return;
+    }
+
+    Subscriber &subscriber = subscribers[freeSlot];
+    subscriber.fd = fd;
+    subscriber.address = address;
+    subscriber.addressLength = fromLength;
+    subscriber.lastSeenMs = nowMs;
+    subscriber.waitingWritable = false;
+    subscriber.head = 0;
+    subscriber.count = 0;
+    subscriberCount++;
+    LOGI("🎧 Relay: ouvinte %s (%d no total)", name, subscriberCount.load());
+}
+
+bool FanoutRelay::acceptSender(const sockaddr_storage &from, socklen_t fromLength, int64_t nowMs)
+{
+    bool same = sameAddress(sender, senderLength, from, fromLength);
+    if (!same && senderLength != 0 && nowMs - senderLastMs <= SENDER_IDLE_MS)
+        return false;
+    if (!same)
+    {
+        char name[INET6_ADDRSTRLEN + 8];
+        describe(from, name, sizeof(name));
+        LOGI("🎙️ Relay: sender %s", name);
+        sender = from;
+        senderLength = fromLength;
+    }
+    senderLastMs = nowMs;
+    return true;
+}
+
+// Mesmo buffer em todas as filas: só o índice e uma referência por ouvinte
+void FanoutRelay::fanOut(int32_t index)
+{
+    for (Subscriber &subscriber : subscribers)
+    {
+        if (subscriber.fd < 0)
+            continue;
+        if (subscriber.count == QUEUE_PACKETS)
+        {
+            release(subscriber.queue[subscriber.head]);
+            subscriber.head = (subscriber.head + 1) % QUEUE_PACKETS;
+            subscriber.count--;
+            dropped++;
+        }
+        subscriber.queue[(subscriber.head + subscriber.count) % QUEUE_PACKETS] = index;
+        subscriber.count++;
+        refs[index]++;
+    }
+}
+
+void FanoutRelay::flush(int32_t slot)
+{
+    Subscriber &subscriber = subscribers[slot];
+    mmsghdr messages[RECV_BATCH];
+    iovec vectors[RECV_BATCH];
+
+    while (subscriber.count > 0)
+    {
+        int32_t batch = std::min(subscriber.count, RECV_BATCH);
+        for (int32_t i = 0; i < batch; i++)
+        {
+            int32_t index = subscriber.queue[(subscriber.head + i) % QUEUE_PACKETS];
+            vectors[i] = {bytesOf(index), static_cast<size_t>(lengths[index])};
+            messages[i] = {};
+            messages[i].msg_hdr.msg_iov = &vectors[i];
+            messages[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        int sent = sendmmsg(subscriber.fd, messages, static_cast<unsigned>(batch), MSG_DONTWAIT);
+        sendCalls++;
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                watchWritable(slot, true);
+                return;
+            }
+            if (errno == EINTR)
+                continue;
+            if (errno == ECONNREFUSED)
+            {
+                removeSubscriber(slot);
+                return;
+            }
+            // Erro deste datagrama (ex.: EMSGSIZE): descarta e segue
+            LOGW("⚠️ Relay: sendmmsg: %s", std::strerror(errno));
+            sent = 1;
+            dropped++;
+        }
+        else
+        {
+            forwarded += sent;
+        }
+
+        for (int32_t i = 0; i < sent; i++)
+        {
+            release(subscriber.queue[subscriber.head]);
+            subscriber.head = (subscriber.head + 1) % QUEUE_PACKETS;
+            subscriber.count--;
+        }
+    }
+    watchWritable(slot, false);
+}
+
+void FanoutRelay::watchWritable(int32_t slot, bool enabled)
+{
+    Subscriber &subscriber = subscribers[slot];
+    if (subscriber.waitingWritable == enabled)
+        return;
+    epoll_event event{};
+    event.events = enabled ? static_cast<uint32_t>(EPOLLOUT) : 0u;
+    event.data.u32 = static_cast<uint32_t>(slot);
+    epoll_ctl(epollFd, EPOLL_CTL_MOD, subscriber.fd, &event);
+    subscriber.waitingWritable = enabled;
+}
+
+void FanoutRelay::removeSubscriber(int32_t slot)
+{
+    Subscriber &subscriber = subscribers[slot];
+    while (subscriber.count > 0)
+    {
+        release(subscriber.queue[subscriber.head]);
+        subscriber.head = (subscriber.head + 1) % QUEUE_PACKETS;
+        subscriber.count--;
+    }
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, subscriber.fd, nullptr);
+    close(subscriber.fd);
+    subscriber.fd = -1;
+    subscriberCount--;
+
+    char name[INET6_ADDRSTRLEN + 8];
+    describe(subscriber.address, name, sizeof(name));
+    LOGI("🎧 Relay: ouvinte %s saiu (%d no total)", name, subscriberCount.load());
+}
+
+void FanoutRelay::expireIdleSubscribers(int64_t nowMs)
+{
+    for (int32_t slot = 0; slot < MAX_SUBSCRIBERS; slot++)
+    {
+        if (subscribers[slot].fd >= 0 && nowMs - subscribers[slot].lastSeenMs > subscriberIdleMs)
+            removeSubscriber(slot);
+    }
+}
+
+int32_t FanoutRelay::acquire()
+{
+    int32_t index = freeList.back();
+    freeList.pop_back();
+    refs[index] = 1;
+    return index;
+}
+
+void FanoutRelay::release(int32_t index)
+{
+    if (--refs[index] == 0)
+        freeList.push_back(index);
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+
+// ✅ Relay local de fan-out (host): um socket de ingest, um socket por ouvinte
+//
+// Faz o papel do servidor para teste de carga: o sender manda datagramas SHB1 para
+// a porta do relay e cada ouvinte inscrito recebe todos, por um socket UDP próprio
+// conectado ao endereço dele (o mesmo que o UdpReceiver do app escuta). Tudo numa
+// thread com epoll.
+//
+// Sem cópia por ouvinte: cada datagrama entra uma vez num buffer do pool, com
+// contagem de referências, e as filas dos ouvintes guardam só o índice; o
+// sendmmsg aponta direto para o buffer. Ouvinte lento (EAGAIN) espera EPOLLOUT
+// com a fila própria; fila cheia descarta o mais antigo dele. Como todas as filas
+// são sufixos da mesma sequência, POOL_PACKETS = QUEUE_PACKETS + RECV_BATCH basta.
+//
+// Um sender por vez (a sequência SHB1 é por sender e o ouvinte vê um endereço
+// só, o do relay); outro sender é recusado até o atual ficar SENDER_IDLE_MS parado.
+//
+// Inscrição ("SHSB", 8 bytes, na mesma porta do ingest):
+//   0 u32 magic  'S' 'H' 'S' 'B'
+//   4 u8  version 1
+//   5 u8  flags   UNSUBSCRIBE
+//   6 u16 port    Porta de entrega (0 = a origem da inscrição)
+// Repetida a cada ~1s; ouvinte sem inscrição por subscriberIdleMs sai.
+namespace relay
+{
+    constexpr int32_t SUBSCRIBE_BYTES = 8;
+    constexpr uint8_t VERSION = 1;
+    constexpr uint8_t FLAG_UNSUBSCRIBE = 1 << 0;
+
+    inline void writeSubscribe(uint8_t *bytes, uint16_t port, bool unsubscribe = false)
+    {
+        bytes[0] = 'S';
+        bytes[1] = 'H';
+        bytes[2] = 'S';
+        bytes[3] = 'B';
+        bytes[4] = VERSION;
+        bytes[5] = unsubscribe ? FLAG_UNSUBSCRIBE : 0;
+        bytes[6] = static_cast<uint8_t>(port & 0xFF);
+        bytes[7] = static_cast<uint8_t>(port >> 8);
+    }
+}
+
+class FanoutRelay
+{
+public:
+    static constexpr int32_t MAX_SUBSCRIBERS = 256;
+    static constexpr int32_t MAX_PACKET_BYTES = 16384; // 60ms de PCM estéreo 48kHz + cabeçalho
+    static constexpr int32_t QUEUE_PACKETS = 128;      // ~2,5s de chunks de 20ms por ouvinte
+    static constexpr int32_t RECV_BATCH = 32;          // recvmmsg/sendmmsg por chamada
+    static constexpr int32_t POOL_PACKETS = QUEUE_PACKETS + RECV_BATCH;
+    static constexpr int32_t POLL_INTERVAL_MS = 100;
+    static constexpr int32_t SUBSCRIBER_IDLE_MS = 5000;
+    static constexpr int32_t SENDER_IDLE_MS = 2000;
+
+    explicit FanoutRelay(int32_t subscriberIdleMs = SUBSCRIBER_IDLE_MS);
+    ~FanoutRelay();
+    FanoutRelay(const FanoutRelay &) = delete;
+    FanoutRelay &operator=(const FanoutRelay &) = delete;
+
+    // Abre o ingest (IPv6 com IPv4 mapeado, ou só IPv4) e inicia a thread.
+    // port = 0 escolhe uma porta livre. Devolve a porta ou -1.
+    int32_t start(int32_t port);
+    void stop(); // Fecha o ingest e os sockets dos ouvintes
+
+    bool isRunning() const { return running.load(); }
+    int32_t getPort() const { return boundPort.load(); }
+
+    // Estatísticas (qualquer thread)
+    int64_t getIngested() const { return ingested.load(); }     // SHB1 aceitos do sender
+    int64_t getRejected() const { return rejected.load(); }     // Sem SHB1, outro sender, grandes demais
+    int64_t getForwarded() const { return forwarded.load(); }   // Datagramas entregues (soma dos ouvintes)
+    int64_t getDropped() const { return dropped.load(); }       // Descartados em filas cheias
+    int64_t getSendCalls() const { return sendCalls.load(); }   // Chamadas de sendmmsg
+    int32_t getSubscriberCount() const { return subscriberCount.load(); }
+
+private:
+    struct Subscriber
+    {
+        int fd = -1; // -1 = vaga livre
+        sockaddr_storage address{};
+        socklen_t addressLength = 0;
+        int64_t lastSeenMs = 0;
+        bool waitingWritable = false;
+        std::vector<int32_t> queue; // Índices no pool, anel de QUEUE_PACKETS
+        int32_t head = 0;
+        int32_t count = 0;
+    };
+
+    void run();
+    void receive(int64_t nowMs);
+    void handleSubscribe(const uint8_t *bytes, const sockaddr_storage &from, socklen_t fromLength, int64_t nowMs);
+    bool acceptSender(const sockaddr_storage &from, socklen_t fromLength, int64_t nowMs);
+    void fanOut(int32_t index);
+    void flush(int32_t slot);
+    void removeSubscriber(int32_t slot);
+    void expireIdleSubscribers(int64_t nowMs);
+    void watchWritable(int32_t slot, bool enabled);
+
+    int32_t acquire();
+    void release(int32_t index);
+    uint8_t *bytesOf(int32_t index) { return pool.data() + static_cast<size_t>(index) * MAX_PACKET_BYTES; }
+
+    const int32_t subscriberIdleMs;
+
+    int ingestFd = -1;
+    int epollFd = -1;
+    std::atomic<bool> running{false};
+    std::atomic<int32_t> boundPort{-1};
+    std::thread thread;
+
+    // Estado da thread do relay
+    std::vector<uint8_t> pool;
+    std::vector<int32_t> lengths;
+    std::vector<int32_t> refs;
+    std::vector<int32_t> freeList;
+    std::vector<Subscriber> subscribers;
+    sockaddr_storage sender{};
+    socklen_t senderLength = 0;
+    int64_t senderLastMs = 0;
+
+    std::atomic<int64_t> ingested{0};
+    std::atomic<int64_t> rejected{0};
+    std::atomic<int64_t> forwarded{0};
+    std::atomic<int64_t> dropped{0};
+    std::atomic<int64_t> sendCalls{0};
+    std::atomic<int32_t> subscriberCount{0};
+};
@@ -0,0 +1,227 @@
+// ✅ Testes do relay de fan-out contra sockets locais (ctest)
+
+#include "TestCheck.h"
+#include "FanoutRelay.h"
+#include "../PacketFormat.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    template <typename Condition>
+    bool waitFor(Condition &&condition, int32_t timeoutMs = 5000)
+    {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition())
+        {
+            if (Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    sockaddr_in loopback(int32_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        return address;
+    }
+
+    // Socket UDP local: sender ou ouvinte (porta de origem = identidade)
+    struct Peer
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in relay;
+        uint32_t sequence = 0;
+
+        explicit Peer(int32_t relayPort) : relay(loopback(relayPort))
+        {
+            sockaddr_in local = loopback(0);
+            bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local));
+        }
+        ~Peer() { close(fd); }
+
+        int32_t port() const
+        {
+            sockaddr_in local{};
+            socklen_t length = sizeof(local);
+            getsockname(fd, reinterpret_cast<sockaddr *>(&local), &length);
+            return ntohs(local.sin_port);
+        }
+
+        void sendRaw(const std::vector<uint8_t> &bytes)
+        {
+            sendto(fd, bytes.data(), bytes.size(), 0, reinterpret_cast<const sockaddr *>(&relay), sizeof(relay));
+        }
+
+        void subscribe(uint16_t deliveryPort = 0, bool unsubscribe = false)
+        {
+            std::vector<uint8_t> bytes(relay::SUBSCRIBE_BYTES);
+            relay::writeSubscribe(bytes.data(), deliveryPort, unsubscribe);
+            sendRaw(bytes);
+        }
+
+        void sendPacket()
+        {
+            std::vector<uint8_t> bytes(packet::HEADER_BYTES + 4);
+            packet::Header header;
+            header.sequence = sequence++;
+            header.frames = 1;
+            packet::write(bytes.data(), header);
+            sendRaw(bytes);
+        }
+
+        // Sequências recebidas até `count` ou o timeout
+        std::vector<uint32_t> receive(size_t count, int32_t timeoutMs = 2000)
+        {
+            std::vector<uint32_t> sequences;
+            std::vector<uint8_t> bytes(FanoutRelay::MAX_PACKET_BYTES);
+            while (sequences.size() < count)
+            {
+                pollfd descriptor{fd, POLLIN, 0};
+                if (poll(&descriptor, 1, timeoutMs) <= 0)
+                    break;
+                ssize_t length = recv(fd, bytes.data(), bytes.size(), 0);
+                packet::Header header;
+                if (length > 0 && packet::parse(bytes.data(), static_cast<int32_t>(length), header))
+                    sequences.push_back(header.sequence);
+            }
+            return sequences;
+        }
+    };
+
+    std::vector<uint32_t> range(uint32_t count)
+    {
+        std::vector<uint32_t> values(count);
+        for (uint32_t i = 0; i < count; i++)
+            values[i] = i;
+        return values;
+    }
+
+    void testFanOut()
+    {
+        FanoutRelay relay;
+        int32_t port = relay.start(0);
+        EXPECT(port > 0);
+        EXPECT(relay.getPort() == port);
+
+        Peer a(port), b(port), c(port);
+        a.subscribe();
+        b.subscribe();
+        c.subscribe();
+        a.subscribe(); // Renovação: não duplica
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 3; }));
+
+        Peer sender(port);
+        for (int32_t i = 0; i < 10; i++)
+            sender.sendPacket();
+        EXPECT(a.receive(10) == range(10));
+        EXPECT(b.receive(10) == range(10));
+        EXPECT(c.receive(10) == range(10));
+        EXPECT(relay.getIngested() == 10);
+        EXPECT(relay.getForwarded() == 30);
+        EXPECT(relay.getDropped() == 0);
+
+        // ✅ Muito mais pacotes que o pool: os buffers voltam ao pool depois de entregues
+        // (ouvintes lendo em paralelo, como o UdpReceiver, para não estourar o socket)
+        size_t expected = 4 * FanoutRelay::POOL_PACKETS;
+        size_t received[3] = {};
+        std::vector<std::thread> readers;
+        Peer *listeners[3] = {&a, &b, &c};
+        for (int32_t i = 0; i < 3; i++)
+            readers.emplace_back([&, i] { received[i] = listeners[i]->receive(expected).size(); });
+        for (size_t i = 0; i < expected; i++)
+        {
+            sender.sendPacket();
+            if (i % 16 == 15)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        for (auto &reader : readers)
+            reader.join();
+        EXPECT(received[0] == expected && received[1] == expected && received[2] == expected);
+        EXPECT(relay.getDropped() == 0);
+        EXPECT(relay.getSendCalls() <= relay.getForwarded());
+    }
+
+    void testRejects()
+    {
+        FanoutRelay relay;
+        int32_t port = relay.start(0);
+        Peer listener(port);
+        listener.subscribe();
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 1; }));
+
+        // Sem SHB1, ou de um segundo sender com o primeiro ativo: recusados
+        Peer sender(port), other(port);
+        sender.sendRaw(std::vector<uint8_t>(64, 0));
+        sender.sendPacket();
+        other.sendPacket();
+        EXPECT(waitFor([&] { return relay.getRejected() == 2; }));
+        EXPECT(listener.receive(1) == range(1));
+        EXPECT(listener.receive(1, 100).empty());
+        EXPECT(relay.getIngested() == 1);
+    }
+
+    void testSubscriptionLifetime()
+    {
+        FanoutRelay relay(300);
+        int32_t port = relay.start(0);
+
+        // Entrega em outra porta (o receptor anuncia a porta do UdpReceiver)
+        Peer control(port), target(port);
+        control.subscribe(static_cast<uint16_t>(target.port()));
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 1; }));
+        Peer sender(port);
+        sender.sendPacket();
+        EXPECT(target.receive(1) == range(1));
+        EXPECT(control.receive(1, 100).empty());
+
+        control.subscribe(static_cast<uint16_t>(target.port()), true);
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 0; }));
+
+        // Sem renovação: sai depois de subscriberIdleMs
+        Peer quiet(port);
+        quiet.subscribe();
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 1; }));
+        EXPECT(waitFor([&] { return relay.getSubscriberCount() == 0; }, 2000));
+
+        // Porta do ouvinte fechada: sai no primeiro envio (ICMP), sem esperar
+        FanoutRelay longLived;
+        int32_t longPort = longLived.start(0);
+        auto gone = std::make_unique<Peer>(longPort);
+        gone->subscribe();
+        EXPECT(waitFor([&] { return longLived.getSubscriberCount() == 1; }));
+        gone.reset();
+        Peer longSender(longPort);
+        for (int32_t i = 0; i < 3 && longLived.getSubscriberCount() > 0; i++)
+        {
+            longSender.sendPacket();
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        EXPECT(waitFor([&] { return longLived.getSubscriberCount() == 0; }, 1000));
+    }
+}
+
+int main()
+{
+    testFanOut();
+    testRejects();
+    testSubscriptionLifetime();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,129 @@
+// ✅ Micro-benchmark do ingest em lote
+//
+// Esvazia um acúmulo de chunks SHB1 PCM de 20ms (o que o canal do app junta
+// depois de uma parada da rede) no SourceMixer de dois jeitos: um withSource +
+// write por chunk, como o addDirect, e um withSource + writeBatch por lote de
+// MAX_BATCH chunks, como o addBatch. Mede só o lado nativo: a travessia JNI que o
+// lote também economiza não existe no host.
+//
+// Uso: ingest-benchmark [iterações] [chunks no acúmulo]
+
+#include "../PacketFormat.h"
+#include "../SourceMixer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960; // 20ms
+    constexpr int32_t MAX_BATCH = 64;     // OboeAudioPlayer::MAX_BATCH_CHUNKS
+    constexpr int32_t CHUNK_BYTES = packet::HEADER_BYTES + CHUNK_FRAMES * CHANNELS * 2;
+
+    // Acúmulo contíguo, como o ByteBuffer do lote: o chunk i vai de offsets[i] a offsets[i + 1]
+    struct Backlog
+    {
+        std::vector<uint8_t> bytes;
+        std::vector<int32_t> offsets;
+
+        explicit Backlog(int32_t chunks)
+            : bytes(static_cast<size_t>(chunks) * CHUNK_BYTES), offsets(chunks + 1)
+        {
+            for (int32_t i = 0; i < chunks; i++)
+            {
+                uint8_t *chunk = bytes.data() + static_cast<size_t>(i) * CHUNK_BYTES;
+                packet::Header header;
+                header.sequence = static_cast<uint32_t>(i);
+                header.frames = CHUNK_FRAMES;
+                packet::write(chunk, header);
+                auto *pcm = reinterpret_cast<int16_t *>(chunk + packet::HEADER_BYTES);
+                for (int32_t f = 0; f < CHUNK_FRAMES; f++)
+                {
+                    auto v = static_cast<int16_t>(8000.0 * std::sin((i * CHUNK_FRAMES + f) * 2.0 * M_PI * 440.0 / SAMPLE_RATE));
+                    pcm[2 * f] = v;
+                    pcm[2 * f + 1] = v;
+                }
+                offsets[i] = i * CHUNK_BYTES;
+            }
+            offsets[chunks] = chunks * CHUNK_BYTES;
+        }
+
+        int32_t count() const { return static_cast<int32_t>(offsets.size()) - 1; }
+    };
+
+    // Tempo (µs) para esvaziar o acúmulo num mixer novo; `accepted` confere que nada ficou de fora
+    template <typename Drain>
+    double measureDrainUs(const Backlog &backlog, int32_t &accepted, Drain &&drain)
+    {
+        SourceMixer mixer(PlayerClock::system());
+        int32_t maxBufferMs = backlog.count() * 20 + 1000;
+        mixer.configure(SAMPLE_RATE, CHANNELS, maxBufferMs);
+        mixer.start();
+
+        auto begin = std::chrono::steady_clock::now();
+        accepted = drain(mixer);
+        auto end = std::chrono::steady_clock::now();
+        mixer.stop();
+        return std::chrono::duration<double, std::micro>(end - begin).count();
+    }
+
+    double median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+    int32_t chunks = argc > 2 ? std::atoi(argv[2]) : 500;
+    Backlog backlog(chunks);
+
+    std::vector<double> perChunkUs;
+    std::vector<double> batchedUs;
+    int32_t perChunkAccepted = 0;
+    int32_t batchedAccepted = 0;
+    for (int it = 0; it < iterations; it++)
+    {
+        perChunkUs.push_back(measureDrainUs(backlog, perChunkAccepted, [&](SourceMixer &mixer)
+                                            {
+            int32_t accepted = 0;
+            for (int32_t i = 0; i < backlog.count(); i++)
+            {
+                const uint8_t *chunk = backlog.bytes.data() + backlog.offsets[i];
+                int32_t length = backlog.offsets[i + 1] - backlog.offsets[i];
+                mixer.withSource(SourceMixer::DEFAULT_SOURCE, [&](SourceMixer::Source &source)
+                                 { accepted += source.write(chunk, length) ? 1 : 0; });
+            }
+            return accepted; }));
+
+        batchedUs.push_back(measureDrainUs(backlog, batchedAccepted, [&](SourceMixer &mixer)
+                                           {
+            int32_t accepted = 0;
+            for (int32_t i = 0; i < backlog.count(); i += MAX_BATCH)
+            {
+                int32_t count = std::min(MAX_BATCH, backlog.count() - i);
+                mixer.withSource(SourceMixer::DEFAULT_SOURCE, [&](SourceMixer::Source &source)
+                                 { accepted += source.writeBatch(backlog.bytes.data(), backlog.offsets.data() + i, count); });
+            }
+            return accepted; }));
+    }
+
+    double perChunk = median(perChunkUs);
+    double batched = median(batchedUs);
+    std::printf("Acúmulo de %d chunks de 20ms (%d KiB), mediana de %d rodadas\n",
+                chunks, static_cast<int>(backlog.bytes.size() / 1024), iterations);
+    std::printf("por chunk  %9.1fµs | %6.2fµs/chunk | aceitos %d\n",
+                perChunk, perChunk / chunks, perChunkAccepted);
+    std::printf("em lote    %9.1fµs | %6.2fµs/chunk | aceitos %d | lotes de %d\n",
+                batched, batched / chunks, batchedAccepted, MAX_BATCH);
+    std::printf("razão      %9.2fx\n", perChunk / batched);
+    return perChunkAccepted == chunks && batchedAccepted == chunks ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+// ✅ Trace simulado de chegada de chunks pela rede
+//
+// O sender gera um chunk a cada `chunkFrames` no seu próprio relógio (com drift
+// em ppm). Cada chunk sofre um atraso aleatório determinístico, e a entrega é em
+// ordem (TCP/Socket.IO): um chunk atrasado segura os seguintes.
+struct NetworkTraceConfig
+{
+    int32_t sampleRate = 48000;
+    int32_t chunkFrames = 960; // 20ms
+    double durationS = 60.0;
+    double senderDriftPpm = 0.0; // > 0: sender mais rápido que o receptor
+    double baseDelayMs = 5.0;
+    double jitterMs = 0.0;       // Atraso extra uniforme em [0, jitterMs]
+    double spikeProbability = 0.0; // Chance de um pico de atraso por chunk
+    double spikeMs = 0.0;
+    double stallAtS = -1.0; // Travada da rede (entrega tudo de uma vez ao final)
+    double stallMs = 0.0;
+    uint32_t seed = 1;
+};
+
+struct ChunkArrival
+{
+    int64_t timeNs;
+    int64_t captureTimeNs; // Tempo real em que o 1º frame foi capturado no sender
+    int32_t frames;
+    uint32_t sequence;
+};
+
+inline std::vector<ChunkArrival> generateNetworkTrace(const NetworkTraceConfig &config)
+{
+    std::vector<ChunkArrival> arrivals;
+    uint32_t state = config.seed * 2654435761u + 1;
+    auto nextUniform = [&state]
+    {
+        state = state * 1664525u + 1013904223u;
+        return (state >> 8) / 16777216.0;
+    };
+
+    double chunkS = static_cast<double>(config.chunkFrames) / config.sampleRate;
+    double senderScale = 1.0 / (1.0 + config.senderDriftPpm / 1000000.0);
+    int64_t lastArrival = 0;
+    uint32_t sequence = 0;
+
+    for (double sendS = 0.0; sendS < config.durationS; sendS += chunkS * senderScale)
+    {
+        // O chunk só existe depois de capturado inteiro
+        double readyS = sendS + chunkS * senderScale;
+        double delayMs = config.baseDelayMs + nextUniform() * config.jitterMs;
+        if (config.spikeProbability > 0.0 && nextUniform() < config.spikeProbability)
+        {
+            delayMs += config.spikeMs;
+        }
+        double arrivalS = readyS + delayMs / 1000.0;
+
+        if (config.stallAtS >= 0.0 && arrivalS >= config.stallAtS &&
+            arrivalS < config.stallAtS + config.stallMs / 1000.0)
+        {
+            arrivalS = config.stallAtS + config.stallMs / 1000.0;
+        }
+
+        auto arrivalNs = static_cast<int64_t>(arrivalS * 1e9);
+        arrivalNs = std::max(arrivalNs, lastArrival); // Entrega em ordem
+        lastArrival = arrivalNs;
+        arrivals.push_back({arrivalNs, static_cast<int64_t>(sendS * 1e9), config.chunkFrames, sequence++});
+    }
+    return arrivals;
+}
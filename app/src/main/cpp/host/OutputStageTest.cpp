@@ -0,0 +1,169 @@
+// ✅ Testes da negociação de saída: float, canais e conversão de taxa (ctest)
+
+#include "TestCheck.h"
+#include "../AudioKernels.h"
+#include "../OutputStage.h"
+#include "../PlayerCore.h"
+#include "FakeAudioStream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr double AMPLITUDE = 12000.0;
+
+    void testFloatKernel()
+    {
+        // Tamanho ímpar: passa pelo corpo SIMD e pela cauda escalar
+        std::vector<int16_t> src(1037);
+        for (size_t i = 0; i < src.size(); i++)
+            src[i] = static_cast<int16_t>((static_cast<int32_t>(i) * 7919) % 65536 - 32768);
+        src[0] = -32768;
+        src[1] = 32767;
+
+        std::vector<float> simd(src.size());
+        std::vector<float> scalar(src.size());
+        audiokernels::int16ToFloat(simd.data(), src.data(), static_cast<int32_t>(src.size()));
+        audiokernels::int16ToFloatScalar(scalar.data(), src.data(), static_cast<int32_t>(src.size()));
+        EXPECT(simd == scalar);
+        EXPECT(simd[0] == -1.0f);
+        EXPECT(simd[1] < 1.0f && simd[1] > 0.9999f);
+    }
+
+    void testChannelMapping()
+    {
+        OutputStage stage;
+
+        // mono -> 4 canais: L e R recebem o sinal, o resto fica em silêncio
+        stage.configure(1);
+        stage.scratch()[0] = 1000;
+        stage.scratch()[1] = -2000;
+        std::vector<int16_t> quad(8, int16_t(7));
+        stage.convert(2, 4, OutputFormat::I16, quad.data(), 0);
+        EXPECT((quad == std::vector<int16_t>{1000, 1000, 0, 0, -2000, -2000, 0, 0}));
+
+        // estéreo -> mono float: média
+        stage.configure(2);
+        stage.scratch()[0] = 16384;
+        stage.scratch()[1] = 0;
+        std::vector<float> mono(3, 9.0f);
+        stage.convert(1, 1, OutputFormat::Float, mono.data(), 1);
+        EXPECT(mono[0] == 9.0f && mono[1] == 0.25f && mono[2] == 9.0f);
+
+        EXPECT(stage.isPassthrough(2, OutputFormat::I16));
+        EXPECT(!stage.isPassthrough(2, OutputFormat::Float));
+        EXPECT(!stage.supports(OutputStage::MAX_DEVICE_CHANNELS + 1));
+    }
+
+    struct Measured
+    {
+        double frequency = 0.0;
+        double rms = 0.0;
+        int32_t underruns = 0;
+    };
+
+    // Sender em sourceRate (seno de `hz`, chunks de 20ms sem timestamp); dispositivo
+    // em deviceRate/deviceChannels/format. Mede a frequência e o RMS do canal 0.
+    Measured play(int32_t sourceRate, int32_t deviceRate, int32_t deviceChannels, OutputFormat format, double hz)
+    {
+        constexpr int32_t SOURCE_CHANNELS = 2;
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(sourceRate, SOURCE_CHANNELS);
+        core.setOutputSampleRate(deviceRate);
+        core.start();
+
+        int32_t burst = deviceRate / 100;
+        FakeAudioStream output(clock, deviceRate, deviceChannels, burst);
+        output.setFormat(format);
+
+        int32_t chunkFrames = sourceRate / 50;
+        std::vector<int16_t> chunk(static_cast<size_t>(chunkFrames) * SOURCE_CHANNELS);
+        int64_t sourceFrame = 0;
+
+        std::vector<double> played;
+        int64_t now = 0;
+        for (int32_t callback = 0; callback < 600; callback++)
+        {
+            if (callback % 2 == 0)
+            {
+                for (int32_t f = 0; f < chunkFrames; f++, sourceFrame++)
+                {
+                    auto v = static_cast<int16_t>(std::lrint(AMPLITUDE * std::sin(2.0 * M_PI * hz * sourceFrame / sourceRate)));
+                    chunk[2 * f] = v;
+                    chunk[2 * f + 1] = v;
+                }
+                core.write(reinterpret_cast<const uint8_t *>(chunk.data()),
+                           static_cast<int32_t>(chunk.size() * sizeof(int16_t)));
+            }
+
+            core.render(output, output.output(), burst);
+            output.advance(burst);
+            now += 10000000LL;
+            clock.set(now);
+
+            if (callback < 100)
+                continue; // Prebuffer e assentamento
+            for (int32_t f = 0; f < burst; f++)
+            {
+                size_t index = static_cast<size_t>(f) * deviceChannels;
+                played.push_back(format == OutputFormat::Float ? output.floatData()[index] * 32768.0
+                                                               : output.data()[index]);
+            }
+        }
+
+        Measured result;
+        int32_t crossings = 0;
+        double energy = 0.0;
+        for (size_t i = 1; i < played.size(); i++)
+        {
+            if (played[i - 1] < 0.0 && played[i] >= 0.0)
+                crossings++;
+            energy += played[i] * played[i];
+        }
+        result.frequency = crossings / (static_cast<double>(played.size()) / deviceRate);
+        result.rms = std::sqrt(energy / played.size());
+        result.underruns = core.getUnderrunCount();
+        return result;
+    }
+
+    void testRateConversion()
+    {
+        const double sineRms = AMPLITUDE / std::sqrt(2.0);
+
+        // 44.1kHz -> dispositivo 48kHz mono float: sem erro de afinação nem de velocidade
+        Measured up = play(44100, 48000, 1, OutputFormat::Float, 1000.0);
+        EXPECT(std::abs(up.frequency - 1000.0) < 10.0);
+        EXPECT(std::abs(up.rms - sineRms) < sineRms * 0.05);
+        EXPECT(up.underruns == 0);
+
+        // 48kHz -> 44.1kHz estéreo PCM16
+        Measured down = play(48000, 44100, 2, OutputFormat::I16, 1000.0);
+        EXPECT(std::abs(down.frequency - 1000.0) < 10.0);
+        EXPECT(std::abs(down.rms - sineRms) < sineRms * 0.05);
+        EXPECT(down.underruns == 0);
+
+        // Acima da Nyquist de 44.1kHz: o filtro do sinc não deixa dobrar (aliasing)
+        Measured alias = play(48000, 44100, 2, OutputFormat::I16, 23500.0);
+        if (alias.rms > sineRms * 0.01)
+        {
+            std::fprintf(stderr, "  aliasing: RMS %.1f (seno %.1f)\n", alias.rms, sineRms);
+            testcheck::failures++;
+        }
+
+        // Mesma taxa: continua sendo cópia exata
+        Measured same = play(48000, 48000, 2, OutputFormat::I16, 1000.0);
+        EXPECT(std::abs(same.frequency - 1000.0) < 10.0);
+    }
+}
+
+int main()
+{
+    testFloatKernel();
+    testChannelMapping();
+    testRateConversion();
+
+    return testcheck::finish();
+}
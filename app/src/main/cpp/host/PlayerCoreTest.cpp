@@ -0,0 +1,371 @@
+// ✅ Testes determinísticos do PlayerCore no host (ctest)
+//
+// Cada cenário gera um trace de rede com seed fixa, roda o player em tempo
+// simulado e confere underruns e nível do buffer. Sem threads e sem relógio real:
+// o resultado é o mesmo em qualquer máquina.
+
+#include "TestCheck.h"
+#include "FakeAudioStream.h"
+#include "PlayerSimulation.h"
+#include "../PacketFormat.h"
+#include "../PlayerCore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    SimulationResult run(const char *name, const NetworkTraceConfig &trace,
+                         SimulationConfig config = SimulationConfig())
+    {
+        config.sampleRate = trace.sampleRate;
+        config.durationS = trace.durationS;
+        SimulationResult result = runSimulation(config, generateNetworkTrace(trace));
+        std::printf("%-14s UR %d (pós-warmup %d) | descartados %lld | 1º áudio %.0fms (rebuffer máx %.0fms) | buffer médio %.1fms máx %.1fms | final %.1fms alvo %.1fms\n",
+                    name, result.underruns, result.underrunsAfterWarmup,
+                    static_cast<long long>(result.droppedFrames), result.firstAudioMs, result.maxRebufferMs,
+                    result.meanBufferedMs, result.maxBufferedMs,
+                    result.finalBufferedMs, result.finalTargetMs);
+        if (config.timestamped)
+        {
+            std::printf("%-14s sincronia: erro médio %+.2fms, máx |%.2f|ms (%d amostras)\n",
+                        "", result.meanSyncErrorMs, result.maxAbsSyncErrorMs, result.syncSamples);
+        }
+        return result;
+    }
+
+    void testCleanNetwork()
+    {
+        NetworkTraceConfig trace;
+        SimulationResult r = run("clean", trace);
+        EXPECT(r.underruns == 0);
+        EXPECT(r.droppedFrames == 0);
+        EXPECT(r.firstAudioMs > 0.0 && r.firstAudioMs < 200.0);
+        EXPECT(r.meanBufferedMs < 100.0);
+    }
+
+    void testJitter()
+    {
+        NetworkTraceConfig trace;
+        trace.jitterMs = 30.0;
+        trace.spikeProbability = 0.01;
+        trace.spikeMs = 80.0;
+        trace.seed = 7;
+        SimulationResult r = run("jitter", trace);
+        EXPECT(r.underrunsAfterWarmup <= 2);
+        EXPECT(r.droppedFrames == 0);
+        EXPECT(r.meanBufferedMs < 300.0);
+    }
+
+    // Drift de ±300ppm: o reamostrador deve segurar o nível perto do alvo
+    // sem cortar frames nem esvaziar o buffer
+    void testDrift(double ppm)
+    {
+        NetworkTraceConfig trace;
+        trace.senderDriftPpm = ppm;
+        trace.jitterMs = 5.0;
+        trace.durationS = 120.0;
+        SimulationResult r = run(ppm > 0 ? "drift +300ppm" : "drift -300ppm", trace);
+        EXPECT(r.underrunsAfterWarmup == 0);
+        EXPECT(r.droppedFrames == 0);
+        EXPECT(std::abs(r.finalBufferedMs - r.finalTargetMs) < 40.0);
+    }
+
+    // Travada de 1s: underruns durante a travada, depois a rajada é cortada
+    // e a latência volta perto do alvo
+    void testStall()
+    {
+        NetworkTraceConfig trace;
+        trace.stallAtS = 20.0;
+        trace.stallMs = 1000.0;
+        SimulationResult r = run("stall", trace);
+        EXPECT(r.underrunsAfterWarmup > 0);
+        EXPECT(r.finalBufferedMs < r.finalTargetMs + 60.0);
+    }
+
+    // Teto por duração: o ring guarda exatamente maxBufferMs (+ folga), qualquer que
+    // seja o tamanho dos chunks. Acima do limite de latência os mais antigos saem em
+    // bursts inteiros, com crossfade: a senoide continua sem degrau na emenda.
+    void testBufferLimit()
+    {
+        constexpr int32_t RATE = 48000;
+        constexpr int32_t CHANNELS = 2;
+        constexpr int32_t BURST = 192;
+        constexpr int32_t CHUNK = 480; // 10ms
+        constexpr int32_t MAX_MS = 2000;
+
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(RATE, CHANNELS, MAX_MS);
+        core.setFramesPerBurst(BURST);
+        core.start();
+        EXPECT(core.getMaxBufferFrames() == RATE * MAX_MS / 1000);
+
+        // Senoide de 70Hz (período que não é múltiplo do burst) em amplitude 10000
+        int64_t phase = 0;
+        std::vector<int16_t> chunk(CHUNK * CHANNELS);
+        auto nextChunk = [&]
+        {
+            for (int32_t i = 0; i < CHUNK; i++, phase++)
+            {
+                auto value = static_cast<int16_t>(10000.0 * std::sin(2.0 * M_PI * 70.0 * phase / RATE));
+                chunk[i * CHANNELS] = chunk[i * CHANNELS + 1] = value;
+            }
+            return core.writeFrames(chunk.data(), CHUNK, PlayoutScheduler::NO_TIMESTAMP);
+        };
+
+        FakeAudioStream output(clock, RATE, CHANNELS, BURST);
+        int64_t now = 0;
+        int32_t maxStep = 0;
+        int16_t last = 0;
+        bool audible = false;
+        auto renderBurst = [&]
+        {
+            core.render(output, output.data(), BURST);
+            output.advance(BURST);
+            for (int32_t i = 0; i < BURST; i++)
+            {
+                int16_t value = output.data()[i * CHANNELS];
+                if (audible)
+                    maxStep = std::max(maxStep, std::abs(value - last));
+                audible = audible || value != 0;
+                last = value;
+            }
+            now += static_cast<int64_t>(BURST) * 1000000000LL / RATE;
+            clock.set(now);
+        };
+
+        // Rede limpa: 10ms por 10ms, até tocar
+        for (int32_t i = 0; i < 400; i++)
+        {
+            if (i % 5 == 0 || i % 5 == 2)
+                nextChunk();
+            renderBurst();
+        }
+        EXPECT(!core.isPrebuffering());
+        EXPECT(core.getDroppedFrames() == 0);
+
+        // Rajada de 1.5s depois de uma travada: cabe no ring, mas passa do limite de latência
+        for (int32_t i = 0; i < 150; i++)
+            EXPECT(nextChunk());
+        renderBurst();
+        int64_t dropped = core.getDroppedFrames();
+        EXPECT(dropped > 0);
+        EXPECT(dropped % BURST == 0);
+        EXPECT(core.getBufferedMs() < core.framesToMs(core.getTargetFrames()) + 20);
+        for (int32_t i = 0; i < 50; i++)
+            renderBurst();
+        std::printf("%-14s descartados %lld frames, maior passo %d (senoide: ~92)\n", "buffer limit",
+                    static_cast<long long>(dropped), maxStep);
+        EXPECT(maxStep < 400);
+
+        // Sem consumo, o ring enche até o teto + folga e recusa o resto (chunk inteiro)
+        while (nextChunk())
+        {
+        }
+        EXPECT(core.getBufferedFrames() <= core.getMaxBufferFrames() + core.getMaxBufferFrames() / 8);
+        EXPECT(core.getBufferedFrames() > core.getMaxBufferFrames());
+    }
+
+    // writeBatch: mesmo resultado que um write() por pacote (inclusive duplicado e
+    // fora de ordem), mas o callback só vê o lote depois do último pacote
+    void testWriteBatch()
+    {
+        constexpr int32_t RATE = 48000;
+        constexpr int32_t CHANNELS = 2;
+        constexpr int32_t CHUNK = 960;
+        const uint32_t order[] = {0, 1, 2, 4, 3, 3, 5, 6, 7, 8, 9};
+        constexpr int32_t COUNT = 11;
+
+        std::vector<uint8_t> bytes;
+        std::vector<int32_t> offsets;
+        for (uint32_t sequence : order)
+        {
+            offsets.push_back(static_cast<int32_t>(bytes.size()));
+            std::vector<uint8_t> chunk(packet::HEADER_BYTES + CHUNK * CHANNELS * 2, 0);
+            packet::Header header;
+            header.sequence = sequence;
+            header.frames = CHUNK;
+            packet::write(chunk.data(), header);
+            auto *pcm = reinterpret_cast<int16_t *>(chunk.data() + packet::HEADER_BYTES);
+            for (int32_t i = 0; i < CHUNK * CHANNELS; i++)
+                pcm[i] = static_cast<int16_t>(sequence + 1);
+            bytes.insert(bytes.end(), chunk.begin(), chunk.end());
+        }
+        offsets.push_back(static_cast<int32_t>(bytes.size()));
+
+        SimClock clock;
+        PlayerCore single(clock);
+        PlayerCore batched(clock);
+        for (PlayerCore *core : {&single, &batched})
+        {
+            core->configure(RATE, CHANNELS, 2000);
+            core->start();
+        }
+        int32_t singleAccepted = 0;
+        for (int32_t i = 0; i < COUNT; i++)
+            singleAccepted += single.write(bytes.data() + offsets[i], offsets[i + 1] - offsets[i]) ? 1 : 0;
+        EXPECT(batched.writeBatch(bytes.data(), offsets.data(), COUNT) == singleAccepted);
+        EXPECT(singleAccepted == 10);
+        EXPECT(batched.getBufferedFrames() == single.getBufferedFrames());
+        EXPECT(batched.getBufferedFrames() == 10 * CHUNK);
+        EXPECT(batched.getReceivedPackets() == single.getReceivedPackets());
+        EXPECT(batched.getLatePackets() == 1);
+        EXPECT(batched.getReorderedPackets() == single.getReorderedPackets());
+
+        // Depois do lote, write() volta a publicar na hora
+        EXPECT(batched.write(bytes.data() + offsets[COUNT - 1], offsets[COUNT] - offsets[COUNT - 1]) == false);
+        EXPECT(batched.writeBatch(bytes.data(), offsets.data(), 0) == 0);
+        EXPECT(batched.getBufferedFrames() == 10 * CHUNK);
+    }
+
+    // Início rápido: áudio com poucos bursts no buffer, que sobe até o alvo tocando
+    // mais devagar. Com jitter, a volta depois de um underrun é bem mais curta
+    void testFastStart()
+    {
+        SimulationConfig fast;
+        fast.fastStart = true;
+
+        NetworkTraceConfig clean;
+        SimulationResult r = run("fast clean", clean, fast);
+        EXPECT(r.firstAudioMs > 0.0 && r.firstAudioMs < 60.0);
+        EXPECT(r.underruns == 0);
+
+        NetworkTraceConfig jitter;
+        jitter.jitterMs = 30.0;
+        jitter.spikeProbability = 0.01;
+        jitter.spikeMs = 80.0;
+        jitter.seed = 7;
+        SimulationResult normal = run("jitter normal", jitter);
+        SimulationResult rj = run("fast jitter", jitter, fast);
+        EXPECT(rj.underrunsAfterWarmup <= 2);
+        EXPECT(rj.droppedFrames == 0);
+        EXPECT(rj.maxRebufferMs < 100.0);
+        EXPECT(rj.maxRebufferMs < normal.maxRebufferMs);
+        EXPECT(rj.underruns <= normal.underruns);
+
+        NetworkTraceConfig stall;
+        stall.stallAtS = 20.0;
+        stall.stallMs = 1000.0;
+        SimulationResult rs = run("fast stall", stall, fast);
+        EXPECT(rs.finalBufferedMs < rs.finalTargetMs + 60.0);
+    }
+
+    // Modo de economia: callbacks de 40ms (stream PowerSaving) desde o início e
+    // troca em tempo de execução (tela apagada), com o stream reaberto e o buffer mantido
+    void testPowerSaving()
+    {
+        constexpr int32_t POWER_SAVING_BURST = 1920; // 40ms a 48kHz
+
+        NetworkTraceConfig wifi;
+        wifi.jitterMs = 30.0;
+        wifi.spikeProbability = 0.01;
+        wifi.spikeMs = 80.0;
+        wifi.seed = 7;
+
+        SimulationConfig deep;
+        deep.framesPerBurst = POWER_SAVING_BURST;
+        deep.outputLatencyMs = 80.0;
+        SimulationResult r = run("power saving", wifi, deep);
+        EXPECT(r.underrunsAfterWarmup <= 2); // Como no testJitter
+        EXPECT(r.meanBufferedMs < 300.0);
+        EXPECT(r.droppedFrames == 0);
+
+        SimulationConfig screenOff;
+        screenOff.routeChangeS = 30.0;
+        screenOff.routeOutageMs = 60.0;
+        screenOff.routeLatencyMs = 80.0;
+        screenOff.routeTimestampDelayCallbacks = 2;
+        screenOff.routeFramesPerBurst = POWER_SAVING_BURST;
+        SimulationResult rs = run("screen off", wifi, screenOff);
+        std::printf("%-14s áudio de volta %.0fms após reabrir\n", "", rs.resumeAfterRouteMs);
+        EXPECT(rs.underrunsAfterWarmup == 0);
+        EXPECT(rs.droppedFrames == 0);
+        EXPECT(rs.resumeAfterRouteMs >= 0.0 && rs.resumeAfterRouteMs < 100.0);
+    }
+
+    // Dois receptores do mesmo sender (drift +200ppm) com redes, latências de
+    // saída e erros de ClockSync diferentes devem tocar o mesmo frame no mesmo
+    // instante, a poucos ms
+    void testSynchronizedReceivers()
+    {
+        NetworkTraceConfig near;
+        near.senderDriftPpm = 200.0;
+        near.jitterMs = 10.0;
+        near.durationS = 90.0;
+
+        NetworkTraceConfig far = near;
+        far.baseDelayMs = 40.0;
+        far.jitterMs = 60.0;
+        far.spikeProbability = 0.01;
+        far.spikeMs = 80.0;
+        far.seed = 3;
+
+        SimulationConfig a;
+        a.timestamped = true;
+        a.warmupS = 15.0;
+        a.outputLatencyMs = 20.0;
+        a.serverClockOffsetUs = 123456789;
+        a.clockOffsetErrorUs = 800;
+        a.captureStampJitterUs = 1000;
+
+        SimulationConfig b = a;
+        b.outputLatencyMs = 65.0;
+        b.serverClockOffsetUs = -987654321;
+        b.clockOffsetErrorUs = -600;
+
+        SimulationResult ra = run("sync near", near, a);
+        SimulationResult rb = run("sync far", far, b);
+
+        EXPECT(ra.syncSamples > 1000 && rb.syncSamples > 1000);
+        EXPECT(ra.underrunsAfterWarmup == 0 && rb.underrunsAfterWarmup == 0);
+        EXPECT(ra.maxAbsSyncErrorMs < 4.0);
+        EXPECT(rb.maxAbsSyncErrorMs < 4.0);
+        EXPECT(std::abs(ra.meanSyncErrorMs - rb.meanSyncErrorMs) < 3.0);
+    }
+
+    // Troca de rota no meio da reprodução: o buffer atravessa a reabertura. No modo
+    // adaptativo o áudio volta no primeiro callback (sem novo prebuffer); no
+    // sincronizado, assim que o stream novo mede a latência, já no frame certo.
+    void testRouteChange()
+    {
+        NetworkTraceConfig trace;
+        trace.jitterMs = 10.0;
+        trace.durationS = 40.0;
+
+        SimulationConfig adaptive;
+        adaptive.warmupS = 10.0;
+        adaptive.routeChangeS = 20.0;
+        SimulationResult ra = run("route adapt", trace, adaptive);
+        EXPECT(ra.resumeAfterRouteMs == 0.0);
+        EXPECT(ra.underrunsAfterWarmup == 0);
+
+        SimulationConfig synced = adaptive;
+        synced.timestamped = true;
+        SimulationResult rs = run("route sync", trace, synced);
+        std::printf("%-14s áudio de volta %.0fms após reabrir\n", "", rs.resumeAfterRouteMs);
+        EXPECT(rs.resumeAfterRouteMs > 0.0 && rs.resumeAfterRouteMs < 100.0);
+        EXPECT(rs.underrunsAfterWarmup == 0);
+        EXPECT(rs.maxAbsSyncErrorMs < 4.0); // Inclui o período depois da troca (latência 150ms)
+    }
+}
+
+int main()
+{
+    testCleanNetwork();
+    testJitter();
+    testDrift(300.0);
+    testDrift(-300.0);
+    testStall();
+    testBufferLimit();
+    testWriteBatch();
+    testFastStart();
+    testSynchronizedReceivers();
+    testRouteChange();
+    testPowerSaving();
+
+    return testcheck::finish();
+}
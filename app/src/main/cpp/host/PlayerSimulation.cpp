@@ -0,0 +1,359 @@
+#include "PlayerSimulation.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "../PacketFormat.h"
+#include "../PlayerCore.h"
+#include "FakeAudioStream.h"
+
+int64_t SimulationResult::callbackPercentile(double p) const
+{
+    if (callbackNanos.empty())
+        return 0;
+    std::vector<int64_t> sorted = callbackNanos;
+    std::sort(sorted.begin(), sorted.end());
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+SimulationResult runSimulation(const SimulationConfig &config, const std::vector<ChunkArrival> &arrivals)
+{
+    SimClock clock;
+    PlayerCore core(clock);
+    // O buffer do callback comporta o burst depois da troca (modo de economia: callbacks longos)
+    int32_t burst = config.framesPerBurst;
+    FakeAudioStream output(clock, config.sampleRate, config.channelCount,
+                           std::max(burst, config.routeFramesPerBurst),
+                           static_cast<int64_t>(config.outputLatencyMs * 1e6));
+    output.reconfigure(config.sampleRate, burst);
+
+    core.configure(config.sampleRate, config.channelCount);
+    core.setFramesPerBurst(burst);
+    core.setFastStart(config.fastStart);
+    if (config.timestamped)
+    {
+        core.setPlayoutDelayMs(config.playoutDelayMs);
+        core.setClockOffsetUs(config.serverClockOffsetUs + config.clockOffsetErrorUs);
+    }
+    core.start();
+
+    // Payload codifica o índice absoluto do frame do sender (canal 0: bits altos,
+    // canal 1: 12 bits baixos), para medir na saída qual frame tocou quando.
+    // Rampas lineares passam intactas pela interpolação cúbica.
+    constexpr int64_t INDEX_LOW = 4096;
+    int32_t maxChunkFrames = 0;
+    for (const auto &arrival : arrivals)
+        maxChunkFrames = std::max(maxChunkFrames, arrival.frames);
+    std::vector<uint8_t> packetBytes(packet::HEADER_BYTES +
+                                     static_cast<size_t>(maxChunkFrames) * config.channelCount * 2);
+
+    // Instante de captura (tempo real) do início de cada chunk, por sequência
+    std::vector<int64_t> captureTimeBySequence(arrivals.size(), 0);
+    int32_t chunkFrames = arrivals.empty() ? 0 : arrivals.front().frames;
+    for (const auto &arrival : arrivals)
+    {
+        if (arrival.sequence < captureTimeBySequence.size())
+            captureTimeBySequence[arrival.sequence] = arrival.captureTimeNs;
+    }
+
+    SimulationResult result;
+    const int64_t endNs = static_cast<int64_t>(config.durationS * 1e9);
+    const int64_t warmupNs = static_cast<int64_t>(config.warmupS * 1e9);
+    int64_t periodNs = output.callbackPeriodNanos();
+    result.callbackNanos.reserve(static_cast<size_t>(endNs / periodNs) + 1);
+
+    int64_t nextCallbackNs = periodNs;
+    size_t nextArrival = 0;
+    double bufferedSumMs = 0.0;
+    int64_t bufferedSamples = 0;
+    double syncSumMs = 0.0;
+    const int64_t routeChangeNs = config.routeChangeS >= 0.0 ? static_cast<int64_t>(config.routeChangeS * 1e9) : -1;
+    int64_t restartNs = -1;
+    int64_t rebufferStartNs = -1;
+
+    while (nextCallbackNs <= endNs)
+    {
+        // Chegadas antes (ou no mesmo instante) do próximo callback vêm primeiro
+        if (nextArrival < arrivals.size() && arrivals[nextArrival].timeNs <= nextCallbackNs)
+        {
+            const auto &arrival = arrivals[nextArrival++];
+            clock.set(arrival.timeNs);
+
+            int32_t headerBytes = 0;
+            if (config.timestamped)
+            {
+                packet::Header header;
+                header.flags = packet::FLAG_HAS_TIMESTAMP;
+                header.sequence = arrival.sequence;
+                header.frames = static_cast<uint32_t>(arrival.frames);
+                int64_t jitterUs = config.captureStampJitterUs > 0
+                                       ? static_cast<int64_t>((arrival.sequence * 7919u) % 2001u) - 1000
+                                       : 0;
+                header.captureTimeUs = arrival.captureTimeNs / 1000 + config.serverClockOffsetUs +
+                                       (jitterUs * config.captureStampJitterUs) / 1000;
+                packet::write(packetBytes.data(), header);
+                headerBytes = packet::HEADER_BYTES;
+            }
+
+            auto *samples = reinterpret_cast<int16_t *>(packetBytes.data() + headerBytes);
+            int64_t firstIndex = static_cast<int64_t>(arrival.sequence) * arrival.frames;
+            for (int32_t i = 0; i < arrival.frames; i++)
+            {
+                int64_t index = firstIndex + i;
+                for (int32_t c = 0; c < config.channelCount; c++)
+                {
+                    samples[static_cast<size_t>(i) * config.channelCount + c] =
+                        static_cast<int16_t>(c == 0 ? index / INDEX_LOW : index % INDEX_LOW);
+                }
+            }
+            core.write(packetBytes.data(), headerBytes + arrival.frames * config.channelCount * 2);
+            continue;
+        }
+
+        if (routeChangeNs >= 0 && restartNs < 0 && nextCallbackNs >= routeChangeNs)
+        {
+            // Sem callbacks durante a troca; os chunks continuam chegando ao ring
+            nextCallbackNs += static_cast<int64_t>(config.routeOutageMs * 1e6);
+            restartNs = nextCallbackNs;
+            if (config.routeFramesPerBurst > 0)
+            {
+                burst = config.routeFramesPerBurst;
+                output.reconfigure(config.sampleRate, burst);
+                core.setFramesPerBurst(burst);
+                periodNs = output.callbackPeriodNanos();
+            }
+            output.restart(static_cast<int64_t>(config.routeLatencyMs * 1e6),
+                           static_cast<int64_t>(config.routeTimestampDelayCallbacks) * burst);
+            core.notifyOutputRestarted();
+            continue;
+        }
+
+        clock.set(nextCallbackNs);
+        int32_t underrunsBefore = core.getUnderrunCount();
+
+        auto begin = std::chrono::steady_clock::now();
+        core.render(output, output.data(), burst);
+        auto end = std::chrono::steady_clock::now();
+        result.callbackNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+        result.callbacks++;
+        output.advance(burst);
+
+        if (result.firstAudioMs < 0.0 && !core.isPrebuffering())
+        {
+            result.firstAudioMs = nextCallbackNs / 1e6;
+        }
+        if (restartNs >= 0 && result.resumeAfterRouteMs < 0.0 && !core.isPrebuffering())
+        {
+            result.resumeAfterRouteMs = (nextCallbackNs - restartNs) / 1e6;
+        }
+        if (result.firstAudioMs >= 0.0 && core.isPrebuffering() && rebufferStartNs < 0)
+        {
+            rebufferStartNs = nextCallbackNs;
+        }
+        else if (rebufferStartNs >= 0 && !core.isPrebuffering())
+        {
+            result.maxRebufferMs = std::max(result.maxRebufferMs, (nextCallbackNs - rebufferStartNs) / 1e6);
+            rebufferStartNs = -1;
+        }
+
+        if (nextCallbackNs >= warmupNs)
+        {
+            result.underrunsAfterWarmup += core.getUnderrunCount() - underrunsBefore;
+            double bufferedMs = core.framesToMs(core.getBufferedFrames());
+            bufferedSumMs += bufferedMs;
+            bufferedSamples++;
+            result.maxBufferedMs = std::max(result.maxBufferedMs, bufferedMs);
+
+            // Decodificar o frame que saiu no início deste callback. Perto das viradas
+            // do índice a interpolação mistura valores: conferir com o frame 4 adiante.
+            auto decode = [&](int32_t frame)
+            {
+                const int16_t *f = output.data() + static_cast<size_t>(frame) * config.channelCount;
+                return static_cast<int64_t>(f[0]) * INDEX_LOW + f[1];
+            };
+            int64_t index = decode(0);
+            int64_t spread = burst > 4 ? decode(4) - index : 0;
+            if (config.timestamped && config.channelCount >= 2 && chunkFrames > 0 &&
+                !core.isPrebuffering() && spread >= 3 && spread <= 5)
+            {
+                auto sequence = static_cast<size_t>(index / chunkFrames);
+                if (sequence < captureTimeBySequence.size())
+                {
+                    int64_t captureNs = captureTimeBySequence[sequence] +
+                                        ((index % chunkFrames) * 1000000000LL) / config.sampleRate;
+                    int64_t idealNs = captureNs + config.playoutDelayMs * 1000000LL;
+                    double errorMs = (output.presentationNanos() - idealNs) / 1e6;
+                    syncSumMs += errorMs;
+                    result.syncSamples++;
+                    result.maxAbsSyncErrorMs = std::max(result.maxAbsSyncErrorMs, std::abs(errorMs));
+                }
+            }
+        }
+
+        nextCallbackNs += periodNs;
+    }
+
+    result.underruns = core.getUnderrunCount();
+    result.droppedFrames = core.getDroppedFrames();
+    result.meanBufferedMs = bufferedSamples > 0 ? bufferedSumMs / bufferedSamples : 0.0;
+    result.meanSyncErrorMs = result.syncSamples > 0 ? syncSumMs / result.syncSamples : 0.0;
+    result.finalBufferedMs = core.framesToMs(core.getBufferedFrames());
+    result.finalTargetMs = core.framesToMs(core.getTargetFrames());
+    return result;
+}
+
+SimulationResult replayTrace(const trace::Header &header, const std::vector<trace::Event> &events,
+                             const SimulationConfig &config)
+{
+    int32_t maxCallbackFrames = std::max(header.framesPerBurst, 1);
+    int32_t maxChunkFrames = 1;
+    for (const auto &event : events)
+    {
+        auto value = static_cast<int32_t>(std::min<uint32_t>(event.value, 1u << 20));
+        if (event.type == trace::EVENT_CALLBACK)
+            maxCallbackFrames = std::max(maxCallbackFrames, value);
+        else if (event.type == trace::EVENT_ARRIVAL)
+            maxChunkFrames = std::max(maxChunkFrames, value);
+    }
+
+    SimClock clock;
+    PlayerCore core(clock);
+    FakeAudioStream output(clock, header.deviceSampleRate, header.channelCount, maxCallbackFrames,
+                           static_cast<int64_t>(config.outputLatencyMs * 1e6));
+    output.reconfigure(header.deviceSampleRate, header.framesPerBurst);
+    core.configure(header.sampleRate, header.channelCount);
+    core.setOutputSampleRate(header.deviceSampleRate);
+    core.setFramesPerBurst(header.framesPerBurst);
+    core.setFastStart(config.fastStart);
+    core.start();
+
+    // Payload constante: o replay mede tempo e nível, não o conteúdo
+    std::vector<int16_t> chunk(static_cast<size_t>(maxChunkFrames) * header.channelCount, int16_t(1000));
+
+    SimulationResult result;
+    result.callbackNanos.reserve(events.size());
+    const int64_t startUs = events.empty() ? 0 : events.front().timeUs;
+    const int64_t warmupUs = static_cast<int64_t>(config.warmupS * 1e6);
+    double bufferedSumMs = 0.0;
+    int64_t bufferedSamples = 0;
+    int64_t restartUs = -1;
+    int64_t rebufferStartUs = -1;
+
+    for (const auto &event : events)
+    {
+        int64_t elapsedUs = event.timeUs - startUs;
+        clock.set(elapsedUs * 1000);
+        switch (event.type)
+        {
+        case trace::EVENT_ARRIVAL:
+            core.writeFrames(chunk.data(), std::min(static_cast<int32_t>(event.value), maxChunkFrames),
+                             PlayoutScheduler::NO_TIMESTAMP);
+            break;
+
+        case trace::EVENT_RESTART:
+            // Mesmo caminho do OboeAudioPlayer::reopenStream: taxa nova antes do 1º callback
+            output.reconfigure(static_cast<int32_t>(event.value), output.getFramesPerBurst());
+            output.restart(static_cast<int64_t>(config.outputLatencyMs * 1e6), 0);
+            core.setOutputSampleRate(static_cast<int32_t>(event.value));
+            core.notifyOutputRestarted();
+            restartUs = elapsedUs;
+            result.resumeAfterRouteMs = -1.0;
+            break;
+
+        case trace::EVENT_BURST:
+            output.reconfigure(output.getSampleRate(), static_cast<int32_t>(event.value));
+            core.setFramesPerBurst(static_cast<int32_t>(event.value));
+            break;
+
+        case trace::EVENT_CALLBACK:
+        {
+            auto frames = static_cast<int32_t>(event.value);
+            if (frames <= 0 || frames > maxCallbackFrames)
+                break;
+            int32_t underrunsBefore = core.getUnderrunCount();
+            auto begin = std::chrono::steady_clock::now();
+            core.render(output, output.data(), frames);
+            auto end = std::chrono::steady_clock::now();
+            result.callbackNanos.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+            result.callbacks++;
+            output.advance(frames);
+
+            if (result.firstAudioMs < 0.0 && !core.isPrebuffering())
+                result.firstAudioMs = elapsedUs / 1e3;
+            if (restartUs >= 0 && result.resumeAfterRouteMs < 0.0 && !core.isPrebuffering())
+                result.resumeAfterRouteMs = (elapsedUs - restartUs) / 1e3;
+            if (result.firstAudioMs >= 0.0 && core.isPrebuffering() && rebufferStartUs < 0)
+            {
+                rebufferStartUs = elapsedUs;
+            }
+            else if (rebufferStartUs >= 0 && !core.isPrebuffering())
+            {
+                result.maxRebufferMs = std::max(result.maxRebufferMs, (elapsedUs - rebufferStartUs) / 1e3);
+                rebufferStartUs = -1;
+            }
+
+            if (elapsedUs >= warmupUs)
+            {
+                result.underrunsAfterWarmup += core.getUnderrunCount() - underrunsBefore;
+                double bufferedMs = core.framesToMs(core.getBufferedFrames());
+                bufferedSumMs += bufferedMs;
+                bufferedSamples++;
+                result.maxBufferedMs = std::max(result.maxBufferedMs, bufferedMs);
+            }
+            break;
+        }
+
+        default:
+            break; // Tipo de uma versão mais nova: ignorar
+        }
+    }
+
+    result.underruns = core.getUnderrunCount();
+    result.droppedFrames = core.getDroppedFrames();
+    result.meanBufferedMs = bufferedSamples > 0 ? bufferedSumMs / bufferedSamples : 0.0;
+    result.finalBufferedMs = core.framesToMs(core.getBufferedFrames());
+    result.finalTargetMs = core.framesToMs(core.getTargetFrames());
+    return result;
+}
+
+std::vector<trace::Event> traceFromNetwork(const SimulationConfig &config, const std::vector<ChunkArrival> &arrivals)
+{
+    std::vector<trace::Event> events;
+    events.reserve(arrivals.size());
+    for (const auto &arrival : arrivals)
+    {
+        trace::Event event;
+        event.timeUs = arrival.timeNs / 1000;
+        event.type = trace::EVENT_ARRIVAL;
+        event.value = static_cast<uint32_t>(arrival.frames);
+        events.push_back(event);
+    }
+
+    const int64_t endUs = static_cast<int64_t>(config.durationS * 1e6);
+    const int64_t routeChangeUs = config.routeChangeS >= 0.0 ? static_cast<int64_t>(config.routeChangeS * 1e6) : -1;
+    int32_t burst = config.framesPerBurst;
+    double timeUs = (burst * 1e6) / config.sampleRate;
+    bool restarted = false;
+    while (timeUs <= endUs)
+    {
+        if (routeChangeUs >= 0 && !restarted && timeUs >= routeChangeUs)
+        {
+            // Sem callbacks durante a troca; o stream novo pode ter outro burst
+            timeUs += config.routeOutageMs * 1e3;
+            restarted = true;
+            if (config.routeFramesPerBurst > 0)
+                burst = config.routeFramesPerBurst;
+            auto at = static_cast<int64_t>(timeUs);
+            events.push_back({at, trace::EVENT_RESTART, static_cast<uint32_t>(config.sampleRate)});
+            events.push_back({at, trace::EVENT_BURST, static_cast<uint32_t>(burst)});
+        }
+        events.push_back({static_cast<int64_t>(timeUs), trace::EVENT_CALLBACK, static_cast<uint32_t>(burst)});
+        timeUs += (burst * 1e6) / config.sampleRate;
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const trace::Event &a, const trace::Event &b) { return a.timeUs < b.timeUs; });
+    return events;
+}
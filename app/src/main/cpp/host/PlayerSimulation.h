@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "NetworkTrace.h"
+#include "../TraceFormat.h"
+
+// ✅ Simulação determinística do PlayerCore: callbacks em tempo simulado
+// intercalados com as chegadas de um NetworkTrace
+struct SimulationConfig
+{
+    int32_t sampleRate = 48000;
+    int32_t channelCount = 2;
+    int32_t framesPerBurst = 192;
+    double durationS = 60.0;
+    double warmupS = 5.0; // Estatísticas de latência só depois disso
+    double outputLatencyMs = 20.0;
+    bool fastStart = false; // PlayerCore::setFastStart
+
+    // ✅ Modo sincronizado: chunks com cabeçalho SHB1 e timestamp de captura
+    bool timestamped = false;
+    int32_t playoutDelayMs = 300;
+    int64_t serverClockOffsetUs = 0;     // Relógio do servidor - relógio do receptor
+    int64_t clockOffsetErrorUs = 0;      // Erro da estimativa do ClockSync
+    int64_t captureStampJitterUs = 0;    // Ruído dos timestamps do sender (±)
+
+    // ✅ Troca de rota (fone -> Bluetooth): em routeChangeS o stream some por
+    // routeOutageMs e volta reaberto com outra latência, sem timestamp nos
+    // primeiros routeTimestampDelayCallbacks callbacks
+    double routeChangeS = -1.0;
+    double routeOutageMs = 250.0;
+    double routeLatencyMs = 150.0;
+    int32_t routeTimestampDelayCallbacks = 10;
+    int32_t routeFramesPerBurst = 0; // Burst do stream novo (0 = o mesmo), como na troca de modo de energia
+};
+
+struct SimulationResult
+{
+    int32_t callbacks = 0;
+    int32_t underruns = 0;
+    int32_t underrunsAfterWarmup = 0;
+    int64_t droppedFrames = 0;
+    double firstAudioMs = -1.0;
+    double meanBufferedMs = 0.0;
+    double maxBufferedMs = 0.0;
+    double finalBufferedMs = 0.0;
+    double finalTargetMs = 0.0;
+    double resumeAfterRouteMs = -1.0; // Do stream reaberto até o áudio voltar
+    double maxRebufferMs = 0.0;       // Maior volta ao prebuffer depois do 1º áudio
+
+    // Erro de sincronização medido na saída: instante real em que cada frame
+    // saiu menos captura + atraso (só no modo sincronizado, após o warmup)
+    int32_t syncSamples = 0;
+    double meanSyncErrorMs = 0.0;
+    double maxAbsSyncErrorMs = 0.0;
+    std::vector<int64_t> callbackNanos; // Tempo de CPU (parede) de cada render
+
+    int64_t callbackPercentile(double p) const;
+};
+
+SimulationResult runSimulation(const SimulationConfig &config, const std::vector<ChunkArrival> &arrivals);
+
+// ✅ Reprodução de um trace gravado (TraceRecorder): chunks e callbacks nos instantes
+// e tamanhos gravados, em tempo simulado e o mais rápido possível. O payload é
+// sintético; de `config` valem warmupS, fastStart e outputLatencyMs.
+SimulationResult replayTrace(const trace::Header &header, const std::vector<trace::Event> &events,
+                             const SimulationConfig &config);
+
+// Trace equivalente a uma simulação (traces de referência): chegadas da rede,
+// callbacks a cada burst e a troca de rota de `config`
+std::vector<trace::Event> traceFromNetwork(const SimulationConfig &config, const std::vector<ChunkArrival> &arrivals);
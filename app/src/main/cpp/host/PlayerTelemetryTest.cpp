@@ -0,0 +1,96 @@
+// ✅ Testes da telemetria do callback (ctest)
+
+#include "TestCheck.h"
+#include "../PlayerCore.h"
+#include "FakeAudioStream.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t BURST = 480;
+
+    int64_t sum(const int64_t *values, int32_t count)
+    {
+        int64_t total = 0;
+        for (int32_t i = 0; i < count; i++)
+            total += values[i];
+        return total;
+    }
+
+    void testBuckets()
+    {
+        EXPECT(PlayerTelemetry::bucketFor(0, 25) == 0);
+        EXPECT(PlayerTelemetry::bucketFor(24, 25) == 0);
+        EXPECT(PlayerTelemetry::bucketFor(25, 25) == 1);
+        EXPECT(PlayerTelemetry::bucketFor(99, 25) == 2);
+        EXPECT(PlayerTelemetry::bucketFor(100, 25) == 3);
+        EXPECT(PlayerTelemetry::bucketFor(1000000000, 25) == stats::HISTOGRAM_BUCKETS - 1);
+
+        PlayerTelemetry telemetry;
+        telemetry.recordCallback(30, 5, 1.0);
+        telemetry.recordCallback(900, 45, 1.0002);
+
+        int64_t out[stats::COUNT] = {};
+        telemetry.snapshotInto(out);
+        EXPECT(out[stats::CALLBACK_HISTOGRAM + 1] == 1);
+        EXPECT(out[stats::CALLBACK_HISTOGRAM + 6] == 1); // 800..1600µs
+        EXPECT(out[stats::FILL_HISTOGRAM + 0] == 1);
+        EXPECT(out[stats::FILL_HISTOGRAM + 3] == 1);     // 40..80ms
+        EXPECT(out[stats::CALLBACK_LAST_US] == 900);
+        EXPECT(out[stats::CALLBACK_MAX_US] == 900);
+        EXPECT(out[stats::RATIO_PPM] == 200);
+
+        // O máximo é "desde a última leitura"
+        telemetry.snapshotInto(out);
+        EXPECT(out[stats::CALLBACK_MAX_US] == 0);
+    }
+
+    // Um callback = uma amostra em cada histograma, inclusive em prebuffer/silêncio
+    void testPlayerCoreStats()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, BURST);
+        std::vector<int16_t> chunk(960 * CHANNELS, int16_t(1000));
+        int64_t now = 0;
+        for (int32_t i = 0; i < 400; i++)
+        {
+            if (i % 2 == 0)
+                core.write(reinterpret_cast<const uint8_t *>(chunk.data()),
+                           static_cast<int32_t>(chunk.size() * sizeof(int16_t)));
+            core.render(output, output.data(), BURST);
+            now += 10000000LL; // 10ms por burst
+            clock.set(now);
+        }
+
+        int64_t out[stats::COUNT];
+        core.getStats(out);
+        EXPECT(out[stats::SAMPLE_RATE] == SAMPLE_RATE);
+        EXPECT(out[stats::CALLBACKS] == 400);
+        EXPECT(sum(out + stats::CALLBACK_HISTOGRAM, stats::HISTOGRAM_BUCKETS) == 400);
+        EXPECT(sum(out + stats::FILL_HISTOGRAM, stats::HISTOGRAM_BUCKETS) == 400);
+        EXPECT(out[stats::XRUNS] == -1);
+        EXPECT(out[stats::STATE] & stats::STATE_PLAYING);
+        EXPECT(!(out[stats::STATE] & stats::STATE_PREBUFFERING));
+        EXPECT(out[stats::BUFFER_FRAMES] > 0);
+        EXPECT(out[stats::TARGET_FRAMES] > 0);
+
+        // Entrada e saída no mesmo ritmo: drift medido perto de zero
+        EXPECT(out[stats::CLOCK_DRIFT_PPM] > -50000 && out[stats::CLOCK_DRIFT_PPM] < 50000);
+    }
+}
+
+int main()
+{
+    testBuckets();
+    testPlayerCoreStats();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,154 @@
+// ✅ Testes do log diferido do callback (ctest)
+
+#include "TestCheck.h"
+#include "../PlayerCore.h"
+#include "../RealtimeLog.h"
+#include "FakeAudioStream.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Captured
+    {
+        RealtimeLog::Level level;
+        std::string text;
+    };
+
+    void capture(RealtimeLog &log, std::vector<Captured> &lines)
+    {
+        log.setSink([&lines](RealtimeLog::Level level, const char *text) { lines.push_back({level, text}); });
+    }
+
+    void testFormatting()
+    {
+        SimClock clock;
+        RealtimeLog log(clock);
+        std::vector<Captured> lines;
+        capture(log, lines);
+
+        log.post(RealtimeLog::UNDERRUN, 0, 100, 480, 10);
+        log.post(RealtimeLog::SCHEDULED, 3, 250);
+        EXPECT(log.drain() == 2);
+        EXPECT(lines.size() == 2);
+        if (lines.size() == 2)
+        {
+            EXPECT(lines[0].level == RealtimeLog::LEVEL_WARN);
+            EXPECT(lines[0].text == "⚠️ Underrun #100 | Ring: 480 frames (~10ms)");
+            EXPECT(lines[1].level == RealtimeLog::LEVEL_INFO);
+            EXPECT(lines[1].text == "[3] 🕒 Reprodução sincronizada (atraso 250ms)");
+        }
+        EXPECT(log.drain() == 0);
+    }
+
+    void testLevel()
+    {
+        SimClock clock;
+        RealtimeLog log(clock);
+        std::vector<Captured> lines;
+        capture(log, lines);
+
+        log.setLevel(RealtimeLog::LEVEL_WARN);
+        log.post(RealtimeLog::PREBUFFER_PROGRESS, 0, 1, 2, 3, 4); // INFO: nem entra na fila
+        log.post(RealtimeLog::UNDERRUN_REBUFFER, 0, 7);
+        log.post(RealtimeLog::PREBUFFER_TIMEOUT, 0, 1001);
+        EXPECT(log.drain() == 2);
+
+        log.setLevel(RealtimeLog::LEVEL_OFF);
+        log.post(RealtimeLog::PREBUFFER_TIMEOUT, 0, 1001);
+        EXPECT(log.drain() == 0);
+        EXPECT(log.getDropped() == 0);
+    }
+
+    // Mais de RATE_LIMIT registros do mesmo código numa janela viram uma linha só
+    void testRateLimit()
+    {
+        SimClock clock;
+        RealtimeLog log(clock);
+        std::vector<Captured> lines;
+        capture(log, lines);
+
+        for (int32_t i = 0; i < 50; i++)
+            log.post(RealtimeLog::UNDERRUN, 0, i);
+        log.post(RealtimeLog::BUFFER_AT_TARGET, 0, 120); // Outro código: limite próprio
+        EXPECT(log.drain() == RealtimeLog::RATE_LIMIT + 1);
+        EXPECT(log.getSuppressed() == 50 - RealtimeLog::RATE_LIMIT);
+
+        clock.set(RealtimeLog::RATE_WINDOW_MS * 1000000LL);
+        lines.clear();
+        log.post(RealtimeLog::UNDERRUN, 0, 51);
+        EXPECT(log.drain() == 2); // Resumo da janela anterior + o registro novo
+        if (lines.size() == 2)
+        {
+            EXPECT(lines[0].text.find("45 mensagens \"underrun\"") != std::string::npos);
+            EXPECT(lines[1].text.find("#51") != std::string::npos);
+        }
+    }
+
+    // Fila cheia: o produtor descarta e o consumidor avisa quantos perdeu
+    void testOverflow()
+    {
+        SimClock clock;
+        RealtimeLog log(clock);
+        std::vector<Captured> lines;
+        capture(log, lines);
+
+        for (uint32_t i = 0; i < RealtimeLog::QUEUE_RECORDS + 10; i++)
+            log.post(RealtimeLog::SCHEDULE_ALIGNED, 0, i);
+        EXPECT(log.getDropped() == 10);
+        log.drain();
+        EXPECT(!lines.empty() && lines.back().text.find("10 registros perdidos") != std::string::npos);
+    }
+
+    // O PlayerCore só empilha: prebuffer sem chunks e underruns chegam pelo drain()
+    void testPlayerCore()
+    {
+        SimClock clock;
+        RealtimeLog log(clock);
+        std::vector<Captured> lines;
+        capture(log, lines);
+
+        PlayerCore core(clock);
+        FakeAudioStream output(clock, 48000, 2, 480);
+        core.configure(48000, 2);
+        core.setLog(&log, 0);
+        core.start();
+
+        for (int32_t i = 0; i < 100; i++)
+            core.render(output, output.data(), 480);
+        EXPECT(log.drain() > 0);
+        bool progress = false;
+        for (const auto &line : lines)
+            progress = progress || line.text.find("Prebuffering...") != std::string::npos;
+        EXPECT(progress);
+
+        core.setLog(nullptr, 0);
+        core.render(output, output.data(), 480);
+        EXPECT(log.drain() == 0);
+    }
+
+    void testThread()
+    {
+        RealtimeLog log;
+        std::vector<Captured> lines;
+        capture(log, lines);
+        log.start();
+        log.post(RealtimeLog::UNSCHEDULED, 0);
+        log.stop();
+        EXPECT(lines.size() == 1);
+    }
+}
+
+int main()
+{
+    testFormatting();
+    testLevel();
+    testRateLimit();
+    testOverflow();
+    testPlayerCore();
+    testThread();
+
+    return testcheck::finish();
+}
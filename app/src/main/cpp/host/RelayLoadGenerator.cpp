@@ -0,0 +1,296 @@
+// ✅ Gerador de carga do relay: um sender e N ouvintes sintéticos com o PlayerCore
+//
+// O sender roda o CapturePipeline (PCM16, chunks de 20ms em tempo real) e manda
+// para o relay; cada ouvinte tem o próprio socket inscrito no relay e o próprio
+// PlayerCore, que recebe os SHB1 como no UdpReceiver e é renderizado em bursts de
+// 4ms no relógio real (todos os ouvintes numa thread com epoll). Por ouvinte:
+// trânsito sender -> ouvinte (p50/p99, pelo instante de envio de cada sequência),
+// buffer médio, perda e underruns depois do aquecimento.
+//
+// Uso: relay-load-generator [ouvintes] [segundos] [porta do relay]
+// (porta 0 = relay no próprio processo)
+
+#include "FakeAudioStream.h"
+#include "FanoutRelay.h"
+#include "../CapturePipeline.h"
+#include "../PlayerCore.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960; // 20ms
+    constexpr int32_t BURST_FRAMES = 192; // 4ms
+    constexpr int64_t WARMUP_US = 2000000;
+    constexpr int64_t SUBSCRIBE_INTERVAL_US = 1000000;
+    constexpr uint32_t SEND_LOG_SIZE = 4096; // ~80s de chunks: sobra para o atraso máximo
+
+    const PlayerClock &clock = PlayerClock::system();
+
+    int64_t nowUs()
+    {
+        return clock.nowNanos() / 1000;
+    }
+
+    sockaddr_in loopback(int32_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        return address;
+    }
+
+    // Instante de envio de cada sequência (escrito pelo sender, lido pelos ouvintes)
+    std::array<std::atomic<int64_t>, SEND_LOG_SIZE> sendLog;
+
+    void runSender(int32_t relayPort, const std::atomic<bool> &running, int64_t &sentPackets)
+    {
+        CapturePipeline pipeline;
+        pipeline.configure(SAMPLE_RATE, CHANNELS, CHUNK_FRAMES, nullptr);
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        sockaddr_in target = loopback(relayPort);
+
+        std::vector<int16_t> chunk(static_cast<size_t>(CHUNK_FRAMES) * CHANNELS);
+        std::vector<uint8_t> bytes(packet::HEADER_BYTES + chunk.size() * sizeof(int16_t));
+        double phase = 0.0;
+        auto next = std::chrono::steady_clock::now();
+        while (running.load())
+        {
+            for (int32_t i = 0; i < CHUNK_FRAMES; i++, phase += 2.0 * M_PI * 440.0 / SAMPLE_RATE)
+                chunk[i * CHANNELS] = chunk[i * CHANNELS + 1] = static_cast<int16_t>(8000.0 * std::sin(phase));
+            pipeline.write(chunk.data(), CHUNK_FRAMES, CapturePipeline::NO_TIMESTAMP);
+
+            int32_t length;
+            while ((length = pipeline.readPacket(bytes.data(), static_cast<int32_t>(bytes.size()))) > 0)
+            {
+                packet::Header header;
+                packet::parse(bytes.data(), length, header);
+                sendLog[header.sequence % SEND_LOG_SIZE].store(nowUs(), std::memory_order_relaxed);
+                sendto(fd, bytes.data(), static_cast<size_t>(length), 0,
+                       reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+                sentPackets++;
+            }
+
+            next += std::chrono::milliseconds(CHUNK_FRAMES * 1000 / SAMPLE_RATE);
+            std::this_thread::sleep_until(next);
+        }
+        close(fd);
+    }
+
+    // ✅ Ouvinte sintético: socket próprio inscrito no relay + PlayerCore (o que o
+    // UdpReceiver e o callback fariam no aparelho)
+    class Listener
+    {
+    public:
+        explicit Listener(int32_t relayPort)
+            : relay(loopback(relayPort)), output(clock, SAMPLE_RATE, CHANNELS, BURST_FRAMES),
+              datagram(FanoutRelay::MAX_PACKET_BYTES)
+        {
+            core.configure(SAMPLE_RATE, CHANNELS);
+            core.start();
+            fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            sockaddr_in local = loopback(0);
+            bind(fd, reinterpret_cast<sockaddr *>(&local), sizeof(local));
+            int bufferBytes = 1 << 20;
+            setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufferBytes, sizeof(bufferBytes));
+        }
+
+        ~Listener() { close(fd); }
+
+        int getFd() const { return fd; }
+
+        void subscribe(bool unsubscribe = false)
+        {
+            uint8_t bytes[relay::SUBSCRIBE_BYTES];
+            relay::writeSubscribe(bytes, 0, unsubscribe);
+            sendto(fd, bytes, sizeof(bytes), 0, reinterpret_cast<const sockaddr *>(&relay), sizeof(relay));
+        }
+
+        // Produtor: tudo o que chegou, como o UdpReceiver (PCM16 direto no ring)
+        void drain(int64_t warmupEndUs)
+        {
+            ssize_t length;
+            while ((length = recv(fd, datagram.data(), datagram.size(), 0)) > 0)
+            {
+                packet::Header header;
+                if (!packet::parse(datagram.data(), static_cast<int32_t>(length), header))
+                    continue;
+                int64_t arrivalUs = nowUs();
+                if (arrivalUs >= warmupEndUs)
+                    transitUs.push_back(arrivalUs - sendLog[header.sequence % SEND_LOG_SIZE].load(std::memory_order_relaxed));
+                core.write(datagram.data(), static_cast<int32_t>(length));
+            }
+        }
+
+        // Consumidor: um burst, como o callback
+        void render(bool warmup)
+        {
+            core.render(output, output.data(), BURST_FRAMES);
+            output.advance(BURST_FRAMES);
+            if (warmup)
+            {
+                warmupUnderruns = core.getUnderrunCount();
+                return;
+            }
+            bufferMsSum += core.getBufferedMs();
+            renders++;
+        }
+
+        int64_t percentileUs(double p)
+        {
+            if (transitUs.empty())
+                return -1;
+            std::sort(transitUs.begin(), transitUs.end());
+            return transitUs[std::min(transitUs.size() - 1, static_cast<size_t>(p * static_cast<double>(transitUs.size())))];
+        }
+
+        double meanBufferMs() const { return renders > 0 ? bufferMsSum / static_cast<double>(renders) : 0.0; }
+        void getStats(int64_t *values) { core.getStats(values); }
+        int32_t getUnderruns() const { return core.getUnderrunCount() - warmupUnderruns; }
+
+    private:
+        sockaddr_in relay;
+        int fd = -1;
+        PlayerCore core;
+        FakeAudioStream output;
+        std::vector<uint8_t> datagram;
+
+        std::vector<int64_t> transitUs;
+        double bufferMsSum = 0.0;
+        int64_t renders = 0;
+        int32_t warmupUnderruns = 0;
+    };
+
+    // ✅ Todos os ouvintes numa thread com epoll: o custo do gerador não cresce em
+    // threads com N (o que se mede é o relay, não o escalonador)
+    void runListeners(std::vector<std::unique_ptr<Listener>> &listeners, const std::atomic<bool> &running,
+                      int64_t warmupEndUs)
+    {
+        int epollFd = epoll_create1(EPOLL_CLOEXEC);
+        for (size_t i = 0; i < listeners.size(); i++)
+        {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(epollFd, EPOLL_CTL_ADD, listeners[i]->getFd(), &event);
+        }
+
+        std::vector<epoll_event> events(listeners.size());
+        int64_t periodUs = static_cast<int64_t>(BURST_FRAMES) * 1000000 / SAMPLE_RATE;
+        int64_t nextRenderUs = nowUs();
+        int64_t nextSubscribeUs = nextRenderUs;
+        while (running.load())
+        {
+            int64_t now = nowUs();
+            if (now >= nextSubscribeUs)
+            {
+                for (auto &listener : listeners)
+                    listener->subscribe();
+                nextSubscribeUs = now + SUBSCRIBE_INTERVAL_US;
+            }
+
+            int timeoutMs = static_cast<int>((std::max<int64_t>(nextRenderUs - now, 0) + 999) / 1000);
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), timeoutMs);
+            for (int i = 0; i < ready; i++)
+                listeners[events[i].data.u32]->drain(warmupEndUs);
+
+            while (nowUs() >= nextRenderUs)
+            {
+                for (auto &listener : listeners)
+                    listener->render(nextRenderUs < warmupEndUs);
+                nextRenderUs += periodUs;
+            }
+        }
+
+        for (auto &listener : listeners)
+            listener->subscribe(true);
+        close(epollFd);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int32_t listenerCount = argc > 1 ? std::atoi(argv[1]) : 20;
+    double seconds = argc > 2 ? std::atof(argv[2]) : 10.0;
+    int32_t relayPort = argc > 3 ? std::atoi(argv[3]) : 0;
+    listenerCount = std::clamp(listenerCount, 1, FanoutRelay::MAX_SUBSCRIBERS);
+
+    std::unique_ptr<FanoutRelay> localRelay;
+    if (relayPort == 0)
+    {
+        localRelay = std::make_unique<FanoutRelay>();
+        relayPort = localRelay->start(0);
+        if (relayPort < 0)
+            return 1;
+    }
+    std::printf("%d ouvintes | %.0fs | relay na porta %d%s\n", listenerCount, seconds, relayPort,
+                localRelay ? " (neste processo)" : "");
+
+    std::atomic<bool> running{true};
+    int64_t warmupEndUs = nowUs() + WARMUP_US;
+    std::vector<std::unique_ptr<Listener>> listeners;
+    for (int32_t i = 0; i < listenerCount; i++)
+        listeners.push_back(std::make_unique<Listener>(relayPort));
+    std::thread receivers(runListeners, std::ref(listeners), std::cref(running), warmupEndUs);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200)); // Inscrições antes do primeiro chunk
+
+    int64_t sentPackets = 0;
+    std::thread sender(runSender, relayPort, std::cref(running), std::ref(sentPackets));
+    std::this_thread::sleep_for(std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000.0)));
+    running = false;
+    sender.join();
+    receivers.join();
+
+    std::printf("%-8s %10s %10s %12s %8s %6s\n", "ouvinte", "p50 (ms)", "p99 (ms)", "buffer (ms)", "perda", "UR");
+    int64_t worstP99 = 0;
+    int64_t totalLost = 0;
+    int64_t totalExpected = 0;
+    int32_t totalUnderruns = 0;
+    for (size_t i = 0; i < listeners.size(); i++)
+    {
+        Listener &listener = *listeners[i];
+        int64_t values[stats::COUNT] = {};
+        listener.getStats(values);
+        int64_t lost = values[stats::LOST_PACKETS];
+        int64_t expected = lost + values[stats::RECEIVED_PACKETS];
+        int64_t p99 = listener.percentileUs(0.99);
+        std::printf("%-8zu %10.2f %10.2f %12.1f %7.2f%% %6d\n", i, listener.percentileUs(0.50) / 1000.0, p99 / 1000.0,
+                    listener.meanBufferMs(), expected > 0 ? 100.0 * static_cast<double>(lost) / static_cast<double>(expected) : 0.0,
+                    listener.getUnderruns());
+        worstP99 = std::max(worstP99, p99);
+        totalLost += lost;
+        totalExpected += expected;
+        totalUnderruns += listener.getUnderruns();
+    }
+
+    std::printf("Total: %lld chunks enviados | pior p99 %.2fms | perda %.3f%% | %d underruns depois do aquecimento\n",
+                static_cast<long long>(sentPackets), worstP99 / 1000.0,
+                totalExpected > 0 ? 100.0 * static_cast<double>(totalLost) / static_cast<double>(totalExpected) : 0.0,
+                totalUnderruns);
+    if (localRelay)
+    {
+        std::printf("Relay: %lld entregues em %lld sendmmsg | %lld descartados | %lld recusados\n",
+                    static_cast<long long>(localRelay->getForwarded()), static_cast<long long>(localRelay->getSendCalls()),
+                    static_cast<long long>(localRelay->getDropped()), static_cast<long long>(localRelay->getRejected()));
+        localRelay->stop();
+    }
+    return 0;
+}
@@ -0,0 +1,58 @@
+// ✅ Relay de fan-out local (FanoutRelay) como processo próprio
+//
+// Faz as vezes do servidor no caminho do áudio: o sender manda SHB1 para a porta,
+// os ouvintes se inscrevem com SHSB (FanoutRelay.h). Mostra o tráfego a cada 5s;
+// Ctrl+C encerra.
+//
+// Uso: fanout-relay [porta]
+
+#include "FanoutRelay.h"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+
+namespace
+{
+    volatile std::sig_atomic_t interrupted = 0;
+
+    void onSignal(int)
+    {
+        interrupted = 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int32_t port = argc > 1 ? std::atoi(argv[1]) : 9000;
+    FanoutRelay relay;
+    if (relay.start(port) < 0)
+    {
+        std::fprintf(stderr, "Não foi possível abrir a porta %d\n", port);
+        return 1;
+    }
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    std::printf("Relay na porta %d\n", relay.getPort());
+
+    int64_t lastIngested = 0;
+    int64_t lastForwarded = 0;
+    while (interrupted == 0)
+    {
+        for (int32_t i = 0; i < 50 && interrupted == 0; i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+        int64_t ingested = relay.getIngested();
+        int64_t forwarded = relay.getForwarded();
+        std::printf("ouvintes %3d | recebidos %6.1f/s | entregues %8.1f/s | descartados %lld | recusados %lld | sendmmsg %lld\n",
+                    relay.getSubscriberCount(), (ingested - lastIngested) / 5.0, (forwarded - lastForwarded) / 5.0,
+                    static_cast<long long>(relay.getDropped()), static_cast<long long>(relay.getRejected()),
+                    static_cast<long long>(relay.getSendCalls()));
+        std::fflush(stdout);
+        lastIngested = ingested;
+        lastForwarded = forwarded;
+    }
+    relay.stop();
+    return 0;
+}
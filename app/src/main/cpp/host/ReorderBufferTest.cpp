@@ -0,0 +1,237 @@
+// ✅ Testes da janela de reordenação e do concealment PCM (ctest)
+
+#include "TestCheck.h"
+#include "../PacketFormat.h"
+#include "../PlayerCore.h"
+#include "FakeAudioStream.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960;
+
+    // (sequência, perdidos antes) na ordem em que saíram da janela
+    using Deliveries = std::vector<std::pair<uint32_t, uint32_t>>;
+
+    Deliveries run(ReorderBuffer &buffer, std::initializer_list<uint32_t> arrivals, int *rejected = nullptr)
+    {
+        Deliveries out;
+        for (uint32_t sequence : arrivals)
+        {
+            uint8_t payload[4];
+            memcpy(payload, &sequence, 4);
+            bool accepted = buffer.push(sequence, 0, payload, 4,
+                                        [&](const ReorderBuffer::Entry &entry, uint32_t lostBefore)
+                                        {
+                                            uint32_t carried;
+                                            memcpy(&carried, entry.data, 4);
+                                            EXPECT(carried == entry.sequence); // Payload certo no slot
+                                            out.emplace_back(entry.sequence, lostBefore);
+                                        });
+            if (!accepted && rejected)
+                (*rejected)++;
+        }
+        return out;
+    }
+
+    void testReorderWindow()
+    {
+        ReorderBuffer buffer;
+        buffer.configure(64);
+
+        // Troca simples: 2 chega antes de 1
+        Deliveries got = run(buffer, {0, 2, 1, 3});
+        EXPECT((got == Deliveries{{0, 0}, {1, 0}, {2, 0}, {3, 0}}));
+        EXPECT(buffer.getReorderedPackets() == 1);
+        EXPECT(buffer.getLostPackets() == 0);
+
+        // Duplicado e atrasado são descartados
+        int rejected = 0;
+        got = run(buffer, {3, 1, 4}, &rejected);
+        EXPECT((got == Deliveries{{4, 0}}));
+        EXPECT(rejected == 2);
+        EXPECT(buffer.getLatePackets() == 2);
+
+        // 5 some: espera até haver MAX_WAIT_PACKETS adiante, aí entrega 6 com 1 perdido
+        got = run(buffer, {6, 7});
+        EXPECT(got.empty());
+        EXPECT(buffer.heldPackets() == 2);
+        got = run(buffer, {8});
+        EXPECT((got == Deliveries{{6, 1}, {7, 0}, {8, 0}}));
+        EXPECT(buffer.getLostPackets() == 1);
+
+        // E se 5 chegar agora, já é tarde
+        rejected = 0;
+        run(buffer, {5}, &rejected);
+        EXPECT(rejected == 1);
+
+        // Salto maior que a janela: sem espera, com o buraco anotado
+        got = run(buffer, {30});
+        EXPECT((got == Deliveries{{30, 21}}));
+
+        // Um pouco atrás ainda é atraso; muito atrás é sender reiniciado
+        rejected = 0;
+        run(buffer, {0}, &rejected);
+        EXPECT(rejected == 1);
+        got = run(buffer, {130});
+        EXPECT((got == Deliveries{{130, 99}}));
+        got = run(buffer, {0, 1});
+        EXPECT((got == Deliveries{{0, ReorderBuffer::DISCONTINUITY}, {1, 0}}));
+
+        // Guardados saem antes de um salto
+        got = run(buffer, {3, 20});
+        EXPECT((got == Deliveries{{3, 1}, {20, 16}}));
+
+        // Sequência dá a volta em 2^32
+        buffer.reset();
+        got = run(buffer, {0xFFFFFFFEu, 0u, 0xFFFFFFFFu});
+        EXPECT((got == Deliveries{{0xFFFFFFFEu, 0}, {0xFFFFFFFFu, 0}, {0u, 0}}));
+    }
+
+    std::vector<int16_t> sineChunk(int64_t firstFrame, int32_t frames, double hz)
+    {
+        std::vector<int16_t> samples(static_cast<size_t>(frames) * CHANNELS);
+        for (int32_t i = 0; i < frames; i++)
+        {
+            double t = static_cast<double>(firstFrame + i) / SAMPLE_RATE;
+            auto v = static_cast<int16_t>(std::lrint(12000.0 * std::sin(2.0 * M_PI * hz * t)));
+            samples[2 * i] = v;
+            samples[2 * i + 1] = v;
+        }
+        return samples;
+    }
+
+    // Maior salto entre frames vizinhos (canal 0)
+    int32_t maxStep(const std::vector<int16_t> &samples)
+    {
+        int32_t step = 0;
+        for (size_t i = CHANNELS; i < samples.size(); i += CHANNELS)
+            step = std::max(step, std::abs(samples[i] - samples[i - CHANNELS]));
+        return step;
+    }
+
+    void testConcealerContinuity()
+    {
+        const double hz = 440.0;
+        LossConcealer concealer;
+        concealer.configure(SAMPLE_RATE, CHANNELS);
+
+        std::vector<int16_t> timeline;
+        for (int32_t c = 0; c < 3; c++)
+        {
+            auto chunk = sineChunk(c * CHUNK_FRAMES, CHUNK_FRAMES, hz);
+            concealer.remember(chunk.data(), CHUNK_FRAMES);
+            timeline.insert(timeline.end(), chunk.begin(), chunk.end());
+        }
+
+        // Chunk 3 perdido
+        std::vector<int16_t> concealed(CHUNK_FRAMES * CHANNELS);
+        concealer.conceal(concealed.data(), CHUNK_FRAMES);
+        EXPECT(concealer.isConcealing());
+        timeline.insert(timeline.end(), concealed.begin(), concealed.end());
+
+        // Chunk 4 volta com crossfade
+        auto next = sineChunk(4 * CHUNK_FRAMES, CHUNK_FRAMES, hz);
+        concealer.blendInto(next.data(), CHUNK_FRAMES);
+        EXPECT(!concealer.isConcealing());
+        timeline.insert(timeline.end(), next.begin(), next.end());
+
+        // Um seno de 440Hz a 12000 anda no máximo ~690 por frame: sem degraus nas emendas
+        int32_t natural = maxStep(sineChunk(0, CHUNK_FRAMES, hz));
+        int32_t step = maxStep(timeline);
+        if (step > natural + 200)
+        {
+            std::fprintf(stderr, "  degrau %d (natural %d)\n", step, natural);
+            testcheck::failures++;
+        }
+
+        // O chunk sintético continua o seno (período encontrado ~ 109 frames)
+        double energy = 0.0;
+        for (size_t i = 0; i < concealed.size(); i += CHANNELS)
+            energy += static_cast<double>(concealed[i]) * concealed[i];
+        double rms = std::sqrt(energy / CHUNK_FRAMES);
+        EXPECT(rms > 12000.0 / std::sqrt(2.0) * 0.9);
+
+        // Perdas seguidas vão a silêncio
+        for (int32_t i = 0; i < 4; i++)
+            concealer.conceal(concealed.data(), CHUNK_FRAMES);
+        EXPECT(concealed[concealed.size() - 2] == 0);
+    }
+
+    std::vector<uint8_t> makePacket(uint32_t sequence, const std::vector<int16_t> &pcm)
+    {
+        std::vector<uint8_t> bytes(packet::HEADER_BYTES + pcm.size() * 2);
+        packet::Header header;
+        header.sequence = sequence;
+        header.frames = static_cast<uint32_t>(pcm.size() / CHANNELS);
+        packet::write(bytes.data(), header);
+        memcpy(bytes.data() + packet::HEADER_BYTES, pcm.data(), pcm.size() * 2);
+        return bytes;
+    }
+
+    // Chunks PCM fora de ordem e com uma perda chegam ao ring em ordem e sem buraco
+    void testPlayerCoreSequencing()
+    {
+        SimClock clock;
+        PlayerCore core(clock);
+        core.configure(SAMPLE_RATE, CHANNELS);
+        core.start();
+
+        auto chunk = [](uint32_t sequence)
+        {
+            return std::vector<int16_t>(CHUNK_FRAMES * CHANNELS, static_cast<int16_t>(1000 + sequence));
+        };
+
+        // 0 2 1 [3 perdido] 4 5 6 3(tarde) 6(dup)
+        for (uint32_t sequence : {0u, 2u, 1u, 4u, 5u, 6u, 3u, 6u})
+        {
+            auto bytes = makePacket(sequence, chunk(sequence));
+            core.write(bytes.data(), static_cast<int32_t>(bytes.size()));
+        }
+
+        EXPECT(core.getReorderedPackets() == 1);
+        EXPECT(core.getLostPackets() == 1);
+        EXPECT(core.getConcealedPackets() == 1);
+        EXPECT(core.getLatePackets() == 2);
+        EXPECT(core.getBufferedFrames() == 7 * CHUNK_FRAMES); // 0..6, com o 3 sintético
+
+        // Sem timestamp, o prebuffer de 120ms precisa de 6 chunks: depois sai tudo em ordem
+        FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, CHUNK_FRAMES);
+        std::vector<int16_t> marks;
+        for (int32_t i = 0; i < 8; i++)
+        {
+            core.render(output, output.data(), CHUNK_FRAMES);
+            int16_t mark = output.data()[(CHUNK_FRAMES / 2) * CHANNELS];
+            if (mark != 0)
+                marks.push_back(mark);
+        }
+        EXPECT(marks.size() >= 6);
+        if (marks.size() >= 6)
+        {
+            EXPECT(marks[0] == 1000 && marks[1] == 1001 && marks[2] == 1002);
+            EXPECT(marks[3] == 1002);                  // Concealment de um sinal constante
+            EXPECT(marks[4] == 1004 && marks[5] == 1005);
+        }
+
+        // requestClear recomeça a sequência (stream novo começando do 0)
+        core.requestClear();
+        auto bytes = makePacket(0, chunk(0));
+        EXPECT(core.write(bytes.data(), static_cast<int32_t>(bytes.size())));
+    }
+}
+
+int main()
+{
+    testReorderWindow();
+    testConcealerContinuity();
+    testPlayerCoreSequencing();
+
+    return testcheck::finish();
+}
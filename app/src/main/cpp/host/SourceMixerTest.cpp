@@ -0,0 +1,268 @@
+// ✅ Testes do mixer de várias fontes (ctest)
+
+#include "TestCheck.h"
+#include "../AudioKernels.h"
+#include "../PacketFormat.h"
+#include "../SourceMixer.h"
+#include "FakeAudioStream.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t BURST = 480;        // 10ms
+    constexpr int32_t CHUNK_FRAMES = 960; // 20ms
+
+    void testMixKernel()
+    {
+        // Tamanho ímpar: passa pelo corpo SIMD e pela cauda escalar
+        std::vector<int16_t> a(1037);
+        std::vector<int16_t> b(a.size());
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            a[i] = static_cast<int16_t>((static_cast<int32_t>(i) * 7919) % 65536 - 32768);
+            b[i] = static_cast<int16_t>((static_cast<int32_t>(i) * 104729) % 65536 - 32768);
+        }
+        a[0] = 30000;
+        b[0] = 10000;
+        a[1] = -30000;
+        b[1] = -10000;
+
+        std::vector<int16_t> simd = a;
+        std::vector<int16_t> scalar = a;
+        audiokernels::mixSaturate(simd.data(), b.data(), static_cast<int32_t>(a.size()));
+        audiokernels::mixSaturateScalar(scalar.data(), b.data(), static_cast<int32_t>(a.size()));
+        EXPECT(simd == scalar);
+        EXPECT(simd[0] == 32767);
+        EXPECT(simd[1] == -32768);
+    }
+
+    // Dois senders com DC constante: a saída é a soma (com ganho e saturação)
+    struct Rig
+    {
+        SimClock clock;
+        SourceMixer mixer{clock};
+        FakeAudioStream output{clock, SAMPLE_RATE, CHANNELS, BURST};
+        std::vector<int16_t> chunk = std::vector<int16_t>(static_cast<size_t>(CHUNK_FRAMES) * CHANNELS);
+        int64_t now = 0;
+        int32_t callback = 0;
+
+        Rig()
+        {
+            mixer.configure(SAMPLE_RATE, CHANNELS);
+            mixer.addSource(7);
+            mixer.start();
+        }
+
+        void write(int32_t id, int16_t value)
+        {
+            std::fill(chunk.begin(), chunk.end(), value);
+            mixer.withSource(id, [&](SourceMixer::Source &source)
+                             { source.core.writeFrames(chunk.data(), CHUNK_FRAMES, PlayoutScheduler::NO_TIMESTAMP); });
+        }
+
+        // Roda `callbacks` callbacks com os dois senders mandando chunks de 20ms
+        void run(int32_t callbacks, int16_t first, int16_t second)
+        {
+            for (int32_t i = 0; i < callbacks; i++, callback++)
+            {
+                if (callback % 2 == 0)
+                {
+                    write(SourceMixer::DEFAULT_SOURCE, first);
+                    write(7, second);
+                }
+                mixer.render(output, output.output(), BURST);
+                output.advance(BURST);
+                now += 10000000LL;
+                clock.set(now);
+            }
+        }
+
+        // 1º sample do último callback
+        double lastSample()
+        {
+            return output.getFormat() == OutputFormat::Float ? output.floatData()[0] * 32768.0 : output.data()[0];
+        }
+
+        int32_t underruns()
+        {
+            int32_t total = 0;
+            mixer.forEachSource([&](SourceMixer::Source &source) { total += source.core.getUnderrunCount(); });
+            return total;
+        }
+    };
+
+    void testMixing()
+    {
+        Rig rig;
+        EXPECT(rig.mixer.getSourceCount() == 2);
+
+        rig.run(100, 1000, 2000);
+        EXPECT(rig.lastSample() == 3000.0);
+        EXPECT(rig.underruns() == 0);
+
+        // Ganho do sender 7 pela metade (rampa de 20ms)
+        EXPECT(rig.mixer.setSourceGain(7, 0.5f));
+        rig.run(10, 1000, 2000);
+        EXPECT(rig.lastSample() == 2000.0);
+
+        // Volume geral multiplica o ganho de cada sender
+        rig.mixer.setMasterVolume(0.5f);
+        rig.run(10, 1000, 2000);
+        EXPECT(rig.lastSample() == 1000.0);
+        rig.mixer.setMasterVolume(1.0f);
+        EXPECT(rig.mixer.setSourceGain(7, 1.0f));
+
+        // Soma acima do int16: satura em vez de dar a volta
+        rig.run(100, 20000, 20000);
+        EXPECT(rig.lastSample() == 32767.0);
+
+        // Saída float: soma em PCM16 e conversão no fim
+        rig.output.setFormat(OutputFormat::Float);
+        rig.run(10, 1000, -3000);
+        EXPECT(rig.lastSample() == -2000.0);
+        EXPECT(rig.underruns() == 0);
+
+        // Sender removido: o outro continua sozinho (render direto, sem mixagem)
+        EXPECT(rig.mixer.removeSource(7));
+        EXPECT(!rig.mixer.removeSource(7));
+        rig.output.setFormat(OutputFormat::I16);
+        rig.run(10, 1000, 2000);
+        EXPECT(rig.lastSample() == 1000.0);
+        EXPECT(rig.mixer.getSourceCount() == 1);
+    }
+
+    void testSourceLimit()
+    {
+        SimClock clock;
+        SourceMixer mixer(clock);
+        mixer.configure(SAMPLE_RATE, CHANNELS);
+        EXPECT(!mixer.addSource(SourceMixer::DEFAULT_SOURCE));
+        for (int32_t id = 1; id < SourceMixer::MAX_SOURCES; id++)
+            EXPECT(mixer.addSource(id));
+        EXPECT(!mixer.addSource(100));
+        EXPECT(mixer.getSourceCount() == SourceMixer::MAX_SOURCES);
+
+        // configure() volta ao sender padrão
+        mixer.configure(SAMPLE_RATE, CHANNELS);
+        EXPECT(mixer.getSourceCount() == 1);
+        EXPECT(mixer.withSource(SourceMixer::DEFAULT_SOURCE, [](SourceMixer::Source &) {}));
+    }
+
+    // Senders entrando e saindo com o callback rodando numa thread de verdade
+    void testChurnWhileRendering()
+    {
+        const PlayerClock &clock = PlayerClock::system();
+        SourceMixer mixer(clock);
+        mixer.configure(SAMPLE_RATE, CHANNELS);
+        mixer.start();
+
+        std::atomic<bool> running{true};
+        std::atomic<int32_t> callbacks{0};
+        std::thread audio([&]
+                          {
+            FakeAudioStream output(clock, SAMPLE_RATE, CHANNELS, BURST);
+            while (running.load())
+            {
+                mixer.render(output, output.output(), BURST);
+                output.advance(BURST);
+                callbacks++;
+            } });
+
+        std::vector<int16_t> chunk(static_cast<size_t>(CHUNK_FRAMES) * CHANNELS, int16_t(500));
+        for (int32_t round = 0; round < 200; round++)
+        {
+            int32_t id = 1 + round % 5;
+            mixer.addSource(id);
+            mixer.withSource(id, [&](SourceMixer::Source &source)
+                             { source.core.writeFrames(chunk.data(), CHUNK_FRAMES, PlayoutScheduler::NO_TIMESTAMP); });
+            if (round % 3 == 0)
+                mixer.removeSource(1 + (round / 3) % 5);
+        }
+
+        running = false;
+        audio.join();
+        EXPECT(callbacks.load() > 0);
+        EXPECT(mixer.getSourceCount() >= 1 && mixer.getSourceCount() <= 6);
+    }
+
+    // Decodificador mínimo: todo pacote vira um chunk de DC
+    class ConstantDecoder : public AudioDecoder
+    {
+    public:
+        int32_t decode(const uint8_t *, int32_t, int16_t *pcm, int32_t) override
+        {
+            std::fill_n(pcm, CHUNK_FRAMES * CHANNELS, int16_t(100));
+            return CHUNK_FRAMES;
+        }
+        int32_t conceal(int16_t *pcm, int32_t frames) override
+        {
+            std::fill_n(pcm, frames * CHANNELS, int16_t(0));
+            return frames;
+        }
+        int32_t recover(const uint8_t *, int32_t, int16_t *pcm, int32_t frames) override { return conceal(pcm, frames); }
+        void reset() override {}
+        const char *name() const override { return "constante"; }
+    };
+
+    std::vector<uint8_t> makeChunk(uint8_t codec, uint32_t sequence)
+    {
+        int32_t payload = codec == packet::CODEC_OPUS ? 4 : CHUNK_FRAMES * CHANNELS * 2;
+        std::vector<uint8_t> bytes(packet::HEADER_BYTES + payload, 0);
+        packet::Header header;
+        header.codec = codec;
+        header.sequence = sequence;
+        header.frames = CHUNK_FRAMES;
+        packet::write(bytes.data(), header);
+        return bytes;
+    }
+
+    // ✅ Opus e depois PCM na mesma fonte (sender reiniciado com outro codec): o PCM
+    // só entra depois de parar o DecodeWorker e descartar o que ele tinha na fila,
+    // então o ring SPSC nunca tem dois produtores
+    void testCodecSwitch()
+    {
+        SimClock clock;
+        SourceMixer mixer(clock);
+        mixer.configure(SAMPLE_RATE, CHANNELS);
+        EXPECT(mixer.withSource(SourceMixer::DEFAULT_SOURCE, [&](SourceMixer::Source &source)
+                                {
+            // Worker parado: a fila fica com o pacote até o PCM chegar
+            source.decodeWorker.configure(std::make_unique<ConstantDecoder>(), CHANNELS);
+            source.core.start();
+
+            auto opus = makeChunk(packet::CODEC_OPUS, 0);
+            EXPECT(source.submitEncoded(opus.data(), static_cast<int32_t>(opus.size())));
+            EXPECT(source.encodedPending);
+
+            auto pcm = makeChunk(packet::CODEC_PCM16, 0);
+            EXPECT(source.write(pcm.data(), static_cast<int32_t>(pcm.size())));
+            EXPECT(!source.encodedPending);
+            EXPECT(source.decodeWorker.drain() == 0);
+            EXPECT(source.core.getBufferedFrames() == CHUNK_FRAMES);
+
+            // De volta ao Opus: o worker decodifica normalmente
+            opus = makeChunk(packet::CODEC_OPUS, 1);
+            EXPECT(source.submitEncoded(opus.data(), static_cast<int32_t>(opus.size())));
+            EXPECT(source.decodeWorker.drain() == 1);
+            EXPECT(source.core.getBufferedFrames() == 2 * CHUNK_FRAMES); }));
+    }
+}
+
+int main()
+{
+    testMixKernel();
+    testMixing();
+    testSourceLimit();
+    testChurnWhileRendering();
+    testCodecSwitch();
+
+    return testcheck::finish();
+}
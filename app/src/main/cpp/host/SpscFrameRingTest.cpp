@@ -0,0 +1,130 @@
+// ✅ Testes do ring SPSC de frames (ctest)
+
+#include "TestCheck.h"
+#include "../SpscFrameRing.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    constexpr int32_t CHANNELS = 2;
+
+    // Frames numerados: o frame n tem n nos dois canais
+    std::vector<int16_t> frames(int32_t first, int32_t count)
+    {
+        std::vector<int16_t> samples(static_cast<size_t>(count) * CHANNELS);
+        for (int32_t i = 0; i < count; i++)
+            samples[i * CHANNELS] = samples[i * CHANNELS + 1] = static_cast<int16_t>(first + i);
+        return samples;
+    }
+
+    // Capacidade exata (não arredondada para potência de 2): memória = duração pedida
+    void testExactCapacity()
+    {
+        SpscFrameRing ring;
+        ring.allocate(1000, CHANNELS);
+        EXPECT(ring.capacityFrames() == 1000);
+
+        auto data = frames(0, 1200);
+        EXPECT(ring.write(data.data(), 1200) == 1000);
+        EXPECT(ring.availableToWrite() == 0);
+        EXPECT(ring.write(data.data(), 1) == 0);
+    }
+
+    // Leitura e escrita atravessando o fim do armazenamento várias vezes
+    void testWrapAround()
+    {
+        SpscFrameRing ring;
+        ring.allocate(300, CHANNELS);
+        std::vector<int16_t> out(128 * CHANNELS);
+        int32_t written = 0;
+        int32_t read = 0;
+        bool ordered = true;
+        for (int32_t round = 0; round < 50; round++)
+        {
+            auto data = frames(written, 128);
+            written += ring.write(data.data(), 128);
+            int32_t got = ring.read(out.data(), 100);
+            for (int32_t i = 0; i < got; i++)
+                ordered = ordered && out[i * CHANNELS] == static_cast<int16_t>(read + i);
+            read += got;
+        }
+        EXPECT(ordered);
+        EXPECT(ring.availableToRead() == written - read);
+    }
+
+    // peek/overwrite: o consumidor lê e reescreve adiante sem consumir
+    void testPeekOverwrite()
+    {
+        SpscFrameRing ring;
+        ring.allocate(100, CHANNELS);
+        std::vector<int16_t> out(100 * CHANNELS);
+        auto data = frames(0, 90);
+        ring.write(data.data(), 90);
+        ring.read(out.data(), 60);
+        data = frames(90, 60);
+        ring.write(data.data(), 60); // Índices 90..149: atravessa o fim
+
+        std::vector<int16_t> window(20 * CHANNELS);
+        EXPECT(ring.peek(30, window.data(), 20) == 20);
+        EXPECT(window[0] == 90 && window[19 * CHANNELS] == 109);
+        EXPECT(ring.availableToRead() == 90);
+
+        // Só até o fim do que foi publicado
+        EXPECT(ring.peek(80, window.data(), 20) == 10);
+        EXPECT(ring.peek(90, window.data(), 20) == 0);
+
+        auto replacement = frames(1000, 20);
+        EXPECT(ring.overwrite(30, replacement.data(), 20) == 20);
+        EXPECT(ring.overwrite(85, replacement.data(), 20) == 5);
+        ring.discard(30);
+        EXPECT(ring.read(out.data(), 20) == 20);
+        EXPECT(out[0] == 1000 && out[19 * CHANNELS + 1] == 1019);
+    }
+
+    // stage/commit: o consumidor só vê o lote depois do commit, num passo só
+    void testStageCommit()
+    {
+        SpscFrameRing ring;
+        ring.allocate(100, CHANNELS);
+        std::vector<int16_t> out(100 * CHANNELS);
+        auto first = frames(0, 30);
+        auto second = frames(30, 30);
+        EXPECT(ring.stage(first.data(), 30) == 30);
+        EXPECT(ring.stage(second.data(), 30) == 30);
+        EXPECT(ring.availableToRead() == 0);
+        EXPECT(ring.read(out.data(), 10) == 0);
+        EXPECT(ring.availableToWrite() == 40);
+        EXPECT(ring.writePosition() == 60);
+
+        // Sem espaço além do que já está em stage
+        auto rest = frames(60, 50);
+        EXPECT(ring.stage(rest.data(), 50) == 40);
+        EXPECT(ring.commit() == 100);
+        EXPECT(ring.commit() == 0);
+        EXPECT(ring.availableToRead() == 100);
+        EXPECT(ring.read(out.data(), 100) == 100);
+        EXPECT(out[0] == 0 && out[59 * CHANNELS] == 59 && out[99 * CHANNELS + 1] == 99);
+
+        // write() publica junto o que estiver em stage, na ordem
+        auto staged = frames(100, 10);
+        auto written = frames(110, 10);
+        ring.stage(staged.data(), 10);
+        EXPECT(ring.write(written.data(), 10) == 10);
+        EXPECT(ring.availableToRead() == 20);
+        EXPECT(ring.read(out.data(), 20) == 20);
+        EXPECT(out[0] == 100 && out[19 * CHANNELS] == 119);
+        EXPECT(ring.commit() == 0);
+    }
+}
+
+int main()
+{
+    testExactCapacity();
+    testWrapAround();
+    testPeekOverwrite();
+    testStageCommit();
+
+    return testcheck::finish();
+}
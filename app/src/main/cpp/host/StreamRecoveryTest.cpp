@@ -0,0 +1,111 @@
+// ✅ Testes da máquina de recuperação do stream (ctest)
+
+#include "TestCheck.h"
+#include "../StreamRecovery.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Espera (com limite) até a condição valer
+    template <typename Condition>
+    bool waitFor(Condition &&condition, int32_t timeoutMs = 5000)
+    {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition())
+        {
+            if (Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    void testBackoff()
+    {
+        EXPECT(StreamRecovery::backoffMs(1) == StreamRecovery::INITIAL_BACKOFF_MS);
+        EXPECT(StreamRecovery::backoffMs(2) == 2 * StreamRecovery::INITIAL_BACKOFF_MS);
+        EXPECT(StreamRecovery::backoffMs(3) == 4 * StreamRecovery::INITIAL_BACKOFF_MS);
+        EXPECT(StreamRecovery::backoffMs(50) == StreamRecovery::MAX_BACKOFF_MS);
+    }
+
+    // Falha duas vezes (dispositivo novo ainda não pronto) e depois abre
+    void testRetryUntilOpen()
+    {
+        std::atomic<int32_t> calls{0};
+        StreamRecovery recovery([&] { return ++calls > 2; });
+        recovery.start();
+
+        auto begin = Clock::now();
+        recovery.request();
+        EXPECT(waitFor([&] { return recovery.getRecoveries() == 1; }));
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count();
+
+        EXPECT(calls == 3);
+        EXPECT(recovery.getFailedAttempts() == 2);
+        EXPECT(recovery.state() == StreamRecovery::State::Idle);
+        // 50 + 100ms de espera entre as tentativas
+        EXPECT(elapsedMs >= StreamRecovery::backoffMs(1) + StreamRecovery::backoffMs(2));
+
+        // Outra troca de rota: nova recuperação
+        recovery.request();
+        EXPECT(waitFor([&] { return recovery.getRecoveries() == 2; }));
+        recovery.stop();
+    }
+
+    // stop() não espera o backoff terminar
+    void testStopDuringBackoff()
+    {
+        StreamRecovery recovery([] { return false; });
+        recovery.start();
+        recovery.request();
+        EXPECT(waitFor([&] { return recovery.getFailedAttempts() >= 5; }, 10000));
+        EXPECT(recovery.state() == StreamRecovery::State::Backoff ||
+               recovery.state() == StreamRecovery::State::Reopening);
+
+        auto begin = Clock::now();
+        recovery.stop();
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count();
+        EXPECT(elapsedMs < StreamRecovery::backoffMs(5));
+        EXPECT(recovery.state() == StreamRecovery::State::Idle);
+        EXPECT(recovery.getRecoveries() == 0);
+    }
+
+    // Pedido novo durante o backoff tenta de novo na hora
+    void testRequestCutsBackoff()
+    {
+        std::atomic<int32_t> calls{0};
+        std::atomic<bool> deviceReady{false};
+        StreamRecovery recovery([&]
+                                {
+            calls++;
+            return deviceReady.load(); });
+        recovery.start();
+        recovery.request();
+        EXPECT(waitFor([&] { return recovery.getFailedAttempts() >= 5; }, 10000));
+
+        // Agora a espera é de 800ms; o dispositivo aparece e o Oboe avisa de novo
+        deviceReady = true;
+        auto begin = Clock::now();
+        recovery.request();
+        EXPECT(waitFor([&] { return recovery.getRecoveries() == 1; }));
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - begin).count();
+        EXPECT(elapsedMs < StreamRecovery::backoffMs(5) / 2);
+        recovery.stop();
+    }
+}
+
+int main()
+{
+    testBackoff();
+    testRetryUntilOpen();
+    testStopDuringBackoff();
+    testRequestCutsBackoff();
+
+    return testcheck::finish();
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdio>
+
+// ✅ Verificações dos testes de host (ctest)
+//
+// EXPECT conta a falha e segue (o teste mostra todas de uma vez); main() termina
+// com `return testcheck::finish();`, que imprime "OK" ou o total de falhas.
+namespace testcheck
+{
+    inline int failures = 0;
+
+    inline int finish()
+    {
+        if (failures > 0)
+        {
+            std::fprintf(stderr, "%d verificação(ões) falharam\n", failures);
+            return 1;
+        }
+        std::printf("OK\n");
+        return 0;
+    }
+}
+
+#define EXPECT(cond)                                                                 \
+    do                                                                               \
+    {                                                                                \
+        if (!(cond))                                                                 \
+        {                                                                            \
+            std::fprintf(stderr, "  FALHOU %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+            testcheck::failures++;                                                   \
+        }                                                                            \
+    } while (0)
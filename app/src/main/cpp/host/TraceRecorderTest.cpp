@@ -0,0 +1,183 @@
+// ✅ Testes da gravação e do replay de traces (ctest)
+//
+// Uso: trace-recorder-test <diretório dos traces de referência>
+
+#include "TestCheck.h"
+#include "FakeAudioStream.h"
+#include "PlayerSimulation.h"
+#include "../PacketFormat.h"
+#include "../TraceRecorder.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+    std::string tempPath(const char *name)
+    {
+        const char *dir = std::getenv("TMPDIR");
+        return std::string(dir != nullptr ? dir : "/tmp") + "/" + name;
+    }
+
+    // Registros com tempo fora de ordem (threads diferentes) e valores grandes
+    void testEncoding()
+    {
+        std::vector<trace::Event> events = {
+            {1000, trace::EVENT_CALLBACK, 192},
+            {900, trace::EVENT_ARRIVAL, 960},
+            {5000000000LL, trace::EVENT_RESTART, 44100},
+            {5000000000LL, trace::EVENT_BURST, 1u << 30},
+        };
+        uint8_t bytes[4 * trace::MAX_RECORD_BYTES];
+        size_t length = 0;
+        int64_t timeUs = 0;
+        for (const auto &event : events)
+        {
+            length += trace::encode(bytes + length, event, timeUs);
+            timeUs = event.timeUs;
+        }
+        EXPECT(length < 4 * trace::MAX_RECORD_BYTES);
+
+        const uint8_t *p = bytes;
+        timeUs = 0;
+        for (const auto &expected : events)
+        {
+            trace::Event event;
+            EXPECT(trace::decode(p, bytes + length, timeUs, event));
+            EXPECT(event.timeUs == expected.timeUs && event.type == expected.type && event.value == expected.value);
+            timeUs = event.timeUs;
+        }
+        trace::Event extra;
+        EXPECT(!trace::decode(p, bytes + length, timeUs, extra));
+
+        // Registro cortado no meio
+        p = bytes;
+        EXPECT(!trace::decode(p, bytes + 2, 0, extra));
+    }
+
+    void testRecorder()
+    {
+        SimClock clock;
+        TraceRecorder recorder(clock);
+        recorder.recordCallback(192); // Antes do start: ignorado
+
+        trace::Header header;
+        header.sampleRate = 48000;
+        header.deviceSampleRate = 44100;
+        header.framesPerBurst = 96;
+        std::string path = tempPath("trace-recorder-test.shtr");
+        EXPECT(recorder.start(path.c_str(), header));
+
+        std::vector<uint8_t> raw(960 * 2 * sizeof(int16_t));
+        std::vector<uint8_t> opus(packet::HEADER_BYTES + 80);
+        packet::Header packetHeader;
+        packetHeader.codec = packet::CODEC_OPUS;
+        packetHeader.frames = 480;
+        packet::write(opus.data(), packetHeader);
+
+        for (int32_t i = 0; i < 100; i++)
+        {
+            clock.set(i * 2000000LL);
+            recorder.recordCallback(96);
+            if (i % 10 == 0)
+                recorder.recordPacket(raw.data(), static_cast<int32_t>(raw.size()));
+        }
+        recorder.recordPacket(opus.data(), static_cast<int32_t>(opus.size()));
+        recorder.recordRestart(48000, 240);
+        recorder.stop();
+        EXPECT(recorder.getEvents() == 100 + 10 + 1 + 2);
+        EXPECT(recorder.getDroppedEvents() == 0);
+
+        trace::Header read;
+        std::vector<trace::Event> events;
+        EXPECT(trace::readFile(path.c_str(), read, events));
+        EXPECT(read.sampleRate == 48000 && read.deviceSampleRate == 44100 && read.framesPerBurst == 96);
+        EXPECT(events.size() == 113);
+        if (events.size() == 113)
+        {
+            EXPECT(events[0].type == trace::EVENT_CALLBACK && events[0].value == 96);
+            EXPECT(events[1].type == trace::EVENT_ARRIVAL && events[1].value == 960);
+            EXPECT(events[110].type == trace::EVENT_ARRIVAL && events[110].value == 480);
+            EXPECT(events[111].type == trace::EVENT_RESTART && events[111].value == 48000);
+            EXPECT(events[112].type == trace::EVENT_BURST && events[112].value == 240);
+            EXPECT(events[112].timeUs == 99 * 2000);
+        }
+        std::remove(path.c_str());
+    }
+
+    // O replay de um trace gerado da simulação dá o mesmo resultado que a simulação
+    void testReplayMatchesSimulation()
+    {
+        NetworkTraceConfig network;
+        network.durationS = 20.0;
+        network.jitterMs = 30.0;
+        network.spikeProbability = 0.01;
+        network.spikeMs = 80.0;
+        network.seed = 7;
+        SimulationConfig config;
+        config.durationS = network.durationS;
+        auto arrivals = generateNetworkTrace(network);
+
+        SimulationResult simulated = runSimulation(config, arrivals);
+        trace::Header header;
+        SimulationResult replayed = replayTrace(header, traceFromNetwork(config, arrivals), config);
+        std::printf("simulação UR %d, %d callbacks | replay UR %d, %d callbacks\n", simulated.underruns,
+                    simulated.callbacks, replayed.underruns, replayed.callbacks);
+        EXPECT(replayed.callbacks == simulated.callbacks);
+        EXPECT(replayed.underruns == simulated.underruns);
+        EXPECT(replayed.droppedFrames == simulated.droppedFrames);
+        EXPECT(std::abs(replayed.meanBufferedMs - simulated.meanBufferedMs) < 2.0);
+    }
+
+    // Traces de referência do repositório: legíveis e com o comportamento esperado
+    void testReferenceTraces(const std::string &directory)
+    {
+        SimulationConfig config;
+        auto load = [&](const char *name, SimulationResult &result)
+        {
+            trace::Header header;
+            std::vector<trace::Event> events;
+            bool ok = trace::readFile((directory + "/" + name).c_str(), header, events);
+            EXPECT(ok);
+            if (ok)
+                result = replayTrace(header, events, config);
+            std::printf("%-20s UR %d (pós-warmup %d) | descartados %lld | buffer médio %.1fms\n", name,
+                        result.underruns, result.underrunsAfterWarmup,
+                        static_cast<long long>(result.droppedFrames), result.meanBufferedMs);
+            return ok;
+        };
+
+        SimulationResult good;
+        if (load("wifi-good.shtr", good))
+        {
+            EXPECT(good.underrunsAfterWarmup == 0);
+            EXPECT(good.droppedFrames == 0);
+        }
+
+        SimulationResult congested;
+        if (load("wifi-congested.shtr", congested))
+        {
+            EXPECT(congested.callbacks > 0);
+            EXPECT(congested.meanBufferedMs > good.meanBufferedMs);
+        }
+
+        SimulationResult route;
+        if (load("bt-route-change.shtr", route))
+        {
+            EXPECT(route.resumeAfterRouteMs == 0.0); // Buffer atravessa a reabertura
+            EXPECT(route.underrunsAfterWarmup == 0);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    testEncoding();
+    testRecorder();
+    testReplayMatchesSimulation();
+    if (argc > 1)
+        testReferenceTraces(argv[1]);
+
+    return testcheck::finish();
+}
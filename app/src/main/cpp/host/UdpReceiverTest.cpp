@@ -0,0 +1,222 @@
+// ✅ Testes da recepção UDP nativa contra um sender local (ctest)
+
+#include "TestCheck.h"
+#include "../PacketFormat.h"
+#include "../UdpReceiver.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    constexpr int32_t SAMPLE_RATE = 48000;
+    constexpr int32_t CHANNELS = 2;
+    constexpr int32_t CHUNK_FRAMES = 960; // 20ms
+
+    template <typename Condition>
+    bool waitFor(Condition &&condition, int32_t timeoutMs = 5000)
+    {
+        auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (!condition())
+        {
+            if (Clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+    // Sender local: um socket UDP próprio (porta de origem = identidade do sender)
+    struct Sender
+    {
+        int fd = socket(AF_INET, SOCK_DGRAM, 0);
+        sockaddr_in target{};
+        uint32_t sequence = 0;
+
+        explicit Sender(int32_t port)
+        {
+            target.sin_family = AF_INET;
+            target.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            target.sin_port = htons(static_cast<uint16_t>(port));
+        }
+        ~Sender() { close(fd); }
+
+        void sendRaw(const std::vector<uint8_t> &bytes)
+        {
+            sendto(fd, bytes.data(), bytes.size(), 0, reinterpret_cast<const sockaddr *>(&target), sizeof(target));
+        }
+
+        void sendPcm(int16_t value, uint8_t codec = packet::CODEC_PCM16)
+        {
+            std::vector<uint8_t> bytes(packet::HEADER_BYTES + CHUNK_FRAMES * CHANNELS * sizeof(int16_t));
+            packet::Header header;
+            header.codec = codec;
+            header.sequence = sequence++;
+            header.frames = CHUNK_FRAMES;
+            packet::write(bytes.data(), header);
+            auto *samples = reinterpret_cast<int16_t *>(bytes.data() + packet::HEADER_BYTES);
+            std::fill(samples, samples + CHUNK_FRAMES * CHANNELS, value);
+            sendRaw(bytes);
+        }
+    };
+
+    struct Rig
+    {
+        SourceMixer mixer;
+        UdpReceiver receiver;
+        int32_t port = -1;
+
+        explicit Rig(int32_t peerIdleMs = UdpReceiver::PEER_IDLE_MS) : receiver(mixer, peerIdleMs)
+        {
+            mixer.configure(SAMPLE_RATE, CHANNELS);
+            mixer.start();
+            port = receiver.start(0);
+        }
+
+        int32_t bufferedFrames(int32_t sourceId)
+        {
+            int32_t frames = -1;
+            mixer.withSource(sourceId, [&](SourceMixer::Source &source)
+                             { frames = source.core.getBufferedFrames(); });
+            return frames;
+        }
+    };
+
+    void testReceivesIntoDefaultSource()
+    {
+        Rig rig;
+        EXPECT(rig.port > 0);
+        EXPECT(rig.receiver.getPort() == rig.port);
+
+        Sender sender(rig.port);
+        for (int32_t i = 0; i < 10; i++)
+            sender.sendPcm(1000);
+        EXPECT(waitFor([&] { return rig.receiver.getDatagrams() == 10; }));
+        EXPECT(rig.receiver.getPeerCount() == 1);
+        EXPECT(rig.mixer.getSourceCount() == 1);
+        EXPECT(rig.bufferedFrames(SourceMixer::DEFAULT_SOURCE) >= 9 * CHUNK_FRAMES);
+
+        // Sem SHB1 (PCM cru) ou codec desconhecido: recusados
+        sender.sendRaw(std::vector<uint8_t>(CHUNK_FRAMES * CHANNELS * sizeof(int16_t), 0));
+        sender.sendPcm(1000, 7);
+        EXPECT(waitFor([&] { return rig.receiver.getRejected() == 2; }));
+        EXPECT(rig.receiver.getDatagrams() == 10);
+
+        rig.receiver.stop();
+        EXPECT(rig.receiver.getPort() == -1);
+        EXPECT(rig.receiver.getPeerCount() == 0);
+    }
+
+    // Cada endereço de origem é um sender com fonte própria no mixer
+    void testSendersGetOwnSources()
+    {
+        Rig rig;
+        Sender first(rig.port);
+        Sender second(rig.port);
+        for (int32_t i = 0; i < 5; i++)
+        {
+            first.sendPcm(1000);
+            second.sendPcm(2000);
+        }
+        EXPECT(waitFor([&] { return rig.receiver.getDatagrams() == 10; }));
+        EXPECT(rig.receiver.getPeerCount() == 2);
+        EXPECT(rig.mixer.getSourceCount() == 2);
+        EXPECT(rig.bufferedFrames(UdpReceiver::FIRST_PEER_SOURCE) >= 4 * CHUNK_FRAMES);
+
+        // stop() tira do mixer as fontes que criou; a padrão fica
+        rig.receiver.stop();
+        EXPECT(rig.mixer.getSourceCount() == 1);
+    }
+
+    void testIdleSenderReleasesSource()
+    {
+        Rig rig(200);
+        Sender first(rig.port);
+        Sender second(rig.port);
+        first.sendPcm(1000);
+        second.sendPcm(2000);
+        EXPECT(waitFor([&] { return rig.receiver.getPeerCount() == 2; }));
+        EXPECT(rig.mixer.getSourceCount() == 2);
+
+        EXPECT(waitFor([&] { return rig.receiver.getPeerCount() == 0; }));
+        EXPECT(rig.mixer.getSourceCount() == 1);
+
+        // Volta a mandar: ganha fonte de novo
+        second.sendPcm(2000);
+        EXPECT(waitFor([&] { return rig.receiver.getPeerCount() == 1; }));
+    }
+
+    // Mixer cheio: senders a mais são descartados, sem derrubar os outros
+    void testMixerFull()
+    {
+        Rig rig;
+        std::vector<std::unique_ptr<Sender>> senders;
+        for (int32_t i = 0; i <= SourceMixer::MAX_SOURCES; i++)
+        {
+            senders.push_back(std::make_unique<Sender>(rig.port));
+            senders.back()->sendPcm(100);
+        }
+        EXPECT(waitFor([&] { return rig.receiver.getDatagrams() + rig.receiver.getDropped() ==
+                                    SourceMixer::MAX_SOURCES + 1; }));
+        EXPECT(rig.receiver.getPeerCount() == SourceMixer::MAX_SOURCES);
+        EXPECT(rig.receiver.getDropped() == 1);
+    }
+
+    // Economia: um chunk a cada 20ms, lidos em lotes de ~100ms sem perder nenhum
+    void testBatchInterval()
+    {
+        auto wakeupsPerSecond = [](int32_t intervalMs)
+        {
+            Rig rig;
+            rig.receiver.setBatchIntervalMs(intervalMs);
+            Sender sender(rig.port);
+            auto next = Clock::now();
+            for (int32_t i = 0; i < 125; i++) // 2,5s
+            {
+                sender.sendPcm(1000);
+                next += std::chrono::milliseconds(20);
+                std::this_thread::sleep_until(next);
+            }
+            EXPECT(waitFor([&] { return rig.receiver.getDatagrams() == 125; }));
+            EXPECT(rig.receiver.getDropped() == 0);
+            return rig.receiver.getWakeupsPerSecond();
+        };
+
+        int64_t immediate = wakeupsPerSecond(0);
+        int64_t batched = wakeupsPerSecond(100);
+        std::printf("despertares UDP: %lld/s imediato | %lld/s em lotes de 100ms\n",
+                    static_cast<long long>(immediate), static_cast<long long>(batched));
+        EXPECT(immediate >= 30);
+        EXPECT(batched > 0 && batched <= 12);
+    }
+
+    void testPortInUse()
+    {
+        Rig rig;
+        SourceMixer other;
+        UdpReceiver clash(other);
+        EXPECT(clash.start(rig.port) == -1);
+        EXPECT(!clash.isRunning());
+    }
+}
+
+int main()
+{
+    testReceivesIntoDefaultSource();
+    testSendersGetOwnSources();
+    testIdleSenderReleasesSource();
+    testMixerFull();
+    testBatchInterval();
+    testPortInUse();
+
+    return testcheck::finish();
+}
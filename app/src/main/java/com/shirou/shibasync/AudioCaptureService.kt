@@ -5,6 +5,7 @@ import android.content.Intent
 import android.media.AudioFormat
 import android.media.AudioPlaybackCaptureConfiguration
 import android.media.AudioRecord
+import android.media.AudioTimestamp
 import android.media.projection.MediaProjection
 import android.media.projection.MediaProjectionManager
 import android.os.Binder
@@ -14,6 +15,8 @@ import android.util.Log
 import androidx.annotation.RequiresApi
 import io.socket.client.Socket
 import kotlinx.coroutines.*
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
 
 @RequiresApi(Build.VERSION_CODES.Q)
 class AudioCaptureService : MediaProjectionService() {
@@ -23,6 +26,7 @@ class AudioCaptureService : MediaProjectionService() {
     private val serviceScope = CoroutineScope(Dispatchers.IO + SupervisorJob())
     private var mediaProjection: MediaProjection? = null
     private var captureJob: Job? = null
+    private var clockSync: ClockSync? = null
     private var isPrepared = false // Nova flag de estado
 
     inner class AudioCaptureBinder : Binder() {
@@ -69,8 +73,10 @@ class AudioCaptureService : MediaProjectionService() {
         }
     }
 
+    // `useOpus` só vale se todos os receptores tiverem o decodificador
+    // (OboeAudioPlayer.isEncodedSupported); senão o padrão PCM16 é o seguro.
     @SuppressLint("MissingPermission")
-    fun startCapture(socket: Socket?, matchingUid: Int? = null): Boolean {
+    fun startCapture(socket: Socket?, matchingUid: Int? = null, useOpus: Boolean = false): Boolean {
         if (!isPrepared || mediaProjection == null) {
             Log.e("AudioCaptureService", "Serviço não está pronto, chame prepareToCapture primeiro.")
             return false
@@ -131,81 +137,97 @@ class AudioCaptureService : MediaProjectionService() {
 
             audioRecord?.startRecording()
 
+            // ✅ Relógio do servidor para os timestamps de captura
+            clockSync?.stop()
+            val sync = ClockSync(socket).also { it.start(serviceScope) }
+            clockSync = sync
+
             captureJob = serviceScope.launch {
-                // ✅ CHUNK DE 20ms PRECISO: 48000Hz * 0.02s * 2ch * 2bytes = 3840 bytes
+                // ✅ CHUNK DE 20ms PRECISO: 48000Hz * 0.02s = 960 frames
                 val bytesPerSample = 2
                 val channels = 2
-                val targetChunkSize = (chosenSampleRate * 0.02 * channels * bytesPerSample).toInt()
+                val frameBytes = channels * bytesPerSample
+                val chunkFrames = chosenSampleRate / 50
+                
+                // ✅ Acumular, medir, codificar e empacotar no nativo; o AudioRecord lê direto
+                // num ByteBuffer direto, sem ByteArray por chunk nem varredura em Kotlin
+                val encoder = NativeCaptureEncoder()
+                if (!encoder.create(chosenSampleRate, channels, chunkFrames, useOpus, adaptive = true)) {
+                    Log.e("AudioCaptureService", "❌ Falha ao criar o pipeline de captura nativo")
+                    return@launch
+                }
+                encoder.setSilenceDetection(true)
                 
-                // ✅ USAR BUFFER MENOR PARA CONTROLE PRECISO
-                val readBufferSize = targetChunkSize / 4  // 960 bytes para leitura frequente
-                val readBuffer = ByteArray(readBufferSize)
-                val accBuffer = ByteArray(targetChunkSize)
-                var accPos = 0
+                // ✅ Relatórios dos ouvintes, repassados pelo servidor: (relatório, id do ouvinte)
+                socket.on("receiver-feedback") { args ->
+                    val report = args.getOrNull(0) as? ByteArray ?: return@on
+                    val listenerId = args.getOrNull(1)?.toString()?.hashCode() ?: 0
+                    encoder.onFeedback(listenerId, report)
+                }
+                val readBufferSize = chunkFrames * frameBytes / 4  // 960 bytes para leitura frequente
+                val readBuffer = ByteBuffer.allocateDirect(readBufferSize).order(ByteOrder.LITTLE_ENDIAN)
                 
                 var chunksEmitted = 0
+                var framesCaptured = 0L // Frames lidos do AudioRecord desde o startRecording()
+                val recordTimestamp = AudioTimestamp()
                 var lastEmitTime = System.currentTimeMillis()
                 var emptyReads = 0
                 var totalReads = 0
 
-                Log.d("AudioCaptureService", "✅ Captura iniciada: ${chosenSampleRate}Hz, chunk=${targetChunkSize}bytes, readBuffer=${readBufferSize}bytes")
-                Log.d("AudioCaptureService", "🔌 Socket conectado: ${socket.connected()}")
+                // Envia tudo que o pipeline deixou pronto
+                fun emitReady() {
+                    while (true) {
+                        val packet = encoder.poll() ?: break
+                        socket.emit("audio-chunk", packet)
+                        chunksEmitted++
+                        
+                        // Log a cada 50 chunks
+                        if (chunksEmitted % 50 == 0) {
+                            val now = System.currentTimeMillis()
+                            val interval = (now - lastEmitTime) / 50.0
+                            Log.d("AudioCaptureService", "📦 Chunk #$chunksEmitted | Interval: ${String.format("%.1f", interval)}ms | Peak: ${String.format("%.3f", encoder.peak)} | RMS: ${String.format("%.3f", encoder.rms)} | Chunk: ${encoder.chunkFrames} frames @ ${encoder.bitrate}bps | EmptyReads: $emptyReads/$totalReads")
+                            lastEmitTime = now
+                            emptyReads = 0
+                            totalReads = 0
+                        }
+                        
+                        // Log primeiros chunks com detalhes
+                        if (chunksEmitted < 3) {
+                            Log.d("AudioCaptureService", "🎵 Chunk #$chunksEmitted | Size: ${packet.size} | Peak: ${encoder.peak} | Socket: ${socket.connected()}")
+                        }
+                    }
+                }
 
-                while (isActive) {
-                    val readResult = audioRecord?.read(readBuffer, 0, readBuffer.size) ?: 0
-                    totalReads++
-                    
-                    if (readResult > 0) {
-                        var offset = 0
-                        while (offset < readResult) {
-                            val toCopy = minOf(readResult - offset, accBuffer.size - accPos)
-                            System.arraycopy(readBuffer, offset, accBuffer, accPos, toCopy)
-                            accPos += toCopy
-                            offset += toCopy
+                Log.d("AudioCaptureService", "✅ Captura iniciada: ${chosenSampleRate}Hz, chunk=${chunkFrames} frames, codec=${encoder.codec}, readBuffer=${readBufferSize}bytes")
+                Log.d("AudioCaptureService", "🔌 Socket conectado: ${socket.connected()}")
 
-                            if (accPos >= accBuffer.size) {
-                                // ✅ EMIT CHUNK E RASTREAR TIMING
-                                val now = System.currentTimeMillis()
-                                socket.emit("audio-chunk", accBuffer.copyOf())
-                                chunksEmitted++
-                                
-                                // ✅ VERIFICAR AMPLITUDE DO ÁUDIO
-                                var maxSample = 0
-                                for (i in 0 until accBuffer.size step 2) {
-                                    val sample = ((accBuffer[i].toInt() and 0xFF) or 
-                                                 ((accBuffer[i+1].toInt() and 0xFF) shl 8)).toShort().toInt()
-                                    maxSample = maxOf(maxSample, Math.abs(sample))
-                                }
-                                
-                                // Log a cada 50 chunks
-                                if (chunksEmitted % 50 == 0) {
-                                    val interval = (now - lastEmitTime) / 50.0
-                                    Log.d("AudioCaptureService", "📦 Chunk #$chunksEmitted | Interval: ${String.format("%.1f", interval)}ms | MaxAmp: $maxSample | EmptyReads: $emptyReads/$totalReads")
-                                    lastEmitTime = now
-                                    emptyReads = 0
-                                    totalReads = 0
-                                }
-                                
-                                // Log primeiros chunks com detalhes
-                                if (chunksEmitted < 3) {
-                                    Log.d("AudioCaptureService", "🎵 Chunk #$chunksEmitted | Size: ${accBuffer.size} | MaxAmp: $maxSample | Socket: ${socket.connected()}")
-                                }
-                                
-                                accPos = 0
+                try {
+                    while (isActive) {
+                        val readResult = audioRecord?.read(readBuffer, readBufferSize) ?: 0
+                        totalReads++
+                        
+                        if (readResult > 0) {
+                            // ✅ Timestamp do 1º frame desta leitura; o nativo extrapola para cada chunk
+                            val framesRead = readResult / frameBytes
+                            val timestampUs = captureTimeUs(sync, recordTimestamp, framesCaptured, framesCaptured + framesRead, chosenSampleRate)
+                            framesCaptured += framesRead
+                            encoder.write(readBuffer, readResult, timestampUs)
+                            emitReady() // Também o que o pacing segurou na leitura anterior
+                        } else {
+                            // slight delay to avoid busy loop if read returns 0
+                            emptyReads++
+                            if (totalReads % 500 == 0) {
+                                Log.w("AudioCaptureService", "⚠️ AudioRecord retornando 0 bytes ($emptyReads/$totalReads leituras)")
                             }
+                            delay(1) // ✅ REDUZIDO PARA MENOS LATÊNCIA
                         }
-                    } else {
-                        // slight delay to avoid busy loop if read returns 0
-                        emptyReads++
-                        if (totalReads % 500 == 0) {
-                            Log.w("AudioCaptureService", "⚠️ AudioRecord retornando 0 bytes ($emptyReads/$totalReads leituras)")
-                        }
-                        delay(1) // ✅ REDUZIDO PARA MENOS LATÊNCIA
                     }
-                }
-                // If there's leftover data when stopping, emit it
-                if (accPos > 0) {
-                    socket.emit("audio-chunk", accBuffer.copyOfRange(0, accPos))
+                } finally {
+                    socket.off("receiver-feedback")
+                    // If there's leftover data when stopping, emit it
+                    encoder.flush()
+                    emitReady()
+                    encoder.destroy()
                 }
             }
             Log.d("AudioCaptureService", "Captura de áudio iniciada com sucesso.")
@@ -216,11 +238,33 @@ class AudioCaptureService : MediaProjectionService() {
         }
     }
 
+    // ✅ Instante de captura (relógio do servidor) do frame `framePosition` do AudioRecord.
+    // null enquanto o ClockSync não convergiu: o chunk vai sem timestamp.
+    private fun captureTimeUs(
+        sync: ClockSync,
+        timestamp: AudioTimestamp,
+        framePosition: Long,
+        framesRead: Long,
+        sampleRate: Int
+    ): Long? {
+        if (!sync.isSynced) return null
+        val record = audioRecord ?: return null
+        val localUs = if (record.getTimestamp(timestamp, AudioTimestamp.TIMEBASE_MONOTONIC) == AudioRecord.SUCCESS) {
+            timestamp.nanoTime / 1000 + (framePosition - timestamp.framePosition) * 1_000_000L / sampleRate
+        } else {
+            // Sem timestamp do HAL: aproximar pelo instante da leitura do último frame
+            ClockSync.localNowUs() - (framesRead - framePosition) * 1_000_000L / sampleRate
+        }
+        return sync.toServerUs(localUs)
+    }
+
     override fun stopCapture() {
         // Stop only the capture-related resources so the service and MediaProjection remain active.
         // This allows the app to stay connected to the server and resume capture quickly.
         captureJob?.cancel()
         captureJob = null
+        clockSync?.stop()
+        clockSync = null
         try {
             audioRecord?.stop()
         } catch (_: Throwable) {
@@ -255,6 +299,8 @@ class AudioCaptureService : MediaProjectionService() {
         try {
             captureJob?.cancel()
             captureJob = null
+            clockSync?.stop()
+            clockSync = null
             try { audioRecord?.stop() } catch (_: Throwable) {}
             audioRecord?.release()
             audioRecord = null
@@ -0,0 +1,78 @@
+package com.shirou.shibasync
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Chunk de áudio com cabeçalho binário "SHB1" (24 bytes, little-endian) na frente do PCM16.
+ *
+ * O cabeçalho leva a sequência do sender e o instante de captura do primeiro frame no
+ * relógio do servidor ([ClockSync]), que os receptores usam para tocar cada frame no
+ * mesmo instante. Precisa bater com PacketFormat.h no lado nativo. Chunks sem o magic
+ * continuam sendo PCM16 cru (senders antigos).
+ */
+data class AudioChunk(
+    val sequence: Int,
+    val captureTimeUs: Long?, // null = sender ainda sem relógio sincronizado
+    val frames: Int
+) {
+    companion object {
+        const val HEADER_BYTES = 24
+        const val VERSION = 1
+        const val CODEC_PCM16 = 0
+        const val CODEC_OPUS = 1 // Decodificado no nativo (DecodeWorker)
+        const val FLAG_HAS_TIMESTAMP = 1
+        const val FLAG_SILENCE = 2 // DTX: payload = frames (u32) + nível RMS (u16), sem áudio
+
+        fun hasHeader(data: ByteArray): Boolean =
+            data.size >= HEADER_BYTES &&
+                data[0] == 'S'.code.toByte() && data[1] == 'H'.code.toByte() &&
+                data[2] == 'B'.code.toByte() && data[3] == '1'.code.toByte()
+
+        // Codec do payload entre position e limit (PCM16 para chunks sem cabeçalho)
+        fun codec(buffer: ByteBuffer): Int {
+            val p = buffer.position()
+            if (buffer.remaining() < HEADER_BYTES ||
+                buffer.get(p) != 'S'.code.toByte() || buffer.get(p + 1) != 'H'.code.toByte() ||
+                buffer.get(p + 2) != 'B'.code.toByte() || buffer.get(p + 3) != '1'.code.toByte()
+            ) return CODEC_PCM16
+            return buffer.get(p + 5).toInt() and 0xFF
+        }
+
+        fun codec(data: ByteArray): Int = if (hasHeader(data)) data[5].toInt() and 0xFF else CODEC_PCM16
+
+        // Marcador de silêncio: mesmo codec/sequência do sender, decidido pelo nativo
+        fun isSilence(data: ByteArray): Boolean =
+            hasHeader(data) && ((data[6].toInt() and 0xFF) or ((data[7].toInt() and 0xFF) shl 8)) and FLAG_SILENCE != 0
+
+        // Offset do PCM dentro do chunk (0 para PCM cru)
+        fun payloadOffset(data: ByteArray): Int = if (hasHeader(data)) HEADER_BYTES else 0
+
+        fun parse(data: ByteArray): AudioChunk? {
+            if (!hasHeader(data)) return null
+            val buffer = ByteBuffer.wrap(data).order(ByteOrder.LITTLE_ENDIAN)
+            val flags = buffer.getShort(6).toInt() and 0xFFFF
+            return AudioChunk(
+                sequence = buffer.getInt(8),
+                captureTimeUs = if (flags and FLAG_HAS_TIMESTAMP != 0) buffer.getLong(12) else null,
+                frames = buffer.getInt(20)
+            )
+        }
+    }
+
+    // Cabeçalho + cópia de pcm[0 until pcmLength]
+    fun encode(pcm: ByteArray, pcmLength: Int = pcm.size): ByteArray {
+        val out = ByteArray(HEADER_BYTES + pcmLength)
+        ByteBuffer.wrap(out).order(ByteOrder.LITTLE_ENDIAN).apply {
+            put('S'.code.toByte()).put('H'.code.toByte()).put('B'.code.toByte()).put('1'.code.toByte())
+            put(VERSION.toByte())
+            put(CODEC_PCM16.toByte())
+            putShort((if (captureTimeUs != null) FLAG_HAS_TIMESTAMP else 0).toShort())
+            putInt(sequence)
+            putLong(captureTimeUs ?: 0L)
+            putInt(frames)
+        }
+        System.arraycopy(pcm, 0, out, HEADER_BYTES, pcmLength)
+        return out
+    }
+}
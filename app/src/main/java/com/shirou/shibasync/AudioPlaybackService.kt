@@ -5,13 +5,17 @@ import android.app.NotificationChannel
 import android.app.NotificationManager
 import android.app.Service
 import android.app.PendingIntent
+import android.content.BroadcastReceiver
+import android.content.Context
 import android.content.Intent
+import android.content.IntentFilter
 import android.media.AudioAttributes
 import android.media.AudioManager
 import android.media.AudioFocusRequest
 import android.os.Binder
 import android.os.Build
 import android.os.IBinder
+import android.os.PowerManager
 import android.support.v4.media.MediaMetadataCompat
 import android.support.v4.media.session.MediaSessionCompat
 import android.support.v4.media.session.PlaybackStateCompat
@@ -29,6 +33,9 @@ import io.socket.client.Socket
 import org.json.JSONArray
 import org.json.JSONObject
 import kotlinx.coroutines.*
+import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.sync.withLock
+import java.nio.ByteBuffer
 import java.util.concurrent.atomic.AtomicBoolean
 import java.util.concurrent.atomic.AtomicLong
 
@@ -36,6 +43,11 @@ enum class ConnectionState {
     IDLE, CONNECTING, CONNECTED, DISCONNECTED, FAILED
 }
 
+// ✅ Modo de energia do player: AUTO economiza só com a tela apagada
+enum class PowerMode {
+    LOW_LATENCY, POWER_SAVING, AUTO
+}
+
 @SuppressLint("MissingPermission")
 class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener {
     
@@ -53,6 +65,7 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
     val isPlayingLive = MutableLiveData(false)
     val activeSenderCount = MutableLiveData(0)
     val activeListenerCount = MutableLiveData(0)
+    val powerModeLive = MutableLiveData(PowerMode.AUTO) // Modo escolhido (sobrevive à tela do receptor)
     
     // Estado
     private val isPlaying = AtomicBoolean(false)
@@ -62,15 +75,99 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
     private var lastChunkTime = System.currentTimeMillis()
     private var chunkIntervals = mutableListOf<Long>()
 
+    // Verbosidade do log nativo do callback; vale também para os players recriados
+    @Volatile
+    private var nativeLogLevel = OboeAudioPlayer.LOG_INFO
+
+    // ✅ Modo de energia escolhido e o efetivo (AUTO segue a tela); valem para os players recriados
+    @Volatile
+    private var powerMode = PowerMode.AUTO
+    @Volatile
+    private var screenOn = true
+    @Volatile
+    private var powerSavingActive = false
+    // ✅ Troca de modo (reabre o stream) e destroy do player em série, nunca juntos
+    private val playerMutex = Mutex()
+    private var powerModeJob: Job? = null
+    
+    private val screenReceiver = object : BroadcastReceiver() {
+        override fun onReceive(context: Context, intent: Intent) {
+            screenOn = intent.action != Intent.ACTION_SCREEN_OFF
+            applyPowerMode()
+        }
+    }
+
     // === Rate limiter para processamento de chunks (throttling)
     private var lastChunkProcessTime = 0L
     private val minChunkInterval = 8L // 8ms = 125 chunks/s (margem para picos de latência)
-    private val chunkChannel = kotlinx.coroutines.channels.Channel<ByteArray>(capacity = 500) // Canal thread-safe
+    private val chunkChannel = kotlinx.coroutines.channels.Channel<SenderChunk>(capacity = 500) // Canal thread-safe
+    // ✅ Buffers diretos reciclados: o consumidor devolve cada chunk ao pool após o JNI
+    private val chunkBufferPool = DirectBufferPool(bufferCapacity = CHUNK_BUFFER_BYTES, maxBuffers = 512)
     private var processingJob: Job? = null
     
+    // ✅ Chunk recebido + fonte do sender no mixer nativo
+    private class SenderChunk(val sourceId: Int, val buffer: ByteBuffer)
+    
+    // ✅ Lote para addBatch(): dois ou mais chunks do mesmo sender e codec copiados em
+    // sequência numa arena direta fixa, com offsets[i]..offsets[i + 1] para cada um.
+    // A arena cabe MAX_BATCH_CHUNKS chunks do pool; chunk que não cabe fecha o lote
+    private class IngestBatch {
+        val buffer: ByteBuffer = ByteBuffer.allocateDirect(OboeAudioPlayer.MAX_BATCH_CHUNKS * CHUNK_BUFFER_BYTES)
+        val offsets = IntArray(OboeAudioPlayer.MAX_BATCH_CHUNKS + 1)
+        var count = 0
+        var sourceId = OboeAudioPlayer.DEFAULT_SOURCE
+        private var codec = AudioChunk.CODEC_PCM16
+        
+        fun isFull() = count >= OboeAudioPlayer.MAX_BATCH_CHUNKS
+        
+        // O nativo escolhe PCM ou Opus pelo primeiro pacote: troca de sender ou codec fecha o lote
+        private fun sameStream(a: SenderChunk, b: SenderChunk) =
+            a.sourceId == b.sourceId && AudioChunk.codec(a.buffer) == AudioChunk.codec(b.buffer)
+        
+        // Vale abrir um lote só se os dois primeiros entram juntos
+        fun canPack(first: SenderChunk, second: SenderChunk) =
+            sameStream(first, second) && first.buffer.remaining() + second.buffer.remaining() <= buffer.capacity()
+        
+        fun begin(chunk: SenderChunk) {
+            buffer.clear()
+            count = 0
+            sourceId = chunk.sourceId
+            codec = AudioChunk.codec(chunk.buffer)
+            add(chunk)
+        }
+        
+        fun accepts(chunk: SenderChunk) =
+            !isFull() && chunk.sourceId == sourceId && AudioChunk.codec(chunk.buffer) == codec &&
+                chunk.buffer.remaining() <= buffer.remaining()
+        
+        fun add(chunk: SenderChunk) {
+            offsets[count] = buffer.position()
+            buffer.put(chunk.buffer.duplicate())
+            count++
+            offsets[count] = buffer.position()
+        }
+    }
+    
+    // ✅ Senders ativos: id do servidor -> fonte no mixer (cada um com buffer e ganho próprios)
+    private class SenderSource(val sourceId: Int, @Volatile var lastChunkMs: Long)
+    private val senderSources = HashMap<String, SenderSource>()
+    private var nextSourceId = OboeAudioPlayer.DEFAULT_SOURCE + 1
+    private val SENDER_IDLE_MS = 10_000L
+    // ✅ Relatório do buffer de cada sender, devolvido a ele pelo servidor (receiver-feedback)
+    private val FEEDBACK_INTERVAL_MS = 500L
+    
     // Configurações de áudio
     private val SAMPLE_RATE = 48000
     private val CHANNEL_COUNT = 2
+    // Teto do buffer nativo por sender, em duração (independe do tamanho dos chunks)
+    private val MAX_BUFFER_MS = 10000
+    
+    // ✅ Sincronização entre receptores: relógio do servidor + atraso comum de reprodução
+    private var clockSync: ClockSync? = null
+    private val PLAYOUT_DELAY_MS = 300
+    
+    // ✅ Áudio por UDP direto no player nativo (0 = qualquer porta livre)
+    private val UDP_PORT = 0
     
     // Media Session e Audio
     private lateinit var mediaSession: MediaSessionCompat
@@ -86,6 +183,9 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         const val CHANNEL_ID = "AudioPlaybackServiceChannel"
         const val NOTIFICATION_ID = 101
         private const val TAG = "AudioPlayback"
+        // Buffer do pool por chunk (e passo da arena do IngestBatch): cabe o maior chunk PCM
+        // estéreo do sender adaptativo (60ms sob congestionamento), sem buffer avulso
+        private const val CHUNK_BUFFER_BYTES = AudioChunk.HEADER_BYTES + NativeCaptureEncoder.MAX_CHUNK_FRAMES * 2 * 2
     }
     
     inner class AudioPlaybackBinder : Binder() {
@@ -100,6 +200,11 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         mediaSession = MediaSessionCompat(this, "AudioPlaybackService").apply {
             setCallback(mediaSessionCallback)
         }
+        screenOn = getSystemService(PowerManager::class.java).isInteractive
+        registerReceiver(screenReceiver, IntentFilter().apply {
+            addAction(Intent.ACTION_SCREEN_OFF)
+            addAction(Intent.ACTION_SCREEN_ON)
+        })
     }
     
     override fun onBind(intent: Intent): IBinder = binder
@@ -178,50 +283,69 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
     private fun startChunkProcessor() {
         processingJob?.cancel()
         processingJob = serviceScope.launch(audioDispatcher) {
-            // Processamento de chunks com prioridade
-            // Aguardar acumular chunks suficientes antes de começar (pre-buffering)
-            var preBufferCount = 0
-            val TARGET_PREBUFFER_CHUNKS = 50  // Aumentar de 20 para 50 (~500-1000ms)
-
-            while (isActive && isPlaying.get() && preBufferCount < TARGET_PREBUFFER_CHUNKS) {
-                try {
-                    withTimeout(50) {  // Aumentar timeout de 10ms para 50ms
-                        chunkChannel.receive()
-                        preBufferCount++
-                    }
-                } catch (e: Exception) {
-                    delay(10)
-                }
-            }
-            
-            if (preBufferCount >= 20) {
-                Log.d(TAG, "✅ Pre-buffer completo: $preBufferCount chunks (~${preBufferCount * 10}ms)")
-            }
+            // ✅ Sem pre-buffer aqui: o primeiro chunk já vai para o nativo, e o início
+            // rápido do PlayerCore (setFastStart) espera só alguns bursts antes de tocar
             
             // Loop principal: consumir do canal e processar SEM rate limiting artificial
+            // ✅ Em lote: depois do receive bloqueante, o que já estiver no canal (o acúmulo
+            // de uma parada da rede) entra numa chamada JNI só, com uma trava e uma
+            // publicação no buffer nativo em vez de uma por chunk
+            // No modo de economia, um despertar por POWER_SAVING_INGEST_MS entrega tudo junto
+            val batch = IngestBatch()
+            var pending: SenderChunk? = null
+            var lastIngestMs = 0L
             while (isActive && isPlaying.get()) {
                 try {
-                    val chunk = withTimeout(100) {
+                    val carried = pending
+                    pending = null
+                    val first = carried ?: withTimeout(100) {
                         chunkChannel.receive()
                     }
+                    if (carried == null && powerSavingActive) {
+                        // ✅ Economia: o resto do intervalo acumula no canal
+                        val waitMs = OboeAudioPlayer.POWER_SAVING_INGEST_MS - (System.currentTimeMillis() - lastIngestMs)
+                        if (waitMs > 0) delay(waitMs)
+                    }
+                    val sent: Int
+                    val accepted: Int
+                    val second = chunkChannel.tryReceive().getOrNull()
+                    if (second == null || !batch.canPack(first, second)) {
+                        // ✅ Chunk sozinho: direto do buffer do pool, sem cópia para o lote
+                        pending = second
+                        sent = 1
+                        accepted = if (ingestSingle(first)) 1 else 0
+                        chunkBufferPool.release(first.buffer)
+                    } else {
+                        batch.begin(first)
+                        chunkBufferPool.release(first.buffer)
+                        var next: SenderChunk? = second
+                        while (next != null) {
+                            if (!batch.accepts(next)) {
+                                pending = next // Abre o próximo lote
+                                break
+                            }
+                            batch.add(next)
+                            chunkBufferPool.release(next.buffer)
+                            if (batch.isFull()) break
+                            next = chunkChannel.tryReceive().getOrNull()
+                        }
+                        sent = batch.count
+                        // Opus vai para a thread de decodificação nativa
+                        accepted = oboePlayer?.addBatch(batch.buffer, batch.offsets, batch.count, batch.sourceId) ?: 0
+                    }
+                    lastIngestMs = System.currentTimeMillis()
                     
-                    // REMOVER o rate limiting artificial
-                    // val timeSinceLastChunk = now - lastChunkProcessTime
-                    // if (timeSinceLastChunk < minChunkInterval) { delay(...) }
-                    
-                    // Enviar IMEDIATAMENTE para Oboe
-                    val success = oboePlayer?.addData(chunk) ?: false
-                    
-                    if (success) {
-                        chunksReceived.incrementAndGet()
+                    if (accepted > 0) {
+                        val total = chunksReceived.addAndGet(accepted.toLong())
                         lastChunkProcessTime = System.currentTimeMillis()
                         
                         // Log a cada 100 chunks
-                        if (chunksReceived.get() % 100 == 0L) {
+                        if (total / 100 != (total - accepted) / 100) {
                             val queueSize = chunkChannel.isEmpty.let { if (it) 0 else "??" }
-                            Log.d(TAG, "📊 Chunk #${chunksReceived.get()} | Canal: $queueSize | Processado imediatamente")
+                            Log.d(TAG, "📊 Chunk #$total | Lote: $sent | Canal: $queueSize")
                         }
-                    } else {
+                    }
+                    if (accepted < sent) {
                         delay(1) // Apenas se Oboe recusar
                     }
                     
@@ -231,6 +355,17 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
                     Log.e(TAG, "❌ Erro no processador: ${e.message}")
                 }
             }
+            pending?.let { chunkBufferPool.release(it.buffer) }
+        }
+    }
+
+    // Enviar IMEDIATAMENTE para Oboe (ByteBuffer direto, sem pinning)
+    private fun ingestSingle(chunk: SenderChunk): Boolean {
+        val player = oboePlayer ?: return false
+        return if (AudioChunk.codec(chunk.buffer) == AudioChunk.CODEC_OPUS) {
+            player.addEncoded(chunk.buffer, chunk.sourceId)
+        } else {
+            player.addDirect(chunk.buffer, chunk.sourceId)
         }
     }
 
@@ -241,19 +376,42 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         
         Log.d(TAG, "🔌 Socket conectado, criando Oboe stream...")
         
-        // Criar Oboe player
+        // Criar Oboe player (senders novos ganham fonte própria no mixer)
+        synchronized(senderSources) { senderSources.clear() }
         oboePlayer = OboeAudioPlayer()
-        if (!oboePlayer!!.createStream(SAMPLE_RATE, CHANNEL_COUNT)) {
+        powerSavingActive = wantsPowerSaving()
+        oboePlayer?.setPowerSaving(powerSavingActive) // Antes do stream: já abre no modo certo
+        if (!oboePlayer!!.createStream(SAMPLE_RATE, CHANNEL_COUNT, MAX_BUFFER_MS)) {
             Log.e(TAG, "❌ Falha ao criar Oboe stream")
             connectionState.postValue(ConnectionState.FAILED)
             return
         }
         
+        // ✅ Chunks com timestamp tocam em captura + PLAYOUT_DELAY_MS no relógio do servidor
+        oboePlayer?.setPlayoutDelay(PLAYOUT_DELAY_MS)
+        oboePlayer?.setFastStart(true)
+        oboePlayer?.setLogLevel(nativeLogLevel)
+        clockSync?.stop()
+        clockSync = socket?.let { s ->
+            ClockSync(s) { offsetUs -> oboePlayer?.setClockOffset(offsetUs) }.also { it.start(serviceScope) }
+        }
+        
         // Iniciar playback
         oboePlayer?.start()
         isPlaying.set(true)
         isPlayingLive.postValue(true)
         
+        // ✅ Recepção UDP nativa: servidores que entendem "udp-receiver" mandam os chunks
+        // SHB1 para esta porta (sem JVM nem GC no caminho do áudio). O Socket.IO fica para
+        // controle e estatísticas; servidores antigos ignoram o evento e seguem com audio-chunk.
+        val udpPort = oboePlayer?.startReceiver(UDP_PORT) ?: -1
+        if (udpPort > 0) {
+            socket?.emit("udp-receiver", JSONObject().put("port", udpPort))
+            Log.d(TAG, "📡 Recepção UDP na porta $udpPort")
+        } else {
+            Log.w(TAG, "⚠️ Recepção UDP indisponível, só audio-chunk")
+        }
+        
         // ✅ INICIAR PROCESSADOR DE CHUNKS COM RATE LIMITING
         startChunkProcessor()
         
@@ -262,11 +420,14 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
             try {
                 val rawData = processAudioData(args[0]) ?: return@on
                 val validData = validateAndProcessAudioData(rawData) ?: return@on
+                val sourceId = sourceIdFor(senderKey(args)) ?: return@on
                 
                 // Usar offer() em vez de trySend() para backpressure adequado
-                val result = chunkChannel.trySend(validData)
+                val buffer = chunkBufferPool.wrap(validData)
+                val result = chunkChannel.trySend(SenderChunk(sourceId, buffer))
                 
                 if (result.isFailure) {
+                    chunkBufferPool.release(buffer)
                     // Logar mas não descartar - Socket.IO vai fazer backpressure
                     Log.w(TAG, "⚠️ Canal saturado, aplicando backpressure")
                     // Socket.IO vai desacelerar sender automaticamente
@@ -288,6 +449,8 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
             Log.w(TAG, "⚠️ Stream parado no servidor")
         }
         
+        startFeedbackReports()
+        
         // 🔍 MONITORAR SE CHUNKS PARAM DE CHEGAR (Timeout)
         serviceScope.launch {
             delay(15000) // Esperar 15 segundos após conectar
@@ -300,6 +463,7 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
                     Log.e(TAG, "   Total recebido: ${chunksReceived.get()}, Buffer: ${oboePlayer?.getBufferSize() ?: 0}")
                     Log.e(TAG, "   Socket conectado: ${socket?.connected()}")
                 }
+                removeIdleSenders()
                 
                 delay(5000) // Verificar a cada 5 segundos
             }
@@ -314,6 +478,70 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         }
     }
     
+    // ✅ A cada FEEDBACK_INTERVAL_MS, um relatório por sender: receiver-feedback(relatório, senderId).
+    // O servidor repassa ao sender com o id deste ouvinte; o CongestionController de lá
+    // ajusta chunk, bitrate e ritmo de envio. Sender sem id: relatório sem senderId.
+    private fun startFeedbackReports() {
+        serviceScope.launch {
+            while (isPlaying.get() && connectionState.value == ConnectionState.CONNECTED) {
+                delay(FEEDBACK_INTERVAL_MS)
+                val senders = synchronized(senderSources) {
+                    senderSources.map { (key, sender) -> key to sender.sourceId }
+                }
+                val targets = if (senders.isEmpty()) listOf(null to OboeAudioPlayer.DEFAULT_SOURCE) else senders
+                for ((key, sourceId) in targets) {
+                    val report = oboePlayer?.getFeedback(sourceId) ?: continue
+                    if (key != null) socket?.emit("receiver-feedback", report, key)
+                    else socket?.emit("receiver-feedback", report)
+                }
+            }
+        }
+    }
+    
+    // Id do sender no evento audio-chunk: 2º argumento ou campo senderId do objeto.
+    // Servidores que não mandam id ficam na fonte padrão (um sender só, como antes).
+    private fun senderKey(args: Array<Any?>): String? {
+        val second = args.getOrNull(1)
+        if (second is String || second is Number) return second.toString()
+        return (args.getOrNull(0) as? JSONObject)?.optString("senderId")?.takeIf { it.isNotEmpty() }
+    }
+    
+    // Fonte do mixer para o sender (criada na primeira vez); null = mixer cheio, descartar
+    private fun sourceIdFor(key: String?): Int? {
+        if (key == null) return OboeAudioPlayer.DEFAULT_SOURCE
+        val now = System.currentTimeMillis()
+        synchronized(senderSources) {
+            senderSources[key]?.let {
+                it.lastChunkMs = now
+                return it.sourceId
+            }
+            val sourceId = nextSourceId++
+            if (oboePlayer?.addSource(sourceId) != true) {
+                Log.w(TAG, "⚠️ Sem vaga no mixer para o sender $key")
+                return null
+            }
+            senderSources[key] = SenderSource(sourceId, now)
+            Log.d(TAG, "🎚️ Sender $key -> fonte $sourceId (${senderSources.size} senders)")
+            return sourceId
+        }
+    }
+    
+    // Sender que parou de mandar chunks libera a vaga e o buffer no mixer
+    private fun removeIdleSenders() {
+        val now = System.currentTimeMillis()
+        synchronized(senderSources) {
+            val iterator = senderSources.entries.iterator()
+            while (iterator.hasNext()) {
+                val (key, sender) = iterator.next()
+                if (now - sender.lastChunkMs > SENDER_IDLE_MS) {
+                    oboePlayer?.removeSource(sender.sourceId)
+                    iterator.remove()
+                    Log.d(TAG, "🎚️ Sender $key inativo, fonte ${sender.sourceId} removida")
+                }
+            }
+        }
+    }
+    
     private fun processAudioData(data: Any?): ByteArray? {
         return try {
             when (data) {
@@ -454,6 +682,11 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         // - 10ms: 480 frames × 2 ch × 2 bytes = 1920 bytes (Electron sender)
         // - Android: varia conforme AudioRecord buffer
         
+        // Opus não é PCM: tamanho e amplitude não dizem nada, o nativo valida
+        if (AudioChunk.codec(rawData) == AudioChunk.CODEC_OPUS) return rawData
+        // Marcador de silêncio (DTX) não tem PCM para validar
+        if (AudioChunk.isSilence(rawData)) return rawData
+        
         val validSizes = listOf(1920, 3840) // 10ms e 20ms
         val isValidSize = validSizes.any { expected ->
             rawData.size >= (expected * 0.9) && rawData.size <= (expected * 1.1)
@@ -468,10 +701,11 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         var hasValidAudio = false
         var maxValue = 0
         var silentSamples = 0
-        val samplesToCheck = minOf(100, (rawData.size / 2))
+        val pcmOffset = AudioChunk.payloadOffset(rawData) // Pular o cabeçalho SHB1
+        val samplesToCheck = minOf(100, ((rawData.size - pcmOffset) / 2))
         
         for (i in 0 until samplesToCheck) {
-            val byteIdx = i * 2
+            val byteIdx = pcmOffset + i * 2
             if (byteIdx + 1 >= rawData.size) break
             
             // ✅ Ler sample PCM16 Little Endian (mesmo formato do C#)
@@ -551,16 +785,22 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
     fun disconnect() {
         Log.d(TAG, "🔌 Desconectando socket e limpando listeners...")
 
-        // Parar processador de chunks
-        processingJob?.cancel()
+        // Parar processador de chunks e a troca de modo pendente (o destroy do player espera os dois)
+        val processor = processingJob
+        processor?.cancel()
         processingJob = null
+        val modeSwitch = powerModeJob
+        modeSwitch?.cancel()
+        powerModeJob = null
+        clockSync?.stop()
+        clockSync = null
 
         // Limpar canal de chunks
         chunkChannel.close()
         // Drenar qualquer chunk restante
         serviceScope.launch {
             while (!chunkChannel.isEmpty) {
-                try { chunkChannel.receive() } catch (e: Exception) { break }
+                try { chunkBufferPool.release(chunkChannel.receive().buffer) } catch (e: Exception) { break }
             }
         }
 
@@ -588,9 +828,17 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         socket = null
         
         // Limpar o Oboe player mas não destruir completamente
+        oboePlayer?.stopReceiver()
+        oboePlayer?.stopTrace()
         oboePlayer?.stop()
-        oboePlayer?.destroy()
+        // ✅ Nenhum addBatch nem reabertura de stream em voo quando o player nativo for apagado
+        runBlocking {
+            processor?.join()
+            modeSwitch?.join()
+            playerMutex.withLock { oboePlayer?.destroy() }
+        }
         oboePlayer = null
+        synchronized(senderSources) { senderSources.clear() }
         
         // Resetar contadores
         chunksReceived.set(0)
@@ -625,17 +873,75 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
         }
     }
     
+    // Telemetria do callback para a UI (null sem player); pode ser lida a cada segundo
+    fun getPlayerStats(): PlayerStats? = oboePlayer?.getStats()
+    
+    // Verbosidade do log do callback nativo (OboeAudioPlayer.LOG_*), em tempo real
+    fun setNativeLogLevel(level: Int) {
+        nativeLogLevel = level
+        oboePlayer?.setLogLevel(level)
+    }
+    
+    // ✅ Modo de energia em tempo real: a troca reabre o stream nativo mantendo o buffer
+    fun setPowerMode(mode: PowerMode) {
+        powerMode = mode
+        powerModeLive.postValue(mode)
+        applyPowerMode()
+    }
+    
+    private fun wantsPowerSaving() = when (powerMode) {
+        PowerMode.LOW_LATENCY -> false
+        PowerMode.POWER_SAVING -> true
+        PowerMode.AUTO -> !screenOn
+    }
+    
+    private fun applyPowerMode() {
+        val enabled = wantsPowerSaving()
+        if (enabled == powerSavingActive) return
+        powerSavingActive = enabled
+        val player = oboePlayer ?: return
+        // Reabrir o stream leva dezenas de ms: fora da thread principal e do processador de chunks.
+        // O Mutex aplica as trocas na ordem e segura o destroy do disconnect() até terminar
+        powerModeJob = serviceScope.launch(Dispatchers.IO) {
+            playerMutex.withLock {
+                if (player.setPowerSaving(enabled)) {
+                    Log.d(TAG, "🔋 Modo ${if (enabled) "economia" else "baixa latência"} (tela ${if (screenOn) "acesa" else "apagada"})")
+                } else {
+                    Log.w(TAG, "⚠️ Stream não reabriu na troca de modo; recuperação em andamento")
+                }
+            }
+        }
+    }
+    
+    // ✅ Trace para investigar underruns: grava em files/traces/<instante>.shtr até
+    // stopTrace() ou desconectar. Devolve o caminho (null sem player ou se falhou).
+    fun startTrace(): String? {
+        val player = oboePlayer ?: return null
+        val dir = java.io.File(filesDir, "traces").apply { mkdirs() }
+        val file = java.io.File(dir, "${System.currentTimeMillis()}.shtr")
+        return if (player.startTrace(file.absolutePath)) file.absolutePath else null
+    }
+    
+    fun stopTrace() {
+        oboePlayer?.stopTrace()
+    }
+    
     fun getStreamInfo(): String {
         val bufferSize = oboePlayer?.getBufferSize() ?: 0
         val underruns = oboePlayer?.getUnderrunCount() ?: 0
         val latency = oboePlayer?.getLatencyMillis() ?: 0
+        val syncErrorMs = (oboePlayer?.getSyncErrorMicros() ?: 0L) / 1000.0
+        val clockOffsetMs = (clockSync?.offsetUs ?: 0L) / 1000.0
+        val packets = oboePlayer?.getPacketCounters()
         
         return """
         Stream Info:
-        - Buffer Size: $bufferSize chunks
+        - Buffer Size: $bufferSize frames (${oboePlayer?.getBufferedMs() ?: 0}ms)
         - Underrun Count: $underruns
         - Latency: ${latency}ms
+        - Sync Error: ${String.format("%.1f", syncErrorMs)}ms (clock offset ${String.format("%.1f", clockOffsetMs)}ms)
         - Chunks Received: ${chunksReceived.get()}
+        - Packets: lost ${packets?.lost ?: 0}, late ${packets?.late ?: 0}, reordered ${packets?.reordered ?: 0}, concealed ${packets?.concealed ?: 0}
         """.trimIndent()
     }
     
@@ -870,6 +1176,7 @@ class AudioPlaybackService : Service(), AudioManager.OnAudioFocusChangeListener
     
     override fun onDestroy() {
         super.onDestroy()
+        unregisterReceiver(screenReceiver)
         stopPlayback()
         serviceScope.cancel()
         mediaSession.release()
@@ -0,0 +1,100 @@
+package com.shirou.shibasync
+
+import android.util.Log
+import io.socket.client.Ack
+import io.socket.client.Socket
+import kotlinx.coroutines.*
+
+/**
+ * Estimador leve estilo NTP do offset entre o relógio local e o do servidor.
+ *
+ * Envia "clock-sync" com o instante local; o servidor responde no ack com o próprio
+ * relógio em microssegundos (`socket.on('clock-sync', (t, ack) => ack(agoraUs))`).
+ * Para cada amostra: offset = servidor - (t0 + t1) / 2, com erro limitado a RTT / 2.
+ * Entre as últimas [WINDOW] amostras vale a de menor RTT (filtro de relógio do NTP).
+ *
+ * O relógio local é o System.nanoTime() (CLOCK_MONOTONIC), o mesmo do lado nativo.
+ */
+class ClockSync(
+    private val socket: Socket,
+    private val onOffsetChanged: (Long) -> Unit = {}
+) {
+    companion object {
+        const val EVENT = "clock-sync"
+        private const val TAG = "ClockSync"
+        private const val WINDOW = 16
+        private const val BURST_SAMPLES = 8
+        private const val BURST_INTERVAL_MS = 100L
+        private const val INTERVAL_MS = 2000L
+        private const val MAX_RTT_US = 500_000L
+
+        fun localNowUs(): Long = System.nanoTime() / 1000
+    }
+
+    private data class Sample(val offsetUs: Long, val rttUs: Long)
+
+    private val samples = ArrayDeque<Sample>()
+    private var job: Job? = null
+
+    @Volatile var offsetUs = 0L
+        private set
+    @Volatile var rttUs = 0L
+        private set
+    @Volatile var isSynced = false
+        private set
+
+    fun serverNowUs(): Long = localNowUs() + offsetUs
+
+    // Converte um instante local (µs, CLOCK_MONOTONIC) para o relógio do servidor
+    fun toServerUs(localUs: Long): Long = localUs + offsetUs
+
+    fun start(scope: CoroutineScope) {
+        job?.cancel()
+        job = scope.launch {
+            // Rajada inicial para convergir rápido, depois manutenção
+            repeat(BURST_SAMPLES) {
+                ping()
+                delay(BURST_INTERVAL_MS)
+            }
+            while (isActive) {
+                ping()
+                delay(INTERVAL_MS)
+            }
+        }
+    }
+
+    fun stop() {
+        job?.cancel()
+        job = null
+    }
+
+    private fun ping() {
+        if (!socket.connected()) return
+        val t0 = localNowUs()
+        socket.emit(EVENT, t0, Ack { args ->
+            val t1 = localNowUs()
+            val serverUs = (args.firstOrNull() as? Number)?.toLong() ?: return@Ack
+            onSample(t0, serverUs, t1)
+        })
+    }
+
+    private fun onSample(t0: Long, serverUs: Long, t1: Long) {
+        val rtt = t1 - t0
+        if (rtt < 0 || rtt > MAX_RTT_US) return
+
+        val best = synchronized(samples) {
+            samples.addLast(Sample(serverUs - (t0 + t1) / 2, rtt))
+            if (samples.size > WINDOW) samples.removeFirst()
+            samples.minByOrNull { it.rttUs }!!
+        }
+
+        val changed = !isSynced || best.offsetUs != offsetUs
+        offsetUs = best.offsetUs
+        rttUs = best.rttUs
+        if (!isSynced) {
+            Log.d(TAG, "🕒 Relógio sincronizado: offset=${best.offsetUs}us, rtt=${best.rttUs}us")
+        }
+        isSynced = true
+        if (changed) onOffsetChanged(best.offsetUs)
+    }
+}
@@ -0,0 +1,43 @@
+package com.shirou.shibasync
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.util.concurrent.ArrayBlockingQueue
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * Pool de ByteBuffers diretos reciclados entre o socket e o player nativo.
+ *
+ * Os buffers são criados sob demanda até [maxBuffers] e depois apenas reutilizados,
+ * então em regime estável o caminho de áudio não aloca nada no heap nativo.
+ * Chunks maiores que [bufferCapacity] recebem um buffer avulso que não volta ao pool.
+ */
+class DirectBufferPool(private val bufferCapacity: Int, maxBuffers: Int) {
+    private val free = ArrayBlockingQueue<ByteBuffer>(maxBuffers)
+    private val created = AtomicInteger(0)
+
+    fun acquire(minCapacity: Int): ByteBuffer {
+        if (minCapacity > bufferCapacity) {
+            return ByteBuffer.allocateDirect(minCapacity).order(ByteOrder.LITTLE_ENDIAN)
+        }
+        free.poll()?.let { return it }
+        created.incrementAndGet()
+        return ByteBuffer.allocateDirect(bufferCapacity).order(ByteOrder.LITTLE_ENDIAN)
+    }
+
+    fun release(buffer: ByteBuffer) {
+        if (buffer.capacity() != bufferCapacity) return
+        buffer.clear()
+        free.offer(buffer)
+    }
+
+    // Copia um chunk recebido para um buffer do pool, pronto para leitura (position=0, limit=size)
+    fun wrap(data: ByteArray): ByteBuffer {
+        val buffer = acquire(data.size)
+        buffer.put(data, 0, data.size)
+        buffer.flip()
+        return buffer
+    }
+
+    fun createdCount(): Int = created.get()
+}
@@ -54,6 +54,7 @@ import androidx.compose.ui.unit.sp
 import io.socket.client.IO
 import io.socket.client.Socket
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.delay
 import kotlinx.coroutines.launch
 import org.json.JSONObject
 
@@ -646,6 +647,16 @@ fun ReceiverScreen(serverIp: String, onBack: () -> Unit) {
     var volume by remember { mutableStateOf(1f) } // 1f = 100%
     val senderCount by audioService?.activeSenderCount?.observeAsState(0) ?: remember { mutableStateOf(0) }
     val listenerCount by audioService?.activeListenerCount?.observeAsState(0) ?: remember { mutableStateOf(0) }
+    var statsText by remember { mutableStateOf("") }
+    val powerMode by audioService?.powerModeLive?.observeAsState(PowerMode.AUTO) ?: remember { mutableStateOf(PowerMode.AUTO) }
+
+    // ✅ Telemetria nativa a cada segundo enquanto toca (uma chamada JNI, sem log no callback)
+    LaunchedEffect(audioService, isPlaying) {
+        while (isPlaying) {
+            statsText = audioService?.getPlayerStats()?.summary() ?: ""
+            delay(1000)
+        }
+    }
 
     val serviceConnection = remember {
         object : ServiceConnection {
@@ -772,6 +783,37 @@ fun ReceiverScreen(serverIp: String, onBack: () -> Unit) {
                         steps = 9,
                         modifier = Modifier.fillMaxWidth().padding(horizontal = 16.dp)
                     )
+                    // ✅ Economia: callbacks longos e rede em lotes (AUTO = só com a tela apagada)
+                    Spacer(modifier = Modifier.height(12.dp))
+                    Text("Battery", style = MaterialTheme.typography.labelMedium, color = colorResource(id = R.color.aurora_purple_light))
+                    Row(
+                        modifier = Modifier.fillMaxWidth(),
+                        horizontalArrangement = Arrangement.SpaceEvenly,
+                        verticalAlignment = Alignment.CenterVertically
+                    ) {
+                        listOf(
+                            PowerMode.LOW_LATENCY to "Low latency",
+                            PowerMode.AUTO to "Screen off",
+                            PowerMode.POWER_SAVING to "Saver"
+                        ).forEach { (mode, label) ->
+                            Row(verticalAlignment = Alignment.CenterVertically) {
+                                RadioButton(
+                                    selected = powerMode == mode,
+                                    onClick = { audioService?.setPowerMode(mode) }
+                                )
+                                Text(label, style = MaterialTheme.typography.bodySmall)
+                            }
+                        }
+                    }
+                    if (statsText.isNotEmpty()) {
+                        Spacer(modifier = Modifier.height(16.dp))
+                        Text(
+                            text = statsText,
+                            textAlign = TextAlign.Center,
+                            color = colorResource(id = R.color.aurora_cyan_light),
+                            style = MaterialTheme.typography.bodySmall
+                        )
+                    }
                 }
                 else -> {
                     Text("Disconnected or connection failure.", color = MaterialTheme.colorScheme.error, textAlign = TextAlign.Center)
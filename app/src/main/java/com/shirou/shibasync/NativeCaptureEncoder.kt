@@ -0,0 +1,83 @@
+package com.shirou.shibasync
+
+import java.nio.ByteBuffer
+
+/**
+ * Pipeline nativo do sender (CapturePipeline.cpp): acumula o PCM lido do AudioRecord,
+ * mede pico/RMS, codifica (Opus ou PCM16) e monta os pacotes SHB1 num pool nativo.
+ *
+ * O Kotlin só entrega as leituras ([write]) e retira os pacotes prontos ([poll]).
+ * Uma instância por vez (o estado nativo é único, como no [OboeAudioPlayer]).
+ */
+class NativeCaptureEncoder {
+    companion object {
+        init {
+            System.loadLibrary("oboe-audio")
+        }
+
+        const val DEFAULT_OPUS_BITRATE = 128_000
+        const val NO_TIMESTAMP = Long.MIN_VALUE
+        // Maior chunk do modo adaptativo (CapturePipeline::MAX_CHUNK_FRAMES, 60ms a 48kHz)
+        const val MAX_CHUNK_FRAMES = 2880
+    }
+
+    external fun nativeCreate(sampleRate: Int, channelCount: Int, chunkFrames: Int, useOpus: Boolean, bitrate: Int,
+                              adaptive: Boolean): Boolean
+    external fun nativeWrite(buffer: ByteBuffer, offset: Int, length: Int, captureTimeUs: Long): Int
+    external fun nativeFlush(): Int
+    external fun nativeNextPacketSize(): Int
+    external fun nativeReadPacket(out: ByteArray): Int
+    external fun nativeGetPeak(): Float
+    external fun nativeGetRms(): Float
+    external fun nativeGetCodec(): Int
+    external fun nativeGetDroppedPackets(): Long
+    external fun nativeSetSilenceDetection(enabled: Boolean)
+    external fun nativeGetSilentPackets(): Long
+    external fun nativeOnFeedback(listenerId: Int, report: ByteArray): Boolean
+    external fun nativeGetChunkFrames(): Int
+    external fun nativeGetBitrate(): Int
+    external fun nativeDestroy()
+
+    // Sem libopus no .so (ou taxa não suportada) o codec efetivo cai para PCM16: ver [codec].
+    // adaptive: chunk, bitrate (Opus) e ritmo de envio seguem os relatórios dos
+    // receptores ([onFeedback]); chunkFrames e bitrate viram o ponto de partida e o teto.
+    fun create(sampleRate: Int, channelCount: Int, chunkFrames: Int, useOpus: Boolean,
+               bitrate: Int = DEFAULT_OPUS_BITRATE, adaptive: Boolean = false): Boolean {
+        return nativeCreate(sampleRate, channelCount, chunkFrames, useOpus, bitrate, adaptive)
+    }
+
+    // ✅ Relatório receiver-feedback de um ouvinte (qualquer thread); listenerId estável por ouvinte
+    fun onFeedback(listenerId: Int, report: ByteArray) = nativeOnFeedback(listenerId, report)
+
+    // ✅ PCM16 entre 0 e length de um ByteBuffer direto; captureTimeUs = instante do 1º frame
+    // (relógio do servidor) ou null. Retorna quantos pacotes ficaram prontos.
+    fun write(buffer: ByteBuffer, length: Int, captureTimeUs: Long?): Int {
+        return nativeWrite(buffer, 0, length, captureTimeUs ?: NO_TIMESTAMP)
+    }
+
+    fun flush() = nativeFlush()
+
+    // ✅ DTX: depois de 300ms de silêncio digital os chunks saem como marcadores de
+    // 30 bytes ("N frames de silêncio"); o receptor toca zeros ou ruído de conforto.
+    // Chamar depois de [create], antes do primeiro [write].
+    fun setSilenceDetection(enabled: Boolean) = nativeSetSilenceDetection(enabled)
+
+    // Próximo pacote pronto (no ritmo do controle, se adaptativo: null = esperar a próxima leitura). O socket guarda a referência até enviar, então cada pacote
+    // precisa do próprio array (do tamanho exato: ~300 bytes com Opus)
+    fun poll(): ByteArray? {
+        val size = nativeNextPacketSize()
+        if (size <= 0) return null
+        val out = ByteArray(size)
+        return if (nativeReadPacket(out) == size) out else null
+    }
+
+    val peak: Float get() = nativeGetPeak() // 0..1 do último chunk
+    val rms: Float get() = nativeGetRms()
+    val codec: Int get() = nativeGetCodec()
+    val droppedPackets: Long get() = nativeGetDroppedPackets()
+    val silentPackets: Long get() = nativeGetSilentPackets()
+    val chunkFrames: Int get() = nativeGetChunkFrames() // Atual (muda com o controle adaptativo)
+    val bitrate: Int get() = nativeGetBitrate() // 0 = PCM
+
+    fun destroy() = nativeDestroy()
+}
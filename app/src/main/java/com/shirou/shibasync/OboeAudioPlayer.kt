@@ -1,49 +1,199 @@
 package com.shirou.shibasync
 
+import java.nio.ByteBuffer
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+
 class OboeAudioPlayer {
     companion object {
         init {
             System.loadLibrary("oboe-audio")
         }
+        
+        // Sender sem id (servidores antigos): a fonte criada junto com o stream
+        const val DEFAULT_SOURCE = 0
+        // Máximo de senders tocando ao mesmo tempo (SourceMixer::MAX_SOURCES)
+        const val MAX_SOURCES = 8
+        // Máximo de pacotes por addBatch() (OboeAudioPlayer::MAX_BATCH_CHUNKS)
+        const val MAX_BATCH_CHUNKS = 64
+        // Modo de economia: a rede é entregue ao nativo em lotes deste intervalo
+        // (OboeAudioPlayer::POWER_SAVING_INGEST_MS)
+        const val POWER_SAVING_INGEST_MS = 100L
+        // getStats(): o sender com mais áudio no buffer
+        const val BUSIEST_SOURCE = -1
+        // Teto do buffer de cada sender (PlayerCore::DEFAULT_MAX_BUFFER_MS), em duração
+        const val DEFAULT_MAX_BUFFER_MS = 10000
+        // setLogLevel(): verbosidade do log do callback (RealtimeLog::Level)
+        const val LOG_OFF = 0
+        const val LOG_ERROR = 1
+        const val LOG_WARN = 2
+        const val LOG_INFO = 3
     }
     
+    // ✅ Ponteiro do player nativo desta instância (0 depois de destroy)
+    // Toda chamada nativa segura o read lock; destroy() pega o write lock, então
+    // o player não é apagado no meio de um addDirect/setPowerSaving de outra thread
+    // (o nativo ignora handle 0).
+    @Volatile
+    private var handle: Long = nativeCreate()
+    private val lifetime = ReentrantReadWriteLock()
+    
+    private inline fun <T> withHandle(call: (Long) -> T): T = lifetime.read { call(handle) }
+    
     // Native methods
-    external fun nativeCreateStream(sampleRate: Int, channelCount: Int): Boolean
-    external fun nativeAddData(audioData: ByteArray, length: Int): Boolean
-    external fun nativeStart()
-    external fun nativePause()
-    external fun nativeStop()
-    external fun nativeClearQueue()
-    external fun nativeGetBufferSize(): Int
-    external fun nativeGetUnderrunCount(): Int
-    external fun nativeGetLatency(): Int
-    external fun nativeSetVolume(volume: Float): Boolean
-    external fun nativeDestroy()
-    
-    fun createStream(sampleRate: Int, channelCount: Int): Boolean {
-        return nativeCreateStream(sampleRate, channelCount)
-    }
-    
-    fun addData(audioData: ByteArray): Boolean {
-        return nativeAddData(audioData, audioData.size)
-    }
-    
-    fun start() = nativeStart()
-    fun pause() = nativePause()
-    fun stop() = nativeStop()
-    fun clearQueue() = nativeClearQueue()
-    fun getBufferSize() = nativeGetBufferSize()
-    fun getUnderrunCount() = nativeGetUnderrunCount()
-    fun getLatencyMillis() = nativeGetLatency()
-    
-    // ✅ NEW: Volume control (0.0 to 1.0)
+    private external fun nativeCreate(): Long
+    external fun nativeCreateStream(handle: Long, sampleRate: Int, channelCount: Int, maxBufferMs: Int): Boolean
+    external fun nativeAddSource(handle: Long, sourceId: Int): Boolean
+    external fun nativeRemoveSource(handle: Long, sourceId: Int): Boolean
+    external fun nativeSetSourceGain(handle: Long, sourceId: Int, gain: Float): Boolean
+    external fun nativeGetSourceCount(handle: Long): Int
+    external fun nativeStartReceiver(handle: Long, port: Int): Int
+    external fun nativeStopReceiver(handle: Long)
+    external fun nativeStartTrace(handle: Long, path: String): Boolean
+    external fun nativeStopTrace(handle: Long)
+    external fun nativeAddData(handle: Long, sourceId: Int, audioData: ByteArray, length: Int): Boolean
+    external fun nativeAddDirect(handle: Long, sourceId: Int, buffer: ByteBuffer, offset: Int, length: Int): Boolean
+    external fun nativeAddEncoded(handle: Long, sourceId: Int, buffer: ByteBuffer, offset: Int, length: Int): Boolean
+    external fun nativeAddBatch(handle: Long, sourceId: Int, buffer: ByteBuffer, offsets: IntArray, count: Int): Int
+    external fun nativeIsEncodedSupported(handle: Long): Boolean
+    external fun nativeSetPowerSaving(handle: Long, enabled: Boolean): Boolean
+    external fun nativeStart(handle: Long)
+    external fun nativePause(handle: Long)
+    external fun nativeStop(handle: Long)
+    external fun nativeClearQueue(handle: Long)
+    external fun nativeGetBufferSize(handle: Long): Int
+    external fun nativeGetBufferedMs(handle: Long): Int
+    external fun nativeGetUnderrunCount(handle: Long): Int
+    external fun nativeGetLatency(handle: Long): Int
+    external fun nativeSetVolume(handle: Long, volume: Float): Boolean
+    external fun nativeSetClockOffset(handle: Long, offsetUs: Long)
+    external fun nativeSetPlayoutDelay(handle: Long, delayMs: Int)
+    external fun nativeSetFastStart(handle: Long, enabled: Boolean)
+    external fun nativeSetComfortNoise(handle: Long, enabled: Boolean)
+    external fun nativeSetLogLevel(handle: Long, level: Int)
+    external fun nativeSetCallbackTuning(handle: Long, pinFastCores: Boolean, performanceHint: Boolean)
+    external fun nativeGetSyncError(handle: Long): Long
+    external fun nativeGetPacketCounters(handle: Long): LongArray
+    external fun nativeGetStats(handle: Long, sourceId: Int, out: LongArray): Int
+    external fun nativeGetFeedback(handle: Long, sourceId: Int): ByteArray?
+    private external fun nativeDestroy(handle: Long)
+    
+    // maxBufferMs: o ring de cada sender guarda exatamente essa duração (500 chunks
+    // de 10ms ou de 20ms dão o mesmo teto); acima dele os mais antigos são cortados
+    fun createStream(sampleRate: Int, channelCount: Int, maxBufferMs: Int = DEFAULT_MAX_BUFFER_MS): Boolean {
+        return withHandle { nativeCreateStream(it, sampleRate, channelCount, maxBufferMs) }
+    }
+    
+    // ✅ Um sender = uma fonte no mixer nativo (buffer, jitter buffer e ganho próprios)
+    fun addSource(sourceId: Int) = withHandle { nativeAddSource(it, sourceId) }
+    fun removeSource(sourceId: Int) = withHandle { nativeRemoveSource(it, sourceId) }
+    fun setSourceGain(sourceId: Int, gain: Float) = withHandle { nativeSetSourceGain(it, sourceId, gain.coerceIn(0.0f, 1.0f)) }
+    fun getSourceCount() = withHandle { nativeGetSourceCount(it) }
+    
+    // ✅ Recepção UDP nativa: chunks SHB1 direto no mixer, sem JVM no caminho do áudio.
+    // port = 0 escolhe uma porta livre; devolve a porta aberta ou -1.
+    fun startReceiver(port: Int = 0) = withHandle { nativeStartReceiver(it, port) }
+    fun stopReceiver() = withHandle { nativeStopReceiver(it) }
+    
+    // ✅ Trace (.shtr) com os instantes/tamanhos das chegadas e dos callbacks, sem o
+    // áudio; reproduzido no host com `trace-replay` (app/src/main/cpp/host)
+    fun startTrace(path: String) = withHandle { nativeStartTrace(it, path) }
+    fun stopTrace() = withHandle { nativeStopTrace(it) }
+    
+    fun addData(audioData: ByteArray, sourceId: Int = DEFAULT_SOURCE): Boolean {
+        return withHandle { nativeAddData(it, sourceId, audioData, audioData.size) }
+    }
+    
+    // ✅ Caminho sem alocação: lê os bytes entre position e limit de um ByteBuffer direto
+    fun addDirect(buffer: ByteBuffer, sourceId: Int = DEFAULT_SOURCE): Boolean {
+        return withHandle { nativeAddDirect(it, sourceId, buffer, buffer.position(), buffer.remaining()) }
+    }
+    
+    // ✅ Pacote SHB1 com codec Opus: decodificado numa thread nativa (PLC/FEC nos buracos)
+    fun addEncoded(buffer: ByteBuffer, sourceId: Int = DEFAULT_SOURCE): Boolean {
+        return withHandle { nativeAddEncoded(it, sourceId, buffer, buffer.position(), buffer.remaining()) }
+    }
+    
+    // ✅ Vários pacotes SHB1 do mesmo sender numa chamada: o pacote i vai de offsets[i]
+    // a offsets[i + 1] no ByteBuffer direto (até MAX_BATCH_CHUNKS). Devolve quantos entraram
+    fun addBatch(buffer: ByteBuffer, offsets: IntArray, count: Int, sourceId: Int = DEFAULT_SOURCE): Int {
+        return withHandle { nativeAddBatch(it, sourceId, buffer, offsets, count) }
+    }
+    
+    // false se a lib nativa foi compilada sem libopus
+    fun isEncodedSupported() = withHandle { nativeIsEncodedSupported(it) }
+    
+    fun start() = withHandle { nativeStart(it) }
+    fun pause() = withHandle { nativePause(it) }
+    fun stop() = withHandle { nativeStop(it) }
+    fun clearQueue() = withHandle { nativeClearQueue(it) }
+    fun getBufferSize() = withHandle { nativeGetBufferSize(it) } // Frames do sender mais cheio
+    fun getBufferedMs() = withHandle { nativeGetBufferedMs(it) }
+    fun getUnderrunCount() = withHandle { nativeGetUnderrunCount(it) }
+    fun getLatencyMillis() = withHandle { nativeGetLatency(it) }
+    
+    // ✅ Volume geral (0.0 to 1.0), multiplica o ganho de cada sender
     fun setVolume(volume: Float): Boolean {
         val clampedVolume = volume.coerceIn(0.0f, 1.0f)
-        return nativeSetVolume(clampedVolume)
+        return withHandle { nativeSetVolume(it, clampedVolume) }
     }
     
-    fun destroy() {
-        nativeDestroy()
+    // ✅ Reprodução sincronizada: offset do ClockSync (servidor - local, em µs)
+    fun setClockOffset(offsetUs: Long) = withHandle { nativeSetClockOffset(it, offsetUs) }
+    
+    // Atraso entre captura e saída; precisa ser o mesmo em todos os receptores
+    fun setPlayoutDelay(delayMs: Int) = withHandle { nativeSetPlayoutDelay(it, delayMs) }
+    
+    // ✅ Início rápido: áudio com poucos bursts no buffer (fade-in), que enche até o alvo
+    // tocando 2% mais devagar; a volta depois de um underrun também fica curta
+    fun setFastStart(enabled: Boolean) = withHandle { nativeSetFastStart(it, enabled) }
+    
+    // ✅ Marcadores de silêncio (DTX) tocam ruído no nível medido pelo sender em vez de
+    // zeros, para o fundo não "sumir" entre as falas
+    fun setComfortNoise(enabled: Boolean) = withHandle { nativeSetComfortNoise(it, enabled) }
+    
+    // ✅ Log do callback: enfileirado sem bloquear e formatado numa thread nativa
+    // (com limite por tipo de mensagem). Mensagens acima do nível nem são geradas.
+    fun setLogLevel(level: Int) = withHandle { nativeSetLogLevel(it, level.coerceIn(LOG_OFF, LOG_INFO)) }
+    
+    // ✅ Callback nos núcleos rápidos (big.LITTLE) e sessão ADPF do Oboe (Android 13+).
+    // Ligados por padrão; valem a partir do próximo createStream/reabertura.
+    fun setCallbackTuning(pinFastCores: Boolean, performanceHint: Boolean) =
+        withHandle { nativeSetCallbackTuning(it, pinFastCores, performanceHint) }
+    
+    // ✅ Modo de economia: stream PowerSaving com callbacks de 40ms e buffer profundo,
+    // UDP lido em lotes. Pode trocar tocando (tela apagada): o stream é reaberto sem
+    // perder o áudio do buffer. false se o stream novo não abriu (a recuperação insiste)
+    fun setPowerSaving(enabled: Boolean) = withHandle { nativeSetPowerSaving(it, enabled) }
+    
+    // Erro de agendamento atual em µs (0 quando o sender não manda timestamps)
+    fun getSyncErrorMicros() = withHandle { nativeGetSyncError(it) }
+    
+    // ✅ Pacotes perdidos, atrasados/duplicados (descartados), reordenados e escondidos
+    data class PacketCounters(val lost: Long, val late: Long, val reordered: Long, val concealed: Long)
+    
+    fun getPacketCounters(): PacketCounters {
+        val c = withHandle { nativeGetPacketCounters(it) }
+        return PacketCounters(c[0], c[1], c[2], c[3])
+    }
+    
+    // ✅ Telemetria completa (histogramas, drift, xruns) num array reaproveitável
+    private val statsBuffer = LongArray(PlayerStats.COUNT)
+    
+    fun getStats(sourceId: Int = BUSIEST_SOURCE): PlayerStats {
+        withHandle { nativeGetStats(it, sourceId, statsBuffer) }
+        return PlayerStats(statsBuffer.copyOf())
+    }
+    
+    // ✅ Relatório de 20 bytes (buffer, alvo, perda e underruns desde o anterior, jitter)
+    // para devolver ao sender; null se a fonte não existe. Um chamador por fonte.
+    fun getFeedback(sourceId: Int): ByteArray? = withHandle { nativeGetFeedback(it, sourceId) }
+    
+    fun destroy() = lifetime.write {
+        if (handle == 0L) return@write
+        nativeDestroy(handle)
+        handle = 0L
     }
     
     protected fun finalize() {
@@ -0,0 +1,132 @@
+package com.shirou.shibasync
+
+/**
+ * Telemetria do player nativo (PlayerTelemetry.h), lida de uma vez por
+ * [OboeAudioPlayer.getStats] sem log nenhum na thread de áudio.
+ *
+ * Os índices espelham `stats::Index` do C++; só se acrescenta no fim.
+ */
+class PlayerStats(private val values: LongArray) {
+    companion object {
+        const val SAMPLE_RATE = 0
+        const val CALLBACKS = 1
+        const val UNDERRUNS = 2
+        const val XRUNS = 3
+        const val DROPPED_FRAMES = 4
+        const val BUFFER_FRAMES = 5
+        const val TARGET_FRAMES = 6
+        const val RATIO_PPM = 7
+        const val CLOCK_DRIFT_PPM = 8
+        const val ARRIVAL_JITTER_US = 9
+        const val CHUNK_INTERVAL_US = 10
+        const val CALLBACK_LAST_US = 11
+        const val CALLBACK_MAX_US = 12
+        const val SYNC_ERROR_US = 13
+        const val STATE = 14
+        const val LOST_PACKETS = 15
+        const val LATE_PACKETS = 16
+        const val REORDERED_PACKETS = 17
+        const val CONCEALED_PACKETS = 18
+        const val HISTOGRAM_BUCKETS = 12
+        const val CALLBACK_HISTOGRAM = 19
+        const val FILL_HISTOGRAM = CALLBACK_HISTOGRAM + HISTOGRAM_BUCKETS
+        const val STREAM_RECOVERIES = FILL_HISTOGRAM + HISTOGRAM_BUCKETS
+        const val SOURCES = STREAM_RECOVERIES + 1
+        const val DEVICE_BUFFER_US = SOURCES + 1
+        const val OUTPUT_LATENCY_US = DEVICE_BUFFER_US + 1
+        const val TOTAL_LATENCY_US = OUTPUT_LATENCY_US + 1
+        const val BUFFER_GROWTHS = TOTAL_LATENCY_US + 1
+        const val UDP_DATAGRAMS = BUFFER_GROWTHS + 1
+        const val UDP_DROPPED = UDP_DATAGRAMS + 1
+        const val MAX_BUFFER_FRAMES = UDP_DROPPED + 1
+        const val CALLBACK_BUDGET_US = MAX_BUFFER_FRAMES + 1
+        const val CALLBACK_LOAD_PERMILLE = CALLBACK_BUDGET_US + 1
+        const val CALLBACK_LOAD_MAX_PERMILLE = CALLBACK_LOAD_PERMILLE + 1
+        const val CALLBACK_OVER_BUDGET = CALLBACK_LOAD_MAX_PERMILLE + 1
+        const val CALLBACK_CPU = CALLBACK_OVER_BUDGET + 1
+        const val CALLBACK_CPU_MASK = CALLBACK_CPU + 1
+        const val PERFORMANCE_HINT = CALLBACK_CPU_MASK + 1
+        const val SILENT_PACKETS = PERFORMANCE_HINT + 1
+        const val RECEIVED_PACKETS = SILENT_PACKETS + 1
+        const val POWER_SAVING = RECEIVED_PACKETS + 1
+        const val CALLBACK_FRAMES = POWER_SAVING + 1
+        const val CALLBACK_WAKEUPS_PER_S = CALLBACK_FRAMES + 1
+        const val INGEST_WAKEUPS_PER_S = CALLBACK_WAKEUPS_PER_S + 1
+        const val COUNT = INGEST_WAKEUPS_PER_S + 1
+
+        const val STATE_PLAYING = 1L
+        const val STATE_PREBUFFERING = 2L
+        const val STATE_SCHEDULED = 4L
+        const val STATE_BUILDING = 8L
+
+        // Limite superior de cada bucket: base, 2×base, 4×base...; o último não tem limite
+        const val CALLBACK_BUCKET_BASE_US = 25L
+        const val FILL_BUCKET_BASE_MS = 10L
+    }
+
+    operator fun get(index: Int): Long = values.getOrElse(index) { 0L }
+
+    private val sampleRate: Long get() = this[SAMPLE_RATE].coerceAtLeast(1L)
+
+    val callbacks get() = this[CALLBACKS]
+    val underruns get() = this[UNDERRUNS]
+    val xruns get() = this[XRUNS] // -1 = não suportado pelo dispositivo
+    val bufferMs get() = this[BUFFER_FRAMES] * 1000 / sampleRate // Frames exatos, sem estimativa por chunk
+    val targetMs get() = this[TARGET_FRAMES] * 1000 / sampleRate
+    val ratioPpm get() = this[RATIO_PPM]
+    val clockDriftPpm get() = this[CLOCK_DRIFT_PPM]
+    val arrivalJitterMs get() = this[ARRIVAL_JITTER_US] / 1000.0
+    val callbackLastUs get() = this[CALLBACK_LAST_US]
+    val callbackMaxUs get() = this[CALLBACK_MAX_US]
+    val streamRecoveries get() = this[STREAM_RECOVERIES]
+    val sources get() = this[SOURCES]
+    val deviceBufferMs get() = this[DEVICE_BUFFER_US] / 1000.0
+    val outputLatencyMs get() = this[OUTPUT_LATENCY_US] / 1000.0 // < 0 = indisponível
+    val totalLatencyMs get() = this[TOTAL_LATENCY_US] / 1000
+    val bufferGrowths get() = this[BUFFER_GROWTHS]
+    val udpDatagrams get() = this[UDP_DATAGRAMS]
+    val udpDropped get() = this[UDP_DROPPED]
+    val maxBufferMs get() = this[MAX_BUFFER_FRAMES] * 1000 / sampleRate
+    val callbackBudgetUs get() = this[CALLBACK_BUDGET_US] // Período do burst
+    val callbackLoadPercent get() = this[CALLBACK_LOAD_PERMILLE] / 10.0 // Do período, média móvel
+    val callbackLoadMaxPercent get() = this[CALLBACK_LOAD_MAX_PERMILLE] / 10.0
+    val callbacksOverBudget get() = this[CALLBACK_OVER_BUDGET] // Acima de 80% do período
+    val callbackCpu get() = this[CALLBACK_CPU].toInt() // -1 = desconhecido
+    val isCallbackPinned get() = this[CALLBACK_CPU_MASK] != 0L
+    val isPerformanceHint get() = this[PERFORMANCE_HINT] != 0L
+    val silentPackets get() = this[SILENT_PACKETS] // Marcadores DTX do sender
+    val receivedPackets get() = this[RECEIVED_PACKETS]
+    val isPowerSaving get() = this[POWER_SAVING] != 0L
+    val callbackFrames get() = this[CALLBACK_FRAMES]
+    val callbackWakeupsPerSecond get() = this[CALLBACK_WAKEUPS_PER_S] // Despertares do callback
+    val ingestWakeupsPerSecond get() = this[INGEST_WAKEUPS_PER_S] // Entregas da rede ao nativo
+    val isPrebuffering get() = this[STATE] and STATE_PREBUFFERING != 0L
+    val isScheduled get() = this[STATE] and STATE_SCHEDULED != 0L
+    val isBuilding get() = this[STATE] and STATE_BUILDING != 0L
+
+    fun callbackHistogram() = LongArray(HISTOGRAM_BUCKETS) { this[CALLBACK_HISTOGRAM + it] }
+    fun fillHistogram() = LongArray(HISTOGRAM_BUCKETS) { this[FILL_HISTOGRAM + it] }
+
+    // Resumo de uma linha para a tela do receptor
+    fun summary(): String {
+        val mode = when {
+            isPrebuffering -> "prebuffer"
+            isScheduled -> "sync"
+            isBuilding -> "fast start"
+            else -> "adaptive"
+        }
+        val xrunText = if (xruns < 0) "n/a" else xruns.toString()
+        return "Buffer ${bufferMs}/${targetMs}ms (max ${maxBufferMs}ms, $mode) · jitter ${String.format("%.1f", arrivalJitterMs)}ms · " +
+            "drift ${clockDriftPpm}ppm (ratio ${ratioPpm}ppm)\n" +
+            "Callback ${callbackLastUs}µs (max ${callbackMaxUs}µs) · UR $underruns · XRun $xrunText · " +
+            "reopen $streamRecoveries · senders $sources · " +
+            "lost ${this[LOST_PACKETS]} concealed ${this[CONCEALED_PACKETS]} silent $silentPackets\n" +
+            "CPU ${String.format("%.0f", callbackLoadPercent)}% de ${callbackBudgetUs}µs " +
+            "(max ${String.format("%.0f", callbackLoadMaxPercent)}%, >80% $callbacksOverBudget) · " +
+            "core $callbackCpu${if (isCallbackPinned) " fixo" else ""}${if (isPerformanceHint) " · ADPF" else ""}\n" +
+            "${if (isPowerSaving) "Economia" else "Baixa latência"} · callback $callbackFrames frames · " +
+            "despertares $callbackWakeupsPerSecond/s (rede $ingestWakeupsPerSecond/s)\n" +
+            "Latência ${totalLatencyMs}ms · device ${String.format("%.1f", deviceBufferMs)}ms (+$bufferGrowths)" +
+            (if (udpDatagrams > 0) " · UDP $udpDatagrams (drop $udpDropped)" else "")
+    }
+}